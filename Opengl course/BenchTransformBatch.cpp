@@ -0,0 +1,96 @@
+// microbenchmark: batched SoA transform kernels (transform_batch.h) vs the usual one-at-a-time glm path
+// no window or GL context needed, it just does the CPU side matrix math and prints timings
+
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <random>
+#include <chrono>
+#include <cmath>
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/quaternion.hpp>
+#include "transform_batch.h"
+
+const int OBJECT_COUNTS[] = { 64, 1024, 16384, 131072 };
+const int REPEATS = 50;
+
+// biggest difference between two sets of matrices, to make sure the fast path isn't just fast and wrong
+template <class M, int COLS, int ROWS>
+float maxError(const std::vector<M>& a, const std::vector<M>& b)
+{
+	float err = 0.0f;
+	for (size_t i = 0; i < a.size(); i++)
+		for (int c = 0; c < COLS; c++)
+			for (int r = 0; r < ROWS; r++)
+				err = std::max(err, std::fabs(a[i][c][r] - b[i][c][r]));
+	return err;
+}
+
+int main()
+{
+	std::cout << "transform batch SIMD path: " << TRANSFORM_BATCH_SIMD << std::endl;
+
+	std::mt19937 rng(1234);
+	std::uniform_real_distribution<float> pos(-50.0f, 50.0f);
+	std::uniform_real_distribution<float> angle(0.0f, 6.2831853f);
+	std::uniform_real_distribution<float> scl(0.25f, 4.0f);
+
+	glm::mat4 view = glm::lookAt(glm::vec3(0.0f, 10.0f, 30.0f), glm::vec3(0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+	glm::mat4 projection = glm::perspective(glm::radians(45.0f), 800.0f / 600.0f, 0.1f, 100.0f);
+	glm::mat4 viewProjection = projection * view;
+
+	for (int count : OBJECT_COUNTS)
+	{
+		// same objects for both paths
+		std::vector<glm::vec3> positions(count), scales(count);
+		std::vector<glm::quat> rotations(count);
+		TransformBatch batch;
+		batch.resize(count);
+		for (int i = 0; i < count; i++)
+		{
+			positions[i] = glm::vec3(pos(rng), pos(rng), pos(rng));
+			glm::vec3 axis = glm::normalize(glm::vec3(pos(rng), pos(rng), pos(rng)) + glm::vec3(0.001f));
+			rotations[i] = glm::angleAxis(angle(rng), axis);
+			scales[i] = glm::vec3(scl(rng), scl(rng), scl(rng));
+			batch.set(i, positions[i], rotations[i], scales[i]);
+		}
+
+		std::vector<glm::mat4> worldA(count), mvpA(count), worldB(count), mvpB(count);
+		std::vector<glm::mat3> normalA(count), normalB(count);
+
+		// scalar glm path, what the chapters do per cube
+		auto start = std::chrono::steady_clock::now();
+		for (int rep = 0; rep < REPEATS; rep++)
+		{
+			for (int i = 0; i < count; i++)
+			{
+				glm::mat4 model = glm::mat4(1.0f);
+				model = glm::translate(model, positions[i]);
+				model = model * glm::mat4_cast(rotations[i]);
+				model = glm::scale(model, scales[i]);
+				worldA[i] = model;
+				mvpA[i] = viewProjection * model;
+				normalA[i] = glm::transpose(glm::inverse(glm::mat3(model)));
+			}
+		}
+		double glmNs = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+
+		// batched path
+		start = std::chrono::steady_clock::now();
+		for (int rep = 0; rep < REPEATS; rep++)
+		{
+			batch.compose(viewProjection, worldB.data(), mvpB.data(), normalB.data());
+		}
+		double batchNs = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+
+		double perObjectGlm = glmNs / ((double)REPEATS * count);
+		double perObjectBatch = batchNs / ((double)REPEATS * count);
+		std::cout << std::setw(7) << count << " objects | glm: " << std::fixed << std::setprecision(2) << std::setw(7) << perObjectGlm
+			<< " ns/obj | batch: " << std::setw(7) << perObjectBatch << " ns/obj | speedup " << perObjectGlm / perObjectBatch << "x"
+			<< " | max err world " << std::scientific << maxError<glm::mat4, 4, 4>(worldA, worldB)
+			<< " mvp " << maxError<glm::mat4, 4, 4>(mvpA, mvpB)
+			<< " normal " << maxError<glm::mat3, 3, 3>(normalA, normalB) << std::defaultfloat << std::endl;
+	}
+	return 0;
+}
@@ -0,0 +1,338 @@
+// make sure that glad comes before glfw
+
+#include <glad/glad.h>
+#include <glfw3.h>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <thread>
+#include <cstring>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include "shader_s.h"
+#include "batch_renderer.h"
+#include "transform_hierarchy.h"
+#include "image_write.h"
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+#define STB_IMAGE_IMPLEMENTATION
+#include "stb_image.h"
+
+// Ch10CameraCircle's orbit rendered offline: frame i looks from angle 2 pi * i / frames instead of glfwGetTime(),
+// spread over several GL contexts on their own threads (batch_renderer.h). The same batch is run with 1, 2, 4 ...
+// threads to show how it scales. usage:
+//   Ch10BatchOrbit [-frames n] [-size WxH] [-threads n] [-out dir]
+// -threads is the most contexts to try (cores by default), -out writes every frame as a PNG
+
+unsigned int loadTexture(const char* path);
+
+// the per frame contents of the Frame uniform block in Shaders/Ch10BatchOrbit/vs.glsl, std140
+struct FrameBlock
+{
+	glm::mat4 viewProjection;
+	glm::mat4 models[10];
+};
+
+// the shared objects are made once on the main context, every worker only reads them
+class OrbitJob : public BatchJob
+{
+public:
+	unsigned int program, texture1, texture2, vertexBuffer;
+	int frameCount;
+	float aspect;
+	glm::mat4 models[10];
+	int width = 0, height = 0;
+	std::string outputDirectory;        // empty: don't write the frames out
+
+	OrbitJob(int workers) : vertexArrays(workers), frameBuffers(workers) {}
+
+	void begin(int worker) override
+	{
+		// VAOs aren't shared between contexts, the buffer they point at is
+		glGenVertexArrays(1, &vertexArrays[worker]);
+		glBindVertexArray(vertexArrays[worker]);
+		glBindBuffer(GL_ARRAY_BUFFER, vertexBuffer);
+		glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)0);
+		glEnableVertexAttribArray(0);
+		glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)(3 * sizeof(float)));
+		glEnableVertexAttribArray(1);
+
+		// this context's uniform block buffer
+		glGenBuffers(1, &frameBuffers[worker]);
+		glBindBuffer(GL_UNIFORM_BUFFER, frameBuffers[worker]);
+		glBufferData(GL_UNIFORM_BUFFER, sizeof(FrameBlock), nullptr, GL_STREAM_DRAW);
+		glBindBufferBase(GL_UNIFORM_BUFFER, 0, frameBuffers[worker]);
+
+		// the rest is context state too, set once per context
+		glUseProgram(program);
+		glActiveTexture(GL_TEXTURE0);
+		glBindTexture(GL_TEXTURE_2D, texture1);
+		glActiveTexture(GL_TEXTURE1);
+		glBindTexture(GL_TEXTURE_2D, texture2);
+		glEnable(GL_DEPTH_TEST);
+	}
+	void render(int worker, int frame) override
+	{
+		// same camera as Ch10CameraCircle, with the angle picked by frame number
+		float angle = glm::radians(360.0f) * frame / frameCount;
+		float radius = 10.0f;
+		glm::vec3 cameraPos = glm::vec3(cos(angle) * radius, -10.0f, sin(angle) * radius);
+		glm::mat4 view = glm::lookAt(cameraPos, glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+		glm::mat4 projection = glm::perspective(glm::radians(25.0f), aspect, 0.1f, 100.0f);
+
+		FrameBlock block;
+		block.viewProjection = projection * view;
+		for (int i = 0; i < 10; i++)
+			block.models[i] = models[i];
+		glBindBuffer(GL_UNIFORM_BUFFER, frameBuffers[worker]);
+		glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(block), &block);
+
+		glClearColor(0.2f, 0.3f, 0.3f, 1.0f);
+		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+		glBindVertexArray(vertexArrays[worker]);
+		glDrawArraysInstanced(GL_TRIANGLES, 0, 36, 10);
+	}
+	void frameDone(int worker, int frame, const unsigned char* pixels) override
+	{
+		if (!outputDirectory.empty())
+		{
+			char name[32];
+			std::snprintf(name, sizeof(name), "/frame_%05d.png", frame);
+			ImageWriter::writePng(outputDirectory + name, width, height, 4, pixels);
+		}
+	}
+	void end(int worker) override
+	{
+		glDeleteVertexArrays(1, &vertexArrays[worker]);
+		glDeleteBuffers(1, &frameBuffers[worker]);
+	}
+
+private:
+	std::vector<unsigned int> vertexArrays, frameBuffers;
+};
+
+int main(int argc, char** argv)
+{
+	int frames = 2000, width = 800, height = 600;
+	int maxThreads = (int)std::max(std::thread::hardware_concurrency(), 1u);
+	std::string outputDirectory;
+	const char* usage = "usage: Ch10BatchOrbit [-frames n] [-size WxH] [-threads n] [-out dir]";
+	for (int i = 1; i < argc; i++)
+	{
+		bool hasValue = i + 1 < argc;
+		if (std::strcmp(argv[i], "-frames") == 0 && hasValue)
+			frames = std::max(std::atoi(argv[++i]), 1);
+		else if (std::strcmp(argv[i], "-size") == 0 && hasValue)
+		{
+			// an empty image would divide by zero in the aspect and make zero sized renderbuffers
+			if (std::sscanf(argv[++i], "%dx%d", &width, &height) != 2 || width <= 0 || height <= 0)
+			{
+				std::cout << usage << std::endl;
+				return 1;
+			}
+		}
+		else if (std::strcmp(argv[i], "-threads") == 0 && hasValue)
+			maxThreads = std::max(std::atoi(argv[++i]), 1);
+		else if (std::strcmp(argv[i], "-out") == 0 && hasValue)
+			outputDirectory = argv[++i];
+		else
+		{
+			std::cout << usage << std::endl;
+			return 1;
+		}
+	}
+
+	// -------------------------------------------- Start Initialization ------------------------------- //
+	glfwInit();
+	// set OpenGL version to 3.3
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+
+	// Core mode over immediate mode
+	glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+
+	// nothing gets shown, this window is only here for its context (the one the shared objects are made on)
+	glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+	GLFWwindow* window = glfwCreateWindow(16, 16, "LearnOpenGL", NULL, NULL);
+	if (window == NULL)
+	{
+		std::cout << "Failed to create GLFW window" << std::endl;
+		glfwTerminate();
+		return -1;
+	}
+	glfwMakeContextCurrent(window);
+
+	// intitialize GLAD
+	if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
+	{
+		std::cout << "Failed to initialize GLAD" << std::endl;
+		return -1;
+	}
+	// -------------------------------------------- End Initialization ------------------------------- //
+
+	// shared between every context: the program, the textures, the vertex buffer
+	Shader ourShaders("./Shaders/Ch10BatchOrbit/vs.glsl", "./Shaders/Ch10BatchOrbit/fs.glsl");
+	// program state, so set it here once and the workers never touch it
+	ourShaders.use();
+	glUniform1i(glGetUniformLocation(ourShaders.ID, "texture1"), 0);
+	glUniform1i(glGetUniformLocation(ourShaders.ID, "texture2"), 1);
+	glUniformBlockBinding(ourShaders.ID, glGetUniformBlockIndex(ourShaders.ID, "Frame"), 0);
+
+	stbi_set_flip_vertically_on_load(true);
+	unsigned int texture1 = loadTexture("images/wood.png");
+	unsigned int texture2 = loadTexture("images/tf.png");
+	if (!texture1 || !texture2)
+	{
+		std::cout << "Failed to load textures" << std::endl;
+		glfwTerminate();
+		return -1;
+	}
+
+	// -------------------------------------------- DATA ------------------------------- //
+	float vertices[] = {
+		-0.5f, -0.5f, -0.5f,  0.0f, 0.0f,
+		 0.5f, -0.5f, -0.5f,  1.0f, 0.0f,
+		 0.5f,  0.5f, -0.5f,  1.0f, 1.0f,
+		 0.5f,  0.5f, -0.5f,  1.0f, 1.0f,
+		-0.5f,  0.5f, -0.5f,  0.0f, 1.0f,
+		-0.5f, -0.5f, -0.5f,  0.0f, 0.0f,
+
+		-0.5f, -0.5f,  0.5f,  0.0f, 0.0f,
+		 0.5f, -0.5f,  0.5f,  1.0f, 0.0f,
+		 0.5f,  0.5f,  0.5f,  1.0f, 1.0f,
+		 0.5f,  0.5f,  0.5f,  1.0f, 1.0f,
+		-0.5f,  0.5f,  0.5f,  0.0f, 1.0f,
+		-0.5f, -0.5f,  0.5f,  0.0f, 0.0f,
+
+		-0.5f,  0.5f,  0.5f,  1.0f, 0.0f,
+		-0.5f,  0.5f, -0.5f,  1.0f, 1.0f,
+		-0.5f, -0.5f, -0.5f,  0.0f, 1.0f,
+		-0.5f, -0.5f, -0.5f,  0.0f, 1.0f,
+		-0.5f, -0.5f,  0.5f,  0.0f, 0.0f,
+		-0.5f,  0.5f,  0.5f,  1.0f, 0.0f,
+
+		 0.5f,  0.5f,  0.5f,  1.0f, 0.0f,
+		 0.5f,  0.5f, -0.5f,  1.0f, 1.0f,
+		 0.5f, -0.5f, -0.5f,  0.0f, 1.0f,
+		 0.5f, -0.5f, -0.5f,  0.0f, 1.0f,
+		 0.5f, -0.5f,  0.5f,  0.0f, 0.0f,
+		 0.5f,  0.5f,  0.5f,  1.0f, 0.0f,
+
+		-0.5f, -0.5f, -0.5f,  0.0f, 1.0f,
+		 0.5f, -0.5f, -0.5f,  1.0f, 1.0f,
+		 0.5f, -0.5f,  0.5f,  1.0f, 0.0f,
+		 0.5f, -0.5f,  0.5f,  1.0f, 0.0f,
+		-0.5f, -0.5f,  0.5f,  0.0f, 0.0f,
+		-0.5f, -0.5f, -0.5f,  0.0f, 1.0f,
+
+		-0.5f,  0.5f, -0.5f,  0.0f, 1.0f,
+		 0.5f,  0.5f, -0.5f,  1.0f, 1.0f,
+		 0.5f,  0.5f,  0.5f,  1.0f, 0.0f,
+		 0.5f,  0.5f,  0.5f,  1.0f, 0.0f,
+		-0.5f,  0.5f,  0.5f,  0.0f, 0.0f,
+		-0.5f,  0.5f, -0.5f,  0.0f, 1.0f
+	};
+
+	glm::vec3 cubePositions[] = {
+		glm::vec3(0.0f, 0.0f, 0.0f),
+		glm::vec3(2.0f, 5.0f, -15.0f),
+		glm::vec3(-1.5f, -2.2f, -2.5f),
+		glm::vec3(-3.8f, -2.0f, -12.3f),
+		glm::vec3(2.4f, -0.4f, -3.5f),
+		glm::vec3(-1.7f, 3.0f, -7.5f),
+		glm::vec3(1.3f, -2.0f, -2.5f),
+		glm::vec3(1.5f, 2.0f, -2.5f),
+		glm::vec3(1.5f, 0.2f, -1.5f),
+		glm::vec3(-1.3f, 1.0f, -1.5f)
+	};
+	TransformHierarchy cubeTransforms;
+	for (int i = 0; i < 10; i++) {
+		cubeTransforms.addNode(TransformHierarchy::NO_PARENT, cubePositions[i]);
+	}
+	cubeTransforms.update();
+
+	unsigned int VBO;
+	glGenBuffers(1, &VBO);
+	glBindBuffer(GL_ARRAY_BUFFER, VBO);
+	glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+	// --------------------------------------------  ------------------------------- //
+	// the contexts for the largest run, the smaller runs use the first few of them. in a block so they're
+	// gone before glfwTerminate
+	{
+		BatchRenderer batch(window, maxThreads, width, height);
+		OrbitJob job(batch.contexts());
+		job.program = ourShaders.ID;
+		job.texture1 = texture1;
+		job.texture2 = texture2;
+		job.vertexBuffer = VBO;
+		job.frameCount = frames;
+		job.aspect = (float)width / (float)height;
+		job.width = width;
+		job.height = height;
+		for (int i = 0; i < 10; i++)
+			job.models[i] = cubeTransforms.world(i);
+		// 1, 2, 4, ... threads, and all of them last
+		std::vector<int> threadCounts;
+		for (int threads = 1; threads < batch.contexts(); threads *= 2)
+			threadCounts.push_back(threads);
+		threadCounts.push_back(batch.contexts());
+
+		std::cout << frames << " frames at " << width << "x" << height << std::endl;
+		double singleThreaded = 0.0;
+		for (int threads : threadCounts)
+		{
+			BatchResult result = batch.run(job, threads, frames);
+			if (threads == 1)
+				singleThreaded = result.framesPerSecond();
+			std::cout << result.threads << " threads: " << result.seconds * 1000.0 << " ms, " << result.framesPerSecond() << " frames/s, "
+				<< (singleThreaded > 0.0 ? result.framesPerSecond() / singleThreaded : 0.0) << "x" << std::endl;
+		}
+
+		// writing PNGs would swamp the timings, so the frames get saved in one more run after them
+		if (!outputDirectory.empty())
+		{
+			std::error_code error;
+			std::filesystem::create_directories(outputDirectory, error);
+			job.outputDirectory = outputDirectory;
+			BatchResult result = batch.run(job, batch.contexts(), frames);
+			std::cout << "wrote " << frames << " frames to " << outputDirectory << " in " << result.seconds << " s" << std::endl;
+		}
+	}
+
+	// de allocate stuff
+	glDeleteBuffers(1, &VBO);
+	glDeleteTextures(1, &texture1);
+	glDeleteTextures(1, &texture2);
+
+	// close the application
+	glfwTerminate();
+	return 0;
+}
+
+// a mipmapped GL_REPEAT / GL_LINEAR texture, like the ones Ch10CameraCircle makes. 0 if the file didn't load
+unsigned int loadTexture(const char* path)
+{
+	int width, height, numChannels;
+	unsigned char* data = stbi_load(path, &width, &height, &numChannels, 4);
+	if (!data)
+	{
+		std::cout << "[textures] stbi image failed! " << path << std::endl;
+		return 0;
+	}
+	unsigned int texture;
+	glGenTextures(1, &texture);
+	glBindTexture(GL_TEXTURE_2D, texture);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, data);
+	glGenerateMipmap(GL_TEXTURE_2D);
+	stbi_image_free(data);
+	return texture;
+}
@@ -3,10 +3,12 @@
 #include <glad/glad.h>
 #include <glfw3.h>
 #include <iostream>
+#include "cpu_profiler.h"
 #include "shader_s.h"
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
+#include "transform_hierarchy.h"
 
 #define STB_IMAGE_IMPLEMENTATION
 #include "stb_image.h"
@@ -177,6 +179,11 @@ int main()
 		glm::vec3(1.5f, 0.2f, -1.5f),
 		glm::vec3(-1.3f, 1.0f, -1.5f)
 	};
+	// one node per cube, none of them have a parent. world matrices get built once on the first update()
+	TransformHierarchy cubeTransforms;
+	for (int i = 0; i < 10; i++) {
+		cubeTransforms.addNode(TransformHierarchy::NO_PARENT, cubePositions[i]);
+	}
 	// index data (which point is what vertex of the rectangle)
 	// ------------------------------------------------------------------ //
 
@@ -251,9 +258,7 @@ int main()
 	glUniform1i(glGetUniformLocation(ourShaders.ID, "texture1"), 0);
 	glUniform1i(glGetUniformLocation(ourShaders.ID, "texture2"), 1);
 
-	glUniformMatrix4fv(glGetUniformLocation(ourShaders.ID, "model"), 1, GL_FALSE, glm::value_ptr(model));
-	// glUniformMatrix4fv(glGetUniformLocation(ourShaders.ID, "view"), 1, GL_FALSE, glm::value_ptr(view));
-	glUniformMatrix4fv(glGetUniformLocation(ourShaders.ID, "projection"), 1, GL_FALSE, glm::value_ptr(projection));
+	ourShaders.setModel(model);
 
 	// ------------------------------------------------ END SET UNIFORMS ------------------------------- //
 
@@ -263,6 +268,7 @@ int main()
 	// simple render loop (its just a while loop!)
 	while (!glfwWindowShouldClose(window))
 	{
+		PROFILE_SCOPE("frame");
 		// nicer background color than black
 		glClearColor(0.2f, 0.3f, 0.3f, 1.0f);
 		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
@@ -285,52 +291,64 @@ int main()
 		// camera info
 		// this vector goes from global origin TO camera
 
-		float radius = 10.0f;
-		glm::vec3 cameraPos = glm::vec3(cos(glfwGetTime()) * radius, -10.0f, sin(glfwGetTime()) * radius);
-		glm::vec3 cameraTarget = glm::vec3(0.0f, 0.0f, 0.0f);
-		//glm::vec3 cameraVector = glm::normalize(cameraPos - cameraTarget);
-		glm::vec3 cameraVector = cameraPos;
+		{
+			PROFILE_SCOPE("uniforms");
+			float radius = 10.0f;
+			glm::vec3 cameraPos = glm::vec3(cos(glfwGetTime()) * radius, -10.0f, sin(glfwGetTime()) * radius);
+			glm::vec3 cameraTarget = glm::vec3(0.0f, 0.0f, 0.0f);
+			//glm::vec3 cameraVector = glm::normalize(cameraPos - cameraTarget);
+			glm::vec3 cameraVector = cameraPos;
 
-		glm::vec3 up = glm::vec3(0.0f, 1.0f, 0.0f);
+			glm::vec3 up = glm::vec3(0.0f, 1.0f, 0.0f);
 
 
-		// lookAt arguemnts: camera position, camera target, camera up
-		// this result becomes the new view matrix (remember view matrix sends global coords to camera coords)
-		// whichis the definition of lookAt
-		view = glm::lookAt(cameraPos, cameraTarget, up);
+			// lookAt arguemnts: camera position, camera target, camera up
+			// this result becomes the new view matrix (remember view matrix sends global coords to camera coords)
+			// whichis the definition of lookAt
+			view = glm::lookAt(cameraPos, cameraTarget, up);
 
 
 
-		glUniformMatrix4fv(glGetUniformLocation(ourShaders.ID, "view"), 1, GL_FALSE, glm::value_ptr(view));
+			ourShaders.setViewProjection(view, projection);
+		}
 
 		ourShaders.use();
 		// draws two triangles
 		glBindVertexArray(VAO);
 
 
+		// cubes don't move, so this is a no-op every frame after the first one
+		cubeTransforms.update();
+
 		// uncomment above for just one cube, this code here is for rendering 10 cubes~!
-		for (int i = 0; i < 10; i++) {
-			glm::mat4 model = glm::mat4(1.0f);
-			model = glm::translate(model, cubePositions[i]);
-
-			model = glm::rotate(model, glm::radians(0.0f), glm::vec3(1.0f, 0.0f, 0.0f));
-			model = glm::rotate(model, glm::radians(0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
-			glUniformMatrix4fv(glGetUniformLocation(ourShaders.ID, "model"), 1, GL_FALSE, glm::value_ptr(model));
-			glDrawArrays(GL_TRIANGLES, 0, 36);
+		{
+			PROFILE_SCOPE("draw");
+			for (int i = 0; i < 10; i++) {
+				glUniformMatrix4fv(glGetUniformLocation(ourShaders.ID, "model"), 1, GL_FALSE, glm::value_ptr(cubeTransforms.world(i)));
+				glDrawArrays(GL_TRIANGLES, 0, 36);
+			}
 		}
 
 
 		// does a double buffer swap to avoid flickering
-		glfwSwapBuffers(window);
+		{
+			PROFILE_SCOPE("swap");
+			glfwSwapBuffers(window);
+		}
 
 		// process any keypresses
-		glfwPollEvents();
+		{
+			PROFILE_SCOPE("poll events");
+			glfwPollEvents();
+		}
 	}
 
 	// de allocate stuff (here its the VBO and VAOs)
 	glDeleteVertexArrays(1, &VAO);
 	glDeleteBuffers(1, &VBO);
 
+	CpuProfiler::writeChromeTrace("cpu_trace.json");
+
 	// close the application 
 	glfwTerminate();
 	return 0;
@@ -3,7 +3,8 @@
 #include <glad/glad.h>
 #include <glfw3.h>
 #include <iostream>
-#include "shader_m.h"
+#include "cpu_profiler.h"
+#include "shader_pipeline.h"
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
@@ -38,9 +39,9 @@ int main()
 {
 	// -------------------------------------------- Start Initialization ------------------------------- //
 	glfwInit();
-	// set OpenGL version to 3.3
-	glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
-	glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+	// separable programs + program pipelines need OpenGL 4.1
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 1);
 
 	// Core mode over immediate mode
 	glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
@@ -71,8 +72,19 @@ int main()
 	// -------------------------------------------- End Initialization ------------------------------- //
 
 	// load shaders
-	Shader ourShaders("./Shaders/Ch12Lighting/vs.glsl", "./Shaders/Ch12Lighting/fs.glsl");
-	Shader lightShaders("./Shaders/Ch12Lighting/vs.glsl", "./Shaders/Ch12Lighting/light_cube_fs.glsl");
+	// both cubes use the same vertex shader, so it's compiled once as its own stage and each
+	// fragment shader gets plugged in next to it with a pipeline (no relinking the vertex shader twice)
+	ShaderStage vertexStage(GL_VERTEX_SHADER, "./Shaders/Ch12Lighting/vs.glsl");
+	ShaderStage objectFragmentStage(GL_FRAGMENT_SHADER, "./Shaders/Ch12Lighting/fs.glsl");
+	ShaderStage lightFragmentStage(GL_FRAGMENT_SHADER, "./Shaders/Ch12Lighting/light_cube_fs.glsl");
+	ShaderPipeline ourShaders(vertexStage, objectFragmentStage);
+	ShaderPipeline lightShaders(vertexStage, lightFragmentStage);
+	ourShaders.validate();
+	lightShaders.validate();
+
+	// these never change, and with separable stages uniforms can be set without binding anything
+	objectFragmentStage.setVec3("objectColor", 1.0f, 0.5f, 0.31f);
+	objectFragmentStage.setVec3("lightColor", 1.0f, 1.0f, 1.0f);
 
 
 	// -------------------------------------------- DATA ------------------------------- //
@@ -155,6 +167,7 @@ int main()
 	// simple render loop (its just a while loop!)
 	while (!glfwWindowShouldClose(window))
 	{
+		PROFILE_SCOPE("frame");
 		// per-frame time logic
 		// --------------------
 		float currentFrame = static_cast<float>(glfwGetTime());
@@ -163,60 +176,78 @@ int main()
 
 		// input
 		// -----
-		processInput(window);
+		{
+			PROFILE_SCOPE("input");
+			processInput(window);
+		}
 
 		// nicer background color than black
 		glClearColor(0.2f, 0.3f, 0.3f, 1.0f);
 		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
-		ourShaders.use(); // using cube shaders
-		ourShaders.setVec3("objectColor", 1.0f, 0.5f, 0.31f);
-		ourShaders.setVec3("lightColor", 1.0f, 1.0f, 1.0f);
-
-		// lookAt arguemnts: camera position, camera target, camera up
-		// this result becomes the new view matrix (remember view matrix sends global coords to camera coords)
-		// whichis the definition of lookAt
-		glm::mat4 view = camera.GetViewMatrix();
-		glUniformMatrix4fv(glGetUniformLocation(ourShaders.ID, "view"), 1, GL_FALSE, glm::value_ptr(view));
-
-		// for projection, use a perspective projection with 45 degree FOV and following settings below:
-		glm::mat4 projection = glm::mat4(1.0f);
-		float nearPlanes = 0.1f;
-		float farPlanes = 100.0f;
-		projection = glm::perspective(glm::radians(camera.Zoom), 800.0f / 600.0f, nearPlanes, farPlanes);
-		glUniformMatrix4fv(glGetUniformLocation(ourShaders.ID, "projection"), 1, GL_FALSE, glm::value_ptr(projection));
-
-		// model
-		glm::mat4 model = glm::mat4(1.0f);
-		glUniformMatrix4fv(glGetUniformLocation(ourShaders.ID, "model"), 1, GL_FALSE, glm::value_ptr(model));
-
-		glBindVertexArray(VAO);
-		glDrawArrays(GL_TRIANGLES, 0, 36);
-
-		// DRAW ANOTHER CUBE
-		// same mvp matrices except this seconds cube is a little smaller.
-		lightShaders.use();
-		lightShaders.setMat4("projection", projection);
-		lightShaders.setMat4("view", view);
-		model = glm::mat4(1.0f);
-		model = glm::translate(model, lightPos);
-		model = glm::scale(model, glm::vec3(0.2f)); // a smaller cube
-		lightShaders.setMat4("model", model);
-
-		glBindVertexArray(lightVAO);
-		glDrawArrays(GL_TRIANGLES, 0, 36);
+		{
+			PROFILE_SCOPE("uniforms");
+			// lookAt arguemnts: camera position, camera target, camera up
+			// this result becomes the new view matrix (remember view matrix sends global coords to camera coords)
+			// whichis the definition of lookAt
+			glm::mat4 view = camera.GetViewMatrix();
+
+			// for projection, use a perspective projection with 45 degree FOV and following settings below:
+			glm::mat4 projection = glm::mat4(1.0f);
+			float nearPlanes = 0.1f;
+			float farPlanes = 100.0f;
+			projection = glm::perspective(glm::radians(camera.Zoom), 800.0f / 600.0f, nearPlanes, farPlanes);
+			// the vertex stage is shared, so this one upload covers both cubes
+			vertexStage.setViewProjection(view, projection);
+		}
+
+		{
+			PROFILE_SCOPE("draw");
+			ourShaders.bind(); // using cube shaders
+
+			// model
+			glm::mat4 model = glm::mat4(1.0f);
+			vertexStage.setModel(model);
+
+			glBindVertexArray(VAO);
+			glDrawArrays(GL_TRIANGLES, 0, 36);
+
+			// DRAW ANOTHER CUBE
+			// same mvp matrices except this seconds cube is a little smaller.
+			lightShaders.bind();
+			model = glm::mat4(1.0f);
+			model = glm::translate(model, lightPos);
+			model = glm::scale(model, glm::vec3(0.2f)); // a smaller cube
+			vertexStage.setModel(model);
+
+			glBindVertexArray(lightVAO);
+			glDrawArrays(GL_TRIANGLES, 0, 36);
+		}
 
 		// does a double buffer swap to avoid flickering
-		glfwSwapBuffers(window);
+		{
+			PROFILE_SCOPE("swap");
+			glfwSwapBuffers(window);
+		}
 
 		// process any keypresses
-		glfwPollEvents();
+		{
+			PROFILE_SCOPE("poll events");
+			glfwPollEvents();
+		}
 	}
 
 	// de allocate stuff (here its the VBO and VAOs)
 	glDeleteVertexArrays(1, &VAO);
 	glDeleteVertexArrays(1, &lightVAO);
 	glDeleteBuffers(1, &VBO);
+	ourShaders.release();
+	lightShaders.release();
+	vertexStage.release();
+	objectFragmentStage.release();
+	lightFragmentStage.release();
+
+	CpuProfiler::writeChromeTrace("cpu_trace.json");
 
 	// close the application 
 	glfwTerminate();
@@ -3,7 +3,15 @@
 #include <glad/glad.h>
 #include <glfw3.h>
 #include <iostream>
-#include "shader_m.h"
+#include "cpu_profiler.h"
+#include "gpu_profiler.h"
+#include "gl_call_stats.h"
+#include "shader_s.h"
+#include "shader_watcher.h"
+#include "shader_variants.h"
+#include "vertex_compression.h"
+#include "frame_capture.h"
+#include "perf_overlay.h"
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
@@ -27,6 +35,17 @@ const int WINDOW_HEIGHT = 600;
 
 // lighting
 // glm::vec3 lightPos(1.2f, 1.0f, 2.0f);
+// keys 1-4 pick how many lights, X turns specular on/off. both are compile time switches in the fragment shader
+const int MAX_LIGHTS = 4;
+const glm::vec3 lightColors[MAX_LIGHTS] = { glm::vec3(1.0f), glm::vec3(1.0f, 0.4f, 0.4f), glm::vec3(0.4f, 1.0f, 0.4f), glm::vec3(0.4f, 0.4f, 1.0f) };
+int numLights = 1;
+bool useSpecular = true;
+bool specularKeyDown = false;
+
+// recording: C writes a PNG per frame into capture/, V pipes the frames to ffmpeg for capture.mp4
+FrameCapture frameCapture;
+bool pngKeyDown = false;
+bool videoKeyDown = false;
 
 // camera
 Camera camera(glm::vec3(0.0f, 0.0f, 3.0f));
@@ -61,6 +80,8 @@ int main()
 		return -1;
 	}
 
+	GlCallStats::install();
+
 	// set viewport (lower left, lower right, width, height)
 	glViewport(0, 0, WINDOW_WIDTH, WINDOW_HEIGHT);
 
@@ -71,8 +92,12 @@ int main()
 	// -------------------------------------------- End Initialization ------------------------------- //
 
 	// load shaders
-	Shader ourShaders("./Shaders/Ch13DiffuseAndSpecular/vs.glsl", "./Shaders/Ch13DiffuseAndSpecular/fs.glsl");
 	Shader lightShaders("./Shaders/Ch12Lighting/vs.glsl", "./Shaders/Ch12Lighting/light_cube_fs.glsl");
+	// edit and save any of the .glsl files while this is running and they get recompiled on the fly
+	ShaderWatcher shaderWatcher;
+	shaderWatcher.watch(lightShaders);
+	// one program per (NUM_LIGHTS, USE_SPECULAR) combination, each compiled the first time it's needed
+	ShaderVariants litShaders("./Shaders/Ch13DiffuseAndSpecular/vs.glsl", "./Shaders/Ch13DiffuseAndSpecular/fs.glsl", &shaderWatcher);
 
 
 	// -------------------------------------------- DATA ------------------------------- //
@@ -134,17 +159,14 @@ int main()
 
 	glBindBuffer(GL_ARRAY_BUFFER, VBO);
 
-	glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
-
-	// x,y,z TEXTURE ATTRIBUTES 
-	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(float),
-		(void*)0);
-	glEnableVertexAttribArray(0);
+	// half float positions + normals packed into one 32 bit int: 12 bytes a vertex instead of 24
+	CompressedVertices cube = CompressedVertices::compress(vertices, sizeof(vertices) / (6 * sizeof(float)),
+		{ { 0, 3, VertexEncoding::Half }, { 1, 3, VertexEncoding::Snorm10 } });
+	cube.printReport("Ch13 cube");
+	glBufferData(GL_ARRAY_BUFFER, cube.data.size(), cube.data.data(), GL_STATIC_DRAW);
 
-	// normals
-	glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(float),
-		(void*)(3 * sizeof(float)));
-	glEnableVertexAttribArray(1);
+	// x,y,z as GL_HALF_FLOAT, normals as GL_INT_2_10_10_10_REV
+	cube.setAttributes();
 
 
 	// create VAO for the lighting
@@ -156,14 +178,20 @@ int main()
 
 	// ok we still need this. Just cuz I don't use any of the attributes for the light shader
 	// doesn't mean I don't need to set the vertex attribs for the light VAO
-	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(float), (void*)0);
-	glEnableVertexAttribArray(0);
+	cube.setAttributes();
 
 
+	// times the cubes on the GPU, saved next to the CPU scopes at the end. the GPU times and GL call counts print once a second
+	GpuProfiler gpuProfiler;
+	float statsTimer = 0.0f;
+	// and the same numbers on screen, drawn after the capture so recordings stay clean
+	PerfOverlay overlay;
+
 	glEnable(GL_DEPTH_TEST);
 	// simple render loop (its just a while loop!)
 	while (!glfwWindowShouldClose(window))
 	{
+		PROFILE_SCOPE("frame");
 		// per-frame time logic
 		// --------------------
 		float currentFrame = static_cast<float>(glfwGetTime());
@@ -172,66 +200,140 @@ int main()
 
 		// input
 		// -----
-		processInput(window);
+		{
+			PROFILE_SCOPE("input");
+			processInput(window);
+		}
+
+		// swap in any shaders that were edited since last frame
+		shaderWatcher.poll();
+
+		gpuProfiler.beginFrame();
+		gpuProfiler.beginPass("frame");
 
 		// nicer background color than black
 		glClearColor(0.1f, 0.1f, 0.1f, 0.2f);
 		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
-		// spinning light for lulz
-		glm::vec3 lightPos(1.2f * cos(glfwGetTime()), 1.0f, 1.2f * sin(glfwGetTime()));
-
+		// spinning lights for lulz, spread out evenly around the circle
+		glm::vec3 lightPos[MAX_LIGHTS];
+		for (int i = 0; i < numLights; i++)
+		{
+			float angle = static_cast<float>(glfwGetTime()) + i * glm::radians(360.0f) / numLights;
+			lightPos[i] = glm::vec3(1.2f * cos(angle), 1.0f, 1.2f * sin(angle));
+		}
+
+		// the shader for the current settings. the shader has no runtime branches on them,
+		// the preprocessor defines decide what gets compiled in
+		Shader& ourShaders = litShaders.get({ "NUM_LIGHTS " + std::to_string(numLights), useSpecular ? "USE_SPECULAR 1" : "USE_SPECULAR 0" });
 		ourShaders.use(); // using cube shaders
-		ourShaders.setVec3("objectColor", 0.4f, 0.7f, 0.65f);
-		ourShaders.setVec3("lightColor", 1.0f, 1.0f, 1.0f);
-		ourShaders.setVec3("lightPos", lightPos);
-		ourShaders.setVec3("viewPos", camera.Position);
+		{
+			PROFILE_SCOPE("uniforms");
+			ourShaders.setVec3("objectColor", 0.4f, 0.7f, 0.65f);
+			for (int i = 0; i < numLights; i++)
+			{
+				std::string index = "[" + std::to_string(i) + "]";
+				ourShaders.setVec3("lightColor" + index, lightColors[i]);
+				ourShaders.setVec3("lightPos" + index, lightPos[i]);
+			}
+			ourShaders.setVec3("viewPos", camera.Position);
+		}
 		
 
 		// lookAt arguemnts: camera position, camera target, camera up
 		// this result becomes the new view matrix (remember view matrix sends global coords to camera coords)
 		// whichis the definition of lookAt
 		glm::mat4 view = camera.GetViewMatrix();
-		glUniformMatrix4fv(glGetUniformLocation(ourShaders.ID, "view"), 1, GL_FALSE, glm::value_ptr(view));
 
 		// for projection, use a perspective projection with 45 degree FOV and following settings below:
 		glm::mat4 projection = glm::mat4(1.0f);
 		float nearPlanes = 0.1f;
 		float farPlanes = 100.0f;
 		projection = glm::perspective(glm::radians(camera.Zoom), 800.0f / 600.0f, nearPlanes, farPlanes);
-		glUniformMatrix4fv(glGetUniformLocation(ourShaders.ID, "projection"), 1, GL_FALSE, glm::value_ptr(projection));
+		ourShaders.setViewProjection(view, projection);
 
 		// model
 		glm::mat4 model = glm::mat4(1.0f);
-		glUniformMatrix4fv(glGetUniformLocation(ourShaders.ID, "model"), 1, GL_FALSE, glm::value_ptr(model));
-
-		glBindVertexArray(VAO);
-		glDrawArrays(GL_TRIANGLES, 0, 36);
-
-		// DRAW ANOTHER CUBE
-		// same mvp matrices except this seconds cube is a little smaller.
-		lightShaders.use();
-		lightShaders.setMat4("projection", projection);
-		lightShaders.setMat4("view", view);
-		model = glm::mat4(1.0f);
-		model = glm::translate(model, lightPos);
-		model = glm::scale(model, glm::vec3(0.2f)); // a smaller cube
-		lightShaders.setMat4("model", model);
-
-		glBindVertexArray(lightVAO);
-		glDrawArrays(GL_TRIANGLES, 0, 36);
+		ourShaders.setModel(model);
+
+		{
+			PROFILE_SCOPE("draw");
+			{
+				GpuProfileScope gpuPass(gpuProfiler, "object cube");
+				glBindVertexArray(VAO);
+				glDrawArrays(GL_TRIANGLES, 0, 36);
+			}
+
+			// DRAW ANOTHER CUBE (one per light)
+			// same mvp matrices except this seconds cube is a little smaller.
+			GpuProfileScope gpuPass(gpuProfiler, "light cubes");
+			lightShaders.use();
+			lightShaders.setViewProjection(view, projection);
+			glBindVertexArray(lightVAO);
+			for (int i = 0; i < numLights; i++)
+			{
+				model = glm::mat4(1.0f);
+				model = glm::translate(model, lightPos[i]);
+				model = glm::scale(model, glm::vec3(0.2f)); // a smaller cube
+				lightShaders.setModel(model);
+				glDrawArrays(GL_TRIANGLES, 0, 36);
+			}
+		}
+
+		// read the frame back before it gets swapped away (only does anything while recording)
+		{
+			PROFILE_SCOPE("capture");
+			GpuProfileScope gpuPass(gpuProfiler, "capture");
+			frameCapture.capture();
+		}
+		gpuProfiler.endPass();
+		gpuProfiler.endFrame();
+
+		statsTimer += deltaTime;
+		if (statsTimer >= 1.0f)
+		{
+			gpuProfiler.printAverages();
+			GlCallStats::printSummary();
+			statsTimer = 0.0f;
+		}
+
+		GlCallStats::endFrame();
+
+		// stats over the finished frame, the overlay's own calls aren't counted
+		{
+			overlay.setValue("triangles", (1 + numLights) * 12);
+			for (const GpuProfiler::PassTime& pass : gpuProfiler.passTimes())
+				overlay.setValue(pass.name, pass.lastMs, "%.3f ms gpu");
+			int framebufferWidth, framebufferHeight;
+			glfwGetFramebufferSize(window, &framebufferWidth, &framebufferHeight);
+			overlay.draw(deltaTime, framebufferWidth, framebufferHeight);
+			GlCallStats::discardFrame();
+		}
 
 		// does a double buffer swap to avoid flickering
-		glfwSwapBuffers(window);
+		{
+			PROFILE_SCOPE("swap");
+			glfwSwapBuffers(window);
+		}
 
 		// process any keypresses
-		glfwPollEvents();
+		{
+			PROFILE_SCOPE("poll events");
+			glfwPollEvents();
+		}
 	}
 
 	// de allocate stuff (here its the VBO and VAOs)
 	glDeleteVertexArrays(1, &VAO);
 	glDeleteVertexArrays(1, &lightVAO);
 	glDeleteBuffers(1, &VBO);
+	// finish writing out whatever was being recorded while the context is still around
+	frameCapture.stop();
+	gpuProfiler.release();
+	overlay.release();
+	shaderWatcher.release();
+
+	CpuProfiler::writeChromeTrace("cpu_trace.json", { gpuProfiler.track() });
 
 	// close the application 
 	glfwTerminate();
@@ -265,6 +367,35 @@ void processInput(GLFWwindow* window)
 		camera.Position -= glm::normalize(glm::cross(camera.Front, camera.Up)) * cameraSpeed;
 	if (glfwGetKey(window, GLFW_KEY_D) == GLFW_PRESS)
 		camera.Position += glm::normalize(glm::cross(camera.Front, camera.Up)) * cameraSpeed;
+
+	// shader variant switches
+	for (int i = 0; i < MAX_LIGHTS; i++)
+		if (glfwGetKey(window, GLFW_KEY_1 + i) == GLFW_PRESS)
+			numLights = i + 1;
+	bool specularKey = glfwGetKey(window, GLFW_KEY_X) == GLFW_PRESS;
+	if (specularKey && !specularKeyDown)
+		useSpecular = !useSpecular;
+	specularKeyDown = specularKey;
+
+	// recording on/off
+	bool pngKey = glfwGetKey(window, GLFW_KEY_C) == GLFW_PRESS;
+	bool videoKey = glfwGetKey(window, GLFW_KEY_V) == GLFW_PRESS;
+	if ((pngKey && !pngKeyDown) || (videoKey && !videoKeyDown))
+	{
+		if (frameCapture.capturing())
+			frameCapture.stop();
+		else
+		{
+			int width, height;
+			glfwGetFramebufferSize(window, &width, &height);
+			if (pngKey)
+				frameCapture.startPngSequence("capture", width, height);
+			else
+				frameCapture.startPipe(FrameCapture::ffmpegCommand(width, height, 60, "capture.mp4"), width, height);
+		}
+	}
+	pngKeyDown = pngKey;
+	videoKeyDown = videoKey;
 }
 
 // glfw: whenever the mouse moves, this callback is called
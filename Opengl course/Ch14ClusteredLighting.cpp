@@ -0,0 +1,394 @@
+// make sure that glad comes before glfw
+
+#include <glad/glad.h>
+#include <glfw3.h>
+#include <iostream>
+#include "cpu_profiler.h"
+#include "gl_call_stats.h"
+#include <vector>
+#include <random>
+#include "shader_s.h"
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+#include "camera.h"
+#include "clustered_lighting.h"
+
+
+void framebuffer_size_callback(GLFWwindow* window, int width, int height);
+void processInput(GLFWwindow* window);
+void mouse_callback(GLFWwindow* window, double xpos, double ypos);
+void scroll_callback(GLFWwindow* window, double xoffset, double yoffset);
+void key_callback(GLFWwindow* window, int key, int scancode, int action, int mods);
+
+// timing
+float deltaTime = 0.0f;	// time between current frame and last frame
+float lastFrame = 0.0f;
+
+int windowWidth = 800;
+int windowHeight = 600;
+
+// camera
+Camera camera(glm::vec3(0.0f, 6.0f, 20.0f));
+float lastX = 800 / 2.0f;
+float lastY = 600 / 2.0f;
+bool firstMouse = true;
+
+// how many point lights are flying around. up/down arrows double/halve it
+unsigned int lightCount = 256;
+const unsigned int MAX_LIGHTS = 4096;
+
+// floor made of GRID_SIZE * GRID_SIZE cubes
+const int GRID_SIZE = 24;
+
+int main()
+{
+	// -------------------------------------------- Start Initialization ------------------------------- //
+	glfwInit();
+	// SSBOs need OpenGL 4.3
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+
+	// Core mode over immediate mode
+	glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+
+	GLFWwindow* window = glfwCreateWindow(windowWidth, windowHeight, "LearnOpenGL", NULL, NULL);
+	if (window == NULL)
+	{
+		std::cout << "Failed to create GLFW window" << std::endl;
+		glfwTerminate();
+		return -1;
+	}
+	glfwMakeContextCurrent(window);
+
+	// intitialize GLAD
+	if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
+	{
+		std::cout << "Failed to initialize GLAD" << std::endl;
+		return -1;
+	}
+
+	GlCallStats::install();
+
+	// set viewport (lower left, lower right, width, height)
+	glViewport(0, 0, windowWidth, windowHeight);
+
+	// register a callback that will reset the viewport each time window size changes
+	glfwSetFramebufferSizeCallback(window, framebuffer_size_callback);
+	glfwSetCursorPosCallback(window, mouse_callback);
+	glfwSetScrollCallback(window, scroll_callback);
+	glfwSetKeyCallback(window, key_callback);
+	// -------------------------------------------- End Initialization ------------------------------- //
+
+	// load shaders (the vertex shader is the same one Ch13 uses, only the lighting changes)
+	Shader ourShaders("./Shaders/Ch13DiffuseAndSpecular/vs.glsl", "./Shaders/Ch14ClusteredLighting/fs.glsl");
+
+
+	// -------------------------------------------- DATA ------------------------------- //
+	// vertex data (coordinates range from -1 to 1)
+	// ------------------------------------------------------------------ //
+	// goes xyz, normals (xyz)
+	float vertices[] = {
+		-0.5f, -0.5f, -0.5f,  0.0f,  0.0f, -1.0f,
+		 0.5f, -0.5f, -0.5f,  0.0f,  0.0f, -1.0f,
+		 0.5f,  0.5f, -0.5f,  0.0f,  0.0f, -1.0f,
+		 0.5f,  0.5f, -0.5f,  0.0f,  0.0f, -1.0f,
+		-0.5f,  0.5f, -0.5f,  0.0f,  0.0f, -1.0f,
+		-0.5f, -0.5f, -0.5f,  0.0f,  0.0f, -1.0f,
+
+		-0.5f, -0.5f,  0.5f,  0.0f,  0.0f,  1.0f,
+		 0.5f, -0.5f,  0.5f,  0.0f,  0.0f,  1.0f,
+		 0.5f,  0.5f,  0.5f,  0.0f,  0.0f,  1.0f,
+		 0.5f,  0.5f,  0.5f,  0.0f,  0.0f,  1.0f,
+		-0.5f,  0.5f,  0.5f,  0.0f,  0.0f,  1.0f,
+		-0.5f, -0.5f,  0.5f,  0.0f,  0.0f,  1.0f,
+
+		-0.5f,  0.5f,  0.5f, -1.0f,  0.0f,  0.0f,
+		-0.5f,  0.5f, -0.5f, -1.0f,  0.0f,  0.0f,
+		-0.5f, -0.5f, -0.5f, -1.0f,  0.0f,  0.0f,
+		-0.5f, -0.5f, -0.5f, -1.0f,  0.0f,  0.0f,
+		-0.5f, -0.5f,  0.5f, -1.0f,  0.0f,  0.0f,
+		-0.5f,  0.5f,  0.5f, -1.0f,  0.0f,  0.0f,
+
+		 0.5f,  0.5f,  0.5f,  1.0f,  0.0f,  0.0f,
+		 0.5f,  0.5f, -0.5f,  1.0f,  0.0f,  0.0f,
+		 0.5f, -0.5f, -0.5f,  1.0f,  0.0f,  0.0f,
+		 0.5f, -0.5f, -0.5f,  1.0f,  0.0f,  0.0f,
+		 0.5f, -0.5f,  0.5f,  1.0f,  0.0f,  0.0f,
+		 0.5f,  0.5f,  0.5f,  1.0f,  0.0f,  0.0f,
+
+		-0.5f, -0.5f, -0.5f,  0.0f, -1.0f,  0.0f,
+		 0.5f, -0.5f, -0.5f,  0.0f, -1.0f,  0.0f,
+		 0.5f, -0.5f,  0.5f,  0.0f, -1.0f,  0.0f,
+		 0.5f, -0.5f,  0.5f,  0.0f, -1.0f,  0.0f,
+		-0.5f, -0.5f,  0.5f,  0.0f, -1.0f,  0.0f,
+		-0.5f, -0.5f, -0.5f,  0.0f, -1.0f,  0.0f,
+
+		-0.5f,  0.5f, -0.5f,  0.0f,  1.0f,  0.0f,
+		 0.5f,  0.5f, -0.5f,  0.0f,  1.0f,  0.0f,
+		 0.5f,  0.5f,  0.5f,  0.0f,  1.0f,  0.0f,
+		 0.5f,  0.5f,  0.5f,  0.0f,  1.0f,  0.0f,
+		-0.5f,  0.5f,  0.5f,  0.0f,  1.0f,  0.0f,
+		-0.5f,  0.5f, -0.5f,  0.0f,  1.0f,  0.0f
+	};
+
+	// lights get a random color, orbit radius, height and speed
+	std::mt19937 rng(42);
+	std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+	struct LightMotion { float orbit, height, speed, phase; };
+	std::vector<LightMotion> motion(MAX_LIGHTS);
+	std::vector<PointLight> allLights(MAX_LIGHTS);
+	for (unsigned int i = 0; i < MAX_LIGHTS; i++)
+	{
+		motion[i].orbit = 1.0f + unit(rng) * GRID_SIZE * 0.5f;
+		motion[i].height = 0.2f + unit(rng) * 2.0f;
+		motion[i].speed = (unit(rng) - 0.5f) * 0.6f;
+		motion[i].phase = unit(rng) * 6.2831853f;
+		allLights[i].positionRadius.w = 2.0f + unit(rng) * 2.0f;
+		allLights[i].color = glm::vec4(glm::normalize(glm::vec3(unit(rng), unit(rng), unit(rng))) * 3.0f, 1.0f);
+	}
+	std::vector<PointLight> lights;
+
+
+
+	// --------------------------------------------  ------------------------------- //
+	unsigned int VBO, VAO;
+	glGenBuffers(1, &VBO);
+	glGenVertexArrays(1, &VAO);
+
+	glBindVertexArray(VAO);
+
+	glBindBuffer(GL_ARRAY_BUFFER, VBO);
+
+	glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
+
+	// x,y,z
+	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(float),
+		(void*)0);
+	glEnableVertexAttribArray(0);
+
+	// normals
+	glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(float),
+		(void*)(3 * sizeof(float)));
+	glEnableVertexAttribArray(1);
+
+
+	// cluster grid, 16 x 9 tiles x 24 depth slices
+	ClusteredLighting clusters(16, 9, 24);
+	float nearPlanes = 0.1f;
+	float farPlanes = 100.0f;
+	float lastZoom = -1.0f;
+	float lastAspect = -1.0f;
+
+	// frame time stats, printed once a second
+	float statsTimer = 0.0f;
+	int statsFrames = 0;
+
+	glEnable(GL_DEPTH_TEST);
+	// simple render loop (its just a while loop!)
+	while (!glfwWindowShouldClose(window))
+	{
+		PROFILE_SCOPE("frame");
+		// per-frame time logic
+		// --------------------
+		float currentFrame = static_cast<float>(glfwGetTime());
+		deltaTime = currentFrame - lastFrame;
+		lastFrame = currentFrame;
+
+		// input
+		// -----
+		{
+			PROFILE_SCOPE("input");
+			processInput(window);
+		}
+
+		glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+		// only rebuild the cluster bounds when the projection actually changes (zoom or window resize)
+		float aspect = (float)windowWidth / (float)windowHeight;
+		glm::mat4 projection = glm::perspective(glm::radians(camera.Zoom), aspect, nearPlanes, farPlanes);
+		if (camera.Zoom != lastZoom || aspect != lastAspect)
+		{
+			clusters.setProjection(projection, nearPlanes, farPlanes);
+			lastZoom = camera.Zoom;
+			lastAspect = aspect;
+		}
+		glm::mat4 view = camera.GetViewMatrix();
+
+		{
+			PROFILE_SCOPE("light assignment");
+			// move the lights around
+			lights.resize(lightCount);
+			for (unsigned int i = 0; i < lightCount; i++)
+			{
+				float angle = motion[i].phase + currentFrame * motion[i].speed;
+				lights[i] = allLights[i];
+				lights[i].positionRadius = glm::vec4(motion[i].orbit * cos(angle), motion[i].height, motion[i].orbit * sin(angle), allLights[i].positionRadius.w);
+			}
+
+			// assign lights to clusters and upload the SSBOs
+			clusters.update(lights, view);
+		}
+
+		{
+			PROFILE_SCOPE("uniforms");
+			ourShaders.use();
+			ourShaders.setVec3("objectColor", 0.8f, 0.8f, 0.8f);
+			ourShaders.setVec3("viewPos", camera.Position);
+			ourShaders.setViewProjection(view, projection);
+			clusters.bind(ourShaders.ID, windowWidth, windowHeight);
+		}
+
+		{
+			PROFILE_SCOPE("draw");
+			glBindVertexArray(VAO);
+			for (int x = 0; x < GRID_SIZE; x++)
+			{
+				for (int z = 0; z < GRID_SIZE; z++)
+				{
+					// bumpy floor so the lights have something to hit from the side too
+					float height = ((x * 7 + z * 13) % 5) * 0.15f;
+					glm::mat4 model = glm::mat4(1.0f);
+					model = glm::translate(model, glm::vec3(x - GRID_SIZE * 0.5f, height - 1.0f, z - GRID_SIZE * 0.5f));
+					ourShaders.setModel(model);
+					glDrawArrays(GL_TRIANGLES, 0, 36);
+				}
+			}
+		}
+
+		statsTimer += deltaTime;
+		statsFrames++;
+		if (statsTimer >= 1.0f)
+		{
+			std::cout << "lights: " << lightCount << "  avg frame: " << 1000.0f * statsTimer / statsFrames << " ms"
+				<< "  light/cluster assignments: " << clusters.assignments() << std::endl;
+			GlCallStats::printSummary();
+			statsTimer = 0.0f;
+			statsFrames = 0;
+		}
+
+		GlCallStats::endFrame();
+
+		// does a double buffer swap to avoid flickering
+		{
+			PROFILE_SCOPE("swap");
+			glfwSwapBuffers(window);
+		}
+
+		// process any keypresses
+		{
+			PROFILE_SCOPE("poll events");
+			glfwPollEvents();
+		}
+	}
+
+	// de allocate stuff (here its the VBO and VAOs)
+	glDeleteVertexArrays(1, &VAO);
+	glDeleteBuffers(1, &VBO);
+	clusters.release();
+
+	CpuProfiler::writeChromeTrace("cpu_trace.json");
+
+	// close the application 
+	glfwTerminate();
+	return 0;
+}
+
+// create a function that runs eachtime window size changes
+// glfw: whenever the window size changed (by OS or user resize) this callback function executes
+// ---------------------------------------------------------------------------------------------
+void framebuffer_size_callback(GLFWwindow* window, int width, int height)
+{
+	// make sure the viewport matches the new window dimensions; note that width and 
+	// height will be significantly larger than specified on retina displays.
+	glViewport(0, 0, width, height);
+	// the cluster tiles are in pixels, so we need to know the real size
+	if (width > 0 && height > 0)
+	{
+		windowWidth = width;
+		windowHeight = height;
+	}
+}
+
+// process all input: query GLFW whether relevant keys are pressed/released this frame and react accordingly
+// ---------------------------------------------------------------------------------------------------------
+void processInput(GLFWwindow* window)
+{
+	if (glfwGetKey(window, GLFW_KEY_ESCAPE) == GLFW_PRESS)
+		glfwSetWindowShouldClose(window, true);
+
+	// just like in unity, all speeds must be relative to deltaTime to account for frame drops!
+	float cameraSpeed = static_cast<float>(5.0 * deltaTime);
+	if (glfwGetKey(window, GLFW_KEY_W) == GLFW_PRESS)
+		camera.Position += cameraSpeed * camera.Front;
+	if (glfwGetKey(window, GLFW_KEY_S) == GLFW_PRESS)
+		camera.Position -= cameraSpeed * camera.Front;
+	if (glfwGetKey(window, GLFW_KEY_A) == GLFW_PRESS)
+		camera.Position -= glm::normalize(glm::cross(camera.Front, camera.Up)) * cameraSpeed;
+	if (glfwGetKey(window, GLFW_KEY_D) == GLFW_PRESS)
+		camera.Position += glm::normalize(glm::cross(camera.Front, camera.Up)) * cameraSpeed;
+}
+
+// glfw: key presses that should only happen once per press (not every frame the key is held)
+// ------------------------------------------------------------------------------------------
+void key_callback(GLFWwindow* window, int key, int scancode, int action, int mods)
+{
+	if (action != GLFW_PRESS)
+		return;
+	if (key == GLFW_KEY_UP && lightCount < MAX_LIGHTS)
+		lightCount *= 2;
+	if (key == GLFW_KEY_DOWN && lightCount > 1)
+		lightCount /= 2;
+}
+
+// glfw: whenever the mouse moves, this callback is called
+void mouse_callback(GLFWwindow* window, double xposIn, double yposIn)
+{
+	float xpos = static_cast<float>(xposIn);
+	float ypos = static_cast<float>(yposIn);
+
+	if (firstMouse)
+	{
+		lastX = xpos;
+		lastY = ypos;
+		firstMouse = false;
+	}
+
+	float xoffset = xpos - lastX;
+	float yoffset = lastY - ypos; // reversed since y-coordinates go from bottom to top
+	lastX = xpos;
+	lastY = ypos;
+
+	float sensitivity = 0.1f; // change this value to your liking
+	xoffset *= sensitivity;
+	yoffset *= sensitivity;
+
+	camera.Yaw += xoffset;
+	camera.Pitch += yoffset;
+
+	// make sure that when pitch is out of bounds, screen doesn't get flipped
+	if (camera.Pitch > 89.0f)
+		camera.Pitch = 89.0f;
+	if (camera.Pitch < -89.0f)
+		camera.Pitch = -89.0f;
+
+	// pitch and yaw influence cameraFront vector, which influence where the target vector 
+	// aka second arg of glfwLookAt function
+	glm::vec3 front;
+	front.x = cos(glm::radians(camera.Yaw)) * cos(glm::radians(camera.Pitch));
+	front.y = sin(glm::radians(camera.Pitch));
+	front.z = sin(glm::radians(camera.Yaw)) * cos(glm::radians(camera.Pitch));
+	camera.Front = glm::normalize(front);
+}
+
+// glfw: whenever the mouse scroll wheel scrolls, this callback is called
+// ----------------------------------------------------------------------
+void scroll_callback(GLFWwindow* window, double xoffset, double yoffset)
+{
+	camera.Zoom -= (float)yoffset;
+	if (camera.Zoom < 1.0f)
+		camera.Zoom = 1.0f;
+	if (camera.Zoom > 45.0f)
+		camera.Zoom = 45.0f;
+}
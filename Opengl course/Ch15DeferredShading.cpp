@@ -0,0 +1,520 @@
+// make sure that glad comes before glfw
+
+#include <glad/glad.h>
+#include <glfw3.h>
+#include <iostream>
+#include "cpu_profiler.h"
+#include "gpu_profiler.h"
+#include "gl_call_stats.h"
+#include <vector>
+#include <random>
+#include <cmath>
+#include <cstddef>
+#include "shader_s.h"
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+#include "camera.h"
+#include "gbuffer.h"
+
+
+void framebuffer_size_callback(GLFWwindow* window, int width, int height);
+void processInput(GLFWwindow* window);
+void mouse_callback(GLFWwindow* window, double xpos, double ypos);
+void scroll_callback(GLFWwindow* window, double xoffset, double yoffset);
+void key_callback(GLFWwindow* window, int key, int scancode, int action, int mods);
+
+// timing
+float deltaTime = 0.0f;	// time between current frame and last frame
+float lastFrame = 0.0f;
+
+int windowWidth = 800;
+int windowHeight = 600;
+
+// camera
+Camera camera(glm::vec3(0.0f, 6.0f, 20.0f));
+float lastX = 800 / 2.0f;
+float lastY = 600 / 2.0f;
+bool firstMouse = true;
+
+// how many point lights. up/down arrows double/halve it
+unsigned int lightCount = 512;
+const unsigned int MAX_LIGHTS = 4096;
+
+// floor made of GRID_SIZE * GRID_SIZE cubes, plus a few towers so there's lots of overdraw
+const int GRID_SIZE = 24;
+const int TOWER_HEIGHT = 6;
+
+// per instance data for the light volumes (matches light_vs.glsl attributes 1 and 2)
+struct LightInstance
+{
+	glm::vec4 positionRadius;
+	glm::vec3 color;
+};
+
+// unit sphere for the light volumes. it's a bit bigger than radius 1 so the flat triangles never cut inside the real sphere
+void makeSphere(int slices, int stacks, std::vector<float>& positions, std::vector<unsigned int>& indices)
+{
+	float grow = 1.0f / cos(glm::radians(180.0f) / stacks);
+	for (int stack = 0; stack <= stacks; stack++)
+	{
+		float phi = glm::radians(180.0f) * stack / stacks;
+		for (int slice = 0; slice <= slices; slice++)
+		{
+			float theta = glm::radians(360.0f) * slice / slices;
+			positions.push_back(grow * sin(phi) * cos(theta));
+			positions.push_back(grow * cos(phi));
+			positions.push_back(grow * sin(phi) * sin(theta));
+		}
+	}
+	for (int stack = 0; stack < stacks; stack++)
+	{
+		for (int slice = 0; slice < slices; slice++)
+		{
+			unsigned int a = stack * (slices + 1) + slice;
+			unsigned int b = a + slices + 1;
+			indices.insert(indices.end(), { a, a + 1, b, a + 1, b + 1, b }); // counter clockwise seen from outside
+		}
+	}
+}
+
+GBuffer* gbuffer = NULL;
+
+int main()
+{
+	// -------------------------------------------- Start Initialization ------------------------------- //
+	glfwInit();
+	// set OpenGL version to 3.3
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+
+	// Core mode over immediate mode
+	glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+
+	GLFWwindow* window = glfwCreateWindow(windowWidth, windowHeight, "LearnOpenGL", NULL, NULL);
+	if (window == NULL)
+	{
+		std::cout << "Failed to create GLFW window" << std::endl;
+		glfwTerminate();
+		return -1;
+	}
+	glfwMakeContextCurrent(window);
+
+	// intitialize GLAD
+	if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
+	{
+		std::cout << "Failed to initialize GLAD" << std::endl;
+		return -1;
+	}
+
+	GlCallStats::install();
+
+	// the G-buffer has to be the same size as the real framebuffer (which isn't always the window size, retina etc.)
+	glfwGetFramebufferSize(window, &windowWidth, &windowHeight);
+	glViewport(0, 0, windowWidth, windowHeight);
+	gbuffer = new GBuffer(windowWidth, windowHeight);
+
+	// register a callback that will reset the viewport each time window size changes
+	glfwSetFramebufferSizeCallback(window, framebuffer_size_callback);
+	glfwSetCursorPosCallback(window, mouse_callback);
+	glfwSetScrollCallback(window, scroll_callback);
+	glfwSetKeyCallback(window, key_callback);
+	// -------------------------------------------- End Initialization ------------------------------- //
+
+	// load shaders
+	Shader geometryShaders("./Shaders/Ch15DeferredShading/geometry_vs.glsl", "./Shaders/Ch15DeferredShading/geometry_fs.glsl");
+	Shader ambientShaders("./Shaders/Ch15DeferredShading/fullscreen_vs.glsl", "./Shaders/Ch15DeferredShading/ambient_fs.glsl");
+	Shader lightShaders("./Shaders/Ch15DeferredShading/light_vs.glsl", "./Shaders/Ch15DeferredShading/light_fs.glsl");
+
+
+	// -------------------------------------------- DATA ------------------------------- //
+	// vertex data (coordinates range from -1 to 1)
+	// ------------------------------------------------------------------ //
+	// goes xyz, normals (xyz)
+	float vertices[] = {
+		-0.5f, -0.5f, -0.5f,  0.0f,  0.0f, -1.0f,
+		 0.5f, -0.5f, -0.5f,  0.0f,  0.0f, -1.0f,
+		 0.5f,  0.5f, -0.5f,  0.0f,  0.0f, -1.0f,
+		 0.5f,  0.5f, -0.5f,  0.0f,  0.0f, -1.0f,
+		-0.5f,  0.5f, -0.5f,  0.0f,  0.0f, -1.0f,
+		-0.5f, -0.5f, -0.5f,  0.0f,  0.0f, -1.0f,
+
+		-0.5f, -0.5f,  0.5f,  0.0f,  0.0f,  1.0f,
+		 0.5f, -0.5f,  0.5f,  0.0f,  0.0f,  1.0f,
+		 0.5f,  0.5f,  0.5f,  0.0f,  0.0f,  1.0f,
+		 0.5f,  0.5f,  0.5f,  0.0f,  0.0f,  1.0f,
+		-0.5f,  0.5f,  0.5f,  0.0f,  0.0f,  1.0f,
+		-0.5f, -0.5f,  0.5f,  0.0f,  0.0f,  1.0f,
+
+		-0.5f,  0.5f,  0.5f, -1.0f,  0.0f,  0.0f,
+		-0.5f,  0.5f, -0.5f, -1.0f,  0.0f,  0.0f,
+		-0.5f, -0.5f, -0.5f, -1.0f,  0.0f,  0.0f,
+		-0.5f, -0.5f, -0.5f, -1.0f,  0.0f,  0.0f,
+		-0.5f, -0.5f,  0.5f, -1.0f,  0.0f,  0.0f,
+		-0.5f,  0.5f,  0.5f, -1.0f,  0.0f,  0.0f,
+
+		 0.5f,  0.5f,  0.5f,  1.0f,  0.0f,  0.0f,
+		 0.5f,  0.5f, -0.5f,  1.0f,  0.0f,  0.0f,
+		 0.5f, -0.5f, -0.5f,  1.0f,  0.0f,  0.0f,
+		 0.5f, -0.5f, -0.5f,  1.0f,  0.0f,  0.0f,
+		 0.5f, -0.5f,  0.5f,  1.0f,  0.0f,  0.0f,
+		 0.5f,  0.5f,  0.5f,  1.0f,  0.0f,  0.0f,
+
+		-0.5f, -0.5f, -0.5f,  0.0f, -1.0f,  0.0f,
+		 0.5f, -0.5f, -0.5f,  0.0f, -1.0f,  0.0f,
+		 0.5f, -0.5f,  0.5f,  0.0f, -1.0f,  0.0f,
+		 0.5f, -0.5f,  0.5f,  0.0f, -1.0f,  0.0f,
+		-0.5f, -0.5f,  0.5f,  0.0f, -1.0f,  0.0f,
+		-0.5f, -0.5f, -0.5f,  0.0f, -1.0f,  0.0f,
+
+		-0.5f,  0.5f, -0.5f,  0.0f,  1.0f,  0.0f,
+		 0.5f,  0.5f, -0.5f,  0.0f,  1.0f,  0.0f,
+		 0.5f,  0.5f,  0.5f,  0.0f,  1.0f,  0.0f,
+		 0.5f,  0.5f,  0.5f,  0.0f,  1.0f,  0.0f,
+		-0.5f,  0.5f,  0.5f,  0.0f,  1.0f,  0.0f,
+		-0.5f,  0.5f, -0.5f,  0.0f,  1.0f,  0.0f
+	};
+
+	// lights get a random color, orbit radius, height and speed
+	std::mt19937 rng(42);
+	std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+	struct LightMotion { float orbit, height, speed, phase; };
+	std::vector<LightMotion> motion(MAX_LIGHTS);
+	std::vector<LightInstance> lights(MAX_LIGHTS);
+	for (unsigned int i = 0; i < MAX_LIGHTS; i++)
+	{
+		motion[i].orbit = 1.0f + unit(rng) * GRID_SIZE * 0.5f;
+		motion[i].height = 0.2f + unit(rng) * 3.0f;
+		motion[i].speed = (unit(rng) - 0.5f) * 0.6f;
+		motion[i].phase = unit(rng) * 6.2831853f;
+		lights[i].positionRadius.w = 2.0f + unit(rng) * 2.0f;
+		lights[i].color = glm::normalize(glm::vec3(unit(rng), unit(rng), unit(rng))) * 3.0f;
+	}
+
+
+
+	// --------------------------------------------  ------------------------------- //
+	// cube (same layout as Ch13)
+	unsigned int VBO, VAO;
+	glGenBuffers(1, &VBO);
+	glGenVertexArrays(1, &VAO);
+
+	glBindVertexArray(VAO);
+
+	glBindBuffer(GL_ARRAY_BUFFER, VBO);
+
+	glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
+
+	// x,y,z
+	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(float),
+		(void*)0);
+	glEnableVertexAttribArray(0);
+
+	// normals
+	glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(float),
+		(void*)(3 * sizeof(float)));
+	glEnableVertexAttribArray(1);
+
+
+	// light volume sphere + one instance per light
+	std::vector<float> spherePositions;
+	std::vector<unsigned int> sphereIndices;
+	makeSphere(16, 12, spherePositions, sphereIndices);
+
+	unsigned int sphereVAO, sphereVBO, sphereEBO, instanceVBO;
+	glGenVertexArrays(1, &sphereVAO);
+	glGenBuffers(1, &sphereVBO);
+	glGenBuffers(1, &sphereEBO);
+	glGenBuffers(1, &instanceVBO);
+
+	glBindVertexArray(sphereVAO);
+	glBindBuffer(GL_ARRAY_BUFFER, sphereVBO);
+	glBufferData(GL_ARRAY_BUFFER, spherePositions.size() * sizeof(float), spherePositions.data(), GL_STATIC_DRAW);
+	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), (void*)0);
+	glEnableVertexAttribArray(0);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, sphereEBO);
+	glBufferData(GL_ELEMENT_ARRAY_BUFFER, sphereIndices.size() * sizeof(unsigned int), sphereIndices.data(), GL_STATIC_DRAW);
+
+	// the instance attributes step once per light instead of once per vertex
+	glBindBuffer(GL_ARRAY_BUFFER, instanceVBO);
+	glBufferData(GL_ARRAY_BUFFER, MAX_LIGHTS * sizeof(LightInstance), NULL, GL_STREAM_DRAW);
+	glVertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, sizeof(LightInstance), (void*)0);
+	glEnableVertexAttribArray(1);
+	glVertexAttribDivisor(1, 1);
+	glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, sizeof(LightInstance), (void*)offsetof(LightInstance, color));
+	glEnableVertexAttribArray(2);
+	glVertexAttribDivisor(2, 1);
+
+	// the fullscreen triangle makes its vertices out of gl_VertexID, but core profile still wants some VAO bound
+	unsigned int emptyVAO;
+	glGenVertexArrays(1, &emptyVAO);
+
+
+	// G-buffer texture units never change
+	ambientShaders.use();
+	ambientShaders.setInt("gAlbedoSpec", 1);
+	ambientShaders.setFloat("ambientFactor", 0.05f);
+	lightShaders.use();
+	lightShaders.setInt("gNormal", 0);
+	lightShaders.setInt("gAlbedoSpec", 1);
+	lightShaders.setInt("gDepth", 2);
+
+	float nearPlanes = 0.1f;
+	float farPlanes = 100.0f;
+
+	// frame time stats, printed once a second
+	float statsTimer = 0.0f;
+	int statsFrames = 0;
+
+	// the passes timed on the GPU, printed with the stats and saved next to the CPU scopes at the end
+	GpuProfiler gpuProfiler;
+
+	// simple render loop (its just a while loop!)
+	while (!glfwWindowShouldClose(window))
+	{
+		PROFILE_SCOPE("frame");
+		// per-frame time logic
+		// --------------------
+		float currentFrame = static_cast<float>(glfwGetTime());
+		deltaTime = currentFrame - lastFrame;
+		lastFrame = currentFrame;
+
+		// input
+		// -----
+		{
+			PROFILE_SCOPE("input");
+			processInput(window);
+		}
+
+		glm::mat4 view = camera.GetViewMatrix();
+		glm::mat4 projection = glm::perspective(glm::radians(camera.Zoom), (float)windowWidth / (float)windowHeight, nearPlanes, farPlanes);
+		glm::mat4 viewProjection = projection * view;
+
+		// ---------------- 1. geometry pass: no lighting at all, just fill the G-buffer ---------------- //
+		gpuProfiler.beginFrame();
+		{
+			PROFILE_SCOPE("geometry pass");
+			GpuProfileScope gpuPass(gpuProfiler, "geometry pass");
+			gbuffer->bindForGeometryPass();
+			glEnable(GL_DEPTH_TEST);
+			glDepthMask(GL_TRUE);
+			glDepthFunc(GL_LESS);
+			glDisable(GL_BLEND);
+			// the cube data isn't wound consistently (same as every chapter), so no back face culling here
+			glDisable(GL_CULL_FACE);
+			glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
+			glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+			geometryShaders.use();
+			geometryShaders.setViewProjection(viewProjection);
+			geometryShaders.setVec3("objectColor", 0.8f, 0.8f, 0.8f);
+			geometryShaders.setFloat("specularStrength", 0.5f);
+			glBindVertexArray(VAO);
+			for (int x = 0; x < GRID_SIZE; x++)
+			{
+				for (int z = 0; z < GRID_SIZE; z++)
+				{
+					// every 6th cell gets a tower, hidden faces in there used to cost a full lighting loop each
+					int height = ((x * 7 + z * 13) % 6 == 0) ? TOWER_HEIGHT : 1;
+					for (int y = 0; y < height; y++)
+					{
+						glm::mat4 model = glm::mat4(1.0f);
+						model = glm::translate(model, glm::vec3(x - GRID_SIZE * 0.5f, y - 1.0f, z - GRID_SIZE * 0.5f));
+						geometryShaders.setModel(model);
+						glDrawArrays(GL_TRIANGLES, 0, 36);
+					}
+				}
+			}
+		}
+
+		// ---------------- 2. lighting pass: every visible pixel gets shaded once per light that reaches it ---------------- //
+		{
+			PROFILE_SCOPE("lighting pass");
+			GpuProfileScope gpuPass(gpuProfiler, "lighting pass");
+			gbuffer->copyDepthTo(0);
+			glViewport(0, 0, windowWidth, windowHeight);
+			glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+			glClear(GL_COLOR_BUFFER_BIT);
+			gbuffer->bindTextures();
+
+			// ambient, one fullscreen triangle
+			glDisable(GL_DEPTH_TEST);
+			glDisable(GL_CULL_FACE);
+			ambientShaders.use();
+			glBindVertexArray(emptyVAO);
+			glDrawArrays(GL_TRIANGLES, 0, 3);
+
+			// move the lights and upload them as instances
+			for (unsigned int i = 0; i < lightCount; i++)
+			{
+				float angle = motion[i].phase + currentFrame * motion[i].speed;
+				lights[i].positionRadius = glm::vec4(motion[i].orbit * cos(angle), motion[i].height, motion[i].orbit * sin(angle), lights[i].positionRadius.w);
+			}
+			glBindBuffer(GL_ARRAY_BUFFER, instanceVBO);
+			glBufferData(GL_ARRAY_BUFFER, MAX_LIGHTS * sizeof(LightInstance), NULL, GL_STREAM_DRAW); // orphan last frame's data
+			glBufferSubData(GL_ARRAY_BUFFER, 0, lightCount * sizeof(LightInstance), lights.data());
+
+			// light volumes: draw the back faces, and only where the scene is in front of them (GL_GEQUAL).
+			// works even when the camera is inside a light's sphere. results get added up with blending
+			glEnable(GL_DEPTH_TEST);
+			glDepthFunc(GL_GEQUAL);
+			glDepthMask(GL_FALSE);
+			glEnable(GL_CULL_FACE);
+			glCullFace(GL_FRONT);
+			glEnable(GL_BLEND);
+			glBlendFunc(GL_ONE, GL_ONE);
+
+			lightShaders.use();
+			lightShaders.setViewProjection(viewProjection);
+			lightShaders.setMat4("inverseViewProjection", glm::inverse(viewProjection));
+			lightShaders.setVec2("screenSize", glm::vec2((float)windowWidth, (float)windowHeight));
+			lightShaders.setVec3("viewPos", camera.Position);
+			glBindVertexArray(sphereVAO);
+			glDrawElementsInstanced(GL_TRIANGLES, (GLsizei)sphereIndices.size(), GL_UNSIGNED_INT, 0, lightCount);
+		}
+
+		gpuProfiler.endFrame();
+
+		statsTimer += deltaTime;
+		statsFrames++;
+		if (statsTimer >= 1.0f)
+		{
+			std::cout << "lights: " << lightCount << "  avg frame: " << 1000.0f * statsTimer / statsFrames << " ms" << std::endl;
+			gpuProfiler.printAverages();
+			GlCallStats::printSummary();
+			statsTimer = 0.0f;
+			statsFrames = 0;
+		}
+
+		GlCallStats::endFrame();
+
+		// does a double buffer swap to avoid flickering
+		{
+			PROFILE_SCOPE("swap");
+			glfwSwapBuffers(window);
+		}
+
+		// process any keypresses
+		{
+			PROFILE_SCOPE("poll events");
+			glfwPollEvents();
+		}
+	}
+
+	// de allocate stuff (here its the VBO and VAOs)
+	glDeleteVertexArrays(1, &VAO);
+	glDeleteVertexArrays(1, &sphereVAO);
+	glDeleteVertexArrays(1, &emptyVAO);
+	glDeleteBuffers(1, &VBO);
+	glDeleteBuffers(1, &sphereVBO);
+	glDeleteBuffers(1, &sphereEBO);
+	glDeleteBuffers(1, &instanceVBO);
+	delete gbuffer;
+
+	gpuProfiler.release();
+
+	CpuProfiler::writeChromeTrace("cpu_trace.json", { gpuProfiler.track() });
+
+	// close the application 
+	glfwTerminate();
+	return 0;
+}
+
+// create a function that runs eachtime window size changes
+// glfw: whenever the window size changed (by OS or user resize) this callback function executes
+// ---------------------------------------------------------------------------------------------
+void framebuffer_size_callback(GLFWwindow* window, int width, int height)
+{
+	// make sure the viewport matches the new window dimensions; note that width and 
+	// height will be significantly larger than specified on retina displays.
+	glViewport(0, 0, width, height);
+	// G-buffer has to follow the window size (skip minimized windows, 0x0 textures aren't allowed)
+	if (width > 0 && height > 0)
+	{
+		windowWidth = width;
+		windowHeight = height;
+		gbuffer->resize(width, height);
+	}
+}
+
+// process all input: query GLFW whether relevant keys are pressed/released this frame and react accordingly
+// ---------------------------------------------------------------------------------------------------------
+void processInput(GLFWwindow* window)
+{
+	if (glfwGetKey(window, GLFW_KEY_ESCAPE) == GLFW_PRESS)
+		glfwSetWindowShouldClose(window, true);
+
+	// just like in unity, all speeds must be relative to deltaTime to account for frame drops!
+	float cameraSpeed = static_cast<float>(5.0 * deltaTime);
+	if (glfwGetKey(window, GLFW_KEY_W) == GLFW_PRESS)
+		camera.Position += cameraSpeed * camera.Front;
+	if (glfwGetKey(window, GLFW_KEY_S) == GLFW_PRESS)
+		camera.Position -= cameraSpeed * camera.Front;
+	if (glfwGetKey(window, GLFW_KEY_A) == GLFW_PRESS)
+		camera.Position -= glm::normalize(glm::cross(camera.Front, camera.Up)) * cameraSpeed;
+	if (glfwGetKey(window, GLFW_KEY_D) == GLFW_PRESS)
+		camera.Position += glm::normalize(glm::cross(camera.Front, camera.Up)) * cameraSpeed;
+}
+
+// glfw: key presses that should only happen once per press (not every frame the key is held)
+// ------------------------------------------------------------------------------------------
+void key_callback(GLFWwindow* window, int key, int scancode, int action, int mods)
+{
+	if (action != GLFW_PRESS)
+		return;
+	if (key == GLFW_KEY_UP && lightCount < MAX_LIGHTS)
+		lightCount *= 2;
+	if (key == GLFW_KEY_DOWN && lightCount > 1)
+		lightCount /= 2;
+}
+
+// glfw: whenever the mouse moves, this callback is called
+void mouse_callback(GLFWwindow* window, double xposIn, double yposIn)
+{
+	float xpos = static_cast<float>(xposIn);
+	float ypos = static_cast<float>(yposIn);
+
+	if (firstMouse)
+	{
+		lastX = xpos;
+		lastY = ypos;
+		firstMouse = false;
+	}
+
+	float xoffset = xpos - lastX;
+	float yoffset = lastY - ypos; // reversed since y-coordinates go from bottom to top
+	lastX = xpos;
+	lastY = ypos;
+
+	float sensitivity = 0.1f; // change this value to your liking
+	xoffset *= sensitivity;
+	yoffset *= sensitivity;
+
+	camera.Yaw += xoffset;
+	camera.Pitch += yoffset;
+
+	// make sure that when pitch is out of bounds, screen doesn't get flipped
+	if (camera.Pitch > 89.0f)
+		camera.Pitch = 89.0f;
+	if (camera.Pitch < -89.0f)
+		camera.Pitch = -89.0f;
+
+	// pitch and yaw influence cameraFront vector, which influence where the target vector 
+	// aka second arg of glfwLookAt function
+	glm::vec3 front;
+	front.x = cos(glm::radians(camera.Yaw)) * cos(glm::radians(camera.Pitch));
+	front.y = sin(glm::radians(camera.Pitch));
+	front.z = sin(glm::radians(camera.Yaw)) * cos(glm::radians(camera.Pitch));
+	camera.Front = glm::normalize(front);
+}
+
+// glfw: whenever the mouse scroll wheel scrolls, this callback is called
+// ----------------------------------------------------------------------
+void scroll_callback(GLFWwindow* window, double xoffset, double yoffset)
+{
+	camera.Zoom -= (float)yoffset;
+	if (camera.Zoom < 1.0f)
+		camera.Zoom = 1.0f;
+	if (camera.Zoom > 45.0f)
+		camera.Zoom = 45.0f;
+}
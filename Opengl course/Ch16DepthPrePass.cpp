@@ -0,0 +1,456 @@
+// make sure that glad comes before glfw
+
+#include <glad/glad.h>
+#include <glfw3.h>
+#include <iostream>
+#include "cpu_profiler.h"
+#include "gl_call_stats.h"
+#include <vector>
+#include <random>
+#include "shader_s.h"
+#include "vertex_layout.h"
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+#include "camera.h"
+
+// only there if glad was generated with ARB_pipeline_statistics_query, the value is fixed by the spec
+#ifndef GL_FRAGMENT_SHADER_INVOCATIONS_ARB
+#define GL_FRAGMENT_SHADER_INVOCATIONS_ARB 0x82F4
+#endif
+
+
+void framebuffer_size_callback(GLFWwindow* window, int width, int height);
+void processInput(GLFWwindow* window);
+void mouse_callback(GLFWwindow* window, double xpos, double ypos);
+void scroll_callback(GLFWwindow* window, double xoffset, double yoffset);
+void key_callback(GLFWwindow* window, int key, int scancode, int action, int mods);
+
+// timing
+float deltaTime = 0.0f;	// time between current frame and last frame
+float lastFrame = 0.0f;
+
+int windowWidth = 800;
+int windowHeight = 600;
+
+// camera
+Camera camera(glm::vec3(0.0f, 0.0f, 12.0f));
+float lastX = 800 / 2.0f;
+float lastY = 600 / 2.0f;
+bool firstMouse = true;
+
+// P toggles the depth pre-pass
+bool depthPrePass = true;
+
+// lots of cubes piled up in front of each other so most of them are hidden
+const int CUBE_COUNT = 600;
+
+// occlusion + timer queries for one frame. there are two sets so we read last frame's results
+// while this frame's are still in flight (reading a query right away would stall until the GPU is done)
+struct FrameQueries
+{
+	unsigned int samples = 0;       // GL_SAMPLES_PASSED in the color pass = fragments that got the Phong shader
+	unsigned int invocations = 0;   // GL_FRAGMENT_SHADER_INVOCATIONS_ARB, exact count (if the driver has it)
+	unsigned int time = 0;          // GL_TIME_ELAPSED for the whole frame (pre-pass + color pass)
+	bool pending = false;
+	bool prePass = false;
+};
+
+int main()
+{
+	// -------------------------------------------- Start Initialization ------------------------------- //
+	glfwInit();
+	// direct state access (vertex_layout.h) needs OpenGL 4.5
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 5);
+
+	// Core mode over immediate mode
+	glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+
+	GLFWwindow* window = glfwCreateWindow(windowWidth, windowHeight, "LearnOpenGL", NULL, NULL);
+	if (window == NULL)
+	{
+		std::cout << "Failed to create GLFW window" << std::endl;
+		glfwTerminate();
+		return -1;
+	}
+	glfwMakeContextCurrent(window);
+
+	// intitialize GLAD
+	if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
+	{
+		std::cout << "Failed to initialize GLAD" << std::endl;
+		return -1;
+	}
+
+	GlCallStats::install();
+
+	// set viewport (lower left, lower right, width, height)
+	glViewport(0, 0, windowWidth, windowHeight);
+
+	// register a callback that will reset the viewport each time window size changes
+	glfwSetFramebufferSizeCallback(window, framebuffer_size_callback);
+	glfwSetCursorPosCallback(window, mouse_callback);
+	glfwSetScrollCallback(window, scroll_callback);
+	glfwSetKeyCallback(window, key_callback);
+	// -------------------------------------------- End Initialization ------------------------------- //
+
+	// load shaders
+	Shader ourShaders("./Shaders/Ch13DiffuseAndSpecular/vs.glsl", "./Shaders/Ch13DiffuseAndSpecular/fs.glsl");
+	Shader depthShaders("./Shaders/Ch16DepthPrePass/depth_vs.glsl", "./Shaders/Ch16DepthPrePass/depth_fs.glsl");
+
+
+	// -------------------------------------------- DATA ------------------------------- //
+	// vertex data (coordinates range from -1 to 1)
+	// ------------------------------------------------------------------ //
+	// goes xyz, normals (xyz)
+	float vertices[] = {
+		-0.5f, -0.5f, -0.5f,  0.0f,  0.0f, -1.0f,
+		 0.5f, -0.5f, -0.5f,  0.0f,  0.0f, -1.0f,
+		 0.5f,  0.5f, -0.5f,  0.0f,  0.0f, -1.0f,
+		 0.5f,  0.5f, -0.5f,  0.0f,  0.0f, -1.0f,
+		-0.5f,  0.5f, -0.5f,  0.0f,  0.0f, -1.0f,
+		-0.5f, -0.5f, -0.5f,  0.0f,  0.0f, -1.0f,
+
+		-0.5f, -0.5f,  0.5f,  0.0f,  0.0f,  1.0f,
+		 0.5f, -0.5f,  0.5f,  0.0f,  0.0f,  1.0f,
+		 0.5f,  0.5f,  0.5f,  0.0f,  0.0f,  1.0f,
+		 0.5f,  0.5f,  0.5f,  0.0f,  0.0f,  1.0f,
+		-0.5f,  0.5f,  0.5f,  0.0f,  0.0f,  1.0f,
+		-0.5f, -0.5f,  0.5f,  0.0f,  0.0f,  1.0f,
+
+		-0.5f,  0.5f,  0.5f, -1.0f,  0.0f,  0.0f,
+		-0.5f,  0.5f, -0.5f, -1.0f,  0.0f,  0.0f,
+		-0.5f, -0.5f, -0.5f, -1.0f,  0.0f,  0.0f,
+		-0.5f, -0.5f, -0.5f, -1.0f,  0.0f,  0.0f,
+		-0.5f, -0.5f,  0.5f, -1.0f,  0.0f,  0.0f,
+		-0.5f,  0.5f,  0.5f, -1.0f,  0.0f,  0.0f,
+
+		 0.5f,  0.5f,  0.5f,  1.0f,  0.0f,  0.0f,
+		 0.5f,  0.5f, -0.5f,  1.0f,  0.0f,  0.0f,
+		 0.5f, -0.5f, -0.5f,  1.0f,  0.0f,  0.0f,
+		 0.5f, -0.5f, -0.5f,  1.0f,  0.0f,  0.0f,
+		 0.5f, -0.5f,  0.5f,  1.0f,  0.0f,  0.0f,
+		 0.5f,  0.5f,  0.5f,  1.0f,  0.0f,  0.0f,
+
+		-0.5f, -0.5f, -0.5f,  0.0f, -1.0f,  0.0f,
+		 0.5f, -0.5f, -0.5f,  0.0f, -1.0f,  0.0f,
+		 0.5f, -0.5f,  0.5f,  0.0f, -1.0f,  0.0f,
+		 0.5f, -0.5f,  0.5f,  0.0f, -1.0f,  0.0f,
+		-0.5f, -0.5f,  0.5f,  0.0f, -1.0f,  0.0f,
+		-0.5f, -0.5f, -0.5f,  0.0f, -1.0f,  0.0f,
+
+		-0.5f,  0.5f, -0.5f,  0.0f,  1.0f,  0.0f,
+		 0.5f,  0.5f, -0.5f,  0.0f,  1.0f,  0.0f,
+		 0.5f,  0.5f,  0.5f,  0.0f,  1.0f,  0.0f,
+		 0.5f,  0.5f,  0.5f,  0.0f,  1.0f,  0.0f,
+		-0.5f,  0.5f,  0.5f,  0.0f,  1.0f,  0.0f,
+		-0.5f,  0.5f, -0.5f,  0.0f,  1.0f,  0.0f
+	};
+
+	// random cubes in a box in front of the camera
+	std::mt19937 rng(7);
+	std::uniform_real_distribution<float> spread(-4.0f, 4.0f);
+	std::uniform_real_distribution<float> angle(0.0f, 360.0f);
+	std::vector<glm::mat4> models(CUBE_COUNT);
+	for (int i = 0; i < CUBE_COUNT; i++)
+	{
+		glm::mat4 model = glm::mat4(1.0f);
+		model = glm::translate(model, glm::vec3(spread(rng), spread(rng), spread(rng)));
+		model = glm::rotate(model, glm::radians(angle(rng)), glm::normalize(glm::vec3(1.0f, spread(rng), spread(rng))));
+		models[i] = model;
+	}
+
+
+
+	// --------------------------------------------  ------------------------------- //
+	// the float array is laid out exactly like VertexPN, so it goes up as is
+	static_assert(sizeof(vertices) == 36 * sizeof(VertexPN), "cube data doesn't match VertexPN");
+	unsigned int VBO = createStaticBuffer(vertices, sizeof(vertices));
+
+	// the attribute setup comes from VertexLayout<VertexPN> (vertex_layout.h), one VAO per layout.
+	// the pre-pass uses the position only layout on the same VBO, same trick as the lightVAO in Ch12/Ch13 (skip the normals)
+	VertexArrayCache vertexArrays;
+
+
+	// queries
+	// exact fragment shader invocation counts need ARB_pipeline_statistics_query, otherwise samples passed is close enough
+#ifdef GL_ARB_pipeline_statistics_query
+	bool haveInvocationCount = GLAD_GL_ARB_pipeline_statistics_query != 0;
+#else
+	bool haveInvocationCount = false;
+#endif
+	FrameQueries queries[2];
+	for (int i = 0; i < 2; i++)
+	{
+		glGenQueries(1, &queries[i].samples);
+		glGenQueries(1, &queries[i].time);
+		if (haveInvocationCount)
+			glGenQueries(1, &queries[i].invocations);
+	}
+	int frameIndex = 0;
+
+	// averaged per mode so you can flip P back and forth and compare
+	double shadedSum[2] = { 0.0, 0.0 }, gpuMsSum[2] = { 0.0, 0.0 };
+	int measuredFrames[2] = { 0, 0 };
+	float statsTimer = 0.0f;
+
+
+	glEnable(GL_DEPTH_TEST);
+	// simple render loop (its just a while loop!)
+	while (!glfwWindowShouldClose(window))
+	{
+		PROFILE_SCOPE("frame");
+		// per-frame time logic
+		// --------------------
+		float currentFrame = static_cast<float>(glfwGetTime());
+		deltaTime = currentFrame - lastFrame;
+		lastFrame = currentFrame;
+
+		// input
+		// -----
+		{
+			PROFILE_SCOPE("input");
+			processInput(window);
+		}
+
+		// nicer background color than black
+		glClearColor(0.1f, 0.1f, 0.1f, 0.2f);
+		glDepthMask(GL_TRUE);
+		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+		// spinning light for lulz
+		glm::vec3 lightPos(6.0f * cos(glfwGetTime()), 3.0f, 6.0f * sin(glfwGetTime()));
+
+		glm::mat4 view = camera.GetViewMatrix();
+		glm::mat4 projection = glm::perspective(glm::radians(camera.Zoom), (float)windowWidth / (float)windowHeight, 0.1f, 100.0f);
+
+		FrameQueries& current = queries[frameIndex];
+		current.prePass = depthPrePass;
+		glBeginQuery(GL_TIME_ELAPSED, current.time);
+
+		{
+			PROFILE_SCOPE("depth pre-pass");
+			if (depthPrePass)
+			{
+				// 1. depth only: fill the depth buffer with the closest surface, no color, trivial fragment shader
+				glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
+				glDepthFunc(GL_LESS);
+				depthShaders.use();
+				depthShaders.setViewProjection(view, projection);
+				vertexArrays.bind<VertexPNPositionOnly>(VBO);
+				for (int i = 0; i < CUBE_COUNT; i++)
+				{
+					depthShaders.setModel(models[i]);
+					glDrawArrays(GL_TRIANGLES, 0, 36);
+				}
+
+				// 2. color pass only shades the fragment that won, everything behind fails GL_EQUAL before the shader runs.
+				// depth is already right so don't write it again
+				glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+				glDepthFunc(GL_EQUAL);
+				glDepthMask(GL_FALSE);
+			}
+			else
+			{
+				glDepthFunc(GL_LESS);
+			}
+		}
+
+		// color pass, counted by the queries
+		glBeginQuery(GL_SAMPLES_PASSED, current.samples);
+		if (haveInvocationCount)
+			glBeginQuery(GL_FRAGMENT_SHADER_INVOCATIONS_ARB, current.invocations);
+
+		{
+			PROFILE_SCOPE("color pass");
+			ourShaders.use(); // using cube shaders
+			ourShaders.setVec3("objectColor", 0.4f, 0.7f, 0.65f);
+			ourShaders.setVec3("lightColor", 1.0f, 1.0f, 1.0f);
+			ourShaders.setVec3("lightPos", lightPos);
+			ourShaders.setVec3("viewPos", camera.Position);
+			ourShaders.setViewProjection(view, projection);
+			vertexArrays.bind<VertexPN>(VBO);
+			for (int i = 0; i < CUBE_COUNT; i++)
+			{
+				ourShaders.setModel(models[i]);
+				glDrawArrays(GL_TRIANGLES, 0, 36);
+			}
+		}
+
+		if (haveInvocationCount)
+			glEndQuery(GL_FRAGMENT_SHADER_INVOCATIONS_ARB);
+		glEndQuery(GL_SAMPLES_PASSED);
+		glEndQuery(GL_TIME_ELAPSED);
+		current.pending = true;
+
+		{
+			PROFILE_SCOPE("query readback");
+			// last frame's queries should be done by now
+			frameIndex = 1 - frameIndex;
+			FrameQueries& previous = queries[frameIndex];
+			if (previous.pending)
+			{
+				GLuint64 shaded = 0, nanoseconds = 0;
+				if (haveInvocationCount)
+					glGetQueryObjectui64v(previous.invocations, GL_QUERY_RESULT, &shaded);
+				else
+					glGetQueryObjectui64v(previous.samples, GL_QUERY_RESULT, &shaded);
+				glGetQueryObjectui64v(previous.time, GL_QUERY_RESULT, &nanoseconds);
+				int mode = previous.prePass ? 1 : 0;
+				shadedSum[mode] += (double)shaded;
+				gpuMsSum[mode] += nanoseconds / 1.0e6;
+				measuredFrames[mode]++;
+				previous.pending = false;
+			}
+		}
+
+		statsTimer += deltaTime;
+		if (statsTimer >= 1.0f)
+		{
+			const char* counter = haveInvocationCount ? "fragment shader invocations" : "shaded samples";
+			for (int mode = 0; mode < 2; mode++)
+			{
+				if (measuredFrames[mode] == 0)
+					continue;
+				std::cout << (mode ? "pre-pass on:  " : "pre-pass off: ") << (long long)(shadedSum[mode] / measuredFrames[mode]) << " " << counter
+					<< "/frame, gpu " << gpuMsSum[mode] / measuredFrames[mode] << " ms" << std::endl;
+			}
+			if (measuredFrames[0] && measuredFrames[1])
+			{
+				double off = shadedSum[0] / measuredFrames[0];
+				double on = shadedSum[1] / measuredFrames[1];
+				std::cout << "  pre-pass saves " << 100.0 * (1.0 - on / off) << "% of the lighting shader work" << std::endl;
+			}
+			GlCallStats::printSummary();
+			statsTimer = 0.0f;
+		}
+
+		GlCallStats::endFrame();
+
+		// does a double buffer swap to avoid flickering
+		{
+			PROFILE_SCOPE("swap");
+			glfwSwapBuffers(window);
+		}
+
+		// process any keypresses
+		{
+			PROFILE_SCOPE("poll events");
+			glfwPollEvents();
+		}
+	}
+
+	// de allocate stuff (here its the VBO and VAOs)
+	for (int i = 0; i < 2; i++)
+	{
+		glDeleteQueries(1, &queries[i].samples);
+		glDeleteQueries(1, &queries[i].time);
+		if (haveInvocationCount)
+			glDeleteQueries(1, &queries[i].invocations);
+	}
+	glDeleteBuffers(1, &VBO);
+	vertexArrays.release();
+
+	CpuProfiler::writeChromeTrace("cpu_trace.json");
+
+	// close the application 
+	glfwTerminate();
+	return 0;
+}
+
+// create a function that runs eachtime window size changes
+// glfw: whenever the window size changed (by OS or user resize) this callback function executes
+// ---------------------------------------------------------------------------------------------
+void framebuffer_size_callback(GLFWwindow* window, int width, int height)
+{
+	// make sure the viewport matches the new window dimensions; note that width and 
+	// height will be significantly larger than specified on retina displays.
+	glViewport(0, 0, width, height);
+	if (width > 0 && height > 0)
+	{
+		windowWidth = width;
+		windowHeight = height;
+	}
+}
+
+// glfw: key presses that should only happen once per press (not every frame the key is held)
+// ------------------------------------------------------------------------------------------
+void key_callback(GLFWwindow* window, int key, int scancode, int action, int mods)
+{
+	if (action == GLFW_PRESS && key == GLFW_KEY_P)
+	{
+		depthPrePass = !depthPrePass;
+		std::cout << "depth pre-pass " << (depthPrePass ? "on" : "off") << std::endl;
+	}
+}
+
+// process all input: query GLFW whether relevant keys are pressed/released this frame and react accordingly
+// ---------------------------------------------------------------------------------------------------------
+void processInput(GLFWwindow* window)
+{
+	if (glfwGetKey(window, GLFW_KEY_ESCAPE) == GLFW_PRESS)
+		glfwSetWindowShouldClose(window, true);
+
+	// just like in unity, all speeds must be relative to deltaTime to account for frame drops!
+	float cameraSpeed = static_cast<float>(2.5 * deltaTime);
+	if (glfwGetKey(window, GLFW_KEY_W) == GLFW_PRESS)
+		camera.Position += cameraSpeed * camera.Front;
+	if (glfwGetKey(window, GLFW_KEY_S) == GLFW_PRESS)
+		camera.Position -= cameraSpeed * camera.Front;
+	if (glfwGetKey(window, GLFW_KEY_A) == GLFW_PRESS)
+		camera.Position -= glm::normalize(glm::cross(camera.Front, camera.Up)) * cameraSpeed;
+	if (glfwGetKey(window, GLFW_KEY_D) == GLFW_PRESS)
+		camera.Position += glm::normalize(glm::cross(camera.Front, camera.Up)) * cameraSpeed;
+}
+
+// glfw: whenever the mouse moves, this callback is called
+void mouse_callback(GLFWwindow* window, double xposIn, double yposIn)
+{
+	float xpos = static_cast<float>(xposIn);
+	float ypos = static_cast<float>(yposIn);
+
+	if (firstMouse)
+	{
+		lastX = xpos;
+		lastY = ypos;
+		firstMouse = false;
+	}
+
+	float xoffset = xpos - lastX;
+	float yoffset = lastY - ypos; // reversed since y-coordinates go from bottom to top
+	lastX = xpos;
+	lastY = ypos;
+
+	float sensitivity = 0.1f; // change this value to your liking
+	xoffset *= sensitivity;
+	yoffset *= sensitivity;
+
+	camera.Yaw += xoffset;
+	camera.Pitch += yoffset;
+
+	// make sure that when pitch is out of bounds, screen doesn't get flipped
+	if (camera.Pitch > 89.0f)
+		camera.Pitch = 89.0f;
+	if (camera.Pitch < -89.0f)
+		camera.Pitch = -89.0f;
+
+	// pitch and yaw influence cameraFront vector, which influence where the target vector 
+	// aka second arg of glfwLookAt function
+	glm::vec3 front;
+	front.x = cos(glm::radians(camera.Yaw)) * cos(glm::radians(camera.Pitch));
+	front.y = sin(glm::radians(camera.Pitch));
+	front.z = sin(glm::radians(camera.Yaw)) * cos(glm::radians(camera.Pitch));
+	camera.Front = glm::normalize(front);
+}
+
+// glfw: whenever the mouse scroll wheel scrolls, this callback is called
+// ----------------------------------------------------------------------
+void scroll_callback(GLFWwindow* window, double xoffset, double yoffset)
+{
+	camera.Zoom -= (float)yoffset;
+	if (camera.Zoom < 1.0f)
+		camera.Zoom = 1.0f;
+	if (camera.Zoom > 45.0f)
+		camera.Zoom = 45.0f;
+}
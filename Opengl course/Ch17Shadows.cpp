@@ -0,0 +1,472 @@
+// make sure that glad comes before glfw
+
+#include <glad/glad.h>
+#include <glfw3.h>
+#include <iostream>
+#include "cpu_profiler.h"
+#include "gpu_profiler.h"
+#include "gl_call_stats.h"
+#include <vector>
+#include "shader_s.h"
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+#include "camera.h"
+#include "shadows.h"
+
+
+void framebuffer_size_callback(GLFWwindow* window, int width, int height);
+void processInput(GLFWwindow* window);
+void mouse_callback(GLFWwindow* window, double xpos, double ypos);
+void scroll_callback(GLFWwindow* window, double xoffset, double yoffset);
+void key_callback(GLFWwindow* window, int key, int scancode, int action, int mods);
+
+// timing
+float deltaTime = 0.0f;	// time between current frame and last frame
+float lastFrame = 0.0f;
+
+int windowWidth = 800;
+int windowHeight = 600;
+
+// camera
+Camera camera(glm::vec3(0.0f, 3.0f, 10.0f));
+float lastX = 800 / 2.0f;
+float lastY = 600 / 2.0f;
+bool firstMouse = true;
+
+// C toggles the static shadow caster cache, SPACE stops the light from spinning
+bool useShadowCache = true;
+bool lightPaused = false;
+float lightAngle = 0.0f;
+
+int main()
+{
+	// -------------------------------------------- Start Initialization ------------------------------- //
+	glfwInit();
+	// set OpenGL version to 3.3
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+
+	// Core mode over immediate mode
+	glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+
+	GLFWwindow* window = glfwCreateWindow(windowWidth, windowHeight, "LearnOpenGL", NULL, NULL);
+	if (window == NULL)
+	{
+		std::cout << "Failed to create GLFW window" << std::endl;
+		glfwTerminate();
+		return -1;
+	}
+	glfwMakeContextCurrent(window);
+
+	// intitialize GLAD
+	if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
+	{
+		std::cout << "Failed to initialize GLAD" << std::endl;
+		return -1;
+	}
+
+	GlCallStats::install();
+
+	// set viewport (lower left, lower right, width, height)
+	glViewport(0, 0, windowWidth, windowHeight);
+
+	// register a callback that will reset the viewport each time window size changes
+	glfwSetFramebufferSizeCallback(window, framebuffer_size_callback);
+	glfwSetCursorPosCallback(window, mouse_callback);
+	glfwSetScrollCallback(window, scroll_callback);
+	glfwSetKeyCallback(window, key_callback);
+	// -------------------------------------------- End Initialization ------------------------------- //
+
+	// load shaders
+	Shader ourShaders("./Shaders/Ch13DiffuseAndSpecular/vs.glsl", "./Shaders/Ch17Shadows/fs.glsl");
+	Shader lightShaders("./Shaders/Ch12Lighting/vs.glsl", "./Shaders/Ch12Lighting/light_cube_fs.glsl");
+	Shader sunDepthShaders("./Shaders/Ch17Shadows/depth_vs.glsl", "./Shaders/Ch17Shadows/depth_fs.glsl");
+	Shader pointDepthShaders("./Shaders/Ch17Shadows/depth_vs.glsl", "./Shaders/Ch17Shadows/point_depth_fs.glsl");
+
+
+	// -------------------------------------------- DATA ------------------------------- //
+	// vertex data (coordinates range from -1 to 1)
+	// ------------------------------------------------------------------ //
+	// goes xyz, normals (xyz)
+	float vertices[] = {
+		-0.5f, -0.5f, -0.5f,  0.0f,  0.0f, -1.0f,
+		 0.5f, -0.5f, -0.5f,  0.0f,  0.0f, -1.0f,
+		 0.5f,  0.5f, -0.5f,  0.0f,  0.0f, -1.0f,
+		 0.5f,  0.5f, -0.5f,  0.0f,  0.0f, -1.0f,
+		-0.5f,  0.5f, -0.5f,  0.0f,  0.0f, -1.0f,
+		-0.5f, -0.5f, -0.5f,  0.0f,  0.0f, -1.0f,
+
+		-0.5f, -0.5f,  0.5f,  0.0f,  0.0f,  1.0f,
+		 0.5f, -0.5f,  0.5f,  0.0f,  0.0f,  1.0f,
+		 0.5f,  0.5f,  0.5f,  0.0f,  0.0f,  1.0f,
+		 0.5f,  0.5f,  0.5f,  0.0f,  0.0f,  1.0f,
+		-0.5f,  0.5f,  0.5f,  0.0f,  0.0f,  1.0f,
+		-0.5f, -0.5f,  0.5f,  0.0f,  0.0f,  1.0f,
+
+		-0.5f,  0.5f,  0.5f, -1.0f,  0.0f,  0.0f,
+		-0.5f,  0.5f, -0.5f, -1.0f,  0.0f,  0.0f,
+		-0.5f, -0.5f, -0.5f, -1.0f,  0.0f,  0.0f,
+		-0.5f, -0.5f, -0.5f, -1.0f,  0.0f,  0.0f,
+		-0.5f, -0.5f,  0.5f, -1.0f,  0.0f,  0.0f,
+		-0.5f,  0.5f,  0.5f, -1.0f,  0.0f,  0.0f,
+
+		 0.5f,  0.5f,  0.5f,  1.0f,  0.0f,  0.0f,
+		 0.5f,  0.5f, -0.5f,  1.0f,  0.0f,  0.0f,
+		 0.5f, -0.5f, -0.5f,  1.0f,  0.0f,  0.0f,
+		 0.5f, -0.5f, -0.5f,  1.0f,  0.0f,  0.0f,
+		 0.5f, -0.5f,  0.5f,  1.0f,  0.0f,  0.0f,
+		 0.5f,  0.5f,  0.5f,  1.0f,  0.0f,  0.0f,
+
+		-0.5f, -0.5f, -0.5f,  0.0f, -1.0f,  0.0f,
+		 0.5f, -0.5f, -0.5f,  0.0f, -1.0f,  0.0f,
+		 0.5f, -0.5f,  0.5f,  0.0f, -1.0f,  0.0f,
+		 0.5f, -0.5f,  0.5f,  0.0f, -1.0f,  0.0f,
+		-0.5f, -0.5f,  0.5f,  0.0f, -1.0f,  0.0f,
+		-0.5f, -0.5f, -0.5f,  0.0f, -1.0f,  0.0f,
+
+		-0.5f,  0.5f, -0.5f,  0.0f,  1.0f,  0.0f,
+		 0.5f,  0.5f, -0.5f,  0.0f,  1.0f,  0.0f,
+		 0.5f,  0.5f,  0.5f,  0.0f,  1.0f,  0.0f,
+		 0.5f,  0.5f,  0.5f,  0.0f,  1.0f,  0.0f,
+		-0.5f,  0.5f,  0.5f,  0.0f,  1.0f,  0.0f,
+		-0.5f,  0.5f, -0.5f,  0.0f,  1.0f,  0.0f
+	};
+
+	// static scene: a big flat floor and a ring of pillars. these only get drawn into the shadow maps when the cache is stale
+	std::vector<glm::mat4> staticModels;
+	glm::mat4 floorModel = glm::mat4(1.0f);
+	floorModel = glm::translate(floorModel, glm::vec3(0.0f, -1.25f, 0.0f));
+	floorModel = glm::scale(floorModel, glm::vec3(30.0f, 0.5f, 30.0f));
+	staticModels.push_back(floorModel);
+	for (int i = 0; i < 12; i++)
+	{
+		float angle = glm::radians(30.0f * i);
+		glm::mat4 model = glm::mat4(1.0f);
+		model = glm::translate(model, glm::vec3(5.0f * cos(angle), 0.5f, 5.0f * sin(angle)));
+		model = glm::scale(model, glm::vec3(0.5f, 3.0f, 0.5f));
+		staticModels.push_back(model);
+	}
+	// bounds of every caster, lets the cascades pick the tightest depth range
+	glm::vec3 sceneMin(-15.0f, -1.5f, -15.0f);
+	glm::vec3 sceneMax(15.0f, 2.0f, 15.0f);
+
+	// dynamic scene: spinning cubes, rebuilt every frame
+	std::vector<glm::mat4> dynamicModels(5);
+
+	glm::vec3 sunDir = glm::normalize(glm::vec3(-0.4f, -1.0f, -0.3f));
+
+
+
+	// --------------------------------------------  ------------------------------- //
+	unsigned int VBO, VAO;
+	glGenBuffers(1, &VBO);
+	glGenVertexArrays(1, &VAO);
+
+	glBindVertexArray(VAO);
+
+	glBindBuffer(GL_ARRAY_BUFFER, VBO);
+
+	glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
+
+	// x,y,z
+	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(float),
+		(void*)0);
+	glEnableVertexAttribArray(0);
+
+	// normals
+	glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(float),
+		(void*)(3 * sizeof(float)));
+	glEnableVertexAttribArray(1);
+
+	// position only VAO for the light cube and all the shadow passes
+	unsigned int lightVAO;
+	glGenVertexArrays(1, &lightVAO);
+
+	glBindVertexArray(lightVAO);
+	glBindBuffer(GL_ARRAY_BUFFER, VBO);
+
+	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(float), (void*)0);
+	glEnableVertexAttribArray(0);
+
+
+	PointShadowMap pointShadows(1024, 25.0f);
+	CascadedShadowMap sunShadows(2048);
+
+	// shadow pass callbacks, same cube VAO for everything
+	ShadowCasterDraw drawStatic = [&](const Shader& depthShader) {
+		glBindVertexArray(lightVAO);
+		for (const glm::mat4& model : staticModels)
+		{
+			depthShader.setModel(model);
+			glDrawArrays(GL_TRIANGLES, 0, 36);
+		}
+	};
+	ShadowCasterDraw drawDynamic = [&](const Shader& depthShader) {
+		glBindVertexArray(lightVAO);
+		for (const glm::mat4& model : dynamicModels)
+		{
+			depthShader.setModel(model);
+			glDrawArrays(GL_TRIANGLES, 0, 36);
+		}
+	};
+
+	// texture units for the shadow maps never change
+	ourShaders.use();
+	ourShaders.setInt("pointShadowMap", 0);
+	ourShaders.setInt("cascadeShadowMap", 1);
+
+	float nearPlanes = 0.1f;
+	float farPlanes = 60.0f;
+
+	// stats, printed once a second
+	float statsTimer = 0.0f;
+	int statsFrames = 0;
+	double shadowMs = 0.0;
+	int pointStaticRedraws = 0, cascadeStaticRedraws = 0;
+
+
+	glEnable(GL_DEPTH_TEST);
+	// the passes timed on the GPU, printed with the stats and saved next to the CPU scopes at the end
+	GpuProfiler gpuProfiler;
+
+	// simple render loop (its just a while loop!)
+	while (!glfwWindowShouldClose(window))
+	{
+		PROFILE_SCOPE("frame");
+		// per-frame time logic
+		// --------------------
+		float currentFrame = static_cast<float>(glfwGetTime());
+		deltaTime = currentFrame - lastFrame;
+		lastFrame = currentFrame;
+
+		// input
+		// -----
+		{
+			PROFILE_SCOPE("input");
+			processInput(window);
+		}
+
+		// spinning light for lulz (same as Ch13, just a bit wider so it goes between the pillars)
+		if (!lightPaused)
+			lightAngle += deltaTime;
+		glm::vec3 lightPos(3.0f * cos(lightAngle), 1.0f, 3.0f * sin(lightAngle));
+
+		for (int i = 0; i < (int)dynamicModels.size(); i++)
+		{
+			float angle = glm::radians(72.0f * i) + currentFrame * 0.3f;
+			glm::mat4 model = glm::mat4(1.0f);
+			model = glm::translate(model, glm::vec3(1.8f * cos(angle), 0.0f, 1.8f * sin(angle)));
+			model = glm::rotate(model, currentFrame * (i + 1) * 0.5f, glm::vec3(0.3f, 1.0f, 0.2f));
+			model = glm::scale(model, glm::vec3(0.6f));
+			dynamicModels[i] = model;
+		}
+
+		glm::mat4 view = camera.GetViewMatrix();
+		float aspect = (float)windowWidth / (float)windowHeight;
+		glm::mat4 projection = glm::perspective(glm::radians(camera.Zoom), aspect, nearPlanes, farPlanes);
+
+		// ---------------- shadow maps ---------------- //
+		gpuProfiler.beginFrame();
+		{
+			PROFILE_SCOPE("shadow maps");
+			GpuProfileScope gpuPass(gpuProfiler, "shadow maps");
+			double shadowStart = glfwGetTime();
+			if (pointShadows.update(lightPos, pointDepthShaders, drawStatic, drawDynamic, useShadowCache))
+				pointStaticRedraws++;
+			cascadeStaticRedraws += sunShadows.update(view, glm::radians(camera.Zoom), aspect, nearPlanes, farPlanes, sunDir,
+				sceneMin, sceneMax, sunDepthShaders, drawStatic, drawDynamic, useShadowCache);
+			shadowMs += (glfwGetTime() - shadowStart) * 1000.0;
+		}
+
+		// ---------------- scene ---------------- //
+		{
+			PROFILE_SCOPE("scene");
+			GpuProfileScope gpuPass(gpuProfiler, "scene");
+			glClearColor(0.1f, 0.1f, 0.1f, 1.0f);
+			glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+			ourShaders.use();
+			ourShaders.setVec3("lightColor", 1.0f, 0.9f, 0.8f);
+			ourShaders.setVec3("lightPos", lightPos);
+			ourShaders.setFloat("pointFarPlane", pointShadows.farPlane);
+			ourShaders.setVec3("sunDir", sunDir);
+			ourShaders.setVec3("sunColor", 0.4f, 0.4f, 0.5f);
+			ourShaders.setVec3("viewPos", camera.Position);
+			ourShaders.setVec3("viewDir", camera.Front);
+			ourShaders.setViewProjection(view, projection);
+			sunShadows.setUniforms(ourShaders);
+			glActiveTexture(GL_TEXTURE0);
+			glBindTexture(GL_TEXTURE_CUBE_MAP, pointShadows.depthCubemap);
+			glActiveTexture(GL_TEXTURE1);
+			glBindTexture(GL_TEXTURE_2D_ARRAY, sunShadows.depthArray);
+
+			glBindVertexArray(VAO);
+			ourShaders.setVec3("objectColor", 0.6f, 0.6f, 0.6f);
+			for (const glm::mat4& model : staticModels)
+			{
+				ourShaders.setModel(model);
+				glDrawArrays(GL_TRIANGLES, 0, 36);
+			}
+			ourShaders.setVec3("objectColor", 0.4f, 0.7f, 0.65f);
+			for (const glm::mat4& model : dynamicModels)
+			{
+				ourShaders.setModel(model);
+				glDrawArrays(GL_TRIANGLES, 0, 36);
+			}
+
+			// the light itself
+			lightShaders.use();
+			lightShaders.setViewProjection(view, projection);
+			glm::mat4 model = glm::mat4(1.0f);
+			model = glm::translate(model, lightPos);
+			model = glm::scale(model, glm::vec3(0.2f)); // a smaller cube
+			lightShaders.setModel(model);
+
+			glBindVertexArray(lightVAO);
+			glDrawArrays(GL_TRIANGLES, 0, 36);
+		}
+
+		gpuProfiler.endFrame();
+
+		statsTimer += deltaTime;
+		statsFrames++;
+		if (statsTimer >= 1.0f)
+		{
+			std::cout << "shadow cache " << (useShadowCache ? "on" : "off") << ": shadow passes " << shadowMs / statsFrames << " ms/frame (cpu submit), "
+				<< "static redraws/s point " << pointStaticRedraws << " cascades " << cascadeStaticRedraws << std::endl;
+			gpuProfiler.printAverages();
+			GlCallStats::printSummary();
+			statsTimer = 0.0f;
+			statsFrames = 0;
+			shadowMs = 0.0;
+			pointStaticRedraws = cascadeStaticRedraws = 0;
+		}
+
+		GlCallStats::endFrame();
+
+		// does a double buffer swap to avoid flickering
+		{
+			PROFILE_SCOPE("swap");
+			glfwSwapBuffers(window);
+		}
+
+		// process any keypresses
+		{
+			PROFILE_SCOPE("poll events");
+			glfwPollEvents();
+		}
+	}
+
+	// de allocate stuff (here its the VBO and VAOs)
+	glDeleteVertexArrays(1, &VAO);
+	glDeleteVertexArrays(1, &lightVAO);
+	glDeleteBuffers(1, &VBO);
+	pointShadows.release();
+	sunShadows.release();
+
+	gpuProfiler.release();
+
+	CpuProfiler::writeChromeTrace("cpu_trace.json", { gpuProfiler.track() });
+
+	// close the application 
+	glfwTerminate();
+	return 0;
+}
+
+// create a function that runs eachtime window size changes
+// glfw: whenever the window size changed (by OS or user resize) this callback function executes
+// ---------------------------------------------------------------------------------------------
+void framebuffer_size_callback(GLFWwindow* window, int width, int height)
+{
+	// make sure the viewport matches the new window dimensions; note that width and 
+	// height will be significantly larger than specified on retina displays.
+	glViewport(0, 0, width, height);
+	if (width > 0 && height > 0)
+	{
+		windowWidth = width;
+		windowHeight = height;
+	}
+}
+
+// glfw: key presses that should only happen once per press (not every frame the key is held)
+// ------------------------------------------------------------------------------------------
+void key_callback(GLFWwindow* window, int key, int scancode, int action, int mods)
+{
+	if (action != GLFW_PRESS)
+		return;
+	if (key == GLFW_KEY_C)
+		useShadowCache = !useShadowCache;
+	if (key == GLFW_KEY_SPACE)
+		lightPaused = !lightPaused;
+}
+
+// process all input: query GLFW whether relevant keys are pressed/released this frame and react accordingly
+// ---------------------------------------------------------------------------------------------------------
+void processInput(GLFWwindow* window)
+{
+	if (glfwGetKey(window, GLFW_KEY_ESCAPE) == GLFW_PRESS)
+		glfwSetWindowShouldClose(window, true);
+
+	// just like in unity, all speeds must be relative to deltaTime to account for frame drops!
+	float cameraSpeed = static_cast<float>(2.5 * deltaTime);
+	if (glfwGetKey(window, GLFW_KEY_W) == GLFW_PRESS)
+		camera.Position += cameraSpeed * camera.Front;
+	if (glfwGetKey(window, GLFW_KEY_S) == GLFW_PRESS)
+		camera.Position -= cameraSpeed * camera.Front;
+	if (glfwGetKey(window, GLFW_KEY_A) == GLFW_PRESS)
+		camera.Position -= glm::normalize(glm::cross(camera.Front, camera.Up)) * cameraSpeed;
+	if (glfwGetKey(window, GLFW_KEY_D) == GLFW_PRESS)
+		camera.Position += glm::normalize(glm::cross(camera.Front, camera.Up)) * cameraSpeed;
+}
+
+// glfw: whenever the mouse moves, this callback is called
+void mouse_callback(GLFWwindow* window, double xposIn, double yposIn)
+{
+	float xpos = static_cast<float>(xposIn);
+	float ypos = static_cast<float>(yposIn);
+
+	if (firstMouse)
+	{
+		lastX = xpos;
+		lastY = ypos;
+		firstMouse = false;
+	}
+
+	float xoffset = xpos - lastX;
+	float yoffset = lastY - ypos; // reversed since y-coordinates go from bottom to top
+	lastX = xpos;
+	lastY = ypos;
+
+	float sensitivity = 0.1f; // change this value to your liking
+	xoffset *= sensitivity;
+	yoffset *= sensitivity;
+
+	camera.Yaw += xoffset;
+	camera.Pitch += yoffset;
+
+	// make sure that when pitch is out of bounds, screen doesn't get flipped
+	if (camera.Pitch > 89.0f)
+		camera.Pitch = 89.0f;
+	if (camera.Pitch < -89.0f)
+		camera.Pitch = -89.0f;
+
+	// pitch and yaw influence cameraFront vector, which influence where the target vector 
+	// aka second arg of glfwLookAt function
+	glm::vec3 front;
+	front.x = cos(glm::radians(camera.Yaw)) * cos(glm::radians(camera.Pitch));
+	front.y = sin(glm::radians(camera.Pitch));
+	front.z = sin(glm::radians(camera.Yaw)) * cos(glm::radians(camera.Pitch));
+	camera.Front = glm::normalize(front);
+}
+
+// glfw: whenever the mouse scroll wheel scrolls, this callback is called
+// ----------------------------------------------------------------------
+void scroll_callback(GLFWwindow* window, double xoffset, double yoffset)
+{
+	camera.Zoom -= (float)yoffset;
+	if (camera.Zoom < 1.0f)
+		camera.Zoom = 1.0f;
+	if (camera.Zoom > 45.0f)
+		camera.Zoom = 45.0f;
+}
@@ -0,0 +1,330 @@
+// make sure that glad comes before glfw
+
+#include <glad/glad.h>
+#include <glfw3.h>
+#include <iostream>
+#include "cpu_profiler.h"
+#include <string>
+#include <chrono>
+#include "shader_s.h"
+#include "vertex_layout.h"
+#include "mesh_loader.h"
+#include "mesh_file.h"
+#include "mesh_optimizer.h"
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+#include "camera.h"
+
+
+void framebuffer_size_callback(GLFWwindow* window, int width, int height);
+void processInput(GLFWwindow* window);
+void mouse_callback(GLFWwindow* window, double xpos, double ypos);
+void scroll_callback(GLFWwindow* window, double xoffset, double yoffset);
+void key_callback(GLFWwindow* window, int key, int scancode, int action, int mods);
+
+// timing
+float deltaTime = 0.0f;	// time between current frame and last frame
+float lastFrame = 0.0f;
+
+int windowWidth = 800;
+int windowHeight = 600;
+
+// camera
+Camera camera(glm::vec3(0.0f, 0.0f, 3.0f));
+float lastX = 800 / 2.0f;
+float lastY = 600 / 2.0f;
+bool firstMouse = true;
+
+// Q switches between the full float vertices and the quantized ones, they should look the same
+bool drawQuantized = false;
+bool canSwitchFormat = true;
+
+// pass a .obj, .glb or .mesh on the command line to look at something other than the torus
+int main(int argc, char** argv)
+{
+	// -------------------------------------------- Start Initialization ------------------------------- //
+	glfwInit();
+	// direct state access (vertex_layout.h) needs OpenGL 4.5
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 5);
+
+	// Core mode over immediate mode
+	glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+
+	GLFWwindow* window = glfwCreateWindow(windowWidth, windowHeight, "LearnOpenGL", NULL, NULL);
+	if (window == NULL)
+	{
+		std::cout << "Failed to create GLFW window" << std::endl;
+		glfwTerminate();
+		return -1;
+	}
+	glfwMakeContextCurrent(window);
+
+	// intitialize GLAD
+	if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
+	{
+		std::cout << "Failed to initialize GLAD" << std::endl;
+		return -1;
+	}
+
+	// set viewport (lower left, lower right, width, height)
+	glViewport(0, 0, windowWidth, windowHeight);
+
+	// register a callback that will reset the viewport each time window size changes
+	glfwSetFramebufferSizeCallback(window, framebuffer_size_callback);
+	glfwSetCursorPosCallback(window, mouse_callback);
+	glfwSetScrollCallback(window, scroll_callback);
+	glfwSetKeyCallback(window, key_callback);
+	// -------------------------------------------- End Initialization ------------------------------- //
+
+	// load shaders, the Ch13 ones only read position + normal which is all we need here
+	Shader ourShaders("./Shaders/Ch13DiffuseAndSpecular/vs.glsl", "./Shaders/Ch13DiffuseAndSpecular/fs.glsl");
+
+
+	// -------------------------------------------- DATA ------------------------------- //
+	// no more float arrays, the mesh comes from a file: .obj/.glb get parsed (mesh_loader.h),
+	// .mesh files (made by MeshConvert, mesh_file.h) are already in GL's format and go straight into buffers
+	std::string path = argc > 1 ? argv[1] : "./models/torus.obj";
+	bool isMeshFile = path.size() >= 5 && path.compare(path.size() - 5, 5, ".mesh") == 0;
+	unsigned int VBO = 0, quantizedVBO = 0, EBO = 0;
+	GLsizei indexCount = 0;
+	GLenum indexType = GL_UNSIGNED_INT;
+	glm::vec3 boundsMin, boundsMax;
+	auto loadStart = std::chrono::high_resolution_clock::now();
+	if (isMeshFile)
+	{
+		MeshFile file;
+		if (!file.open(path))
+		{
+			glfwTerminate();
+			return -1;
+		}
+		// only one vertex format is stored, so Q has nothing to switch to
+		if (file.quantized())
+			quantizedVBO = file.createVertexBuffer();
+		else
+			VBO = file.createVertexBuffer();
+		drawQuantized = file.quantized();
+		canSwitchFormat = false;
+		EBO = file.createIndexBuffer();
+		indexCount = (GLsizei)file.lod(0).indexCount;
+		indexType = file.indexType();
+		boundsMin = file.boundsMin();
+		boundsMax = file.boundsMax();
+		double loadMs = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - loadStart).count();
+		std::cout << path << ": " << file.info().vertexCount << " vertices, " << indexCount / 3 << " triangles, mapped and uploaded in " << loadMs << " ms" << std::endl;
+	}
+	else
+	{
+		MeshData mesh;
+		if (!MeshLoader::load(path, mesh))
+		{
+			glfwTerminate();
+			return -1;
+		}
+		double loadMs = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - loadStart).count();
+		std::cout << path << ": " << mesh.vertices.size() << " vertices, " << mesh.triangleCount() << " triangles, loaded in " << loadMs << " ms" << std::endl;
+
+		// file order is whatever the exporter felt like, reorder for the vertex cache/overdraw/fetch (mesh_optimizer.h)
+		MeshOptimizer::optimize(mesh, path);
+
+		// same vertices at 16 bytes instead of 32
+		CompressedVertices quantized = mesh.quantize();
+		quantized.printReport(path.c_str());
+		if (quantized.stride != sizeof(VertexPNTQuantized))
+		{
+			std::cout << "ERROR::CH18::QUANTIZED_STRIDE " << quantized.stride << std::endl;
+			glfwTerminate();
+			return -1;
+		}
+
+		// both vertex versions share one index buffer, and VertexArrayCache gives each layout its VAO
+		VBO = createStaticBuffer(mesh.vertices.data(), mesh.vertices.size() * sizeof(VertexPNT));
+		quantizedVBO = createStaticBuffer(quantized.data.data(), quantized.data.size());
+		EBO = createStaticBuffer(mesh.indices.data(), mesh.indices.size() * sizeof(uint32_t));
+		indexCount = (GLsizei)mesh.indices.size();
+		boundsMin = mesh.boundsMin;
+		boundsMax = mesh.boundsMax;
+	}
+
+	// whatever size the model was authored at, scale it to about one unit and put it at the origin
+	glm::vec3 extent = boundsMax - boundsMin;
+	float largest = std::max(extent.x, std::max(extent.y, extent.z));
+	glm::mat4 model = glm::mat4(1.0f);
+	model = glm::scale(model, glm::vec3(largest > 0.0f ? 1.5f / largest : 1.0f));
+	model = glm::translate(model, -0.5f * (boundsMin + boundsMax));
+
+
+
+	// --------------------------------------------  ------------------------------- //
+	VertexArrayCache vertexArrays;
+
+	glEnable(GL_DEPTH_TEST);
+	// simple render loop (its just a while loop!)
+	while (!glfwWindowShouldClose(window))
+	{
+		PROFILE_SCOPE("frame");
+		// per-frame time logic
+		// --------------------
+		float currentFrame = static_cast<float>(glfwGetTime());
+		deltaTime = currentFrame - lastFrame;
+		lastFrame = currentFrame;
+
+		// input
+		// -----
+		{
+			PROFILE_SCOPE("input");
+			processInput(window);
+		}
+
+		// nicer background color than black
+		glClearColor(0.1f, 0.1f, 0.1f, 0.2f);
+		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+		// spinning light for lulz
+		glm::vec3 lightPos(3.0f * cos(glfwGetTime()), 2.0f, 3.0f * sin(glfwGetTime()));
+
+		glm::mat4 view = camera.GetViewMatrix();
+		glm::mat4 projection = glm::perspective(glm::radians(camera.Zoom), (float)windowWidth / (float)windowHeight, 0.1f, 100.0f);
+
+		{
+			PROFILE_SCOPE("uniforms");
+			ourShaders.use();
+			ourShaders.setVec3("objectColor", 0.8f, 0.6f, 0.4f);
+			ourShaders.setVec3("lightColor", 1.0f, 1.0f, 1.0f);
+			ourShaders.setVec3("lightPos", lightPos);
+			ourShaders.setVec3("viewPos", camera.Position);
+			ourShaders.setViewProjection(view, projection);
+			ourShaders.setModel(model);
+		}
+		{
+			PROFILE_SCOPE("draw");
+			if (drawQuantized)
+				vertexArrays.bind<VertexPNTQuantized>(quantizedVBO, EBO);
+			else
+				vertexArrays.bind<VertexPNT>(VBO, EBO);
+			glDrawElements(GL_TRIANGLES, indexCount, indexType, 0);
+		}
+
+		// does a double buffer swap to avoid flickering
+		{
+			PROFILE_SCOPE("swap");
+			glfwSwapBuffers(window);
+		}
+
+		// process any keypresses
+		{
+			PROFILE_SCOPE("poll events");
+			glfwPollEvents();
+		}
+	}
+
+	// de allocate stuff (here its the buffers and the cached VAOs)
+	glDeleteBuffers(1, &VBO);
+	glDeleteBuffers(1, &quantizedVBO);
+	glDeleteBuffers(1, &EBO);
+	vertexArrays.release();
+
+	CpuProfiler::writeChromeTrace("cpu_trace.json");
+
+	// close the application 
+	glfwTerminate();
+	return 0;
+}
+
+// create a function that runs eachtime window size changes
+// glfw: whenever the window size changed (by OS or user resize) this callback function executes
+// ---------------------------------------------------------------------------------------------
+void framebuffer_size_callback(GLFWwindow* window, int width, int height)
+{
+	// make sure the viewport matches the new window dimensions; note that width and 
+	// height will be significantly larger than specified on retina displays.
+	glViewport(0, 0, width, height);
+	if (width > 0 && height > 0)
+	{
+		windowWidth = width;
+		windowHeight = height;
+	}
+}
+
+// glfw: key presses that should only happen once per press (not every frame the key is held)
+// ------------------------------------------------------------------------------------------
+void key_callback(GLFWwindow* window, int key, int scancode, int action, int mods)
+{
+	if (action == GLFW_PRESS && key == GLFW_KEY_Q && canSwitchFormat)
+	{
+		drawQuantized = !drawQuantized;
+		std::cout << "drawing the " << (drawQuantized ? "quantized (16 byte)" : "float (32 byte)") << " vertices" << std::endl;
+	}
+}
+
+// process all input: query GLFW whether relevant keys are pressed/released this frame and react accordingly
+// ---------------------------------------------------------------------------------------------------------
+void processInput(GLFWwindow* window)
+{
+	if (glfwGetKey(window, GLFW_KEY_ESCAPE) == GLFW_PRESS)
+		glfwSetWindowShouldClose(window, true);
+
+	// just like in unity, all speeds must be relative to deltaTime to account for frame drops!
+	float cameraSpeed = static_cast<float>(2.5 * deltaTime);
+	if (glfwGetKey(window, GLFW_KEY_W) == GLFW_PRESS)
+		camera.Position += cameraSpeed * camera.Front;
+	if (glfwGetKey(window, GLFW_KEY_S) == GLFW_PRESS)
+		camera.Position -= cameraSpeed * camera.Front;
+	if (glfwGetKey(window, GLFW_KEY_A) == GLFW_PRESS)
+		camera.Position -= glm::normalize(glm::cross(camera.Front, camera.Up)) * cameraSpeed;
+	if (glfwGetKey(window, GLFW_KEY_D) == GLFW_PRESS)
+		camera.Position += glm::normalize(glm::cross(camera.Front, camera.Up)) * cameraSpeed;
+}
+
+// glfw: whenever the mouse moves, this callback is called
+void mouse_callback(GLFWwindow* window, double xposIn, double yposIn)
+{
+	float xpos = static_cast<float>(xposIn);
+	float ypos = static_cast<float>(yposIn);
+
+	if (firstMouse)
+	{
+		lastX = xpos;
+		lastY = ypos;
+		firstMouse = false;
+	}
+
+	float xoffset = xpos - lastX;
+	float yoffset = lastY - ypos; // reversed since y-coordinates go from bottom to top
+	lastX = xpos;
+	lastY = ypos;
+
+	float sensitivity = 0.1f; // change this value to your liking
+	xoffset *= sensitivity;
+	yoffset *= sensitivity;
+
+	camera.Yaw += xoffset;
+	camera.Pitch += yoffset;
+
+	// make sure that when pitch is out of bounds, screen doesn't get flipped
+	if (camera.Pitch > 89.0f)
+		camera.Pitch = 89.0f;
+	if (camera.Pitch < -89.0f)
+		camera.Pitch = -89.0f;
+
+	// pitch and yaw influence cameraFront vector, which influence where the target vector 
+	// aka second arg of glfwLookAt function
+	glm::vec3 front;
+	front.x = cos(glm::radians(camera.Yaw)) * cos(glm::radians(camera.Pitch));
+	front.y = sin(glm::radians(camera.Pitch));
+	front.z = sin(glm::radians(camera.Yaw)) * cos(glm::radians(camera.Pitch));
+	camera.Front = glm::normalize(front);
+}
+
+// glfw: whenever the mouse scroll wheel scrolls, this callback is called
+// ----------------------------------------------------------------------
+void scroll_callback(GLFWwindow* window, double xoffset, double yoffset)
+{
+	camera.Zoom -= (float)yoffset;
+	if (camera.Zoom < 1.0f)
+		camera.Zoom = 1.0f;
+	if (camera.Zoom > 45.0f)
+		camera.Zoom = 45.0f;
+}
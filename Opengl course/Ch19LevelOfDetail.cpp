@@ -0,0 +1,386 @@
+// make sure that glad comes before glfw
+
+#include <glad/glad.h>
+#include <glfw3.h>
+#include <iostream>
+#include "cpu_profiler.h"
+#include "gl_call_stats.h"
+#include <string>
+#include <vector>
+#include "shader_s.h"
+#include "vertex_layout.h"
+#include "mesh_loader.h"
+#include "mesh_file.h"
+#include "mesh_optimizer.h"
+#include "mesh_simplifier.h"
+#include "lod_selector.h"
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+#include "camera.h"
+
+
+void framebuffer_size_callback(GLFWwindow* window, int width, int height);
+void processInput(GLFWwindow* window);
+void mouse_callback(GLFWwindow* window, double xpos, double ypos);
+void scroll_callback(GLFWwindow* window, double xoffset, double yoffset);
+void key_callback(GLFWwindow* window, int key, int scancode, int action, int mods);
+
+// timing
+float deltaTime = 0.0f;	// time between current frame and last frame
+float lastFrame = 0.0f;
+
+int windowWidth = 800;
+int windowHeight = 600;
+
+// camera
+Camera camera(glm::vec3(0.0f, 1.0f, 4.0f));
+float lastX = 800 / 2.0f;
+float lastY = 600 / 2.0f;
+bool firstMouse = true;
+
+// L turns LOD selection off (everything full detail) to compare, C colors every object by its level,
+// up/down doubles/halves how many pixels of error are acceptable
+bool useLods = true;
+bool showLevels = false;
+LodSelector lodSelector(1.0f, 0.25f);
+
+// a long field of copies of the model, most of them far away
+const int GRID_WIDTH = 16;
+const int GRID_DEPTH = 64;
+const float GRID_SPACING = 3.0f;
+
+// level 0, 1, 2, ... colors for C
+const glm::vec3 LEVEL_COLORS[] = {
+	glm::vec3(0.9f, 0.9f, 0.9f), glm::vec3(0.3f, 0.8f, 0.3f), glm::vec3(0.3f, 0.5f, 0.9f), glm::vec3(0.9f, 0.8f, 0.2f),
+	glm::vec3(0.9f, 0.5f, 0.2f), glm::vec3(0.9f, 0.2f, 0.2f), glm::vec3(0.8f, 0.3f, 0.9f), glm::vec3(0.4f, 0.9f, 0.9f)
+};
+
+// pass a .obj/.glb (the LOD chain gets built at startup) or a .mesh baked with MeshConvert -lods
+int main(int argc, char** argv)
+{
+	// -------------------------------------------- Start Initialization ------------------------------- //
+	glfwInit();
+	// direct state access (vertex_layout.h) needs OpenGL 4.5
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 5);
+
+	// Core mode over immediate mode
+	glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+
+	GLFWwindow* window = glfwCreateWindow(windowWidth, windowHeight, "LearnOpenGL", NULL, NULL);
+	if (window == NULL)
+	{
+		std::cout << "Failed to create GLFW window" << std::endl;
+		glfwTerminate();
+		return -1;
+	}
+	glfwMakeContextCurrent(window);
+
+	// intitialize GLAD
+	if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
+	{
+		std::cout << "Failed to initialize GLAD" << std::endl;
+		return -1;
+	}
+
+	GlCallStats::install();
+
+	// set viewport (lower left, lower right, width, height)
+	glViewport(0, 0, windowWidth, windowHeight);
+
+	// register a callback that will reset the viewport each time window size changes
+	glfwSetFramebufferSizeCallback(window, framebuffer_size_callback);
+	glfwSetCursorPosCallback(window, mouse_callback);
+	glfwSetScrollCallback(window, scroll_callback);
+	glfwSetKeyCallback(window, key_callback);
+	// -------------------------------------------- End Initialization ------------------------------- //
+
+	// load shaders
+	Shader ourShaders("./Shaders/Ch13DiffuseAndSpecular/vs.glsl", "./Shaders/Ch13DiffuseAndSpecular/fs.glsl");
+
+
+	// -------------------------------------------- DATA ------------------------------- //
+	// every level is a range of one index buffer over the same vertices (MeshLod), so switching level is
+	// just a different count/offset in glDrawElements
+	std::string path = argc > 1 ? argv[1] : "./models/torus.obj";
+	bool isMeshFile = path.size() >= 5 && path.compare(path.size() - 5, 5, ".mesh") == 0;
+	std::vector<MeshLod> lods;
+	unsigned int VBO = 0, EBO = 0;
+	GLenum indexType = GL_UNSIGNED_INT;
+	unsigned int indexSize = sizeof(uint32_t);
+	bool quantized = false;
+	glm::vec3 boundsMin, boundsMax;
+	if (isMeshFile)
+	{
+		MeshFile file;
+		if (!file.open(path))
+		{
+			glfwTerminate();
+			return -1;
+		}
+		for (uint32_t i = 0; i < file.lodCount(); i++)
+			lods.push_back(file.lod(i));
+		if (lods.size() == 1)
+			std::cout << path << " has no LODs, bake it with MeshConvert -lods" << std::endl;
+		VBO = file.createVertexBuffer();
+		EBO = file.createIndexBuffer();
+		indexType = file.indexType();
+		indexSize = file.info().indexSize;
+		quantized = file.quantized();
+		boundsMin = file.boundsMin();
+		boundsMax = file.boundsMax();
+	}
+	else
+	{
+		MeshData mesh;
+		if (!MeshLoader::load(path, mesh))
+		{
+			glfwTerminate();
+			return -1;
+		}
+		MeshOptimizer::optimize(mesh, path, false);
+		MeshSimplifier::buildLods(mesh, 8, 0.5f, path);
+		lods = mesh.lods;
+		VBO = createStaticBuffer(mesh.vertices.data(), mesh.vertices.size() * sizeof(VertexPNT));
+		EBO = createStaticBuffer(mesh.indices.data(), mesh.indices.size() * sizeof(uint32_t));
+		boundsMin = mesh.boundsMin;
+		boundsMax = mesh.boundsMax;
+	}
+
+	// scale the model to about one unit like in Ch18, and lay the copies out on a grid going away from the camera
+	glm::vec3 extent = boundsMax - boundsMin;
+	float largest = std::max(extent.x, std::max(extent.y, extent.z));
+	float scale = largest > 0.0f ? 1.5f / largest : 1.0f;
+	float radius = 0.5f * glm::length(extent) * scale;
+	std::vector<glm::vec3> positions;
+	std::vector<glm::mat4> models;
+	for (int z = 0; z < GRID_DEPTH; z++)
+	{
+		for (int x = 0; x < GRID_WIDTH; x++)
+		{
+			glm::vec3 position((x - GRID_WIDTH / 2) * GRID_SPACING, 0.0f, -z * GRID_SPACING);
+			glm::mat4 model = glm::mat4(1.0f);
+			model = glm::translate(model, position);
+			model = glm::rotate(model, (float)(x * 7 + z * 13), glm::vec3(0.3f, 1.0f, 0.1f));
+			model = glm::scale(model, glm::vec3(scale));
+			model = glm::translate(model, -0.5f * (boundsMin + boundsMax));
+			positions.push_back(position);
+			models.push_back(model);
+		}
+	}
+	// every object remembers its level for the hysteresis
+	std::vector<LodState> lodStates(models.size());
+
+
+
+	// --------------------------------------------  ------------------------------- //
+	VertexArrayCache vertexArrays;
+
+	long long fullTriangles = (long long)models.size() * (lods[0].indexCount / 3);
+	double drawnSum = 0.0;
+	int statsFrames = 0;
+	float statsTimer = 0.0f;
+
+	glEnable(GL_DEPTH_TEST);
+	// simple render loop (its just a while loop!)
+	while (!glfwWindowShouldClose(window))
+	{
+		PROFILE_SCOPE("frame");
+		// per-frame time logic
+		// --------------------
+		float currentFrame = static_cast<float>(glfwGetTime());
+		deltaTime = currentFrame - lastFrame;
+		lastFrame = currentFrame;
+
+		// input
+		// -----
+		{
+			PROFILE_SCOPE("input");
+			processInput(window);
+		}
+
+		// nicer background color than black
+		glClearColor(0.1f, 0.1f, 0.1f, 0.2f);
+		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+		glm::mat4 view = camera.GetViewMatrix();
+		glm::mat4 projection = glm::perspective(glm::radians(camera.Zoom), (float)windowWidth / (float)windowHeight, 0.1f, 500.0f);
+		lodSelector.setProjection(glm::radians(camera.Zoom), windowHeight);
+
+		{
+			PROFILE_SCOPE("uniforms");
+			ourShaders.use();
+			ourShaders.setVec3("lightColor", 1.0f, 1.0f, 1.0f);
+			ourShaders.setVec3("lightPos", camera.Position + glm::vec3(0.0f, 10.0f, 0.0f));
+			ourShaders.setVec3("viewPos", camera.Position);
+			ourShaders.setViewProjection(view, projection);
+			if (quantized)
+				vertexArrays.bind<VertexPNTQuantized>(VBO, EBO);
+			else
+				vertexArrays.bind<VertexPNT>(VBO, EBO);
+		}
+
+		long long drawn = 0;
+		{
+			PROFILE_SCOPE("draw");
+			for (size_t i = 0; i < models.size(); i++)
+			{
+				// distance to the closest point of the bounding sphere, the error can't look any bigger than there
+				float distance = std::max(glm::length(positions[i] - camera.Position) - radius, 0.0f);
+				int level = useLods ? lodSelector.select(lods, scale, distance, lodStates[i]) : 0;
+				const MeshLod& lod = lods[level];
+
+				glm::vec3 color = showLevels ? LEVEL_COLORS[level % 8] : glm::vec3(0.8f, 0.6f, 0.4f);
+				ourShaders.setVec3("objectColor", color);
+				ourShaders.setModel(models[i]);
+				glDrawElements(GL_TRIANGLES, lod.indexCount, indexType, (void*)(uintptr_t)(lod.firstIndex * indexSize));
+				drawn += lod.indexCount / 3;
+			}
+		}
+
+		drawnSum += (double)drawn;
+		statsFrames++;
+		statsTimer += deltaTime;
+		if (statsTimer >= 1.0f)
+		{
+			double average = drawnSum / statsFrames;
+			std::cout << (long long)average << " triangles/frame (" << 100.0 * average / fullTriangles << "% of full detail), "
+				<< statsFrames / statsTimer << " fps" << std::endl;
+			GlCallStats::printSummary();
+			drawnSum = 0.0;
+			statsFrames = 0;
+			statsTimer = 0.0f;
+		}
+
+		GlCallStats::endFrame();
+
+		// does a double buffer swap to avoid flickering
+		{
+			PROFILE_SCOPE("swap");
+			glfwSwapBuffers(window);
+		}
+
+		// process any keypresses
+		{
+			PROFILE_SCOPE("poll events");
+			glfwPollEvents();
+		}
+	}
+
+	// de allocate stuff (here its the buffers and the cached VAOs)
+	glDeleteBuffers(1, &VBO);
+	glDeleteBuffers(1, &EBO);
+	vertexArrays.release();
+
+	CpuProfiler::writeChromeTrace("cpu_trace.json");
+
+	// close the application 
+	glfwTerminate();
+	return 0;
+}
+
+// create a function that runs eachtime window size changes
+// glfw: whenever the window size changed (by OS or user resize) this callback function executes
+// ---------------------------------------------------------------------------------------------
+void framebuffer_size_callback(GLFWwindow* window, int width, int height)
+{
+	// make sure the viewport matches the new window dimensions; note that width and 
+	// height will be significantly larger than specified on retina displays.
+	glViewport(0, 0, width, height);
+	if (width > 0 && height > 0)
+	{
+		windowWidth = width;
+		windowHeight = height;
+	}
+}
+
+// glfw: key presses that should only happen once per press (not every frame the key is held)
+// ------------------------------------------------------------------------------------------
+void key_callback(GLFWwindow* window, int key, int scancode, int action, int mods)
+{
+	if (action != GLFW_PRESS)
+		return;
+	if (key == GLFW_KEY_L)
+	{
+		useLods = !useLods;
+		std::cout << "LOD selection " << (useLods ? "on" : "off (everything at full detail)") << std::endl;
+	}
+	if (key == GLFW_KEY_C)
+		showLevels = !showLevels;
+	if (key == GLFW_KEY_UP || key == GLFW_KEY_DOWN)
+	{
+		lodSelector.pixelThreshold = glm::clamp(lodSelector.pixelThreshold * (key == GLFW_KEY_UP ? 2.0f : 0.5f), 0.25f, 64.0f);
+		std::cout << "LOD pixel error threshold " << lodSelector.pixelThreshold << std::endl;
+	}
+}
+
+// process all input: query GLFW whether relevant keys are pressed/released this frame and react accordingly
+// ---------------------------------------------------------------------------------------------------------
+void processInput(GLFWwindow* window)
+{
+	if (glfwGetKey(window, GLFW_KEY_ESCAPE) == GLFW_PRESS)
+		glfwSetWindowShouldClose(window, true);
+
+	// just like in unity, all speeds must be relative to deltaTime to account for frame drops!
+	float cameraSpeed = static_cast<float>(2.5 * deltaTime);
+	if (glfwGetKey(window, GLFW_KEY_W) == GLFW_PRESS)
+		camera.Position += cameraSpeed * camera.Front;
+	if (glfwGetKey(window, GLFW_KEY_S) == GLFW_PRESS)
+		camera.Position -= cameraSpeed * camera.Front;
+	if (glfwGetKey(window, GLFW_KEY_A) == GLFW_PRESS)
+		camera.Position -= glm::normalize(glm::cross(camera.Front, camera.Up)) * cameraSpeed;
+	if (glfwGetKey(window, GLFW_KEY_D) == GLFW_PRESS)
+		camera.Position += glm::normalize(glm::cross(camera.Front, camera.Up)) * cameraSpeed;
+}
+
+// glfw: whenever the mouse moves, this callback is called
+void mouse_callback(GLFWwindow* window, double xposIn, double yposIn)
+{
+	float xpos = static_cast<float>(xposIn);
+	float ypos = static_cast<float>(yposIn);
+
+	if (firstMouse)
+	{
+		lastX = xpos;
+		lastY = ypos;
+		firstMouse = false;
+	}
+
+	float xoffset = xpos - lastX;
+	float yoffset = lastY - ypos; // reversed since y-coordinates go from bottom to top
+	lastX = xpos;
+	lastY = ypos;
+
+	float sensitivity = 0.1f; // change this value to your liking
+	xoffset *= sensitivity;
+	yoffset *= sensitivity;
+
+	camera.Yaw += xoffset;
+	camera.Pitch += yoffset;
+
+	// make sure that when pitch is out of bounds, screen doesn't get flipped
+	if (camera.Pitch > 89.0f)
+		camera.Pitch = 89.0f;
+	if (camera.Pitch < -89.0f)
+		camera.Pitch = -89.0f;
+
+	// pitch and yaw influence cameraFront vector, which influence where the target vector 
+	// aka second arg of glfwLookAt function
+	glm::vec3 front;
+	front.x = cos(glm::radians(camera.Yaw)) * cos(glm::radians(camera.Pitch));
+	front.y = sin(glm::radians(camera.Pitch));
+	front.z = sin(glm::radians(camera.Yaw)) * cos(glm::radians(camera.Pitch));
+	camera.Front = glm::normalize(front);
+}
+
+// glfw: whenever the mouse scroll wheel scrolls, this callback is called
+// ----------------------------------------------------------------------
+void scroll_callback(GLFWwindow* window, double xoffset, double yoffset)
+{
+	camera.Zoom -= (float)yoffset;
+	if (camera.Zoom < 1.0f)
+		camera.Zoom = 1.0f;
+	if (camera.Zoom > 45.0f)
+		camera.Zoom = 45.0f;
+}
@@ -0,0 +1,404 @@
+// make sure that glad comes before glfw
+
+#include <glad/glad.h>
+#include <glfw3.h>
+#include <iostream>
+#include "cpu_profiler.h"
+#include "gl_call_stats.h"
+#include "perf_overlay.h"
+#include <string>
+#include <vector>
+#include "shader_s.h"
+#include "shader_pipeline.h"
+#include "vertex_layout.h"
+#include "mesh_loader.h"
+#include "mesh_optimizer.h"
+#include "meshlets.h"
+#include "meshlet_culling.h"
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+#include "camera.h"
+
+
+void framebuffer_size_callback(GLFWwindow* window, int width, int height);
+void processInput(GLFWwindow* window);
+void mouse_callback(GLFWwindow* window, double xpos, double ypos);
+void scroll_callback(GLFWwindow* window, double xoffset, double yoffset);
+void key_callback(GLFWwindow* window, int key, int scancode, int action, int mods);
+void createSceneTargets(int width, int height);
+
+// timing
+float deltaTime = 0.0f;	// time between current frame and last frame
+float lastFrame = 0.0f;
+
+int windowWidth = 800;
+int windowHeight = 600;
+
+// camera, low down in the field so the near objects hide a lot of the far ones
+Camera camera(glm::vec3(0.0f, 1.0f, 4.0f));
+float lastX = 800 / 2.0f;
+float lastY = 600 / 2.0f;
+bool firstMouse = true;
+
+// F/B/O switch frustum, backface (normal cone) and occlusion culling, M colors every meshlet differently
+MeshletCuller* culler = nullptr;
+bool showMeshlets = false;
+
+// a big square field of copies of the model
+const int GRID_SIZE = 64;
+const float GRID_SPACING = 2.0f;
+
+// the scene is drawn into our own framebuffer so its depth can be read back into the depth pyramid
+unsigned int sceneFBO = 0, sceneColor = 0, sceneDepth = 0;
+int sceneWidth = 0, sceneHeight = 0;
+
+// pass an .obj/.glb, the torus otherwise
+int main(int argc, char** argv)
+{
+	// -------------------------------------------- Start Initialization ------------------------------- //
+	glfwInit();
+	// glMultiDrawElementsIndirectCount and gl_BaseInstance need OpenGL 4.6
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 6);
+
+	// Core mode over immediate mode
+	glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+
+	GLFWwindow* window = glfwCreateWindow(windowWidth, windowHeight, "LearnOpenGL", NULL, NULL);
+	if (window == NULL)
+	{
+		std::cout << "Failed to create GLFW window" << std::endl;
+		glfwTerminate();
+		return -1;
+	}
+	glfwMakeContextCurrent(window);
+
+	// intitialize GLAD
+	if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
+	{
+		std::cout << "Failed to initialize GLAD" << std::endl;
+		return -1;
+	}
+
+	GlCallStats::install();
+
+	// set viewport (lower left, lower right, width, height)
+	glViewport(0, 0, windowWidth, windowHeight);
+
+	// register a callback that will reset the viewport each time window size changes
+	glfwSetFramebufferSizeCallback(window, framebuffer_size_callback);
+	glfwSetCursorPosCallback(window, mouse_callback);
+	glfwSetScrollCallback(window, scroll_callback);
+	glfwSetKeyCallback(window, key_callback);
+	// -------------------------------------------- End Initialization ------------------------------- //
+
+	// -------------------------------------------- DATA ------------------------------- //
+	// the mesh first, so a missing file quits before any GL objects need cleaning up
+	std::string path = argc > 1 ? argv[1] : "./models/torus.obj";
+	MeshData mesh;
+	if (!MeshLoader::load(path, mesh))
+	{
+		glfwTerminate();
+		return -1;
+	}
+
+	// load shaders, the two compute ones are single stages (shader_pipeline.h)
+	Shader ourShaders("./Shaders/Ch20MeshletCulling/vs.glsl", "./Shaders/Ch20MeshletCulling/fs.glsl");
+	ShaderStage cullShader(GL_COMPUTE_SHADER, "./Shaders/Ch20MeshletCulling/cull_cs.glsl");
+	ShaderStage depthReduceShader(GL_COMPUTE_SHADER, "./Shaders/Ch20MeshletCulling/depth_reduce_cs.glsl");
+
+	// vertex cache order first, so each run of triangles the meshlet builder walks over shares its vertices
+	MeshOptimizer::optimize(mesh, path, false);
+	MeshletMesh meshlets = MeshletMesh::build(mesh, mesh.indices);
+	meshlets.printReport(path);
+	unsigned int VBO = createStaticBuffer(mesh.vertices.data(), mesh.vertices.size() * sizeof(VertexPNT));
+
+	// scale the model to about one unit like in Ch18, and fill the field with randomly turned copies
+	glm::vec3 extent = mesh.boundsMax - mesh.boundsMin;
+	float largest = std::max(extent.x, std::max(extent.y, extent.z));
+	float scale = largest > 0.0f ? 1.5f / largest : 1.0f;
+	std::vector<glm::mat4> models;
+	for (int z = 0; z < GRID_SIZE; z++)
+	{
+		for (int x = 0; x < GRID_SIZE; x++)
+		{
+			glm::vec3 position((x - GRID_SIZE / 2) * GRID_SPACING, 0.0f, -z * GRID_SPACING);
+			glm::mat4 model = glm::mat4(1.0f);
+			model = glm::translate(model, position);
+			model = glm::rotate(model, (float)(x * 7 + z * 13), glm::vec3(0.3f, 1.0f, 0.1f));
+			model = glm::scale(model, glm::vec3(scale));
+			model = glm::translate(model, -0.5f * (mesh.boundsMin + mesh.boundsMax));
+			models.push_back(model);
+		}
+	}
+	createSceneTargets(windowWidth, windowHeight);
+	MeshletCuller meshletCuller(meshlets, models, sceneWidth, sceneHeight);
+	culler = &meshletCuller;
+
+
+
+	// --------------------------------------------  ------------------------------- //
+	VertexArrayCache vertexArrays;
+
+	long long totalMeshlets = (long long)meshletCuller.meshlets() * meshletCuller.objects();
+	long long totalTriangles = (long long)mesh.triangleCount() * meshletCuller.objects();
+	std::cout << meshletCuller.objects() << " objects, " << totalMeshlets << " meshlets, " << totalTriangles << " triangles" << std::endl;
+	int statsFrames = 0;
+	float statsTimer = 0.0f;
+	// the same numbers on screen, the culling ones update with the once a second readback
+	PerfOverlay overlay;
+
+	glEnable(GL_DEPTH_TEST);
+	// simple render loop (its just a while loop!)
+	while (!glfwWindowShouldClose(window))
+	{
+		PROFILE_SCOPE("frame");
+		// per-frame time logic
+		// --------------------
+		float currentFrame = static_cast<float>(glfwGetTime());
+		deltaTime = currentFrame - lastFrame;
+		lastFrame = currentFrame;
+
+		// input
+		// -----
+		{
+			PROFILE_SCOPE("input");
+			processInput(window);
+		}
+
+		if (windowWidth != sceneWidth || windowHeight != sceneHeight)
+		{
+			createSceneTargets(windowWidth, windowHeight);
+			meshletCuller.resize(sceneWidth, sceneHeight);
+		}
+
+		glm::mat4 view = camera.GetViewMatrix();
+		glm::mat4 projection = glm::perspective(glm::radians(camera.Zoom), (float)sceneWidth / (float)sceneHeight, 0.1f, 500.0f);
+
+		// 1. decide on the GPU what gets drawn, against last frame's depth
+		{
+			PROFILE_SCOPE("cull");
+			meshletCuller.cull(cullShader, view, projection, camera.Position);
+		}
+
+		// 2. draw it all with one call
+		{
+			PROFILE_SCOPE("draw");
+			glBindFramebuffer(GL_FRAMEBUFFER, sceneFBO);
+			glViewport(0, 0, sceneWidth, sceneHeight);
+			// nicer background color than black
+			glClearColor(0.1f, 0.1f, 0.1f, 0.2f);
+			glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+			ourShaders.use();
+			ourShaders.setVec3("lightColor", 1.0f, 1.0f, 1.0f);
+			ourShaders.setVec3("lightPos", camera.Position + glm::vec3(0.0f, 10.0f, 0.0f));
+			ourShaders.setVec3("viewPos", camera.Position);
+			ourShaders.setVec3("objectColor", 0.8f, 0.6f, 0.4f);
+			ourShaders.setBool("showMeshlets", showMeshlets);
+			ourShaders.setInt("meshletCount", (int)meshletCuller.meshlets());
+			ourShaders.setViewProjection(view, projection);
+			vertexArrays.bind<VertexPNT>(VBO, meshletCuller.indexBuffer);
+			meshletCuller.draw();
+		}
+
+		// 3. this frame's depth becomes next frame's occluders
+		{
+			PROFILE_SCOPE("depth pyramid");
+			meshletCuller.buildDepthPyramid(depthReduceShader, sceneDepth, view, projection);
+		}
+
+		// 4. show it
+		glBlitNamedFramebuffer(sceneFBO, 0, 0, 0, sceneWidth, sceneHeight, 0, 0, windowWidth, windowHeight, GL_COLOR_BUFFER_BIT, GL_NEAREST);
+		glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+		statsFrames++;
+		statsTimer += deltaTime;
+		if (statsTimer >= 1.0f)
+		{
+			// reading the counters back waits for the GPU, so only once a second
+			MeshletCullStats stats = meshletCuller.stats();
+			std::cout << stats.meshletsDrawn << "/" << totalMeshlets << " meshlets, " << stats.trianglesDrawn << " triangles ("
+				<< 100.0 * stats.trianglesDrawn / totalTriangles << "%) drawn | culled: " << stats.frustumCulled << " frustum, "
+				<< stats.coneCulled << " backface, " << stats.occlusionCulled << " occlusion | " << statsFrames / statsTimer << " fps" << std::endl;
+			GlCallStats::printSummary();
+			overlay.setValue("meshlets drawn", (double)stats.meshletsDrawn);
+			overlay.setValue("triangles drawn", (double)stats.trianglesDrawn);
+			overlay.setValue("frustum culled", (double)stats.frustumCulled);
+			overlay.setValue("backface culled", (double)stats.coneCulled);
+			overlay.setValue("occlusion culled", (double)stats.occlusionCulled);
+			statsFrames = 0;
+			statsTimer = 0.0f;
+		}
+
+		GlCallStats::endFrame();
+
+		// after endFrame(), and its calls dropped, so the overlay isn't in the numbers it shows
+		overlay.draw(deltaTime, windowWidth, windowHeight);
+		GlCallStats::discardFrame();
+
+		// does a double buffer swap to avoid flickering
+		{
+			PROFILE_SCOPE("swap");
+			glfwSwapBuffers(window);
+		}
+
+		// process any keypresses
+		{
+			PROFILE_SCOPE("poll events");
+			glfwPollEvents();
+		}
+	}
+
+	// de allocate stuff
+	culler = nullptr;
+	meshletCuller.release();
+	cullShader.release();
+	depthReduceShader.release();
+	overlay.release();
+	glDeleteBuffers(1, &VBO);
+	vertexArrays.release();
+	unsigned int textures[2] = { sceneColor, sceneDepth };
+	glDeleteTextures(2, textures);
+	glDeleteFramebuffers(1, &sceneFBO);
+
+	CpuProfiler::writeChromeTrace("cpu_trace.json");
+
+	// close the application 
+	glfwTerminate();
+	return 0;
+}
+
+// (re)creates the framebuffer the scene gets drawn into, depth as a float texture the pyramid can read
+// ---------------------------------------------------------------------------------------------
+void createSceneTargets(int width, int height)
+{
+	if (sceneFBO == 0)
+		glCreateFramebuffers(1, &sceneFBO);
+	unsigned int textures[2] = { sceneColor, sceneDepth };
+	glDeleteTextures(2, textures);
+	sceneWidth = width;
+	sceneHeight = height;
+
+	glCreateTextures(GL_TEXTURE_2D, 1, &sceneColor);
+	glTextureStorage2D(sceneColor, 1, GL_RGBA8, width, height);
+	glCreateTextures(GL_TEXTURE_2D, 1, &sceneDepth);
+	glTextureStorage2D(sceneDepth, 1, GL_DEPTH_COMPONENT32F, width, height);
+	glTextureParameteri(sceneDepth, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+	glTextureParameteri(sceneDepth, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+	glNamedFramebufferTexture(sceneFBO, GL_COLOR_ATTACHMENT0, sceneColor, 0);
+	glNamedFramebufferTexture(sceneFBO, GL_DEPTH_ATTACHMENT, sceneDepth, 0);
+	if (glCheckNamedFramebufferStatus(sceneFBO, GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+		std::cout << "ERROR::FRAMEBUFFER::NOT_COMPLETE" << std::endl;
+}
+
+// create a function that runs eachtime window size changes
+// glfw: whenever the window size changed (by OS or user resize) this callback function executes
+// ---------------------------------------------------------------------------------------------
+void framebuffer_size_callback(GLFWwindow* window, int width, int height)
+{
+	// make sure the viewport matches the new window dimensions; note that width and 
+	// height will be significantly larger than specified on retina displays.
+	glViewport(0, 0, width, height);
+	if (width > 0 && height > 0)
+	{
+		windowWidth = width;
+		windowHeight = height;
+	}
+}
+
+// glfw: key presses that should only happen once per press (not every frame the key is held)
+// ------------------------------------------------------------------------------------------
+void key_callback(GLFWwindow* window, int key, int scancode, int action, int mods)
+{
+	if (action != GLFW_PRESS || culler == nullptr)
+		return;
+	if (key == GLFW_KEY_F)
+	{
+		culler->frustumCulling = !culler->frustumCulling;
+		std::cout << "frustum culling " << (culler->frustumCulling ? "on" : "off") << std::endl;
+	}
+	if (key == GLFW_KEY_B)
+	{
+		culler->coneCulling = !culler->coneCulling;
+		std::cout << "backface (normal cone) culling " << (culler->coneCulling ? "on" : "off") << std::endl;
+	}
+	if (key == GLFW_KEY_O)
+	{
+		culler->occlusionCulling = !culler->occlusionCulling;
+		std::cout << "occlusion culling " << (culler->occlusionCulling ? "on" : "off") << std::endl;
+	}
+	if (key == GLFW_KEY_M)
+		showMeshlets = !showMeshlets;
+}
+
+// process all input: query GLFW whether relevant keys are pressed/released this frame and react accordingly
+// ---------------------------------------------------------------------------------------------------------
+void processInput(GLFWwindow* window)
+{
+	if (glfwGetKey(window, GLFW_KEY_ESCAPE) == GLFW_PRESS)
+		glfwSetWindowShouldClose(window, true);
+
+	// just like in unity, all speeds must be relative to deltaTime to account for frame drops!
+	float cameraSpeed = static_cast<float>(2.5 * deltaTime);
+	if (glfwGetKey(window, GLFW_KEY_W) == GLFW_PRESS)
+		camera.Position += cameraSpeed * camera.Front;
+	if (glfwGetKey(window, GLFW_KEY_S) == GLFW_PRESS)
+		camera.Position -= cameraSpeed * camera.Front;
+	if (glfwGetKey(window, GLFW_KEY_A) == GLFW_PRESS)
+		camera.Position -= glm::normalize(glm::cross(camera.Front, camera.Up)) * cameraSpeed;
+	if (glfwGetKey(window, GLFW_KEY_D) == GLFW_PRESS)
+		camera.Position += glm::normalize(glm::cross(camera.Front, camera.Up)) * cameraSpeed;
+}
+
+// glfw: whenever the mouse moves, this callback is called
+void mouse_callback(GLFWwindow* window, double xposIn, double yposIn)
+{
+	float xpos = static_cast<float>(xposIn);
+	float ypos = static_cast<float>(yposIn);
+
+	if (firstMouse)
+	{
+		lastX = xpos;
+		lastY = ypos;
+		firstMouse = false;
+	}
+
+	float xoffset = xpos - lastX;
+	float yoffset = lastY - ypos; // reversed since y-coordinates go from bottom to top
+	lastX = xpos;
+	lastY = ypos;
+
+	float sensitivity = 0.1f; // change this value to your liking
+	xoffset *= sensitivity;
+	yoffset *= sensitivity;
+
+	camera.Yaw += xoffset;
+	camera.Pitch += yoffset;
+
+	// make sure that when pitch is out of bounds, screen doesn't get flipped
+	if (camera.Pitch > 89.0f)
+		camera.Pitch = 89.0f;
+	if (camera.Pitch < -89.0f)
+		camera.Pitch = -89.0f;
+
+	// pitch and yaw influence cameraFront vector, which influence where the target vector 
+	// aka second arg of glfwLookAt function
+	glm::vec3 front;
+	front.x = cos(glm::radians(camera.Yaw)) * cos(glm::radians(camera.Pitch));
+	front.y = sin(glm::radians(camera.Pitch));
+	front.z = sin(glm::radians(camera.Yaw)) * cos(glm::radians(camera.Pitch));
+	camera.Front = glm::normalize(front);
+}
+
+// glfw: whenever the mouse scroll wheel scrolls, this callback is called
+// ----------------------------------------------------------------------
+void scroll_callback(GLFWwindow* window, double xoffset, double yoffset)
+{
+	camera.Zoom -= (float)yoffset;
+	if (camera.Zoom < 1.0f)
+		camera.Zoom = 1.0f;
+	if (camera.Zoom > 45.0f)
+		camera.Zoom = 45.0f;
+}
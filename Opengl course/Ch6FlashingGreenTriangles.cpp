@@ -3,6 +3,7 @@
 #include <glad/glad.h>
 #include <glfw3.h>
 #include <iostream>
+#include "cpu_profiler.h"
 
 void framebuffer_size_callback(GLFWwindow* window, int width, int height);
 
@@ -169,34 +170,49 @@ int main()
 	// simple render loop (its just a while loop!)
 	while (!glfwWindowShouldClose(window))
 	{
+		PROFILE_SCOPE("frame");
 
 		glUseProgram(shaderProgram);
 
-		// set the frag shader color
-		float time = glfwGetTime();
-		float green = sin(time) / 2.0f + 0.5f;
+		{
+			PROFILE_SCOPE("uniforms");
+			// set the frag shader color
+			float time = glfwGetTime();
+			float green = sin(time) / 2.0f + 0.5f;
 
-		// get a reference to the uniform
-		int fragColorLocation = glGetUniformLocation(shaderProgram, "ourColor");
-		// set its value
-		glUniform4f(fragColorLocation, 0.0f, green, 0.0f, 1.0f);
+			// get a reference to the uniform
+			int fragColorLocation = glGetUniformLocation(shaderProgram, "ourColor");
+			// set its value
+			glUniform4f(fragColorLocation, 0.0f, green, 0.0f, 1.0f);
+		}
 
 
-		// draws two triangles
-		glBindVertexArray(VAO); // seeing as we only have a single VAO there's no need to bind it every time, but we'll do so to keep things a bit more organized
-		glDrawArrays(GL_TRIANGLES, 0, 6); // draw from vertex 0, and draw 3 vertices
+		{
+			PROFILE_SCOPE("draw");
+			// draws two triangles
+			glBindVertexArray(VAO); // seeing as we only have a single VAO there's no need to bind it every time, but we'll do so to keep things a bit more organized
+			glDrawArrays(GL_TRIANGLES, 0, 6); // draw from vertex 0, and draw 3 vertices
+		}
 
 		// does a double buffer swap to avoid flickering
-		glfwSwapBuffers(window);
+		{
+			PROFILE_SCOPE("swap");
+			glfwSwapBuffers(window);
+		}
 
 		// process any keypresses
-		glfwPollEvents();
+		{
+			PROFILE_SCOPE("poll events");
+			glfwPollEvents();
+		}
 	}
 
 	// de allocate stuff (here its the VBO and VAOs)
 	glDeleteVertexArrays(1, &VAO);
 	glDeleteBuffers(1, &VBO);
 
+	CpuProfiler::writeChromeTrace("cpu_trace.json");
+
 	// close the application 
 	glfwTerminate();
 	return 0;
@@ -3,6 +3,7 @@
 #include <glad/glad.h>
 #include <glfw3.h>
 #include <iostream>
+#include "cpu_profiler.h"
 #include "shader_s.h"
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
@@ -199,31 +200,44 @@ int main()
 	// simple render loop (its just a while loop!)
 	while (!glfwWindowShouldClose(window))
 	{
+		PROFILE_SCOPE("frame");
 
-		// define transformation matrix data
-		glm::mat4 mat = glm::mat4(1.0f); // identity
-		mat = glm::translate(mat, glm::vec3(0.5f, 0.5f, 0.0f)); // move center to top right corner
-		mat = glm::rotate(mat, (float)glfwGetTime(), glm::vec3(0.0f, 0.0f, 1.0f));
+		{
+			PROFILE_SCOPE("uniforms");
+			// define transformation matrix data
+			glm::mat4 mat = glm::mat4(1.0f); // identity
+			mat = glm::translate(mat, glm::vec3(0.5f, 0.5f, 0.0f)); // move center to top right corner
+			mat = glm::rotate(mat, (float)glfwGetTime(), glm::vec3(0.0f, 0.0f, 1.0f));
 
-		// pass in the uniform (for transformation matrices, this has to happen every frame)
-		glUniformMatrix4fv(glGetUniformLocation(ourShaders.ID, "transformation_matrix"), 1, GL_FALSE, glm::value_ptr(mat));
+			// pass in the uniform (for transformation matrices, this has to happen every frame)
+			glUniformMatrix4fv(glGetUniformLocation(ourShaders.ID, "transformation_matrix"), 1, GL_FALSE, glm::value_ptr(mat));
+		}
 
-		glActiveTexture(GL_TEXTURE0);
-		glBindTexture(GL_TEXTURE_2D, texture1);
+		{
+			PROFILE_SCOPE("draw");
+			glActiveTexture(GL_TEXTURE0);
+			glBindTexture(GL_TEXTURE_2D, texture1);
 
-		glActiveTexture(GL_TEXTURE1);
-		glBindTexture(GL_TEXTURE_2D, texture2);
+			glActiveTexture(GL_TEXTURE1);
+			glBindTexture(GL_TEXTURE_2D, texture2);
 
-		ourShaders.use();
-		// draws two triangles
-		glBindVertexArray(VAO); // seeing as we only have a single VAO there's no need to bind it every time, but we'll do so to keep things a bit more organized
-		glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
+			ourShaders.use();
+			// draws two triangles
+			glBindVertexArray(VAO); // seeing as we only have a single VAO there's no need to bind it every time, but we'll do so to keep things a bit more organized
+			glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
+		}
 
 		// does a double buffer swap to avoid flickering
-		glfwSwapBuffers(window);
+		{
+			PROFILE_SCOPE("swap");
+			glfwSwapBuffers(window);
+		}
 
 		// process any keypresses
-		glfwPollEvents();
+		{
+			PROFILE_SCOPE("poll events");
+			glfwPollEvents();
+		}
 	}
 
 	// de allocate stuff (here its the VBO and VAOs)
@@ -231,6 +245,8 @@ int main()
 	glDeleteBuffers(1, &VBO);
 	glDeleteBuffers(1, &EBO);
 
+	CpuProfiler::writeChromeTrace("cpu_trace.json");
+
 	// close the application 
 	glfwTerminate();
 	return 0;
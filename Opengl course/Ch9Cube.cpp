@@ -3,7 +3,9 @@
 #include <glad/glad.h>
 #include <glfw3.h>
 #include <iostream>
+#include "cpu_profiler.h"
 #include "shader_s.h"
+#include "vertex_compression.h"
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
@@ -207,8 +209,12 @@ int main()
 
 	// GL Populate methods (these functions actually move the data into the OpenGL objects)
 	// --------------------------------- //
+	// squeeze the floats down to half floats first (20 -> 12 bytes a vertex), then
 	// copy the vertex data into this buffer's memory
-	glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
+	CompressedVertices cube = CompressedVertices::compress(vertices, sizeof(vertices) / (5 * sizeof(float)),
+		{ { 0, 3, VertexEncoding::Half }, { 1, 2, VertexEncoding::Half } });
+	cube.printReport("Ch9Cube");
+	glBufferData(GL_ARRAY_BUFFER, cube.data.size(), cube.data.data(), GL_STATIC_DRAW);
 
 	// --------------------------------- //
 
@@ -218,15 +224,8 @@ int main()
 
 	// TEXTURE ATTRIBUTES aka "telling how the input data to vertex shader is packed"
 	// ----------------------------------------------
-	// x,y,z
-	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 5 * sizeof(float),
-		(void*)0);
-	glEnableVertexAttribArray(0);
-
-	// s,t (texture coordinates)
-	glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 5 * sizeof(float),
-		(void*)(3 * sizeof(float)));
-	glEnableVertexAttribArray(1);
+	// x,y,z then s,t (texture coordinates), both as GL_HALF_FLOAT now
+	cube.setAttributes();
 	// ----------------------------------------------
 
 
@@ -238,9 +237,8 @@ int main()
 	glUniform1i(glGetUniformLocation(ourShaders.ID, "texture1"), 0);
 	glUniform1i(glGetUniformLocation(ourShaders.ID, "texture2"), 1);
 
-	glUniformMatrix4fv(glGetUniformLocation(ourShaders.ID, "model"), 1, GL_FALSE, glm::value_ptr(model));
-	glUniformMatrix4fv(glGetUniformLocation(ourShaders.ID, "view"), 1, GL_FALSE, glm::value_ptr(view));
-	glUniformMatrix4fv(glGetUniformLocation(ourShaders.ID, "projection"), 1, GL_FALSE, glm::value_ptr(projection));
+	ourShaders.setModel(model);
+	ourShaders.setViewProjection(view, projection);
 
 	// ------------------------------------------------ END SET UNIFORMS ------------------------------- //
 
@@ -248,44 +246,56 @@ int main()
 	// simple render loop (its just a while loop!)
 	while (!glfwWindowShouldClose(window))
 	{
+		PROFILE_SCOPE("frame");
 		// nicer background color than black
 		glClearColor(0.2f, 0.3f, 0.3f, 1.0f);
 		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
 
-		glActiveTexture(GL_TEXTURE0);
-		glBindTexture(GL_TEXTURE_2D, texture1);
+		{
+			PROFILE_SCOPE("draw");
+			glActiveTexture(GL_TEXTURE0);
+			glBindTexture(GL_TEXTURE_2D, texture1);
 
-		glActiveTexture(GL_TEXTURE1);
-		glBindTexture(GL_TEXTURE_2D, texture2);
+			glActiveTexture(GL_TEXTURE1);
+			glBindTexture(GL_TEXTURE_2D, texture2);
 
-		// define transformation matrix data
-		// glm::mat4 mat = glm::mat4(1.0f); // identity
-		// mat = glm::translate(mat, glm::vec3(0.5f, 0.5f, 0.0f)); // move center to top right corner
-		// mat = glm::rotate(mat, (float)glfwGetTime(), glm::vec3(0.0f, 0.0f, 1.0f));
+			// define transformation matrix data
+			// glm::mat4 mat = glm::mat4(1.0f); // identity
+			// mat = glm::translate(mat, glm::vec3(0.5f, 0.5f, 0.0f)); // move center to top right corner
+			// mat = glm::rotate(mat, (float)glfwGetTime(), glm::vec3(0.0f, 0.0f, 1.0f));
 
-		// pass in the uniform (for transformation matrices, this has to happen every frame)
-		// glUniformMatrix4fv(glGetUniformLocation(ourShaders.ID, "transformation_matrix"), 1, GL_FALSE, glm::value_ptr(mat));
+			// pass in the uniform (for transformation matrices, this has to happen every frame)
+			// glUniformMatrix4fv(glGetUniformLocation(ourShaders.ID, "transformation_matrix"), 1, GL_FALSE, glm::value_ptr(mat));
 
-		ourShaders.use();
-		// draws two triangles
-		glBindVertexArray(VAO);
+			ourShaders.use();
+			// draws two triangles
+			glBindVertexArray(VAO);
 
 
-		glDrawArrays(GL_TRIANGLES, 0, 36);
+			glDrawArrays(GL_TRIANGLES, 0, 36);
+		}
 
 
 		// does a double buffer swap to avoid flickering
-		glfwSwapBuffers(window);
+		{
+			PROFILE_SCOPE("swap");
+			glfwSwapBuffers(window);
+		}
 
 		// process any keypresses
-		glfwPollEvents();
+		{
+			PROFILE_SCOPE("poll events");
+			glfwPollEvents();
+		}
 	}
 
 	// de allocate stuff (here its the VBO and VAOs)
 	glDeleteVertexArrays(1, &VAO);
 	glDeleteBuffers(1, &VBO);
 
+	CpuProfiler::writeChromeTrace("cpu_trace.json");
+
 	// close the application 
 	glfwTerminate();
 	return 0;
@@ -0,0 +1,79 @@
+// tool: turns an .obj/.glb into our binary .mesh format (mesh_file.h) so chapters can skip the text parsing,
+// with the triangles and vertices reordered for the GPU on the way (mesh_optimizer.h)
+// no window or GL context needed. usage:
+//   MeshConvert input.obj output.mesh [-quantize] [-lods]
+// -quantize stores 16 byte vertices (half floats + packed normal) instead of 32 byte float ones
+// -lods adds a chain of simplified levels (mesh_simplifier.h) to the lod table
+
+#include <iostream>
+#include <string>
+#include <chrono>
+#include <cstring>
+#include "mesh_loader.h"
+#include "mesh_file.h"
+#include "mesh_optimizer.h"
+#include "mesh_simplifier.h"
+
+double millisecondsSince(std::chrono::high_resolution_clock::time_point start)
+{
+	return std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+}
+
+int main(int argc, char** argv)
+{
+	if (argc < 3)
+	{
+		std::cout << "usage: MeshConvert input.obj|input.glb output.mesh [-quantize] [-lods]" << std::endl;
+		return 1;
+	}
+	std::string input = argv[1];
+	std::string output = argv[2];
+	bool quantize = false, lods = false;
+	for (int i = 3; i < argc; i++)
+	{
+		if (std::strcmp(argv[i], "-quantize") == 0)
+			quantize = true;
+		else if (std::strcmp(argv[i], "-lods") == 0)
+			lods = true;
+		else
+			std::cout << "unknown option " << argv[i] << std::endl;
+	}
+
+	auto start = std::chrono::high_resolution_clock::now();
+	MeshData mesh;
+	if (!MeshLoader::load(input, mesh))
+		return 1;
+	double parseMs = millisecondsSince(start);
+	std::cout << input << ": " << mesh.vertices.size() << " vertices, " << mesh.triangleCount() << " triangles, parsed in " << parseMs << " ms" << std::endl;
+
+	// baked once here so nothing has to reorder at load time
+	start = std::chrono::high_resolution_clock::now();
+	MeshOptimizer::optimize(mesh, input);
+	std::cout << "optimized in " << millisecondsSince(start) << " ms" << std::endl;
+
+	if (lods)
+	{
+		start = std::chrono::high_resolution_clock::now();
+		MeshSimplifier::buildLods(mesh, 8, 0.5f, input);
+		// the new levels come after the full mesh in the index buffer, put the vertices in first use order again
+		MeshOptimizer::optimizeVertexFetch(mesh);
+		std::cout << "simplified in " << millisecondsSince(start) << " ms" << std::endl;
+	}
+
+	if (quantize)
+		mesh.quantize().printReport(input);
+
+	if (!MeshFile::write(output, mesh, quantize))
+		return 1;
+
+	// open it again to check it and show what loading costs now
+	start = std::chrono::high_resolution_clock::now();
+	MeshFile file;
+	if (!file.open(output))
+		return 1;
+	double openMs = millisecondsSince(start);
+	const MeshFileHeader& info = file.info();
+	std::cout << output << ": " << info.vertexBytes + info.indexBytes << " bytes of vertex/index data (" << info.vertexStride << " byte vertices, "
+		<< info.indexSize << " byte indices), opened in " << openMs << " ms" << std::endl;
+	return 0;
+}
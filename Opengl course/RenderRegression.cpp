@@ -0,0 +1,412 @@
+// tool: golden image regression test for the chapters. runs the real chapters (their GL code and shaders) one
+// after the other in a hidden window, with glfwGetTime() stuck at fixed times, reads the last frame back with
+// glReadPixels and compares it against the reference in images/golden with a perceptual tolerance (image_compare.h).
+// -software does the same for the CPU copies of the scenes in software_scenes.h (no window or GPU needed),
+// against images/golden/software. usage:
+//   RenderRegression [chapter] [-software] [-update] [-threshold dE] [-differing fraction] [-out dir]
+// -update writes the current images as the new references, do that after a change that's meant to look different
+// (and with the driver the references came from, the GL ones are from Mesa's llvmpipe so any machine can make them)
+// -threshold is the delta E a pixel may be off by (2.3, just noticeable), -differing the fraction of pixels
+// allowed over it (0.001, room for an edge pixel flipping between compilers)
+// failures leave the actual image and a diff (differing pixels in red) in -out, regression_output by default.
+// a chapter whose context version the driver doesn't have is skipped, not failed.
+// exits with the number of failures, so it can gate a build
+//
+// every chapter is #included below in a namespace of its own, with its main renamed and the few GLFW calls
+// that decide what ends up on screen swapped for the ones in GoldenRun. so build this file instead of a chapter,
+// like the other tools, and leave Ch10BatchOrbit out (its window is the batch renderer's, not the screen).
+
+// everything the chapters include, here first so their own #includes (inside the namespaces) find it already done
+#include <glad/glad.h>
+#include <glfw3.h>
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <random>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstring>
+#include <cstdlib>
+#include <cstdio>
+#include <filesystem>
+// the overlay shows timings, which no two runs agree on
+#define PERF_OVERLAY_VISIBLE false
+#include "camera.h"
+#include "shader_s.h"
+#include "cpu_profiler.h"
+#include "gl_call_stats.h"
+#include "gpu_profiler.h"
+#include "perf_overlay.h"
+#include "frame_capture.h"
+#include "shader_variants.h"
+#include "shader_watcher.h"
+#include "shader_pipeline.h"
+#include "vertex_compression.h"
+#include "vertex_layout.h"
+#include "transform_hierarchy.h"
+#include "clustered_lighting.h"
+#include "gbuffer.h"
+#include "shadows.h"
+#include "mesh_file.h"
+#include "mesh_loader.h"
+#include "mesh_optimizer.h"
+#include "mesh_simplifier.h"
+#include "meshlets.h"
+#include "meshlet_culling.h"
+#include "lod_selector.h"
+// stb_image.h comes in through software_rasterizer.h, its implementation goes in this file (only once, the
+// chapters asking for it again get nothing)
+#define STB_IMAGE_IMPLEMENTATION
+#include "software_rasterizer.h"
+#include "software_scenes.h"
+#include "image_write.h"
+#include "image_compare.h"
+#undef STB_IMAGE_IMPLEMENTATION
+
+// what the chapters get instead of glfwGetTime(), glfwCreateWindow(), glfwWindowShouldClose() and glfwSwapBuffers()
+namespace GoldenRun
+{
+	// frames a chapter draws before it's read back, a few so anything that catches up over frames has (shadow
+	// caches, readbacks a frame late)
+	const int FRAMES = 3;
+
+	double time = 0.0;
+	int frames = 0;
+	bool noWindow = false;
+	int width = 0, height = 0;
+	std::vector<unsigned char> pixels;
+
+	// ------------------------------------------------------------------------
+	void start(double atTime)
+	{
+		time = atTime;
+		frames = 0;
+		noWindow = false;
+		width = height = 0;
+		pixels.clear();
+		// the chapters that flip their textures set it themselves, the others expect stb_image's default
+		stbi_set_flip_vertically_on_load(false);
+	}
+	// ------------------------------------------------------------------------
+	double getTime()
+	{
+		return time;
+	}
+	// ------------------------------------------------------------------------
+	GLFWwindow* createWindow(int width, int height, const char* title, GLFWmonitor* monitor, GLFWwindow* share)
+	{
+		glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+		GLFWwindow* window = glfwCreateWindow(width, height, title, monitor, share);
+		noWindow = window == NULL;
+		return window;
+	}
+	// called at the top of every frame. what a chapter doesn't draw over is whatever the driver left in the back
+	// buffer (the ones before Ch9 never clear), so make that black like a new window, keeping the chapter's state
+	// ------------------------------------------------------------------------
+	int windowShouldClose(GLFWwindow* window)
+	{
+		if (frames < FRAMES)
+		{
+			GLint framebuffer;
+			GLfloat clearColor[4];
+			glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &framebuffer);
+			glGetFloatv(GL_COLOR_CLEAR_VALUE, clearColor);
+			glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
+			glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+			glClear(GL_COLOR_BUFFER_BIT);
+			glClearColor(clearColor[0], clearColor[1], clearColor[2], clearColor[3]);
+			glBindFramebuffer(GL_DRAW_FRAMEBUFFER, framebuffer);
+		}
+		return frames >= FRAMES || glfwWindowShouldClose(window);
+	}
+	// the last frame is read back before it's swapped, bottom row first like GL has it
+	// ------------------------------------------------------------------------
+	void swapBuffers(GLFWwindow* window)
+	{
+		if (++frames == FRAMES)
+		{
+			glfwGetFramebufferSize(window, &width, &height);
+			std::vector<unsigned char> flipped((size_t)width * height * 3);
+			glBindFramebuffer(GL_READ_FRAMEBUFFER, 0);
+			glReadBuffer(GL_BACK);
+			glPixelStorei(GL_PACK_ALIGNMENT, 1);
+			glReadPixels(0, 0, width, height, GL_RGB, GL_UNSIGNED_BYTE, flipped.data());
+			pixels.resize(flipped.size());
+			size_t row = (size_t)width * 3;
+			for (int y = 0; y < height; y++)
+				std::memcpy(&pixels[y * row], &flipped[(height - 1 - y) * row], row);
+		}
+		glfwSwapBuffers(window);
+	}
+}
+
+#define main run
+#define glfwGetTime GoldenRun::getTime
+#define glfwCreateWindow GoldenRun::createWindow
+#define glfwWindowShouldClose GoldenRun::windowShouldClose
+#define glfwSwapBuffers GoldenRun::swapBuffers
+namespace ch5TwoOrangeTriangles {
+#include "Ch5TwoOrangeTriangles.cpp"
+}
+namespace ch6FlashingGreenTriangles {
+#include "Ch6FlashingGreenTriangles.cpp"
+}
+namespace ch7SimpleTexture {
+#include "Ch7SimpleTexture.cpp"
+}
+namespace ch7TwoTexturesMixed {
+#include "Ch7TwoTexturesMixed.cpp"
+}
+namespace ch8RotatingImageOverTime {
+#include "Ch8RotatingImageOverTime.cpp"
+}
+namespace ch9Plane {
+#include "Ch9Plane.cpp"
+}
+namespace ch9Cube {
+#include "Ch9Cube.cpp"
+}
+namespace ch9ManyCubes {
+#include "Ch9ManyCubes.cpp"
+}
+namespace ch10CameraCircle {
+#include "Ch10CameraCircle.cpp"
+}
+namespace ch10KeyboardInput {
+#include "Ch10KeyboardInput.cpp"
+}
+namespace ch12LightingSetup {
+#include "Ch12LightingSetup.cpp"
+}
+namespace ch13DiffuseAndSpecular {
+#include "Ch13DiffuseAndSpecular.cpp"
+}
+namespace ch14ClusteredLighting {
+#include "Ch14ClusteredLighting.cpp"
+}
+namespace ch15DeferredShading {
+#include "Ch15DeferredShading.cpp"
+}
+namespace ch16DepthPrePass {
+#include "Ch16DepthPrePass.cpp"
+}
+namespace ch17Shadows {
+#include "Ch17Shadows.cpp"
+}
+namespace ch18MeshLoading {
+#include "Ch18MeshLoading.cpp"
+}
+namespace ch19LevelOfDetail {
+#include "Ch19LevelOfDetail.cpp"
+}
+namespace ch20MeshletCulling {
+#include "Ch20MeshletCulling.cpp"
+}
+#undef main
+#undef glfwGetTime
+#undef glfwCreateWindow
+#undef glfwWindowShouldClose
+#undef glfwSwapBuffers
+
+struct GoldenChapter
+{
+	const char* name;
+	bool animated;          // uses glfwGetTime() for more than the frame time, so time matters
+	int (*run)(int argc, char** argv);
+};
+
+const std::vector<GoldenChapter>& goldenChapters()
+{
+	static const std::vector<GoldenChapter> chapters = {
+		{ "Ch5TwoOrangeTriangles", false, [](int, char**) { return ch5TwoOrangeTriangles::run(); } },
+		{ "Ch6FlashingGreenTriangles", true, [](int, char**) { return ch6FlashingGreenTriangles::run(); } },
+		{ "Ch7SimpleTexture", false, [](int, char**) { return ch7SimpleTexture::run(); } },
+		{ "Ch7TwoTexturesMixed", false, [](int, char**) { return ch7TwoTexturesMixed::run(); } },
+		{ "Ch8RotatingImageOverTime", true, [](int, char**) { return ch8RotatingImageOverTime::run(); } },
+		{ "Ch9Plane", false, [](int, char**) { return ch9Plane::run(); } },
+		{ "Ch9Cube", false, [](int, char**) { return ch9Cube::run(); } },
+		{ "Ch9ManyCubes", true, [](int, char**) { return ch9ManyCubes::run(); } },
+		{ "Ch10CameraCircle", true, [](int, char**) { return ch10CameraCircle::run(); } },
+		{ "Ch10KeyboardInput", false, [](int, char**) { return ch10KeyboardInput::run(); } },
+		{ "Ch12LightingSetup", false, [](int, char**) { return ch12LightingSetup::run(); } },
+		{ "Ch13DiffuseAndSpecular", true, [](int, char**) { return ch13DiffuseAndSpecular::run(); } },
+		{ "Ch14ClusteredLighting", true, [](int, char**) { return ch14ClusteredLighting::run(); } },
+		{ "Ch15DeferredShading", true, [](int, char**) { return ch15DeferredShading::run(); } },
+		{ "Ch16DepthPrePass", true, [](int, char**) { return ch16DepthPrePass::run(); } },
+		{ "Ch17Shadows", true, [](int, char**) { return ch17Shadows::run(); } },
+		{ "Ch18MeshLoading", true, ch18MeshLoading::run },
+		{ "Ch19LevelOfDetail", false, ch19LevelOfDetail::run },
+		{ "Ch20MeshletCulling", false, ch20MeshletCulling::run },
+	};
+	return chapters;
+}
+
+// the size the software references are stored at, same aspect as the chapters' 800x600 windows. the GL ones
+// are whatever size the chapter's window is
+const int SOFTWARE_WIDTH = 400;
+const int SOFTWARE_HEIGHT = 300;
+// when to look at the animated scenes: the start, and two times far enough along that everything has moved
+const float ANIMATED_TIMES[] = { 0.0f, 1.0f, 2.5f };
+
+struct RegressionSettings
+{
+	std::string referenceDirectory, outputDirectory;
+	bool update;
+	double threshold, allowedFraction;
+};
+
+std::string referenceName(const char* scene, float time)
+{
+	char name[128];
+	std::snprintf(name, sizeof(name), "%s_t%.2f.png", scene, time);
+	return name;
+}
+
+// compares an RGB image against its reference (or makes it the reference with -update), returns false on a failure
+bool checkImage(const RegressionSettings& settings, const std::string& name, const std::vector<unsigned char>& pixels, int width, int height)
+{
+	std::string referencePath = settings.referenceDirectory + "/" + name;
+	if (settings.update)
+	{
+		if (!ImageWriter::writePng(referencePath, width, height, 3, pixels.data()))
+			return false;
+		std::cout << "UPDATED " << referencePath << std::endl;
+		return true;
+	}
+
+	// a chapter may have left stb_image flipping
+	stbi_set_flip_vertically_on_load(false);
+	int referenceWidth, referenceHeight, channels;
+	unsigned char* reference = stbi_load(referencePath.c_str(), &referenceWidth, &referenceHeight, &channels, 3);
+	if (!reference || referenceWidth != width || referenceHeight != height)
+	{
+		std::cout << "FAIL " << name << ": no " << width << "x" << height << " reference at " << referencePath << " (run with -update)" << std::endl;
+		stbi_image_free(reference);
+		return false;
+	}
+	std::vector<unsigned char> diff;
+	ImageDifference difference = ImageCompare::compare(pixels.data(), reference, width, height, 3, settings.threshold, &diff);
+	stbi_image_free(reference);
+	bool pass = difference.differingFraction() <= settings.allowedFraction;
+	std::cout << (pass ? "PASS " : "FAIL ") << name << ": max dE " << difference.maxDelta << ", mean dE " << difference.meanDelta
+		<< ", " << difference.differingPixels << " pixels over " << settings.threshold << std::endl;
+	if (!pass)
+	{
+		std::string base = settings.outputDirectory + "/" + name.substr(0, name.size() - 4);
+		ImageWriter::writePng(base + "_actual.png", width, height, 3, pixels.data());
+		ImageWriter::writePng(base + "_diff.png", width, height, 3, diff.data());
+	}
+	return pass;
+}
+
+int main(int argc, char** argv)
+{
+	std::string sceneName;
+	RegressionSettings settings = { "images/golden", "regression_output", false, 2.3, 0.001 };
+	bool software = false;
+	for (int i = 1; i < argc; i++)
+	{
+		bool hasValue = i + 1 < argc;
+		if (std::strcmp(argv[i], "-update") == 0)
+			settings.update = true;
+		else if (std::strcmp(argv[i], "-software") == 0)
+			software = true;
+		else if (std::strcmp(argv[i], "-threshold") == 0 && hasValue)
+			settings.threshold = std::atof(argv[++i]);
+		else if (std::strcmp(argv[i], "-differing") == 0 && hasValue)
+			settings.allowedFraction = std::atof(argv[++i]);
+		else if (std::strcmp(argv[i], "-out") == 0 && hasValue)
+			settings.outputDirectory = argv[++i];
+		else if (argv[i][0] != '-')
+			sceneName = argv[i];
+		else
+		{
+			std::cout << "usage: RenderRegression [chapter] [-software] [-update] [-threshold dE] [-differing fraction] [-out dir]" << std::endl;
+			return 1;
+		}
+	}
+	if (software)
+		settings.referenceDirectory += "/software";
+
+	std::error_code error;
+	std::filesystem::create_directories(settings.update ? settings.referenceDirectory : settings.outputDirectory, error);
+
+	int tests = 0, failures = 0, skipped = 0;
+	auto timesFor = [](bool animated) {
+		std::vector<float> times(1, 0.0f);
+		if (animated)
+			times.assign(std::begin(ANIMATED_TIMES), std::end(ANIMATED_TIMES));
+		return times;
+	};
+	if (software)
+	{
+		// paths are relative like in the chapters, run it from the project directory
+		SoftwareSceneAssets assets;
+		if (!assets.load())
+			return 1;
+		// the image doesn't depend on the thread count (see software_rasterizer.h), so use them all
+		SoftwareRasterizer raster(SOFTWARE_WIDTH, SOFTWARE_HEIGHT);
+		std::vector<unsigned char> pixels;
+		for (const SoftwareScene& scene : SoftwareScenes::all())
+		{
+			if (!sceneName.empty() && sceneName != scene.name)
+				continue;
+			for (float time : timesFor(scene.animated))
+			{
+				tests++;
+				scene.render(raster, assets, time);
+				// RGB only, the window ignores alpha
+				raster.readPixels(pixels);
+				for (size_t pixel = 0; pixel < (size_t)SOFTWARE_WIDTH * SOFTWARE_HEIGHT; pixel++)
+					for (int c = 0; c < 3; c++)
+						pixels[pixel * 3 + c] = pixels[pixel * 4 + c];
+				pixels.resize((size_t)SOFTWARE_WIDTH * SOFTWARE_HEIGHT * 3);
+				if (!checkImage(settings, referenceName(scene.name, time), pixels, SOFTWARE_WIDTH, SOFTWARE_HEIGHT))
+					failures++;
+			}
+		}
+	}
+	else
+	{
+		// the chapters that take a mesh get their default one
+		char* chapterArgv[] = { argv[0], nullptr };
+		for (const GoldenChapter& chapter : goldenChapters())
+		{
+			if (!sceneName.empty() && sceneName != chapter.name)
+				continue;
+			for (float time : timesFor(chapter.animated))
+			{
+				tests++;
+				std::string name = referenceName(chapter.name, time);
+				GoldenRun::start(time);
+				int result = chapter.run(1, chapterArgv);
+				if (GoldenRun::noWindow)
+				{
+					std::cout << "SKIP " << name << ": no window, the driver doesn't have the GL version it asks for" << std::endl;
+					skipped++;
+				}
+				else if (result != 0 || GoldenRun::pixels.empty())
+				{
+					std::cout << "FAIL " << name << ": the chapter exited with " << result << " after " << GoldenRun::frames << " frames" << std::endl;
+					failures++;
+				}
+				else if (!checkImage(settings, name, GoldenRun::pixels, GoldenRun::width, GoldenRun::height))
+					failures++;
+			}
+		}
+	}
+	if (tests == 0)
+	{
+		std::cout << "no chapter called " << sceneName << std::endl;
+		return 1;
+	}
+	std::cout << tests - failures - skipped << " of " << tests << " passed";
+	if (skipped > 0)
+		std::cout << ", " << skipped << " skipped";
+	std::cout << std::endl;
+	return failures;
+}
@@ -0,0 +1,20 @@
+#version 330 core
+// Ch10CameraCircle's cubes in one instanced draw. the matrices come from a uniform block instead of uniforms:
+// the program is shared by every batch context, the buffer behind the block is each context's own
+layout (std140) uniform Frame
+{
+	mat4 viewProjection;
+	mat4 models[10];
+};
+
+layout (location = 0) in vec3 pos;
+layout (location = 1) in vec2 texturecoords;
+
+// pass these along to fragment shader
+out vec2 texturecoord;
+
+void main() {
+	gl_Position = viewProjection * (models[gl_InstanceID] * vec4(pos, 1.0f));
+
+	texturecoord = texturecoords;
+}
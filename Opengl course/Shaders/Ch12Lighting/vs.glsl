@@ -1,12 +1,8 @@
-
 #version 330 core
 layout (location = 0) in vec3 pos;
 
-
-uniform mat4 model;
-uniform mat4 view;
-uniform mat4 projection;
+#include "../Common/transforms.glsl"
 
 void main() {
-	gl_Position = projection * view * model * vec4(pos, 1.0f);
+	gl_Position = viewProjection * (model * vec4(pos, 1.0f));
 }
@@ -1,22 +1,22 @@
-
 #version 330 core
 layout (location = 0) in vec3 pos;
 layout (location = 1) in vec3 normals;
 
-uniform mat4 model;
-uniform mat4 view;
-uniform mat4 projection;
+#include "../Common/transforms.glsl"
 
 out vec3 FragPos;
 out vec3 Normal;
 
+// lets a depth pre-pass (Ch16DepthPrePass/depth_vs.glsl) reproduce the exact same depth for GL_EQUAL testing
+invariant gl_Position;
+
 void main() {
     // multiply by model matrix only to get world space coords of the fragments
     FragPos = vec3(model * vec4(pos, 1.0f));
 
     // use the normal matrix to map the local space normals to world space
-    Normal = mat3(transpose(inverse(model))) * normals;
-
+    Normal = normalMatrix * normals;
 
-	gl_Position = projection * view * model * vec4(pos, 1.0f);
+    // world space position is already computed, so only the view projection is left
+	gl_Position = viewProjection * vec4(FragPos, 1.0f);
 }
@@ -0,0 +1,81 @@
+#version 430 core
+out vec4 FragColor;
+
+#include "../Common/phong.glsl"
+
+in vec3 FragPos;
+in vec3 Normal;
+
+// has to match PointLight in clustered_lighting.h
+struct PointLight
+{
+    vec4 positionRadius; // xyz = world space position, w = radius
+    vec4 color;
+};
+
+// every light in the scene
+layout (std430, binding = 0) readonly buffer Lights
+{
+    PointLight lights[];
+};
+// per cluster: x = offset into lightIndices, y = how many lights
+layout (std430, binding = 1) readonly buffer Clusters
+{
+    uvec2 clusters[];
+};
+layout (std430, binding = 2) readonly buffer LightIndices
+{
+    uint lightIndices[];
+};
+
+uniform uvec3 clusterCounts; // tiles in x, tiles in y, depth slices
+uniform vec2 tileSize;       // in pixels
+uniform float zNear;
+uniform float zFar;
+
+uniform vec3 viewPos;
+uniform vec3 objectColor;
+
+// gl_FragCoord.z is non linear, turn it back into view space depth
+float linearDepth(float depth)
+{
+    float ndc = depth * 2.0 - 1.0;
+    return (2.0 * zNear * zFar) / (zFar + zNear - ndc * (zFar - zNear));
+}
+
+void main()
+{
+    // find our cluster. depth slices are exponential, so the slice is a log of the depth
+    // (same formula as ClusteredLighting::sliceIndex on the CPU)
+    float depth = linearDepth(gl_FragCoord.z);
+    uint slice = uint(clamp(floor(log(depth / zNear) / log(zFar / zNear) * float(clusterCounts.z)), 0.0, float(clusterCounts.z - 1u)));
+    uvec2 tile = min(uvec2(gl_FragCoord.xy / tileSize), clusterCounts.xy - 1u);
+    uint cluster = (slice * clusterCounts.y + tile.y) * clusterCounts.x + tile.x;
+
+    vec3 norm = normalize(Normal);
+    vec3 viewDir = normalize(viewPos - FragPos);
+
+    // ambient
+    vec3 result = vec3(0.02);
+
+    // only the lights that can actually reach this cluster
+    uvec2 range = clusters[cluster];
+    for (uint i = 0u; i < range.y; i++)
+    {
+        PointLight light = lights[lightIndices[range.x + i]];
+        vec3 toLight = light.positionRadius.xyz - FragPos;
+        float dist = length(toLight);
+        float radius = light.positionRadius.w;
+        if (dist >= radius)
+            continue;
+        vec3 lightDir = toLight / dist;
+
+        // smooth falloff that hits exactly 0 at the radius, so culling lights by radius doesn't leave seams
+        float falloff = clamp(1.0 - pow(dist / radius, 4.0), 0.0, 1.0);
+        float attenuation = falloff * falloff / (1.0 + dist * dist);
+
+        result += phong(norm, lightDir, viewDir, light.color.rgb) * attenuation;
+    }
+
+    FragColor = vec4(result * objectColor, 1.0);
+}
@@ -0,0 +1,13 @@
+#version 330 core
+out vec4 FragColor;
+
+uniform sampler2D gAlbedoSpec;
+
+uniform float ambientFactor;
+
+void main()
+{
+    // every lit pixel gets the ambient term once, the point lights get added on top
+    vec3 albedo = texelFetch(gAlbedoSpec, ivec2(gl_FragCoord.xy), 0).rgb;
+    FragColor = vec4(albedo * ambientFactor, 1.0);
+}
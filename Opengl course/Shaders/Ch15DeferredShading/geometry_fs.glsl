@@ -0,0 +1,28 @@
+#version 330 core
+// G-buffer outputs (see gbuffer.h)
+layout (location = 0) out vec2 gNormal;     // octahedral encoded normal
+layout (location = 1) out vec4 gAlbedoSpec; // rgb = albedo, a = specular strength
+
+in vec3 Normal;
+
+uniform vec3 objectColor;
+uniform float specularStrength;
+
+// octahedral normal encoding: project the unit vector onto an octahedron (|x|+|y|+|z| = 1),
+// then fold the bottom half over the top so the whole sphere fits into a 2d square
+vec2 signNotZero(vec2 v)
+{
+    return vec2(v.x >= 0.0 ? 1.0 : -1.0, v.y >= 0.0 ? 1.0 : -1.0);
+}
+
+vec2 encodeNormal(vec3 n)
+{
+    n /= (abs(n.x) + abs(n.y) + abs(n.z));
+    return n.z >= 0.0 ? n.xy : (1.0 - abs(n.yx)) * signNotZero(n.xy);
+}
+
+void main()
+{
+    gNormal = encodeNormal(normalize(Normal));
+    gAlbedoSpec = vec4(objectColor, specularStrength);
+}
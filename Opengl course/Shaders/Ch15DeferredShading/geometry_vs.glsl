@@ -0,0 +1,12 @@
+#version 330 core
+layout (location = 0) in vec3 pos;
+layout (location = 1) in vec3 normals;
+
+#include "../Common/transforms.glsl"
+
+out vec3 Normal;
+
+void main() {
+    Normal = normalMatrix * normals;
+	gl_Position = viewProjection * (model * vec4(pos, 1.0f));
+}
@@ -0,0 +1,57 @@
+#version 330 core
+out vec4 FragColor;
+
+flat in vec4 LightPosRadius;
+flat in vec3 LightColor;
+
+uniform sampler2D gNormal;
+uniform sampler2D gAlbedoSpec;
+uniform sampler2D gDepth;
+
+uniform mat4 inverseViewProjection;
+uniform vec2 screenSize;
+uniform vec3 viewPos;
+
+vec3 decodeNormal(vec2 f)
+{
+    // undo the octahedral fold from geometry_fs.glsl
+    vec3 n = vec3(f.x, f.y, 1.0 - abs(f.x) - abs(f.y));
+    float t = clamp(-n.z, 0.0, 1.0);
+    n.x += n.x >= 0.0 ? -t : t;
+    n.y += n.y >= 0.0 ? -t : t;
+    return normalize(n);
+}
+
+void main()
+{
+    ivec2 pixel = ivec2(gl_FragCoord.xy);
+
+    // rebuild the world space position from depth instead of storing it in the G-buffer
+    float depth = texelFetch(gDepth, pixel, 0).r;
+    vec4 ndc = vec4(gl_FragCoord.xy / screenSize * 2.0 - 1.0, depth * 2.0 - 1.0, 1.0);
+    vec4 world = inverseViewProjection * ndc;
+    vec3 FragPos = world.xyz / world.w;
+
+    vec3 toLight = LightPosRadius.xyz - FragPos;
+    float dist = length(toLight);
+    if (dist >= LightPosRadius.w)
+        discard;
+
+    vec3 norm = decodeNormal(texelFetch(gNormal, pixel, 0).rg);
+    vec4 albedoSpec = texelFetch(gAlbedoSpec, pixel, 0);
+    vec3 lightDir = toLight / dist;
+
+    // same falloff as the clustered chapter, hits 0 right at the radius so the volume edge is invisible
+    float falloff = clamp(1.0 - pow(dist / LightPosRadius.w, 4.0), 0.0, 1.0);
+    float attenuation = falloff * falloff / (1.0 + dist * dist);
+
+    // diffuse
+    float diff = max(dot(norm, lightDir), 0.0);
+
+    // specular
+    vec3 viewDir = normalize(viewPos - FragPos);
+    vec3 reflected = reflect(-lightDir, norm);
+    float spec = albedoSpec.a * pow(max(dot(reflected, viewDir), 0.0), 32);
+
+    FragColor = vec4((diff * albedoSpec.rgb + spec) * LightColor * attenuation, 1.0);
+}
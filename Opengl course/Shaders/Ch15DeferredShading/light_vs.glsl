@@ -0,0 +1,16 @@
+#version 330 core
+layout (location = 0) in vec3 pos;             // unit sphere
+layout (location = 1) in vec4 lightPosRadius;  // per instance: world position, radius
+layout (location = 2) in vec3 lightColor;      // per instance
+
+uniform mat4 viewProjection;
+
+flat out vec4 LightPosRadius;
+flat out vec3 LightColor;
+
+void main() {
+    LightPosRadius = lightPosRadius;
+    LightColor = lightColor;
+    // blow the unit sphere up to the light's radius, the sphere covers every pixel the light can reach
+	gl_Position = viewProjection * vec4(lightPosRadius.xyz + pos * lightPosRadius.w, 1.0f);
+}
@@ -0,0 +1,13 @@
+#version 330 core
+layout (location = 0) in vec3 pos;
+
+#include "../Common/transforms.glsl"
+
+// the color pass tests with GL_EQUAL, so depth here has to come out bit for bit the same as in
+// Ch13DiffuseAndSpecular/vs.glsl. same math in the same order + invariant makes the compiler promise that
+invariant gl_Position;
+
+void main() {
+    vec3 FragPos = vec3(model * vec4(pos, 1.0f));
+	gl_Position = viewProjection * vec4(FragPos, 1.0f);
+}
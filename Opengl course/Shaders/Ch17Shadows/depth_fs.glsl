@@ -0,0 +1,6 @@
+#version 330 core
+
+// directional shadows only need the depth the rasterizer already writes
+void main()
+{
+}
@@ -0,0 +1,12 @@
+#version 330 core
+layout (location = 0) in vec3 pos;
+
+uniform mat4 model;
+uniform mat4 lightSpace; // light's projection * view for the cascade / cube face being rendered
+
+out vec3 FragPos;
+
+void main() {
+    FragPos = vec3(model * vec4(pos, 1.0f));
+	gl_Position = lightSpace * vec4(FragPos, 1.0f);
+}
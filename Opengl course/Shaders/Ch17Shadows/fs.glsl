@@ -0,0 +1,74 @@
+#version 330 core
+out vec4 FragColor;
+
+#include "../Common/phong.glsl"
+
+in vec3 FragPos;
+in vec3 Normal;
+
+uniform vec3 viewPos;
+uniform vec3 viewDir;       // camera forward, picks the cascade
+uniform vec3 objectColor;
+
+// spinning point light (same as Ch13) with cube map shadows
+uniform vec3 lightPos;
+uniform vec3 lightColor;
+uniform samplerCube pointShadowMap;
+uniform float pointFarPlane;
+
+// sun with cascaded shadows
+const int CASCADES = 4;
+uniform vec3 sunDir;        // direction the sunlight travels
+uniform vec3 sunColor;
+uniform sampler2DArrayShadow cascadeShadowMap;
+uniform mat4 cascadeLightSpace[CASCADES];
+uniform float cascadeSplits[CASCADES];
+
+float pointShadow(vec3 norm)
+{
+    vec3 fromLight = FragPos - lightPos;
+    float current = length(fromLight);
+    // push the lookup a bit along the normal so flat surfaces don't shadow themselves (acne)
+    float closest = texture(pointShadowMap, fromLight + norm * 0.02).r * pointFarPlane;
+    return current - 0.05 > closest ? 0.0 : 1.0;
+}
+
+float sunShadow(vec3 norm)
+{
+    // which cascade are we in? cascadeSplits holds the view depth where each one ends
+    float depth = dot(FragPos - viewPos, viewDir);
+    int cascade = CASCADES - 1;
+    for (int i = 0; i < CASCADES; i++)
+    {
+        if (depth < cascadeSplits[i])
+        {
+            cascade = i;
+            break;
+        }
+    }
+
+    vec4 lightClip = cascadeLightSpace[cascade] * vec4(FragPos + norm * 0.02, 1.0);
+    vec3 coords = lightClip.xyz / lightClip.w * 0.5 + 0.5;
+    if (coords.z > 1.0)
+        return 1.0;
+
+    // 3x3 PCF on top of the hardware 2x2 compare
+    vec2 texel = 1.0 / vec2(textureSize(cascadeShadowMap, 0).xy);
+    float lit = 0.0;
+    for (int x = -1; x <= 1; x++)
+        for (int y = -1; y <= 1; y++)
+            lit += texture(cascadeShadowMap, vec4(coords.xy + vec2(x, y) * texel, float(cascade), coords.z - 0.0005));
+    return lit / 9.0;
+}
+
+void main()
+{
+    vec3 norm = normalize(Normal);
+    vec3 toEye = normalize(viewPos - FragPos);
+    vec3 ambient = 0.05 * (lightColor + sunColor);
+
+    vec3 point = phong(norm, normalize(lightPos - FragPos), toEye, lightColor) * pointShadow(norm);
+    vec3 sun = phong(norm, normalize(-sunDir), toEye, sunColor) * sunShadow(norm);
+
+    FragColor = vec4((ambient + point + sun) * objectColor, 1.0);
+}
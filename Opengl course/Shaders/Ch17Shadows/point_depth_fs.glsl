@@ -0,0 +1,12 @@
+#version 330 core
+in vec3 FragPos;
+
+uniform vec3 lightPos;
+uniform float farPlane;
+
+void main()
+{
+    // store linear distance to the light (0..1) instead of the perspective depth,
+    // then the lighting shader can compare it against its own distance with one lookup in any direction
+    gl_FragDepth = length(FragPos - lightPos) / farPlane;
+}
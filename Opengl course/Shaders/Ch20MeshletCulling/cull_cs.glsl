@@ -0,0 +1,136 @@
+#version 460 core
+// one thread per (object, meshlet): either counts why the meshlet got culled or appends a draw command for it.
+// meshlet_culling.h has the big picture
+layout (local_size_x = 64) in;
+
+// same layouts as Meshlet (meshlets.h), DrawElementsIndirectCommand and MeshletCullStats (meshlet_culling.h)
+struct Meshlet
+{
+    vec4 centerRadius;
+    vec4 coneAxisCutoff;
+    vec4 coneApex;
+    uint firstIndex;
+    uint indexCount;
+    uint vertexCount;
+    uint reserved;
+};
+
+struct DrawCommand
+{
+    uint count;
+    uint instanceCount;
+    uint firstIndex;
+    int baseVertex;
+    uint baseInstance;
+};
+
+layout (std430, binding = 0) readonly buffer Meshlets { Meshlet meshlets[]; };
+layout (std430, binding = 1) readonly buffer Objects { mat4 models[]; };
+layout (std430, binding = 2) writeonly buffer Commands { DrawCommand commands[]; };
+layout (std430, binding = 3) buffer Stats
+{
+    uint meshletsDrawn; // also the draw count glMultiDrawElementsIndirectCount reads
+    uint trianglesDrawn;
+    uint frustumCulled;
+    uint coneCulled;
+    uint occlusionCulled;
+};
+
+// farthest depth of each texel's area, mip 0 is the depth buffer (depth_reduce_cs.glsl)
+layout (binding = 0) uniform sampler2D depthPyramid;
+
+uniform vec4 frustumPlanes[6];          // world space, xyz normalized and pointing inwards
+uniform mat4 occlusionViewProjection;   // the camera the depth pyramid was drawn with
+uniform vec3 cameraPosition;
+uniform int meshletCount;
+uniform int objectCount;
+uniform bool frustumCulling;
+uniform bool coneCulling;
+uniform bool occlusionCulling;
+
+bool outsideFrustum(vec3 center, float radius)
+{
+    for (int i = 0; i < 6; i++)
+        if (dot(frustumPlanes[i].xyz, center) + frustumPlanes[i].w < -radius)
+            return true;
+    return false;
+}
+
+bool occluded(vec3 center, float radius)
+{
+    // screen rect and nearest depth of the sphere's box
+    vec2 lo = vec2(1e30), hi = vec2(-1e30);
+    float nearest = 1.0;
+    for (int i = 0; i < 8; i++)
+    {
+        vec3 corner = center + radius * vec3((i & 1) != 0 ? 1.0 : -1.0, (i & 2) != 0 ? 1.0 : -1.0, (i & 4) != 0 ? 1.0 : -1.0);
+        vec4 clip = occlusionViewProjection * vec4(corner, 1.0);
+        // pokes through the near plane, so it can't be projected properly. it's right in front of us anyway
+        if (clip.w <= 0.0 || clip.z < -clip.w)
+            return false;
+        vec3 ndc = clip.xyz / clip.w;
+        lo = min(lo, ndc.xy);
+        hi = max(hi, ndc.xy);
+        nearest = min(nearest, ndc.z);
+    }
+    // off screen for that camera, the pyramid knows nothing about it
+    if (hi.x < -1.0 || hi.y < -1.0 || lo.x > 1.0 || lo.y > 1.0)
+        return false;
+
+    ivec2 size = textureSize(depthPyramid, 0);
+    ivec2 a = ivec2(clamp((lo * 0.5 + 0.5) * vec2(size), vec2(0.0), vec2(size - 1)));
+    ivec2 b = ivec2(clamp((hi * 0.5 + 0.5) * vec2(size), vec2(0.0), vec2(size - 1)));
+    // go up to the level where the rect is at most 2x2 texels, then the 4 corners cover all of it
+    int span = max(b.x - a.x, b.y - a.y);
+    int level = span <= 1 ? 0 : findMSB(span - 1) + 1;
+    level = min(level, textureQueryLevels(depthPyramid) - 1);
+    ivec2 levelMax = textureSize(depthPyramid, level) - 1;
+    a = min(a >> level, levelMax);
+    b = min(b >> level, levelMax);
+    float farthest = max(max(texelFetch(depthPyramid, a, level).r, texelFetch(depthPyramid, ivec2(b.x, a.y), level).r),
+                         max(texelFetch(depthPyramid, ivec2(a.x, b.y), level).r, texelFetch(depthPyramid, b, level).r));
+    // ndc -> window depth like the depth buffer has it
+    return nearest * 0.5 + 0.5 > farthest;
+}
+
+void main()
+{
+    uint id = gl_GlobalInvocationID.x;
+    if (id >= uint(meshletCount * objectCount))
+        return;
+    uint object = id / uint(meshletCount);
+    Meshlet meshlet = meshlets[id % uint(meshletCount)];
+    mat4 model = models[object];
+
+    // objects are only rotated and uniformly scaled, so the sphere stays a sphere
+    vec3 center = vec3(model * vec4(meshlet.centerRadius.xyz, 1.0));
+    float scale = max(length(model[0].xyz), max(length(model[1].xyz), length(model[2].xyz)));
+    float radius = meshlet.centerRadius.w * scale;
+
+    if (frustumCulling && outsideFrustum(center, radius))
+    {
+        atomicAdd(frustumCulled, 1);
+        return;
+    }
+    // cheapest test first after the frustum, and it doesn't need the pyramid
+    if (coneCulling && meshlet.coneAxisCutoff.w <= 1.0)
+    {
+        vec3 apex = vec3(model * vec4(meshlet.coneApex.xyz, 1.0));
+        vec3 axis = normalize(mat3(model) * meshlet.coneAxisCutoff.xyz);
+        if (dot(normalize(apex - cameraPosition), axis) >= meshlet.coneAxisCutoff.w)
+        {
+            atomicAdd(coneCulled, 1);
+            return;
+        }
+    }
+    if (occlusionCulling && occluded(center, radius))
+    {
+        atomicAdd(occlusionCulled, 1);
+        return;
+    }
+
+    // baseInstance carries the ids to the vertex shader
+    uint slot = atomicAdd(meshletsDrawn, 1);
+    atomicAdd(trianglesDrawn, meshlet.indexCount / 3);
+    commands[slot] = DrawCommand(meshlet.indexCount, 1, meshlet.firstIndex, 0, id);
+}
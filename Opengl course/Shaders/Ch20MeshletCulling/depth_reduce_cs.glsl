@@ -0,0 +1,38 @@
+#version 450 core
+// builds one level of the depth pyramid (see meshlet_culling.h): every texel keeps the farthest depth of the
+// texels under it in the level above, so "nearer than this" is true for anything visible in that area
+layout (local_size_x = 8, local_size_y = 8) in;
+
+layout (binding = 0) uniform sampler2D source;  // the depth texture for level 0, the pyramid itself after that
+layout (r32f, binding = 0) writeonly uniform image2D target;
+
+uniform int sourceLevel;
+uniform bool copy;  // level 0: same size as the depth buffer, just copied over
+
+void main()
+{
+    ivec2 p = ivec2(gl_GlobalInvocationID.xy);
+    ivec2 size = imageSize(target);
+    if (p.x >= size.x || p.y >= size.y)
+        return;
+
+    float depth = 0.0;
+    if (copy)
+        depth = texelFetch(source, p, 0).r;
+    else
+    {
+        ivec2 sourceSize = textureSize(source, sourceLevel);
+        ivec2 first = p * 2;
+        // odd sized levels: the last row/column also takes the texel that doesn't have a pair,
+        // otherwise its depth would go missing and things behind it could get culled
+        ivec2 last = min(first + 1, sourceSize - 1);
+        if (p.x == size.x - 1)
+            last.x = sourceSize.x - 1;
+        if (p.y == size.y - 1)
+            last.y = sourceSize.y - 1;
+        for (int y = first.y; y <= last.y; y++)
+            for (int x = first.x; x <= last.x; x++)
+                depth = max(depth, texelFetch(source, ivec2(x, y), sourceLevel).r);
+    }
+    imageStore(target, p, vec4(depth));
+}
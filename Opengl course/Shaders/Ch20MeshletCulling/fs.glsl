@@ -0,0 +1,35 @@
+#version 460 core
+out vec4 FragColor;
+
+#include "../Common/phong.glsl"
+
+in vec3 FragPos;
+in vec3 Normal;
+flat in uint MeshletId;
+
+uniform vec3 viewPos;
+uniform vec3 lightPos;
+uniform vec3 lightColor;
+uniform vec3 objectColor;
+uniform bool showMeshlets;
+
+// a random looking but stable color per meshlet
+vec3 meshletColor(uint id)
+{
+    id = id * 747796405u + 2891336453u;
+    id = ((id >> ((id >> 28u) + 4u)) ^ id) * 277803737u;
+    return vec3(uvec3(id, id >> 8u, id >> 16u) & 255u) / 255.0 * 0.7 + 0.3;
+}
+
+void main()
+{
+    vec3 norm = normalize(Normal);
+    vec3 viewDir = normalize(viewPos - FragPos);
+    vec3 lightDir = normalize(lightPos - FragPos);
+
+    float ambientFactor = 0.05;
+    vec3 result = ambientFactor * lightColor + phong(norm, lightDir, viewDir, lightColor);
+
+    vec3 color = showMeshlets ? meshletColor(MeshletId) : objectColor;
+    FragColor = vec4(result * color, 1.0);
+}
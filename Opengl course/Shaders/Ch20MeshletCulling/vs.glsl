@@ -0,0 +1,25 @@
+#version 460 core
+layout (location = 0) in vec3 pos;
+layout (location = 1) in vec3 normals;
+
+// every draw is one meshlet of one object, the culling shader put object * meshletCount + meshlet in baseInstance
+layout (std430, binding = 1) readonly buffer Objects { mat4 models[]; };
+
+uniform mat4 viewProjection;
+uniform int meshletCount;
+
+out vec3 FragPos;
+out vec3 Normal;
+flat out uint MeshletId;
+
+void main() {
+    uint id = uint(gl_BaseInstance);
+    mat4 model = models[id / uint(meshletCount)];
+    FragPos = vec3(model * vec4(pos, 1.0f));
+
+    // rotation + uniform scale only, so the model matrix does for the normals too (fs normalizes)
+    Normal = mat3(model) * normals;
+    MeshletId = id;
+
+	gl_Position = viewProjection * vec4(FragPos, 1.0f);
+}
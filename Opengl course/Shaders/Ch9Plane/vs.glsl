@@ -1,18 +1,2 @@
-
 #version 330 core
-layout (location = 0) in vec3 pos;
-layout (location = 1) in vec2 texturecoords;
-
-// pass these along to fragment shader
-out vec2 texturecoord;
-
-
-uniform mat4 model;
-uniform mat4 view;
-uniform mat4 projection;
-
-void main() {
-	gl_Position = projection * view * model * vec4(pos, 1.0f);
-
-	texturecoord = texturecoords;
-}
+#include "../Common/textured_vs.glsl"
@@ -0,0 +1,23 @@
+// position + vertex color + texture coords, used by the Ch7 and Ch8 chapters.
+// define USE_TRANSFORMATION_MATRIX to run the position through a matrix first (Ch8)
+layout (location = 0) in vec3 pos;
+layout (location = 1) in vec3 rgb;
+layout (location = 2) in vec2 texturecoords;
+
+// pass these along to fragment shader
+out vec3 color;
+out vec2 texturecoord;
+
+#ifdef USE_TRANSFORMATION_MATRIX
+uniform mat4 transformation_matrix;
+#endif
+
+void main() {
+#ifdef USE_TRANSFORMATION_MATRIX
+	gl_Position = transformation_matrix * vec4(pos, 1.0);
+#else
+	gl_Position = vec4(pos, 1.0);
+#endif
+	color = rgb;
+	texturecoord = texturecoords;
+}
@@ -0,0 +1,12 @@
+#version 330 core
+// the font atlas only has coverage in red, solid quads sample its one all white cell
+out vec4 FragColor;
+
+in vec2 texturecoord;
+in vec4 color;
+
+uniform sampler2D atlas;
+
+void main() {
+	FragColor = vec4(color.rgb, color.a * texture(atlas, texturecoord).r);
+}
@@ -0,0 +1,17 @@
+#version 330 core
+// perf_overlay.h: text and graph quads, positioned in pixels from the top left corner of the window
+layout (location = 0) in vec2 pos;
+layout (location = 1) in vec2 texturecoords;
+layout (location = 2) in vec4 rgba;
+
+out vec2 texturecoord;
+out vec4 color;
+
+uniform vec2 screenSize;
+
+void main() {
+	vec2 ndc = pos / screenSize * 2.0 - 1.0;
+	gl_Position = vec4(ndc.x, -ndc.y, 0.0, 1.0);
+	texturecoord = texturecoords;
+	color = rgba;
+}
@@ -0,0 +1,39 @@
+// diffuse + specular from one light, shared by the lit chapters.
+// define USE_SPECULAR as 0 before this gets included to leave the specular part out at compile time
+#ifndef USE_SPECULAR
+#define USE_SPECULAR 1
+#endif
+
+// norm, lightDir (fragment -> light) and toEye (fragment -> camera) all normalized
+vec3 phong(vec3 norm, vec3 lightDir, vec3 toEye, vec3 lightColor)
+{
+    // If the angle between both vectors is greater than 90 degrees then the result of the dot product
+    // will actually become negative and we end up with a negative diffuse component.
+    // which kinda makes sense as if light hits a surface at > 90 degrees then
+    // it should just be dark since that means its off to the side?
+    float diff = max(dot(norm, lightDir), 0.0);
+
+    // now the definition of diffuse- scale the lighting according to this dot product!
+    vec3 diffuse = lightColor * diff;
+
+#if USE_SPECULAR
+    float specularStrength = 0.5;
+
+    // get the reflected light ray
+    // negate lightDir cuz without the negative its going from fragment to light
+    // which we want the opposite of
+    vec3 reflected = reflect(-lightDir, norm);
+
+    // dot product will be large when the rays are at similar angles (small theta means cos near 1)
+    // and will be near zero when far away
+    // the max is there to prevent negative values
+    // also the value 32 is configurable, larger = brighter since 
+    // the value is less than 1 and we're raising to the xth power
+    float amount = pow(max(dot(reflected, toEye), 0.0), 32);
+    vec3 specular = lightColor * specularStrength * amount;
+
+    return diffuse + specular;
+#else
+    return diffuse;
+#endif
+}
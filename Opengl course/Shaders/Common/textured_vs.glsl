@@ -0,0 +1,14 @@
+// position + texture coords with the usual model / viewProjection transform, used by the Ch9 and Ch10 chapters
+#include "transforms.glsl"
+
+layout (location = 0) in vec3 pos;
+layout (location = 1) in vec2 texturecoords;
+
+// pass these along to fragment shader
+out vec2 texturecoord;
+
+void main() {
+	gl_Position = viewProjection * (model * vec4(pos, 1.0f));
+
+	texturecoord = texturecoords;
+}
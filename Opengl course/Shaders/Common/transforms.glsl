@@ -0,0 +1,4 @@
+// transform uniforms every lit/3D vertex shader uses, filled in by Shader::setViewProjection() / setModel()
+uniform mat4 model;
+uniform mat4 viewProjection; // projection * view, already multiplied on the CPU
+uniform mat3 normalMatrix; // transpose(inverse(mat3(model))), also done on the CPU (once per object, not per vertex)
@@ -0,0 +1,102 @@
+// tool: renders the chapter scenes on the CPU (software_rasterizer.h, software_scenes.h) and writes them out as
+// PNGs, for machines without a GPU and for timing the rasterizer. no window or GL context needed. usage:
+//   SoftwareRender [scene|all] [-time t] [-size WxH] [-threads n] [-frames n] [-out dir]
+// -time is what glfwGetTime() would return (0 by default), -frames renders that many times and prints the
+// average, -threads 1 gives the single threaded time to compare with
+
+#include <iostream>
+#include <string>
+#include <chrono>
+#include <cstring>
+#include <cstdlib>
+#include <cstdio>
+// stb_image.h comes in through software_rasterizer.h, its implementation goes in this file
+#define STB_IMAGE_IMPLEMENTATION
+#include "software_rasterizer.h"
+#include "software_scenes.h"
+#include "image_write.h"
+
+double millisecondsSince(std::chrono::high_resolution_clock::time_point start)
+{
+	return std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+}
+
+int main(int argc, char** argv)
+{
+	std::string sceneName = "all", outputDirectory = ".";
+	float time = 0.0f;
+	int width = 800, height = 600, frames = 1;
+	unsigned int threads = 0;
+	for (int i = 1; i < argc; i++)
+	{
+		bool hasValue = i + 1 < argc;
+		if (std::strcmp(argv[i], "-time") == 0 && hasValue)
+			time = (float)std::atof(argv[++i]);
+		else if (std::strcmp(argv[i], "-size") == 0 && hasValue)
+		{
+			if (std::sscanf(argv[++i], "%dx%d", &width, &height) != 2 || width <= 0 || height <= 0)
+			{
+				std::cout << "bad size " << argv[i] << ", expected WxH" << std::endl;
+				return 1;
+			}
+		}
+		else if (std::strcmp(argv[i], "-threads") == 0 && hasValue)
+			threads = (unsigned int)std::atoi(argv[++i]);
+		else if (std::strcmp(argv[i], "-frames") == 0 && hasValue)
+			frames = std::max(std::atoi(argv[++i]), 1);
+		else if (std::strcmp(argv[i], "-out") == 0 && hasValue)
+			outputDirectory = argv[++i];
+		else if (argv[i][0] != '-')
+			sceneName = argv[i];
+		else
+		{
+			std::cout << "usage: SoftwareRender [scene|all] [-time t] [-size WxH] [-threads n] [-frames n] [-out dir]" << std::endl;
+			return 1;
+		}
+	}
+
+	std::vector<const SoftwareScene*> scenes;
+	if (sceneName == "all")
+	{
+		for (const SoftwareScene& scene : SoftwareScenes::all())
+			scenes.push_back(&scene);
+	}
+	else if (const SoftwareScene* scene = SoftwareScenes::find(sceneName))
+		scenes.push_back(scene);
+	else
+	{
+		std::cout << "no scene called " << sceneName << ", there's:" << std::endl;
+		for (const SoftwareScene& scene : SoftwareScenes::all())
+			std::cout << "  " << scene.name << std::endl;
+		return 1;
+	}
+
+	// paths are relative like in the chapters, run it from the project directory
+	SoftwareSceneAssets assets;
+	if (!assets.load())
+		return 1;
+
+	SoftwareRasterizer raster(width, height, threads);
+	std::cout << width << "x" << height << ", " << raster.threads() << " threads, " << SOFTWARE_RASTERIZER_SIMD << std::endl;
+	std::vector<unsigned char> pixels;
+	for (const SoftwareScene* scene : scenes)
+	{
+		raster.resetStats();
+		auto start = std::chrono::high_resolution_clock::now();
+		for (int frame = 0; frame < frames; frame++)
+			scene->render(raster, assets, time);
+		double ms = millisecondsSince(start) / frames;
+
+		std::string path = outputDirectory + "/" + scene->name + ".png";
+		raster.readPixels(pixels);
+		// the window ignores alpha (Ch13 clears with 0.2), so keep RGB only and the PNG looks like the window
+		for (size_t pixel = 0; pixel < (size_t)width * height; pixel++)
+			for (int c = 0; c < 3; c++)
+				pixels[pixel * 3 + c] = pixels[pixel * 4 + c];
+		if (!ImageWriter::writePng(path, width, height, 3, pixels.data()))
+			return 1;
+		std::cout << scene->name << ": " << ms << " ms, " << raster.setUpTriangles() / frames << " of "
+			<< raster.submittedTriangles() / frames << " triangles on screen -> " << path << std::endl;
+	}
+	return 0;
+}
@@ -0,0 +1,184 @@
+#ifndef BATCH_RENDERER_H
+#define BATCH_RENDERER_H
+
+#include <glad/glad.h>
+#include <glfw3.h>
+
+#include <vector>
+#include <thread>
+#include <chrono>
+#include <functional>
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+
+// What a batch renders. begin()/end() run once per context on its worker thread, for the objects GL never
+// shares between contexts (VAOs, framebuffers) and for context state (bound textures, the program in use).
+// render() draws one frame into the framebuffer that's bound, frameDone() gets its pixels (RGBA, top row
+// first) and is called from every worker at once, so it has to be thread safe.
+class BatchJob
+{
+public:
+    virtual ~BatchJob() = default;
+    virtual void begin(int worker) {}
+    virtual void render(int worker, int frame) = 0;
+    virtual void frameDone(int worker, int frame, const unsigned char* pixels) {}
+    virtual void end(int worker) {}
+};
+
+struct BatchResult
+{
+    int threads = 0;
+    int frames = 0;
+    double seconds = 0.0;
+
+    double framesPerSecond() const { return seconds > 0.0 ? frames / seconds : 0.0; }
+};
+
+// Renders lots of frames offline on several GL contexts at once.
+// Every context is a hidden GLFW window sharing objects with the main one, so textures, buffers and programs
+// made on the main context are usable everywhere without loading them N times. run() gives each thread a
+// disjoint range of frames; the thread renders them into its own framebuffer and reads them back.
+// The readback is double buffered through two PBOs, so frame N's pixels are fetched while frame N+1 is drawing.
+//
+// Shared objects should only be read by the workers. A program's uniforms are part of the program, so two
+// contexts setting them at once would trample each other. Per frame data goes in a uniform block with a
+// buffer per context (binding points are context state), and the samplers get set once up front.
+//
+// GLFW wants windows made on the main thread, so the contexts are made in the constructor and the workers only
+// make them current. glad's function pointers are loaded once for the main context; that's fine as long as
+// every context is from the same driver, which sharing objects requires anyway.
+class BatchRenderer
+{
+public:
+    // uses the window hints in effect, so the contexts match the main one (same GL version, profile)
+    BatchRenderer(GLFWwindow* share, int contextCount, int width, int height) : width(width), height(height)
+    {
+        glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+        for (int i = 0; i < contextCount; i++)
+        {
+            GLFWwindow* context = glfwCreateWindow(16, 16, "batch", NULL, share);
+            if (!context)
+            {
+                std::cout << "ERROR::BATCH_RENDERER::CONTEXT_CREATION_FAILED only got " << i << " of " << contextCount << std::endl;
+                break;
+            }
+            windows.push_back(context);
+        }
+        glfwWindowHint(GLFW_VISIBLE, GLFW_TRUE);
+    }
+    ~BatchRenderer()
+    {
+        for (GLFWwindow* context : windows)
+            glfwDestroyWindow(context);
+    }
+    BatchRenderer(const BatchRenderer&) = delete;
+    BatchRenderer& operator=(const BatchRenderer&) = delete;
+
+    int contexts() const { return (int)windows.size(); }
+
+    // renders frames 0..frameCount-1 on threadCount contexts (at most contexts()). call it on the main thread,
+    // with everything the job shares finished being made
+    // ------------------------------------------------------------------------
+    BatchResult run(BatchJob& job, int threadCount, int frameCount)
+    {
+        BatchResult result;
+        result.threads = std::min(std::max(threadCount, 1), contexts());
+        result.frames = frameCount;
+        if (result.threads == 0)
+            return result;
+        // objects made on one context are only safe to use on another once the commands that made them are done
+        glFinish();
+
+        auto start = std::chrono::high_resolution_clock::now();
+        std::vector<std::thread> threads;
+        for (int worker = 0; worker < result.threads; worker++)
+        {
+            int first = (int)((long long)frameCount * worker / result.threads);
+            int last = (int)((long long)frameCount * (worker + 1) / result.threads);
+            threads.emplace_back(&BatchRenderer::work, this, std::ref(job), worker, first, last);
+        }
+        for (std::thread& thread : threads)
+            thread.join();
+        result.seconds = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+        return result;
+    }
+
+private:
+    std::vector<GLFWwindow*> windows;
+    int width, height;
+
+    // one worker: frames [first, last) on context `worker`
+    void work(BatchJob& job, int worker, int first, int last)
+    {
+        glfwMakeContextCurrent(windows[worker]);
+
+        // framebuffers aren't shared, every context makes its own
+        unsigned int fbo, color, depth;
+        glGenFramebuffers(1, &fbo);
+        glGenRenderbuffers(1, &color);
+        glGenRenderbuffers(1, &depth);
+        glBindRenderbuffer(GL_RENDERBUFFER, color);
+        glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width, height);
+        glBindRenderbuffer(GL_RENDERBUFFER, depth);
+        glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, width, height);
+        glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+        glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, color);
+        glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, depth);
+        if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+            std::cout << "ERROR::BATCH_RENDERER::FRAMEBUFFER_INCOMPLETE" << std::endl;
+
+        size_t stride = (size_t)width * 4, size = stride * height;
+        unsigned int pbos[2];
+        glGenBuffers(2, pbos);
+        for (unsigned int pbo : pbos)
+        {
+            glBindBuffer(GL_PIXEL_PACK_BUFFER, pbo);
+            glBufferData(GL_PIXEL_PACK_BUFFER, size, nullptr, GL_STREAM_READ);
+        }
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+        std::vector<unsigned char> pixels(size);
+
+        // maps a finished readback and hands it to the job
+        auto deliver = [&](int frame)
+        {
+            glBindBuffer(GL_PIXEL_PACK_BUFFER, pbos[frame % 2]);
+            const unsigned char* mapped = (const unsigned char*)glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, size, GL_MAP_READ_BIT);
+            if (mapped)
+            {
+                for (int y = 0; y < height; y++)
+                    std::memcpy(&pixels[(size_t)y * stride], mapped + (size_t)(height - 1 - y) * stride, stride);
+                glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+            }
+            glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+            job.frameDone(worker, frame, pixels.data());
+        };
+
+        job.begin(worker);
+        for (int frame = first; frame < last; frame++)
+        {
+            glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+            glViewport(0, 0, width, height);
+            job.render(worker, frame);
+            glBindFramebuffer(GL_READ_FRAMEBUFFER, fbo);
+            glBindBuffer(GL_PIXEL_PACK_BUFFER, pbos[frame % 2]);
+            glPixelStorei(GL_PACK_ALIGNMENT, 4);
+            glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+            glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+            // the frame before this one has had a whole frame's drawing to finish its copy
+            if (frame > first)
+                deliver(frame - 1);
+        }
+        if (last > first)
+            deliver(last - 1);
+        job.end(worker);
+
+        glDeleteBuffers(2, pbos);
+        glDeleteRenderbuffers(1, &color);
+        glDeleteRenderbuffers(1, &depth);
+        glDeleteFramebuffers(1, &fbo);
+        glFinish();
+        glfwMakeContextCurrent(NULL);
+    }
+};
+#endif
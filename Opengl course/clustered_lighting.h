@@ -0,0 +1,230 @@
+#ifndef CLUSTERED_LIGHTING_H
+#define CLUSTERED_LIGHTING_H
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <vector>
+#include <cmath>
+#include <algorithm>
+
+// one point light, laid out the same way as the std430 struct in the fragment shader
+struct PointLight
+{
+    glm::vec4 positionRadius; // xyz = world space position, w = radius where the light fades out to 0
+    glm::vec4 color;          // rgb = color, a unused (keeps it 16 byte aligned)
+};
+
+// Clustered forward lighting.
+// The view frustum is cut into a grid of "froxels" (tilesX * tilesY screen tiles, times depthSlices
+// slices along z, spaced exponentially so near slices are thin). Every frame the CPU works out which
+// lights touch which cluster and uploads three SSBOs:
+//   binding 0: all lights
+//   binding 1: per cluster (offset, count) into the index list
+//   binding 2: the index list itself
+// The fragment shader figures out its cluster from gl_FragCoord and only loops over those lights.
+class ClusteredLighting
+{
+public:
+    unsigned int tilesX, tilesY, depthSlices;
+
+    ClusteredLighting(unsigned int tilesX = 16, unsigned int tilesY = 9, unsigned int depthSlices = 24)
+        : tilesX(tilesX), tilesY(tilesY), depthSlices(depthSlices)
+    {
+        glGenBuffers(3, buffers);
+    }
+    ~ClusteredLighting()
+    {
+        release();
+    }
+    // deletes the buffers, while the context is still around
+    // ------------------------------------------------------------------------
+    void release()
+    {
+        // already released, the destructor can run after glfwTerminate
+        if (buffers[0] == 0)
+            return;
+        glDeleteBuffers(3, buffers);
+        buffers[0] = buffers[1] = buffers[2] = 0;
+    }
+    // recompute the cluster bounds, only needed when the projection (fov, aspect, near/far) changes
+    // ------------------------------------------------------------------------
+    void setProjection(const glm::mat4& projection, float nearPlane, float farPlane)
+    {
+        zNear = nearPlane;
+        zFar = farPlane;
+        this->projection = projection;
+        glm::mat4 inverseProjection = glm::inverse(projection);
+
+        clusterMin.resize(clusterCount());
+        clusterMax.resize(clusterCount());
+        for (unsigned int z = 0; z < depthSlices; z++)
+        {
+            float sliceNear = sliceDepth(z);
+            float sliceFar = sliceDepth(z + 1);
+            for (unsigned int y = 0; y < tilesY; y++)
+            {
+                for (unsigned int x = 0; x < tilesX; x++)
+                {
+                    // tile corners in NDC, turned into view space rays that hit z = -1
+                    glm::vec2 ndcMin(-1.0f + 2.0f * x / tilesX, -1.0f + 2.0f * y / tilesY);
+                    glm::vec2 ndcMax(-1.0f + 2.0f * (x + 1) / tilesX, -1.0f + 2.0f * (y + 1) / tilesY);
+                    glm::vec3 lo(1e30f), hi(-1e30f);
+                    for (int corner = 0; corner < 4; corner++)
+                    {
+                        glm::vec2 ndc((corner & 1) ? ndcMax.x : ndcMin.x, (corner & 2) ? ndcMax.y : ndcMin.y);
+                        glm::vec4 p = inverseProjection * glm::vec4(ndc, -1.0f, 1.0f);
+                        glm::vec3 ray = glm::vec3(p) / p.w;
+                        ray /= -ray.z;
+                        glm::vec3 a = ray * sliceNear;
+                        glm::vec3 b = ray * sliceFar;
+                        lo = glm::min(lo, glm::min(a, b));
+                        hi = glm::max(hi, glm::max(a, b));
+                    }
+                    unsigned int index = clusterIndex(x, y, z);
+                    clusterMin[index] = lo;
+                    clusterMax[index] = hi;
+                }
+            }
+        }
+    }
+    // assign lights to clusters and upload everything. view is the camera view matrix for this frame
+    // ------------------------------------------------------------------------
+    void update(const std::vector<PointLight>& lights, const glm::mat4& view)
+    {
+        pairs.clear();
+        counts.assign(clusterCount(), 0);
+
+        for (unsigned int i = 0; i < lights.size(); i++)
+        {
+            glm::vec3 center = glm::vec3(view * glm::vec4(glm::vec3(lights[i].positionRadius), 1.0f));
+            float radius = lights[i].positionRadius.w;
+
+            // depth range (view space looks down -z, so depth = -z)
+            float depthMin = -center.z - radius;
+            float depthMax = -center.z + radius;
+            if (depthMax < zNear || depthMin > zFar)
+                continue;
+            unsigned int zFirst = sliceIndex(depthMin);
+            unsigned int zLast = sliceIndex(depthMax);
+
+            // screen tile range from projecting the light's bounding box.
+            // if the box pokes behind the near plane the projection breaks down, so just take every tile
+            unsigned int xFirst = 0, xLast = tilesX - 1, yFirst = 0, yLast = tilesY - 1;
+            if (depthMin > zNear)
+            {
+                glm::vec2 lo(1e30f), hi(-1e30f);
+                for (int corner = 0; corner < 8; corner++)
+                {
+                    glm::vec3 p = center + glm::vec3((corner & 1) ? radius : -radius, (corner & 2) ? radius : -radius, (corner & 4) ? radius : -radius);
+                    glm::vec4 clip = projection * glm::vec4(p, 1.0f);
+                    glm::vec2 ndc = glm::vec2(clip.x, clip.y) / clip.w;
+                    lo = glm::vec2(std::min(lo.x, ndc.x), std::min(lo.y, ndc.y));
+                    hi = glm::vec2(std::max(hi.x, ndc.x), std::max(hi.y, ndc.y));
+                }
+                if (hi.x < -1.0f || lo.x > 1.0f || hi.y < -1.0f || lo.y > 1.0f)
+                    continue;
+                xFirst = tileIndex(lo.x, tilesX);
+                xLast = tileIndex(hi.x, tilesX);
+                yFirst = tileIndex(lo.y, tilesY);
+                yLast = tileIndex(hi.y, tilesY);
+            }
+
+            // the ranges above are conservative, the sphere vs cluster box test trims the corners
+            for (unsigned int z = zFirst; z <= zLast; z++)
+                for (unsigned int y = yFirst; y <= yLast; y++)
+                    for (unsigned int x = xFirst; x <= xLast; x++)
+                    {
+                        unsigned int cluster = clusterIndex(x, y, z);
+                        if (sphereTouchesBox(center, radius, clusterMin[cluster], clusterMax[cluster]))
+                        {
+                            pairs.push_back(glm::uvec2(cluster, i));
+                            counts[cluster]++;
+                        }
+                    }
+        }
+
+        // counts -> (offset, count) per cluster, then drop every light index in its slot
+        grid.resize(clusterCount() * 2);
+        unsigned int offset = 0;
+        for (unsigned int c = 0; c < clusterCount(); c++)
+        {
+            grid[c * 2 + 0] = offset;
+            grid[c * 2 + 1] = 0;
+            offset += counts[c];
+        }
+        indices.resize(std::max(offset, 1u));
+        for (const glm::uvec2& pair : pairs)
+        {
+            unsigned int& count = grid[pair.x * 2 + 1];
+            indices[grid[pair.x * 2 + 0] + count] = pair.y;
+            count++;
+        }
+        lightAssignments = offset;
+
+        // orphan + refill every frame so we don't wait on last frame's draws still reading the old data
+        upload(0, lights.empty() ? nullptr : lights.data(), std::max<size_t>(lights.size(), 1) * sizeof(PointLight));
+        upload(1, grid.data(), grid.size() * sizeof(unsigned int));
+        upload(2, indices.data(), indices.size() * sizeof(unsigned int));
+    }
+    // bind the SSBOs and the uniforms the fragment shader needs to find its cluster. shader has to be in use
+    // ------------------------------------------------------------------------
+    void bind(unsigned int program, int screenWidth, int screenHeight) const
+    {
+        for (unsigned int i = 0; i < 3; i++)
+            glBindBufferBase(GL_SHADER_STORAGE_BUFFER, i, buffers[i]);
+        glUniform3ui(glGetUniformLocation(program, "clusterCounts"), tilesX, tilesY, depthSlices);
+        glUniform2f(glGetUniformLocation(program, "tileSize"), (float)screenWidth / tilesX, (float)screenHeight / tilesY);
+        glUniform1f(glGetUniformLocation(program, "zNear"), zNear);
+        glUniform1f(glGetUniformLocation(program, "zFar"), zFar);
+    }
+    // ------------------------------------------------------------------------
+    unsigned int clusterCount() const { return tilesX * tilesY * depthSlices; }
+    // total number of (cluster, light) entries from the last update, i.e. how many lights get evaluated per cluster summed up
+    unsigned int assignments() const { return lightAssignments; }
+
+private:
+    unsigned int buffers[3] = { 0, 0, 0 };
+    float zNear = 0.1f, zFar = 100.0f;
+    glm::mat4 projection = glm::mat4(1.0f);
+    std::vector<glm::vec3> clusterMin, clusterMax;
+    std::vector<glm::uvec2> pairs;
+    std::vector<unsigned int> counts, grid, indices;
+    unsigned int lightAssignments = 0;
+
+    unsigned int clusterIndex(unsigned int x, unsigned int y, unsigned int z) const
+    {
+        return (z * tilesY + y) * tilesX + x;
+    }
+    // view space depth where slice k starts, same formula as the fragment shader uses in reverse
+    float sliceDepth(unsigned int k) const
+    {
+        return zNear * std::pow(zFar / zNear, (float)k / depthSlices);
+    }
+    unsigned int sliceIndex(float depth) const
+    {
+        depth = glm::clamp(depth, zNear, zFar);
+        int k = (int)std::floor(std::log(depth / zNear) / std::log(zFar / zNear) * depthSlices);
+        return (unsigned int)glm::clamp(k, 0, (int)depthSlices - 1);
+    }
+    static unsigned int tileIndex(float ndc, unsigned int tiles)
+    {
+        int t = (int)std::floor((ndc * 0.5f + 0.5f) * tiles);
+        return (unsigned int)glm::clamp(t, 0, (int)tiles - 1);
+    }
+    static bool sphereTouchesBox(const glm::vec3& center, float radius, const glm::vec3& lo, const glm::vec3& hi)
+    {
+        glm::vec3 closest = glm::clamp(center, lo, hi);
+        glm::vec3 d = center - closest;
+        return glm::dot(d, d) <= radius * radius;
+    }
+    void upload(unsigned int binding, const void* data, size_t bytes)
+    {
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, buffers[binding]);
+        glBufferData(GL_SHADER_STORAGE_BUFFER, bytes, nullptr, GL_STREAM_DRAW);
+        if (data)
+            glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, bytes, data);
+    }
+};
+#endif
@@ -0,0 +1,220 @@
+#ifndef CPU_PROFILER_H
+#define CPU_PROFILER_H
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <cstdint>
+#include <iostream>
+
+// 1 records PROFILE_SCOPE()s, 0 compiles them out completely
+#ifndef CPU_PROFILER_ENABLED
+#define CPU_PROFILER_ENABLED 1
+#endif
+
+// the timestamp counter is a single instruction, steady_clock is a call that can cost 20+ ns. the counter
+// is only trusted on x86, where every CPU of the last 15 years ticks it at a constant rate
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#define CPU_PROFILER_RDTSC
+#elif (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#include <x86intrin.h>
+#define CPU_PROFILER_RDTSC
+#endif
+
+// Scoped CPU timing, saved as a Chrome trace (chrome://tracing or ui.perfetto.dev).
+//
+//   PROFILE_SCOPE("draw");                      // times from here to the end of the enclosing block
+//   CpuProfiler::writeChromeTrace("trace.json"); // once at the end, or whenever the loop isn't running
+//
+// Every thread records into its own fixed size ring of events, so recording never takes a lock or allocates:
+// two timestamps and a store. The ring keeps the last EVENTS_PER_THREAD scopes, which is the last few
+// thousand frames of a chapter, and writeChromeTrace() saves those. Names have to be string literals (only
+// the pointer is kept). Threads show up as "thread 0", "thread 1"... in the order they first recorded
+// something, unless named with setThreadName(). Writing a trace while other threads are still recording
+// can catch an event being overwritten, so do it when they're done.
+class CpuProfiler
+{
+public:
+    static const size_t EVENTS_PER_THREAD = 1 << 16;
+
+    struct Event
+    {
+        const char* name;
+        uint64_t start, end;    // ticks()
+    };
+
+    // ------------------------------------------------------------------------
+    static uint64_t ticks()
+    {
+#if defined(CPU_PROFILER_RDTSC)
+        return __rdtsc();
+#else
+        return (uint64_t)std::chrono::steady_clock::now().time_since_epoch().count();
+#endif
+    }
+    // ------------------------------------------------------------------------
+    static void record(const char* name, uint64_t start, uint64_t end)
+    {
+        ThreadBuffer& buffer = threadBuffer();
+        uint64_t index = buffer.written.load(std::memory_order_relaxed);
+        buffer.events[index % EVENTS_PER_THREAD] = { name, start, end };
+        buffer.written.store(index + 1, std::memory_order_release);
+    }
+    // shows up as the thread's name in the trace viewer
+    // ------------------------------------------------------------------------
+    static void setThreadName(const std::string& name)
+    {
+        ThreadBuffer& buffer = threadBuffer();
+        std::lock_guard<std::mutex> lock(registry().mutex);
+        buffer.name = name;
+    }
+    // steady_clock counts nanoseconds (on every platform we build on), the timestamp counter gets measured
+    // against it over the time the program has been running
+    // ------------------------------------------------------------------------
+    static double ticksPerMicrosecond()
+    {
+#if defined(CPU_PROFILER_RDTSC)
+        Registry& r = registry();
+        double micros = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - r.startTime).count();
+        uint64_t elapsed = ticks() - r.startTicks;
+        return micros > 1000.0 ? elapsed / micros : 1000.0;
+#else
+        return std::chrono::steady_clock::period::den / (1e6 * std::chrono::steady_clock::period::num);
+#endif
+    }
+
+    // one track of events for the trace, e.g. the GPU's (see gpu_profiler.h)
+    struct Track
+    {
+        std::string name;
+        std::vector<Event> events;
+    };
+    // every thread's recorded scopes (and any extra tracks) as Chrome trace event JSON
+    // ------------------------------------------------------------------------
+    static bool writeChromeTrace(const std::string& path, const std::vector<Track>& extraTracks = {})
+    {
+        std::vector<Track> tracks;
+        {
+            Registry& r = registry();
+            std::lock_guard<std::mutex> lock(r.mutex);
+            for (size_t i = 0; i < r.buffers.size(); i++)
+            {
+                const ThreadBuffer& buffer = *r.buffers[i];
+                Track track;
+                track.name = buffer.name.empty() ? "thread " + std::to_string(i) : buffer.name;
+                uint64_t written = buffer.written.load(std::memory_order_acquire);
+                uint64_t first = written > EVENTS_PER_THREAD ? written - EVENTS_PER_THREAD : 0;
+                for (uint64_t e = first; e < written; e++)
+                    track.events.push_back(buffer.events[e % EVENTS_PER_THREAD]);
+                tracks.push_back(std::move(track));
+            }
+        }
+        tracks.insert(tracks.end(), extraTracks.begin(), extraTracks.end());
+
+        std::ofstream file(path, std::ios::trunc);
+        if (!file)
+        {
+            std::cout << "ERROR::CPU_PROFILER::CANNOT_WRITE " << path << std::endl;
+            return false;
+        }
+        // ticks to microseconds since the profiler started, what the trace format wants
+        double perMicrosecond = ticksPerMicrosecond();
+        uint64_t startTicks = registry().startTicks;
+        size_t eventCount = 0;
+        file << std::fixed << std::setprecision(3);
+        file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+        for (size_t tid = 0; tid < tracks.size(); tid++)
+        {
+            // metadata event naming the track
+            file << (tid ? ",\n" : "") << "{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":1,\"tid\":" << tid
+                << ",\"args\":{\"name\":\"" << escape(tracks[tid].name) << "\"}}";
+            for (const Event& event : tracks[tid].events)
+            {
+                // a complete event: start and duration in microseconds
+                file << ",\n{\"ph\":\"X\",\"pid\":1,\"tid\":" << tid << ",\"name\":\"" << escape(event.name) << "\",\"ts\":"
+                    << (double)(int64_t)(event.start - startTicks) / perMicrosecond << ",\"dur\":" << (double)(event.end - event.start) / perMicrosecond << "}";
+                eventCount++;
+            }
+        }
+        file << "\n]}\n";
+        std::cout << "cpu profiler: " << eventCount << " events in " << tracks.size() << " tracks written to " << path << std::endl;
+        return (bool)file;
+    }
+
+private:
+    struct ThreadBuffer
+    {
+        std::unique_ptr<Event[]> events{ new Event[EVENTS_PER_THREAD] };
+        std::atomic<uint64_t> written{ 0 };
+        std::string name;
+    };
+    struct Registry
+    {
+        std::mutex mutex;
+        // never freed before exit, so a thread's events outlive the thread
+        std::vector<std::unique_ptr<ThreadBuffer>> buffers;
+        uint64_t startTicks = ticks();
+        std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+    };
+    static Registry& registry()
+    {
+        static Registry r;
+        return r;
+    }
+    // the first scope on a thread registers its buffer, the only time recording locks
+    static ThreadBuffer& threadBuffer()
+    {
+        thread_local ThreadBuffer* buffer = nullptr;
+        if (!buffer)
+        {
+            Registry& r = registry();
+            std::lock_guard<std::mutex> lock(r.mutex);
+            r.buffers.emplace_back(new ThreadBuffer());
+            buffer = r.buffers.back().get();
+        }
+        return *buffer;
+    }
+    static std::string escape(const std::string& text)
+    {
+        std::string out;
+        for (char c : text)
+        {
+            if (c == '"' || c == '\\')
+                out += '\\';
+            out += c;
+        }
+        return out;
+    }
+};
+
+// records the time between construction and destruction
+class CpuProfileScope
+{
+public:
+    explicit CpuProfileScope(const char* name) : name(name), start(CpuProfiler::ticks()) {}
+    ~CpuProfileScope()
+    {
+        CpuProfiler::record(name, start, CpuProfiler::ticks());
+    }
+    CpuProfileScope(const CpuProfileScope&) = delete;
+    CpuProfileScope& operator=(const CpuProfileScope&) = delete;
+
+private:
+    const char* name;
+    uint64_t start;
+};
+
+#define CPU_PROFILER_CONCAT_(a, b) a##b
+#define CPU_PROFILER_CONCAT(a, b) CPU_PROFILER_CONCAT_(a, b)
+#if CPU_PROFILER_ENABLED
+#define PROFILE_SCOPE(name) CpuProfileScope CPU_PROFILER_CONCAT(profileScope, __LINE__)(name)
+#else
+#define PROFILE_SCOPE(name) do {} while (0)
+#endif
+#endif
@@ -0,0 +1,285 @@
+#ifndef FRAME_CAPTURE_H
+#define FRAME_CAPTURE_H
+
+#include <glad/glad.h>
+
+#include "image_write.h"
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <atomic>
+#include <filesystem>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+
+#if defined(_WIN32)
+#define FRAME_CAPTURE_POPEN(command) _popen(command, "wb")
+#define FRAME_CAPTURE_PCLOSE _pclose
+#else
+#define FRAME_CAPTURE_POPEN(command) popen(command, "w")
+#define FRAME_CAPTURE_PCLOSE pclose
+#endif
+
+// Records what a chapter draws, at full frame rate.
+// glReadPixels straight into client memory waits for the GPU to finish the frame, and then for the copy,
+// every frame. Here it reads into a pixel pack buffer instead, which only queues the copy, and puts a fence
+// after it. A few frames later (the ring has PBO_COUNT buffers) the fence has long signaled, so mapping the
+// buffer doesn't wait on anything. The pixels get flipped to top row first on the way out of the mapping,
+// and worker threads take it from there:
+//   startPngSequence(dir)    frame_00000.png, frame_00001.png, ... one thread per core, frames are independent
+//   startPipe(command)       raw RGBA frames written to the stdin of a command (an encoder, see ffmpegCommand)
+//
+// Call capture() once a frame after drawing and before glfwSwapBuffers. If the workers fall behind by more
+// than MAX_QUEUED frames the new frame gets dropped (and counted) rather than stalling the render loop, and
+// the same goes for the GPU: if the oldest readback still isn't done when its buffer comes round again, that
+// one wait is counted as a stall. stop() drains everything and prints the counts.
+class FrameCapture
+{
+public:
+    static const int PBO_COUNT = 3;
+    static const size_t MAX_QUEUED = 16;
+
+    FrameCapture() = default;
+    ~FrameCapture()
+    {
+        stop();
+    }
+    FrameCapture(const FrameCapture&) = delete;
+    FrameCapture& operator=(const FrameCapture&) = delete;
+
+    // the capture size is the framebuffer size at start, later capture() calls read that rectangle
+    // ------------------------------------------------------------------------
+    bool startPngSequence(const std::string& directory, int width, int height)
+    {
+        stop();
+        std::error_code error;
+        std::filesystem::create_directories(directory, error);
+        if (error)
+        {
+            std::cout << "ERROR::FRAME_CAPTURE::CANNOT_CREATE " << directory << std::endl;
+            return false;
+        }
+        outputDirectory = directory;
+        unsigned int workers = std::max(std::thread::hardware_concurrency(), 2u) - 1;
+        return start(width, height, workers);
+    }
+    // ------------------------------------------------------------------------
+    bool startPipe(const std::string& command, int width, int height)
+    {
+        stop();
+        pipe = FRAME_CAPTURE_POPEN(command.c_str());
+        if (!pipe)
+        {
+            std::cout << "ERROR::FRAME_CAPTURE::CANNOT_RUN " << command << std::endl;
+            return false;
+        }
+        // one writer, the frames have to go in in order
+        return start(width, height, 1);
+    }
+    // an ffmpeg command line for startPipe that turns the raw frames into a video file
+    // ------------------------------------------------------------------------
+    static std::string ffmpegCommand(int width, int height, int framesPerSecond, const std::string& outputFile)
+    {
+        return "ffmpeg -y -loglevel error -f rawvideo -pix_fmt rgba -s " + std::to_string(width) + "x" + std::to_string(height)
+            + " -r " + std::to_string(framesPerSecond) + " -i - -pix_fmt yuv420p \"" + outputFile + "\"";
+    }
+
+    // queues a readback of the frame just drawn, and hands any finished ones to the workers
+    // ------------------------------------------------------------------------
+    void capture()
+    {
+        if (!active)
+            return;
+        // everything that's done already, oldest first
+        while (pendingCount > 0 && isSignaled(slots[oldest].fence))
+            collect(false);
+        // the ring is full, the oldest readback is still going and we need its buffer
+        if (pendingCount == PBO_COUNT)
+        {
+            stalls++;
+            collect(true);
+        }
+        int slot = (oldest + pendingCount) % PBO_COUNT;
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, slots[slot].buffer);
+        glPixelStorei(GL_PACK_ALIGNMENT, 4);
+        glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+        slots[slot].fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        slots[slot].frame = framesRead++;
+        pendingCount++;
+    }
+    // waits for the readbacks in flight and for the workers to write everything out
+    // ------------------------------------------------------------------------
+    void stop()
+    {
+        if (!active)
+            return;
+        while (pendingCount > 0)
+            collect(true);
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        queueChanged.notify_all();
+        for (std::thread& worker : workers)
+            worker.join();
+        workers.clear();
+        for (Slot& slot : slots)
+            glDeleteBuffers(1, &slot.buffer);
+        if (pipe)
+            FRAME_CAPTURE_PCLOSE(pipe);
+        pipe = nullptr;
+        active = false;
+        std::cout << "capture: " << framesWritten << " frames written, " << framesDropped << " dropped, " << stalls << " stalls waiting for the GPU" << std::endl;
+    }
+    // ------------------------------------------------------------------------
+    bool capturing() const { return active; }
+    unsigned long long written() const { return framesWritten; }
+    unsigned long long dropped() const { return framesDropped; }
+
+private:
+    struct Slot
+    {
+        unsigned int buffer = 0;
+        GLsync fence = nullptr;
+        unsigned long long frame = 0;
+    };
+    struct Frame
+    {
+        unsigned long long index;
+        std::vector<unsigned char> pixels;  // RGBA, top row first
+    };
+
+    Slot slots[PBO_COUNT];
+    int oldest = 0, pendingCount = 0;
+    int width = 0, height = 0;
+    bool active = false;
+    unsigned long long framesRead = 0, stalls = 0;
+    std::string outputDirectory;
+    FILE* pipe = nullptr;
+    std::vector<std::thread> workers;
+    // shared with the workers
+    std::mutex mutex;
+    std::condition_variable queueChanged;
+    std::deque<Frame> queue;
+    std::vector<std::vector<unsigned char>> freeBuffers;   // pixel buffers to reuse, so there's no allocating per frame
+    bool stopping = false;
+    std::atomic<unsigned long long> framesWritten{ 0 }, framesDropped{ 0 };
+
+    bool start(int captureWidth, int captureHeight, unsigned int workerCount)
+    {
+        width = captureWidth;
+        height = captureHeight;
+        oldest = pendingCount = 0;
+        framesRead = stalls = 0;
+        framesWritten = framesDropped = 0;
+        stopping = false;
+        for (Slot& slot : slots)
+        {
+            glGenBuffers(1, &slot.buffer);
+            glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.buffer);
+            glBufferData(GL_PIXEL_PACK_BUFFER, (size_t)width * height * 4, nullptr, GL_STREAM_READ);
+        }
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+        for (unsigned int i = 0; i < workerCount; i++)
+            workers.emplace_back(&FrameCapture::run, this);
+        active = true;
+        return true;
+    }
+    static bool isSignaled(GLsync fence)
+    {
+        GLenum result = glClientWaitSync(fence, 0, 0);
+        return result == GL_ALREADY_SIGNALED || result == GL_CONDITION_SATISFIED;
+    }
+    // maps the oldest readback (waiting for it if wait is set) and queues its pixels
+    void collect(bool wait)
+    {
+        Slot& slot = slots[oldest];
+        if (wait)
+            glClientWaitSync(slot.fence, GL_SYNC_FLUSH_COMMANDS_BIT, GL_TIMEOUT_IGNORED);
+        glDeleteSync(slot.fence);
+        slot.fence = nullptr;
+        oldest = (oldest + 1) % PBO_COUNT;
+        pendingCount--;
+
+        Frame frame;
+        frame.index = slot.frame;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (queue.size() >= MAX_QUEUED)
+            {
+                framesDropped++;
+                return;
+            }
+            if (!freeBuffers.empty())
+            {
+                frame.pixels.swap(freeBuffers.back());
+                freeBuffers.pop_back();
+            }
+        }
+        size_t stride = (size_t)width * 4;
+        frame.pixels.resize(stride * height);
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.buffer);
+        const unsigned char* mapped = (const unsigned char*)glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, stride * height, GL_MAP_READ_BIT);
+        if (mapped)
+        {
+            // GL's rows go bottom to top
+            for (int y = 0; y < height; y++)
+                std::memcpy(&frame.pixels[(size_t)y * stride], mapped + (size_t)(height - 1 - y) * stride, stride);
+            glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+        }
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+        if (!mapped)
+        {
+            framesDropped++;
+            return;
+        }
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            queue.push_back(std::move(frame));
+        }
+        queueChanged.notify_one();
+    }
+    // worker thread: writes frames until stop() and the queue is empty
+    void run()
+    {
+        while (true)
+        {
+            Frame frame;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                queueChanged.wait(lock, [this] { return stopping || !queue.empty(); });
+                if (queue.empty())
+                    return;
+                frame = std::move(queue.front());
+                queue.pop_front();
+            }
+            bool ok;
+            if (pipe)
+                ok = std::fwrite(frame.pixels.data(), 1, frame.pixels.size(), pipe) == frame.pixels.size();
+            else
+            {
+                // RGB only, the window ignores alpha and a PNG viewer wouldn't
+                size_t pixels = (size_t)width * height;
+                for (size_t i = 0; i < pixels; i++)
+                    for (int c = 0; c < 3; c++)
+                        frame.pixels[i * 3 + c] = frame.pixels[i * 4 + c];
+                char name[32];
+                std::snprintf(name, sizeof(name), "/frame_%05llu.png", frame.index);
+                ok = ImageWriter::writePng(outputDirectory + name, width, height, 3, frame.pixels.data());
+            }
+            if (ok)
+                framesWritten++;
+            else
+                framesDropped++;
+            std::lock_guard<std::mutex> lock(mutex);
+            freeBuffers.push_back(std::move(frame.pixels));
+        }
+    }
+};
+#endif
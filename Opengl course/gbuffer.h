@@ -0,0 +1,109 @@
+#ifndef GBUFFER_H
+#define GBUFFER_H
+
+#include <glad/glad.h>
+
+#include <iostream>
+
+// G-buffer for deferred shading, kept small on purpose (8 bytes of color targets per pixel):
+//   normal       GL_RG16F       octahedral encoded world space normal (2 numbers instead of 3 floats). RG16F
+//                               rather than RG16_SNORM, 3.3 core doesn't have to render to SNORM formats
+//   albedoSpec   GL_RGBA8       rgb = albedo, a = specular strength
+//   depth        GL_DEPTH24_STENCIL8 (texture, so the lighting pass can rebuild world position from it)
+// There's no position target at all, the lighting pass gets position back out of depth + inverse viewProjection.
+class GBuffer
+{
+public:
+    unsigned int FBO = 0;
+    unsigned int normalTexture = 0;
+    unsigned int albedoSpecTexture = 0;
+    unsigned int depthTexture = 0;
+    int width = 0, height = 0;
+
+    GBuffer(int width, int height)
+    {
+        glGenFramebuffers(1, &FBO);
+        resize(width, height);
+    }
+    ~GBuffer()
+    {
+        release();
+        if (FBO != 0)
+            glDeleteFramebuffers(1, &FBO);
+    }
+    // (re)create the attachments, call this from the framebuffer size callback
+    // ------------------------------------------------------------------------
+    void resize(int newWidth, int newHeight)
+    {
+        if (newWidth == width && newHeight == height)
+            return;
+        release();
+        width = newWidth;
+        height = newHeight;
+
+        glBindFramebuffer(GL_FRAMEBUFFER, FBO);
+        normalTexture = makeTexture(GL_RG16F, GL_RG, GL_FLOAT);
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, normalTexture, 0);
+        albedoSpecTexture = makeTexture(GL_RGBA8, GL_RGBA, GL_UNSIGNED_BYTE);
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT1, GL_TEXTURE_2D, albedoSpecTexture, 0);
+        depthTexture = makeTexture(GL_DEPTH24_STENCIL8, GL_DEPTH_STENCIL, GL_UNSIGNED_INT_24_8);
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_TEXTURE_2D, depthTexture, 0);
+
+        unsigned int attachments[2] = { GL_COLOR_ATTACHMENT0, GL_COLOR_ATTACHMENT1 };
+        glDrawBuffers(2, attachments);
+        if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+            std::cout << "ERROR::GBUFFER::FRAMEBUFFER_NOT_COMPLETE" << std::endl;
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    }
+    // geometry pass renders into the G-buffer
+    // ------------------------------------------------------------------------
+    void bindForGeometryPass() const
+    {
+        glBindFramebuffer(GL_FRAMEBUFFER, FBO);
+        glViewport(0, 0, width, height);
+    }
+    // lighting pass reads it: normal on unit 0, albedoSpec on unit 1, depth on unit 2
+    // ------------------------------------------------------------------------
+    void bindTextures() const
+    {
+        glActiveTexture(GL_TEXTURE0);
+        glBindTexture(GL_TEXTURE_2D, normalTexture);
+        glActiveTexture(GL_TEXTURE1);
+        glBindTexture(GL_TEXTURE_2D, albedoSpecTexture);
+        glActiveTexture(GL_TEXTURE2);
+        glBindTexture(GL_TEXTURE_2D, depthTexture);
+    }
+    // copy the G-buffer depth into the window's depth buffer so light volumes can be depth tested against the scene
+    // ------------------------------------------------------------------------
+    void copyDepthTo(unsigned int targetFBO) const
+    {
+        glBindFramebuffer(GL_READ_FRAMEBUFFER, FBO);
+        glBindFramebuffer(GL_DRAW_FRAMEBUFFER, targetFBO);
+        glBlitFramebuffer(0, 0, width, height, 0, 0, width, height, GL_DEPTH_BUFFER_BIT, GL_NEAREST);
+        glBindFramebuffer(GL_FRAMEBUFFER, targetFBO);
+    }
+
+private:
+    unsigned int makeTexture(int internalFormat, unsigned int format, unsigned int type) const
+    {
+        unsigned int texture;
+        glGenTextures(1, &texture);
+        glBindTexture(GL_TEXTURE_2D, texture);
+        glTexImage2D(GL_TEXTURE_2D, 0, internalFormat, width, height, 0, format, type, NULL);
+        // one texel per pixel, never filtered
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        return texture;
+    }
+    void release()
+    {
+        if (normalTexture == 0)
+            return;
+        unsigned int textures[3] = { normalTexture, albedoSpecTexture, depthTexture };
+        glDeleteTextures(3, textures);
+        normalTexture = albedoSpecTexture = depthTexture = 0;
+    }
+};
+#endif
@@ -0,0 +1,291 @@
+#ifndef GL_CALL_STATS_H
+#define GL_CALL_STATS_H
+
+#include <glad/glad.h>
+
+#include <vector>
+#include <algorithm>
+#include <cstring>
+#include <cstdint>
+#include <cmath>
+#include <iostream>
+
+// every entry point that gets counted, by what kind of work it is. the ones that upload data are further down
+// (GL_CALL_STATS_UPLOADS), they also count bytes
+#define GL_CALL_STATS_ENTRY_POINTS(X) \
+    X(DRAW, glDrawArrays) X(DRAW, glDrawElements) X(DRAW, glDrawArraysInstanced) X(DRAW, glDrawElementsInstanced) \
+    X(DRAW, glMultiDrawElementsIndirect) X(DRAW, glMultiDrawElementsIndirectCount) X(DRAW, glDispatchCompute) \
+    X(DRAW, glClear) X(DRAW, glBlitFramebuffer) X(DRAW, glBlitNamedFramebuffer) \
+    X(STATE, glUseProgram) X(STATE, glBindProgramPipeline) X(STATE, glBindVertexArray) X(STATE, glBindBuffer) \
+    X(STATE, glBindBufferBase) X(STATE, glBindTexture) X(STATE, glBindTextureUnit) X(STATE, glActiveTexture) \
+    X(STATE, glBindImageTexture) X(STATE, glBindFramebuffer) X(STATE, glBindRenderbuffer) X(STATE, glViewport) \
+    X(STATE, glEnable) X(STATE, glDisable) X(STATE, glDepthFunc) X(STATE, glDepthMask) X(STATE, glColorMask) \
+    X(STATE, glCullFace) X(STATE, glBlendFunc) X(STATE, glClearColor) X(STATE, glPixelStorei) X(STATE, glDrawBuffer) \
+    X(STATE, glDrawBuffers) X(STATE, glReadBuffer) X(STATE, glMemoryBarrier) X(STATE, glTexParameteri) \
+    X(STATE, glTexParameterfv) X(STATE, glTextureParameteri) X(STATE, glVertexAttribPointer) \
+    X(STATE, glEnableVertexAttribArray) X(STATE, glVertexAttribDivisor) X(STATE, glUniformBlockBinding) \
+    X(QUERY, glBeginQuery) X(QUERY, glEndQuery) X(QUERY, glQueryCounter) X(QUERY, glGetQueryObjectuiv) \
+    X(QUERY, glGetQueryObjectui64v) X(QUERY, glFenceSync) X(QUERY, glClientWaitSync) X(QUERY, glDeleteSync) \
+    X(OTHER, glGenBuffers) X(OTHER, glCreateBuffers) X(OTHER, glDeleteBuffers) X(OTHER, glGenTextures) \
+    X(OTHER, glCreateTextures) X(OTHER, glDeleteTextures) X(OTHER, glGenVertexArrays) X(OTHER, glDeleteVertexArrays) \
+    X(OTHER, glGenFramebuffers) X(OTHER, glDeleteFramebuffers) X(OTHER, glGenerateMipmap) X(OTHER, glMapBufferRange) \
+    X(OTHER, glUnmapBuffer) X(OTHER, glReadPixels) X(OTHER, glGetIntegerv) X(OTHER, glFinish) \
+    X(OTHER, glGetUniformLocation)
+
+// entry points that upload data, and how many bytes one call sends: (category, name, byte count from the arguments)
+#define GL_CALL_STATS_UPLOADS(X) \
+    X(BUFFER, glBufferData, (GLenum, GLsizeiptr size, const void* data, GLenum), data ? size : 0) \
+    X(BUFFER, glBufferSubData, (GLenum, GLintptr, GLsizeiptr size, const void*), size) \
+    X(BUFFER, glNamedBufferStorage, (GLuint, GLsizeiptr size, const void* data, GLbitfield), data ? size : 0) \
+    X(BUFFER, glNamedBufferSubData, (GLuint, GLintptr, GLsizeiptr size, const void*), size) \
+    X(TEXTURE, glTexImage2D, (GLenum, GLint, GLint, GLsizei w, GLsizei h, GLint, GLenum format, GLenum type, const void* data), \
+        data ? (uint64_t)w * h * pixelBytes(format, type) : 0) \
+    X(TEXTURE, glTexSubImage2D, (GLenum, GLint, GLint, GLint, GLsizei w, GLsizei h, GLenum format, GLenum type, const void*), \
+        (uint64_t)w * h * pixelBytes(format, type)) \
+    X(TEXTURE, glTexImage3D, (GLenum, GLint, GLint, GLsizei w, GLsizei h, GLsizei d, GLint, GLenum format, GLenum type, const void* data), \
+        data ? (uint64_t)w * h * d * pixelBytes(format, type) : 0) \
+    X(UNIFORM, glUniform1i, (GLint, GLint), 4) X(UNIFORM, glUniform1f, (GLint, GLfloat), 4) \
+    X(UNIFORM, glUniform2f, (GLint, GLfloat, GLfloat), 8) X(UNIFORM, glUniform3f, (GLint, GLfloat, GLfloat, GLfloat), 12) \
+    X(UNIFORM, glUniform4f, (GLint, GLfloat, GLfloat, GLfloat, GLfloat), 16) \
+    X(UNIFORM, glUniform3ui, (GLint, GLuint, GLuint, GLuint), 12) \
+    X(UNIFORM, glUniform1fv, (GLint, GLsizei count, const GLfloat*), count * 4) \
+    X(UNIFORM, glUniform2fv, (GLint, GLsizei count, const GLfloat*), count * 8) \
+    X(UNIFORM, glUniform3fv, (GLint, GLsizei count, const GLfloat*), count * 12) \
+    X(UNIFORM, glUniform4fv, (GLint, GLsizei count, const GLfloat*), count * 16) \
+    X(UNIFORM, glUniformMatrix3fv, (GLint, GLsizei count, GLboolean, const GLfloat*), count * 36) \
+    X(UNIFORM, glUniformMatrix4fv, (GLint, GLsizei count, GLboolean, const GLfloat*), count * 64) \
+    X(UNIFORM, glProgramUniform1i, (GLuint, GLint, GLint), 4) X(UNIFORM, glProgramUniform1f, (GLuint, GLint, GLfloat), 4) \
+    X(UNIFORM, glProgramUniform3f, (GLuint, GLint, GLfloat, GLfloat, GLfloat), 12) \
+    X(UNIFORM, glProgramUniform3fv, (GLuint, GLint, GLsizei count, const GLfloat*), count * 12) \
+    X(UNIFORM, glProgramUniform4fv, (GLuint, GLint, GLsizei count, const GLfloat*), count * 16) \
+    X(UNIFORM, glProgramUniformMatrix3fv, (GLuint, GLint, GLsizei count, GLboolean, const GLfloat*), count * 36) \
+    X(UNIFORM, glProgramUniformMatrix4fv, (GLuint, GLint, GLsizei count, GLboolean, const GLfloat*), count * 64)
+
+// what one frame did, between two GlCallStats::endFrame()s
+struct GlFrameStats
+{
+    enum Category { DRAW, STATE, UNIFORM, BUFFER, TEXTURE, QUERY, OTHER, CATEGORY_COUNT };
+    static const int MAX_ENTRY_POINTS = 128;
+
+    uint64_t calls[MAX_ENTRY_POINTS] = {};           // per entry point, see GlCallStats::entryPointName()
+    uint64_t categoryCalls[CATEGORY_COUNT] = {};
+    uint64_t categoryBytes[CATEGORY_COUNT] = {};     // BUFFER, TEXTURE and UNIFORM upload data
+
+    uint64_t totalCalls() const
+    {
+        uint64_t total = 0;
+        for (uint64_t count : categoryCalls)
+            total += count;
+        return total;
+    }
+    uint64_t drawCalls() const { return categoryCalls[DRAW]; }
+    uint64_t stateChanges() const { return categoryCalls[STATE]; }
+    uint64_t uniformUploads() const { return categoryCalls[UNIFORM]; }
+    uint64_t bufferBytes() const { return categoryBytes[BUFFER]; }
+    uint64_t textureBytes() const { return categoryBytes[TEXTURE]; }
+    uint64_t uniformBytes() const { return categoryBytes[UNIFORM]; }
+};
+
+// Counts what a chapter asks of GL every frame: calls per entry point, and the bytes it sends through buffer,
+// texture and uniform uploads.
+// glad calls everything through function pointers (glDrawArrays is really glad_glDrawArrays), so install()
+// swaps each pointer for a wrapper that counts and then calls the driver's function. Nothing else has to
+// change, and not calling install() leaves GL exactly as it was.
+//
+//   gladLoadGLLoader(...);
+//   GlCallStats::install();
+//   ...
+//   GlCallStats::endFrame();        // once a frame, before glfwSwapBuffers
+//   GlCallStats::lastFrame().drawCalls(), GlCallStats::printSummary() once a second
+//   overlay.draw(...); GlCallStats::discardFrame();    // after endFrame(), so the overlay isn't in its own numbers
+//
+// The counters aren't atomic, so only count a context that one thread draws with (not the batch renderer).
+// "Draw" includes clears, blits and compute dispatches, anything that makes the GPU go through pixels.
+class GlCallStats
+{
+public:
+    // after gladLoadGLLoader. entry points the driver doesn't have stay null and aren't counted
+    // ------------------------------------------------------------------------
+    static void install()
+    {
+#define GL_CALL_STATS_INSTALL(category, name) hook<ID_##name>(glad_##name, #name, GlFrameStats::category);
+#define GL_CALL_STATS_INSTALL_UPLOAD(category, name, arguments, bytes) \
+        hook<ID_##name>(glad_##name, #name, GlFrameStats::category, [] arguments -> uint64_t { return (uint64_t)(bytes); });
+        GL_CALL_STATS_ENTRY_POINTS(GL_CALL_STATS_INSTALL)
+        GL_CALL_STATS_UPLOADS(GL_CALL_STATS_INSTALL_UPLOAD)
+#undef GL_CALL_STATS_INSTALL
+#undef GL_CALL_STATS_INSTALL_UPLOAD
+    }
+    // the frame's counts become lastFrame() and count towards the next printSummary()
+    // ------------------------------------------------------------------------
+    static void endFrame()
+    {
+        State& s = state();
+        s.last = s.current;
+        for (int i = 0; i < GlFrameStats::MAX_ENTRY_POINTS; i++)
+            s.summed.calls[i] += s.current.calls[i];
+        for (int c = 0; c < GlFrameStats::CATEGORY_COUNT; c++)
+        {
+            s.summed.categoryCalls[c] += s.current.categoryCalls[c];
+            s.summed.categoryBytes[c] += s.current.categoryBytes[c];
+        }
+        s.summedFrames++;
+        s.current = GlFrameStats();
+    }
+    // forget what's been counted since endFrame(), for calls that shouldn't be in the stats (the perf overlay's)
+    // ------------------------------------------------------------------------
+    static void discardFrame()
+    {
+        state().current = GlFrameStats();
+    }
+    // ------------------------------------------------------------------------
+    static const GlFrameStats& lastFrame() { return state().last; }
+    static int entryPointCount() { return ENTRY_POINT_COUNT; }
+    static const char* entryPointName(int entryPoint) { return state().names[entryPoint]; }
+    // last frame's calls to one entry point by name, e.g. lastFrameCalls("glUniformMatrix4fv")
+    // ------------------------------------------------------------------------
+    static uint64_t lastFrameCalls(const char* name)
+    {
+        State& s = state();
+        for (int i = 0; i < ENTRY_POINT_COUNT; i++)
+            if (s.names[i] && std::strcmp(s.names[i], name) == 0)
+                return s.last.calls[i];
+        return 0;
+    }
+    // per frame averages since the last summary, and the busiest entry points
+    // ------------------------------------------------------------------------
+    static void printSummary(int topCount = 6)
+    {
+        State& s = state();
+        if (s.summedFrames == 0)
+            return;
+        double frames = (double)s.summedFrames;
+        const GlFrameStats& sum = s.summed;
+        std::cout << "gl calls/frame: " << (uint64_t)(sum.totalCalls() / frames) << " (draws " << sum.drawCalls() / frames
+            << ", state " << sum.stateChanges() / frames << ", uniforms " << sum.uniformUploads() / frames << ")  uploaded/frame: buffers "
+            << kilobytes(sum.bufferBytes() / frames) << " KB, textures " << kilobytes(sum.textureBytes() / frames) << " KB, uniforms "
+            << kilobytes(sum.uniformBytes() / frames) << " KB" << std::endl;
+
+        std::vector<int> busiest;
+        for (int i = 0; i < ENTRY_POINT_COUNT; i++)
+            if (sum.calls[i] > 0)
+                busiest.push_back(i);
+        std::sort(busiest.begin(), busiest.end(), [&](int a, int b) { return sum.calls[a] > sum.calls[b]; });
+        if (busiest.size() > (size_t)topCount)
+            busiest.resize(topCount);
+        std::cout << "  busiest:";
+        for (int i : busiest)
+            std::cout << " " << s.names[i] << " " << sum.calls[i] / frames;
+        std::cout << std::endl;
+
+        s.summed = GlFrameStats();
+        s.summedFrames = 0;
+    }
+
+private:
+    // every entry point gets a number, its index in the counters
+    enum EntryPoint
+    {
+#define GL_CALL_STATS_ID(category, name) ID_##name,
+#define GL_CALL_STATS_UPLOAD_ID(category, name, arguments, bytes) ID_##name,
+        GL_CALL_STATS_ENTRY_POINTS(GL_CALL_STATS_ID)
+        GL_CALL_STATS_UPLOADS(GL_CALL_STATS_UPLOAD_ID)
+#undef GL_CALL_STATS_ID
+#undef GL_CALL_STATS_UPLOAD_ID
+        ENTRY_POINT_COUNT
+    };
+    static_assert(ENTRY_POINT_COUNT <= GlFrameStats::MAX_ENTRY_POINTS, "raise GlFrameStats::MAX_ENTRY_POINTS");
+
+    struct State
+    {
+        GlFrameStats current, last, summed;
+        unsigned long long summedFrames = 0;
+        const char* names[ENTRY_POINT_COUNT] = {};
+        GlFrameStats::Category categories[ENTRY_POINT_COUNT] = {};
+    };
+    static State& state()
+    {
+        static State s;
+        return s;
+    }
+
+    // one wrapper per entry point: Id keeps entry points with the same signature (glEnable, glDisable) apart
+    template <int Id, typename R, typename... Args>
+    struct Hook
+    {
+        typedef R (APIENTRYP Function)(Args...);
+        typedef uint64_t (*Bytes)(Args...);
+        static Function original;
+        static Bytes bytes;
+
+        static R APIENTRY call(Args... args)
+        {
+            GlFrameStats& frame = state().current;
+            GlFrameStats::Category category = state().categories[Id];
+            frame.calls[Id]++;
+            frame.categoryCalls[category]++;
+            if (bytes)
+                frame.categoryBytes[category] += bytes(args...);
+            return original(args...);
+        }
+    };
+    template <int Id, typename R, typename... Args>
+    static void hook(R (APIENTRYP& pointer)(Args...), const char* name, GlFrameStats::Category category,
+        typename Hook<Id, R, Args...>::Bytes bytes = nullptr)
+    {
+        State& s = state();
+        s.names[Id] = name;
+        s.categories[Id] = category;
+        // installing twice would wrap the wrapper
+        if (!pointer || pointer == &Hook<Id, R, Args...>::call)
+            return;
+        Hook<Id, R, Args...>::original = pointer;
+        Hook<Id, R, Args...>::bytes = bytes;
+        pointer = &Hook<Id, R, Args...>::call;
+    }
+    // to one decimal, for printing
+    static double kilobytes(double bytes)
+    {
+        return std::round(bytes / 102.4) / 10.0;
+    }
+    // bytes per pixel of client pixel data
+    static uint64_t pixelBytes(GLenum format, GLenum type)
+    {
+        switch (type)
+        {
+        case GL_UNSIGNED_SHORT_5_6_5: case GL_UNSIGNED_SHORT_4_4_4_4: case GL_UNSIGNED_SHORT_5_5_5_1:
+            return 2;
+        case GL_UNSIGNED_INT_8_8_8_8: case GL_UNSIGNED_INT_10_10_10_2: case GL_UNSIGNED_INT_2_10_10_10_REV:
+        case GL_UNSIGNED_INT_10F_11F_11F_REV: case GL_UNSIGNED_INT_24_8: case GL_UNSIGNED_INT_5_9_9_9_REV:
+            return 4;
+        }
+        uint64_t components = 4;
+        switch (format)
+        {
+        case GL_RED: case GL_RED_INTEGER: case GL_DEPTH_COMPONENT: case GL_STENCIL_INDEX:
+            components = 1;
+            break;
+        case GL_RG: case GL_RG_INTEGER: case GL_DEPTH_STENCIL:
+            components = 2;
+            break;
+        case GL_RGB: case GL_BGR: case GL_RGB_INTEGER:
+            components = 3;
+            break;
+        }
+        switch (type)
+        {
+        case GL_UNSIGNED_BYTE: case GL_BYTE:
+            return components;
+        case GL_UNSIGNED_SHORT: case GL_SHORT: case GL_HALF_FLOAT:
+            return components * 2;
+        default:
+            return components * 4;
+        }
+    }
+};
+
+template <int Id, typename R, typename... Args>
+typename GlCallStats::Hook<Id, R, Args...>::Function GlCallStats::Hook<Id, R, Args...>::original = nullptr;
+template <int Id, typename R, typename... Args>
+typename GlCallStats::Hook<Id, R, Args...>::Bytes GlCallStats::Hook<Id, R, Args...>::bytes = nullptr;
+#endif
@@ -0,0 +1,274 @@
+#ifndef GPU_PROFILER_H
+#define GPU_PROFILER_H
+
+#include <glad/glad.h>
+
+#include "cpu_profiler.h"
+
+#include <vector>
+#include <cstring>
+#include <cstdint>
+#include <iostream>
+
+// Times render passes on the GPU.
+// A CPU timer around glDrawArrays only measures queueing the draw, the GPU runs it later. Timer queries get
+// the GPU to write its own clock (glQueryCounter(GL_TIMESTAMP)) when it reaches a point in the command stream,
+// so a pass is the difference between the timestamp before it and the one after it. Timestamps rather than
+// GL_TIME_ELAPSED because elapsed queries can't nest or overlap, and a frame pass around smaller passes is
+// the useful case.
+//
+//   gpuProfiler.beginFrame();
+//   { GpuProfileScope pass(gpuProfiler, "object cube"); ...draw... }
+//   gpuProfiler.endFrame();                      // before glfwSwapBuffers
+//
+// Results take a frame or two to come back, and asking for them sooner waits for the GPU. So every frame
+// gets its own set of queries from a ring of FRAMES_IN_FLIGHT, and beginFrame() only reads the ones the GPU
+// says are available. If the ring comes round to a frame that still isn't done, that frame just isn't
+// profiled (counted in skipped()) rather than stalling. Passes have to be string literals, like PROFILE_SCOPE.
+//
+// Every frame also samples the GPU clock and the CPU one together, so GPU passes can be put on the CPU's
+// timeline: track() goes into CpuProfiler::writeChromeTrace() and the GPU shows up as one more thread.
+class GpuProfiler
+{
+public:
+    static const int FRAMES_IN_FLIGHT = 4;
+    static const int MAX_PASSES = 64;       // per frame, more than that aren't timed
+    static const size_t MAX_EVENTS = 1 << 16;
+
+    // milliseconds per pass name, since the last printAverages()
+    struct PassTime
+    {
+        const char* name;
+        double lastMs = 0.0;
+        double totalMs = 0.0;
+        int frames = 0;
+
+        double averageMs() const { return frames ? totalMs / frames : 0.0; }
+    };
+
+    GpuProfiler() = default;
+    ~GpuProfiler()
+    {
+        release();
+    }
+    GpuProfiler(const GpuProfiler&) = delete;
+    GpuProfiler& operator=(const GpuProfiler&) = delete;
+
+    // ------------------------------------------------------------------------
+    void beginFrame()
+    {
+        if (!created && (unsupported || !create()))
+            return;
+        collect();
+        Frame& frame = frames[frameIndex % FRAMES_IN_FLIGHT];
+        recording = !frame.pending;
+        if (!recording)
+        {
+            skippedFrames++;
+            return;
+        }
+        frame.passes.clear();
+        stack.clear();
+        frame.index = frameIndex;
+        // the GPU's clock right now next to the CPU's, so this frame's timestamps can be moved onto the CPU timeline
+        GLint64 gpuNow = 0;
+        glGetInteger64v(GL_TIMESTAMP, &gpuNow);
+        frame.gpuSync = (uint64_t)gpuNow;
+        frame.cpuSync = CpuProfiler::ticks();
+    }
+    // ------------------------------------------------------------------------
+    void endFrame()
+    {
+        if (recording)
+        {
+            Frame& frame = frames[frameIndex % FRAMES_IN_FLIGHT];
+            while (!stack.empty())
+                endPass();
+            frame.pending = !frame.passes.empty();
+        }
+        recording = false;
+        frameIndex++;
+    }
+    // passes nest, endPass() closes the innermost open one
+    // ------------------------------------------------------------------------
+    void beginPass(const char* name)
+    {
+        if (!recording)
+            return;
+        Frame& frame = frames[frameIndex % FRAMES_IN_FLIGHT];
+        if (frame.passes.size() == (size_t)MAX_PASSES)
+        {
+            stack.push_back(-1);
+            return;
+        }
+        Pass pass;
+        pass.name = name;
+        frame.last = frame.queries[frame.passes.size() * 2];
+        glQueryCounter(frame.last, GL_TIMESTAMP);
+        stack.push_back((int)frame.passes.size());
+        frame.passes.push_back(pass);
+    }
+    // ------------------------------------------------------------------------
+    void endPass()
+    {
+        if (!recording || stack.empty())
+            return;
+        int pass = stack.back();
+        stack.pop_back();
+        if (pass < 0)
+            return;
+        Frame& frame = frames[frameIndex % FRAMES_IN_FLIGHT];
+        frame.last = frame.queries[pass * 2 + 1];
+        glQueryCounter(frame.last, GL_TIMESTAMP);
+    }
+
+    // ------------------------------------------------------------------------
+    const std::vector<PassTime>& passTimes() const { return times; }
+    unsigned long long skipped() const { return skippedFrames; }
+    // average GPU time per pass, then starts averaging over again
+    // ------------------------------------------------------------------------
+    void printAverages()
+    {
+        if (times.empty())
+            return;
+        std::cout << "gpu:";
+        for (PassTime& time : times)
+        {
+            std::cout << "  " << time.name << " " << time.averageMs() << " ms";
+            time.totalMs = 0.0;
+            time.frames = 0;
+        }
+        std::cout << std::endl;
+    }
+    // the passes read back so far (the last MAX_EVENTS), as a track for CpuProfiler::writeChromeTrace()
+    // ------------------------------------------------------------------------
+    CpuProfiler::Track track() const
+    {
+        CpuProfiler::Track gpu;
+        gpu.name = "GPU";
+        size_t first = eventsWritten > MAX_EVENTS ? eventsWritten - MAX_EVENTS : 0;
+        for (size_t e = first; e < eventsWritten; e++)
+            gpu.events.push_back(events[e % MAX_EVENTS]);
+        return gpu;
+    }
+    // deletes the queries, while the context is still around
+    // ------------------------------------------------------------------------
+    void release()
+    {
+        if (!created)
+            return;
+        for (Frame& frame : frames)
+        {
+            glDeleteQueries(MAX_PASSES * 2, frame.queries);
+            frame.pending = false;
+        }
+        created = recording = false;
+    }
+
+private:
+    struct Pass
+    {
+        const char* name;
+    };
+    struct Frame
+    {
+        GLuint queries[MAX_PASSES * 2];     // begin and end timestamp of every pass
+        GLuint last = 0;                    // the query issued last
+        std::vector<Pass> passes;
+        uint64_t gpuSync = 0, cpuSync = 0;  // the two clocks at beginFrame()
+        unsigned long long index = 0;
+        bool pending = false;               // queries issued, results not read yet
+    };
+
+    Frame frames[FRAMES_IN_FLIGHT];
+    unsigned long long frameIndex = 0, skippedFrames = 0;
+    bool created = false, recording = false, unsupported = false;
+    std::vector<int> stack;                 // open passes, -1 for ones over MAX_PASSES
+    std::vector<PassTime> times;
+    std::vector<CpuProfiler::Event> events;
+    size_t eventsWritten = 0;
+
+    bool create()
+    {
+        GLint bits = 0;
+        glGetQueryiv(GL_TIMESTAMP, GL_QUERY_COUNTER_BITS, &bits);
+        if (bits == 0)
+        {
+            std::cout << "ERROR::GPU_PROFILER::NO_TIMESTAMP_QUERIES" << std::endl;
+            unsupported = true;
+            return false;
+        }
+        for (Frame& frame : frames)
+        {
+            glGenQueries(MAX_PASSES * 2, frame.queries);
+            frame.passes.reserve(MAX_PASSES);
+        }
+        events.resize(MAX_EVENTS);
+        created = true;
+        return true;
+    }
+    // reads back every frame the GPU has finished, oldest first
+    void collect()
+    {
+        double perMicrosecond = CpuProfiler::ticksPerMicrosecond();
+        for (unsigned long long i = frameIndex >= FRAMES_IN_FLIGHT ? frameIndex - FRAMES_IN_FLIGHT : 0; i < frameIndex; i++)
+        {
+            Frame& frame = frames[i % FRAMES_IN_FLIGHT];
+            if (!frame.pending || frame.index != i)
+                continue;
+            // timestamps are written in order, when the last one is there they all are
+            GLuint available = 0;
+            glGetQueryObjectuiv(frame.last, GL_QUERY_RESULT_AVAILABLE, &available);
+            if (!available)
+                break;
+            for (size_t p = 0; p < frame.passes.size(); p++)
+            {
+                GLuint64 begin = 0, end = 0;
+                glGetQueryObjectui64v(frame.queries[p * 2], GL_QUERY_RESULT, &begin);
+                glGetQueryObjectui64v(frame.queries[p * 2 + 1], GL_QUERY_RESULT, &end);
+                double ms = (double)(int64_t)(end - begin) / 1.0e6;
+                PassTime& time = timeFor(frame.passes[p].name);
+                time.lastMs = ms;
+                time.totalMs += ms;
+                time.frames++;
+                // nanoseconds on the GPU clock to ticks on the CPU one
+                CpuProfiler::Event event;
+                event.name = frame.passes[p].name;
+                event.start = frame.cpuSync + (uint64_t)(int64_t)((double)(int64_t)(begin - frame.gpuSync) / 1000.0 * perMicrosecond);
+                event.end = event.start + (uint64_t)(int64_t)((double)(int64_t)(end - begin) / 1000.0 * perMicrosecond);
+                events[eventsWritten++ % MAX_EVENTS] = event;
+            }
+            frame.pending = false;
+        }
+    }
+    PassTime& timeFor(const char* name)
+    {
+        for (PassTime& time : times)
+            if (time.name == name || std::strcmp(time.name, name) == 0)
+                return time;
+        PassTime time;
+        time.name = name;
+        times.push_back(time);
+        return times.back();
+    }
+};
+
+// times the GPU work issued between construction and destruction as one pass
+class GpuProfileScope
+{
+public:
+    GpuProfileScope(GpuProfiler& profiler, const char* name) : profiler(profiler)
+    {
+        profiler.beginPass(name);
+    }
+    ~GpuProfileScope()
+    {
+        profiler.endPass();
+    }
+    GpuProfileScope(const GpuProfileScope&) = delete;
+    GpuProfileScope& operator=(const GpuProfileScope&) = delete;
+
+private:
+    GpuProfiler& profiler;
+};
+#endif
@@ -0,0 +1,101 @@
+#ifndef IMAGE_COMPARE_H
+#define IMAGE_COMPARE_H
+
+#include <vector>
+#include <cmath>
+#include <cstdint>
+#include <algorithm>
+
+// how far apart two images are, in CIELAB delta E (CIE76): about 1 is the smallest difference anyone can see,
+// 2.3 a "just noticeable" one, and black vs white is 100
+struct ImageDifference
+{
+    double maxDelta = 0.0;
+    double meanDelta = 0.0;
+    size_t differingPixels = 0;     // pixels over the threshold given to compare()
+    size_t pixels = 0;
+
+    double differingFraction() const { return pixels ? (double)differingPixels / pixels : 0.0; }
+};
+
+// Compares rendered images the way a person would, rather than byte for byte. Both images are taken as sRGB,
+// turned into CIELAB (which is roughly perceptually uniform) and compared per pixel, so a rounding difference
+// in a dark corner counts for as much as the same one on a bright face. Meant for golden images: some tiny
+// shading difference between compilers is fine, a changed edge or a wrong color isn't.
+class ImageCompare
+{
+public:
+    // RGB or RGBA 8 bit, same size and channel count. alpha is ignored (the window doesn't show it either)
+    // ------------------------------------------------------------------------
+    static ImageDifference compare(const unsigned char* a, const unsigned char* b, int width, int height, int channels,
+        double threshold, std::vector<unsigned char>* diffImage = nullptr)
+    {
+        ImageDifference result;
+        result.pixels = (size_t)width * height;
+        if (diffImage)
+            diffImage->resize(result.pixels * 3);
+        double total = 0.0;
+        for (size_t i = 0; i < result.pixels; i++)
+        {
+            const unsigned char* p = a + i * channels;
+            const unsigned char* q = b + i * channels;
+            double delta = 0.0;
+            if (p[0] != q[0] || p[1] != q[1] || p[2] != q[2])
+            {
+                float labA[3], labB[3];
+                toLab(p, labA);
+                toLab(q, labB);
+                delta = std::sqrt((double)square(labA[0] - labB[0]) + square(labA[1] - labB[1]) + square(labA[2] - labB[2]));
+            }
+            total += delta;
+            result.maxDelta = std::max(result.maxDelta, delta);
+            bool differs = delta > threshold;
+            if (differs)
+                result.differingPixels++;
+            // the diff image is the first image faded out, with every pixel over the threshold in red
+            if (diffImage)
+            {
+                unsigned char* out = &(*diffImage)[i * 3];
+                unsigned char gray = (unsigned char)((p[0] * 77 + p[1] * 150 + p[2] * 29) >> 9);
+                out[0] = differs ? 255 : gray;
+                out[1] = differs ? 0 : gray;
+                out[2] = differs ? 0 : gray;
+            }
+        }
+        result.meanDelta = result.pixels ? total / result.pixels : 0.0;
+        return result;
+    }
+
+private:
+    static float square(float v) { return v * v; }
+    // sRGB -> linear -> XYZ (D65 white) -> L*a*b*
+    static void toLab(const unsigned char* rgb, float lab[3])
+    {
+        struct Table
+        {
+            float linear[256];
+            Table()
+            {
+                for (int i = 0; i < 256; i++)
+                {
+                    float c = i / 255.0f;
+                    linear[i] = c <= 0.04045f ? c / 12.92f : std::pow((c + 0.055f) / 1.055f, 2.4f);
+                }
+            }
+        };
+        static const Table table;
+        float r = table.linear[rgb[0]], g = table.linear[rgb[1]], b = table.linear[rgb[2]];
+        float x = (0.4124f * r + 0.3576f * g + 0.1805f * b) / 0.95047f;
+        float y = 0.2126f * r + 0.7152f * g + 0.0722f * b;
+        float z = (0.0193f * r + 0.1192f * g + 0.9505f * b) / 1.08883f;
+        float fx = labCurve(x), fy = labCurve(y), fz = labCurve(z);
+        lab[0] = 116.0f * fy - 16.0f;
+        lab[1] = 500.0f * (fx - fy);
+        lab[2] = 200.0f * (fy - fz);
+    }
+    static float labCurve(float t)
+    {
+        return t > 0.008856f ? std::cbrt(t) : 7.787f * t + 16.0f / 116.0f;
+    }
+};
+#endif
@@ -0,0 +1,289 @@
+#ifndef IMAGE_WRITE_H
+#define IMAGE_WRITE_H
+
+#include <string>
+#include <vector>
+#include <fstream>
+#include <cstdint>
+#include <cstdlib>
+#include <algorithm>
+#include <iostream>
+
+// The other half of stb_image.h: writes 8 bit RGB/RGBA pixels out as a PNG, so anything we render without a
+// window (software_rasterizer.h, screenshots read back from GL) can be looked at and diffed.
+//
+// PNG data is zlib compressed. This does a small deflate of its own (LZ77 matches with the fixed Huffman
+// codes from the deflate spec, no dynamic tables), after picking the best PNG row filter per row the usual
+// way (smallest sum of absolute values). Flat rendered images shrink a lot, photos not so much.
+class ImageWriter
+{
+public:
+    // rows go top to bottom like in the file. flipRows takes them bottom to top instead (glReadPixels order)
+    // ------------------------------------------------------------------------
+    static bool writePng(const std::string& path, int width, int height, int channels, const unsigned char* pixels, bool flipRows = false)
+    {
+        if (width <= 0 || height <= 0 || (channels != 3 && channels != 4))
+        {
+            std::cout << "ERROR::IMAGE_WRITE::BAD_FORMAT " << path << std::endl;
+            return false;
+        }
+        // filter every row, each one starts with the filter type byte
+        size_t stride = (size_t)width * channels;
+        std::vector<unsigned char> filtered(height * (stride + 1));
+        std::vector<unsigned char> candidate(stride);
+        for (int y = 0; y < height; y++)
+        {
+            const unsigned char* row = pixels + (size_t)(flipRows ? height - 1 - y : y) * stride;
+            const unsigned char* above = y == 0 ? nullptr : pixels + (size_t)(flipRows ? height - y : y - 1) * stride;
+            unsigned char* out = &filtered[y * (stride + 1)];
+            long bestSum = -1;
+            for (int type = 0; type < 5; type++)
+            {
+                long sum = 0;
+                for (size_t i = 0; i < stride; i++)
+                {
+                    int a = i >= (size_t)channels ? row[i - channels] : 0;
+                    int b = above ? above[i] : 0;
+                    int c = above && i >= (size_t)channels ? above[i - channels] : 0;
+                    unsigned char value = (unsigned char)(row[i] - predict(type, a, b, c));
+                    candidate[i] = value;
+                    sum += value < 128 ? value : 256 - value;
+                }
+                if (bestSum < 0 || sum < bestSum)
+                {
+                    bestSum = sum;
+                    out[0] = (unsigned char)type;
+                    std::copy(candidate.begin(), candidate.end(), out + 1);
+                }
+            }
+        }
+
+        std::vector<unsigned char> header;
+        put32(header, (uint32_t)width);
+        put32(header, (uint32_t)height);
+        header.push_back(8);                            // bits per channel
+        header.push_back(channels == 4 ? 6 : 2);        // RGBA or RGB
+        header.push_back(0);                            // deflate
+        header.push_back(0);                            // adaptive filtering
+        header.push_back(0);                            // not interlaced
+
+        std::ofstream file(path, std::ios::binary | std::ios::trunc);
+        if (!file)
+        {
+            std::cout << "ERROR::IMAGE_WRITE::CANNOT_WRITE " << path << std::endl;
+            return false;
+        }
+        static const unsigned char signature[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+        file.write((const char*)signature, 8);
+        writeChunk(file, "IHDR", header);
+        writeChunk(file, "IDAT", zlibCompress(filtered));
+        writeChunk(file, "IEND", {});
+        if (!file)
+        {
+            std::cout << "ERROR::IMAGE_WRITE::CANNOT_WRITE " << path << std::endl;
+            return false;
+        }
+        return true;
+    }
+
+    // a zlib stream (what PNG's IDAT holds)
+    // ------------------------------------------------------------------------
+    static std::vector<unsigned char> zlibCompress(const std::vector<unsigned char>& data)
+    {
+        BitWriter out;
+        out.bytes.push_back(0x78);  // deflate, 32K window
+        out.bytes.push_back(0x01);  // no preset dictionary, check bits
+        out.put(1, 1);              // last block
+        out.put(1, 2);              // fixed Huffman codes
+
+        // LZ77: head[hash] is the latest position those 3 bytes were seen, prev[] chains older ones
+        const size_t WINDOW = 32768, MAX_MATCH = 258, MAX_CHAIN = 32;
+        const size_t HASH_SIZE = 1 << 15;
+        std::vector<int32_t> head(HASH_SIZE, -1), prev(WINDOW, -1);
+        size_t n = data.size();
+        auto hash = [&](size_t i) { return ((data[i] << 10) ^ (data[i + 1] << 5) ^ data[i + 2]) & (HASH_SIZE - 1); };
+        auto insert = [&](size_t i)
+        {
+            if (i + 2 >= n)
+                return;
+            size_t h = hash(i);
+            prev[i % WINDOW] = head[h];
+            head[h] = (int32_t)i;
+        };
+        size_t i = 0;
+        while (i < n)
+        {
+            size_t bestLength = 0, bestDistance = 0;
+            if (i + 2 < n)
+            {
+                int32_t candidate = head[hash(i)];
+                for (size_t chain = 0; candidate >= 0 && i - candidate <= WINDOW - 1 && chain < MAX_CHAIN; chain++)
+                {
+                    size_t length = 0, limit = std::min(MAX_MATCH, n - i);
+                    while (length < limit && data[candidate + length] == data[i + length])
+                        length++;
+                    if (length > bestLength)
+                    {
+                        bestLength = length;
+                        bestDistance = i - candidate;
+                        if (length == limit)
+                            break;
+                    }
+                    int32_t older = prev[candidate % WINDOW];
+                    if (older >= candidate)
+                        break;
+                    candidate = older;
+                }
+            }
+            if (bestLength >= 3)
+            {
+                writeLength(out, (int)bestLength);
+                writeDistance(out, (int)bestDistance);
+                for (size_t k = 0; k < bestLength; k++)
+                    insert(i + k);
+                i += bestLength;
+            }
+            else
+            {
+                writeLiteral(out, data[i]);
+                insert(i);
+                i++;
+            }
+        }
+        writeLiteral(out, 256); // end of block
+        out.flush();
+
+        uint32_t a = 1, b = 0;
+        for (unsigned char byte : data)
+        {
+            a = (a + byte) % 65521;
+            b = (b + a) % 65521;
+        }
+        put32(out.bytes, (b << 16) | a);
+        return out.bytes;
+    }
+
+private:
+    struct BitWriter
+    {
+        std::vector<unsigned char> bytes;
+        uint32_t buffer = 0;
+        int count = 0;
+        // deflate packs values least significant bit first
+        void put(uint32_t value, int bits)
+        {
+            buffer |= value << count;
+            count += bits;
+            while (count >= 8)
+            {
+                bytes.push_back((unsigned char)buffer);
+                buffer >>= 8;
+                count -= 8;
+            }
+        }
+        // Huffman codes go in most significant bit first
+        void putCode(uint32_t code, int bits)
+        {
+            uint32_t reversed = 0;
+            for (int i = 0; i < bits; i++)
+                reversed |= ((code >> i) & 1) << (bits - 1 - i);
+            put(reversed, bits);
+        }
+        void flush()
+        {
+            if (count > 0)
+                bytes.push_back((unsigned char)buffer);
+            buffer = 0;
+            count = 0;
+        }
+    };
+
+    static int predict(int type, int a, int b, int c)
+    {
+        switch (type)
+        {
+        case 1: return a;
+        case 2: return b;
+        case 3: return (a + b) / 2;
+        case 4:
+        {
+            // Paeth: whichever neighbour is closest to a + b - c
+            int p = a + b - c;
+            int pa = std::abs(p - a), pb = std::abs(p - b), pc = std::abs(p - c);
+            return pa <= pb && pa <= pc ? a : pb <= pc ? b : c;
+        }
+        }
+        return 0;
+    }
+    // fixed literal/length code for symbol 0..287
+    static void writeLiteral(BitWriter& out, int symbol)
+    {
+        if (symbol < 144)
+            out.putCode(0x30 + symbol, 8);
+        else if (symbol < 256)
+            out.putCode(0x190 + symbol - 144, 9);
+        else if (symbol < 280)
+            out.putCode(symbol - 256, 7);
+        else
+            out.putCode(0xC0 + symbol - 280, 8);
+    }
+    static void writeLength(BitWriter& out, int length)
+    {
+        static const int base[29] = { 3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258 };
+        static const int extra[29] = { 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0 };
+        int code = 28;
+        while (base[code] > length)
+            code--;
+        writeLiteral(out, 257 + code);
+        out.put(length - base[code], extra[code]);
+    }
+    static void writeDistance(BitWriter& out, int distance)
+    {
+        static const int base[30] = { 1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193, 257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577 };
+        static const int extra[30] = { 0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13 };
+        int code = 29;
+        while (base[code] > distance)
+            code--;
+        out.putCode(code, 5);
+        out.put(distance - base[code], extra[code]);
+    }
+    // big endian, the way PNG and zlib store numbers
+    static void put32(std::vector<unsigned char>& out, uint32_t value)
+    {
+        for (int shift = 24; shift >= 0; shift -= 8)
+            out.push_back((unsigned char)(value >> shift));
+    }
+    static void writeChunk(std::ofstream& file, const char* type, const std::vector<unsigned char>& data)
+    {
+        std::vector<unsigned char> chunk;
+        put32(chunk, (uint32_t)data.size());
+        chunk.insert(chunk.end(), type, type + 4);
+        chunk.insert(chunk.end(), data.begin(), data.end());
+        // the CRC covers the type and the data, not the length
+        put32(chunk, crc32(&chunk[4], chunk.size() - 4));
+        file.write((const char*)chunk.data(), chunk.size());
+    }
+    static uint32_t crc32(const unsigned char* data, size_t size)
+    {
+        struct Table
+        {
+            uint32_t entries[256];
+            Table()
+            {
+                for (uint32_t n = 0; n < 256; n++)
+                {
+                    uint32_t c = n;
+                    for (int k = 0; k < 8; k++)
+                        c = c & 1 ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+                    entries[n] = c;
+                }
+            }
+        };
+        static const Table table;
+        uint32_t crc = 0xFFFFFFFFu;
+        for (size_t i = 0; i < size; i++)
+            crc = table.entries[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+        return crc ^ 0xFFFFFFFFu;
+    }
+};
+#endif
@@ -0,0 +1,213 @@
+#ifndef JSON_VALUE_H
+#define JSON_VALUE_H
+
+#include <string>
+#include <vector>
+#include <utility>
+#include <cstdlib>
+#include <cstring>
+
+// Just enough JSON to read glTF headers: parse() builds a tree of JsonValues, and lookups that don't exist
+// return a null value instead of throwing, so chains like json["accessors"][3]["count"].number() are safe.
+// Numbers are doubles, \u escapes are kept as they are (glTF only needs them inside names).
+class JsonValue
+{
+public:
+    enum Type { Null, Bool, Number, String, Array, Object };
+
+    Type type = Null;
+    bool boolean = false;
+    double num = 0.0;
+    std::string str;
+    std::vector<JsonValue> items;                              // Array
+    std::vector<std::pair<std::string, JsonValue>> members;   // Object, in file order
+
+    // returns false (and leaves out as Null) if text isn't valid JSON
+    // ------------------------------------------------------------------------
+    static bool parse(const char* text, size_t length, JsonValue& out)
+    {
+        const char* p = text;
+        const char* end = text + length;
+        out = JsonValue();
+        if (!parseValue(p, end, out, 0))
+        {
+            out = JsonValue();
+            return false;
+        }
+        return true;
+    }
+
+    // ------------------------------------------------------------------------
+    const JsonValue& operator[](const char* key) const
+    {
+        for (const auto& member : members)
+            if (member.first == key)
+                return member.second;
+        return null();
+    }
+    const JsonValue& operator[](size_t index) const
+    {
+        return index < items.size() ? items[index] : null();
+    }
+    // plain ints too, so node[0] isn't ambiguous with the key overload. negative indices give null
+    const JsonValue& operator[](int index) const
+    {
+        return index >= 0 ? (*this)[(size_t)index] : null();
+    }
+    bool has(const char* key) const { return &(*this)[key] != &null(); }
+    size_t size() const { return type == Array ? items.size() : members.size(); }
+    double number(double fallback = 0.0) const { return type == Number ? num : fallback; }
+    int integer(int fallback = 0) const { return type == Number ? (int)num : fallback; }
+    const std::string& string() const { return str; }
+
+private:
+    static const JsonValue& null()
+    {
+        static const JsonValue value;
+        return value;
+    }
+    static void skipSpace(const char*& p, const char* end)
+    {
+        while (p < end && (*p == ' ' || *p == '\t' || *p == '\n' || *p == '\r'))
+            p++;
+    }
+    static bool parseString(const char*& p, const char* end, std::string& out)
+    {
+        if (p >= end || *p != '"')
+            return false;
+        p++;
+        while (p < end && *p != '"')
+        {
+            if (*p == '\\' && p + 1 < end)
+            {
+                p++;
+                switch (*p)
+                {
+                case 'n': out += '\n'; break;
+                case 't': out += '\t'; break;
+                case 'r': out += '\r'; break;
+                case 'b': out += '\b'; break;
+                case 'f': out += '\f'; break;
+                case 'u': out += "\\u"; break;
+                default: out += *p; break;
+                }
+                p++;
+            }
+            else
+                out += *p++;
+        }
+        if (p >= end)
+            return false;
+        p++;
+        return true;
+    }
+    static bool parseValue(const char*& p, const char* end, JsonValue& out, int depth)
+    {
+        // glTF is never nested this deep, something is off
+        if (depth > 64)
+            return false;
+        skipSpace(p, end);
+        if (p >= end)
+            return false;
+        switch (*p)
+        {
+        case '{':
+            out.type = Object;
+            p++;
+            skipSpace(p, end);
+            if (p < end && *p == '}')
+            {
+                p++;
+                return true;
+            }
+            while (p < end)
+            {
+                std::pair<std::string, JsonValue> member;
+                skipSpace(p, end);
+                if (!parseString(p, end, member.first))
+                    return false;
+                skipSpace(p, end);
+                if (p >= end || *p != ':')
+                    return false;
+                p++;
+                if (!parseValue(p, end, member.second, depth + 1))
+                    return false;
+                out.members.push_back(std::move(member));
+                skipSpace(p, end);
+                if (p < end && *p == ',')
+                {
+                    p++;
+                    continue;
+                }
+                if (p < end && *p == '}')
+                {
+                    p++;
+                    return true;
+                }
+                return false;
+            }
+            return false;
+        case '[':
+            out.type = Array;
+            p++;
+            skipSpace(p, end);
+            if (p < end && *p == ']')
+            {
+                p++;
+                return true;
+            }
+            while (p < end)
+            {
+                out.items.emplace_back();
+                if (!parseValue(p, end, out.items.back(), depth + 1))
+                    return false;
+                skipSpace(p, end);
+                if (p < end && *p == ',')
+                {
+                    p++;
+                    continue;
+                }
+                if (p < end && *p == ']')
+                {
+                    p++;
+                    return true;
+                }
+                return false;
+            }
+            return false;
+        case '"':
+            out.type = String;
+            return parseString(p, end, out.str);
+        case 't':
+        case 'f':
+        case 'n':
+        {
+            const char* word = *p == 't' ? "true" : (*p == 'f' ? "false" : "null");
+            size_t length = std::strlen(word);
+            if ((size_t)(end - p) < length || std::strncmp(p, word, length) != 0)
+                return false;
+            p += length;
+            out.type = *word == 'n' ? Null : Bool;
+            out.boolean = *word == 't';
+            return true;
+        }
+        default:
+        {
+            // strtod wants a terminated string, numbers are short so copy them out
+            char buffer[64];
+            size_t length = 0;
+            while (p + length < end && length < sizeof(buffer) - 1 && p[length] != 0 && std::strchr("+-0123456789.eE", p[length]))
+                length++;
+            if (length == 0)
+                return false;
+            std::memcpy(buffer, p, length);
+            buffer[length] = 0;
+            out.type = Number;
+            out.num = std::strtod(buffer, NULL);
+            p += length;
+            return true;
+        }
+        }
+    }
+};
+#endif
@@ -0,0 +1,74 @@
+#ifndef LOD_SELECTOR_H
+#define LOD_SELECTOR_H
+
+#include <glm/glm.hpp>
+
+#include "mesh_data.h"
+
+#include <vector>
+#include <cmath>
+#include <algorithm>
+
+// Picks which level of a LOD chain (mesh_simplifier.h) to draw, by how big its error would look on screen:
+// a level whose error is under a pixel (or whatever pixelThreshold is) looks the same as the full mesh.
+//
+// Without hysteresis an object sitting right at a switching distance flips between two levels every frame
+// as the camera jitters, and the popping is very visible. So going coarser needs the error to be comfortably
+// under the threshold (pixelThreshold * (1 - hysteresis)), going finer happens as soon as it's over.
+// Each object keeps its own LodState for that.
+struct LodState
+{
+    int level = 0;
+};
+
+class LodSelector
+{
+public:
+    float pixelThreshold;
+    float hysteresis;
+
+    LodSelector(float pixelThreshold = 1.0f, float hysteresis = 0.25f) : pixelThreshold(pixelThreshold), hysteresis(hysteresis) {}
+
+    // once a frame, or whenever the projection changes
+    // ------------------------------------------------------------------------
+    void setProjection(float fovYRadians, int viewportHeight)
+    {
+        // a unit long thing one unit in front of the camera is this many pixels tall
+        pixelsPerUnit = (float)viewportHeight / (2.0f * std::tan(fovYRadians * 0.5f));
+    }
+    // error in model units -> pixels, for an object scaled by scale whose closest point is distance away
+    // ------------------------------------------------------------------------
+    float projectedError(float error, float scale, float distance) const
+    {
+        return error * scale * pixelsPerUnit / std::max(distance, 1e-3f);
+    }
+    // distance: from the camera to the object's bounding sphere (center distance - radius), scale: its model scale
+    // ------------------------------------------------------------------------
+    int select(const std::vector<MeshLod>& lods, float scale, float distance, LodState& state) const
+    {
+        if (lods.empty())
+            return 0;
+        int current = std::min(std::max(state.level, 0), (int)lods.size() - 1);
+
+        // the current level got too coarse: go finer right away, to the coarsest level that's good enough
+        if (projectedError(lods[current].error, scale, distance) > pixelThreshold)
+        {
+            int level = current;
+            while (level > 0 && projectedError(lods[level].error, scale, distance) > pixelThreshold)
+                level--;
+            state.level = level;
+            return level;
+        }
+        // maybe go coarser, but only by clearing the stricter threshold
+        float strict = pixelThreshold * (1.0f - hysteresis);
+        int level = current;
+        while (level + 1 < (int)lods.size() && projectedError(lods[level + 1].error, scale, distance) <= strict)
+            level++;
+        state.level = level;
+        return level;
+    }
+
+private:
+    float pixelsPerUnit = 1.0f;
+};
+#endif
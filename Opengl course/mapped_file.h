@@ -0,0 +1,123 @@
+#ifndef MAPPED_FILE_H
+#define MAPPED_FILE_H
+
+#include <string>
+#include <cstddef>
+#include <iostream>
+
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+// Read only memory mapped file. The OS pages the file in as it gets touched instead of us reading the
+// whole thing into a buffer first, so parsing can start right away and nothing gets copied twice.
+class MappedFile
+{
+public:
+    MappedFile() = default;
+    explicit MappedFile(const std::string& path)
+    {
+        open(path);
+    }
+    ~MappedFile()
+    {
+        close();
+    }
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    // ------------------------------------------------------------------------
+    bool open(const std::string& path)
+    {
+        close();
+#if defined(_WIN32)
+        file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+        if (file == INVALID_HANDLE_VALUE)
+        {
+            std::cout << "ERROR::MAPPED_FILE::OPEN_FAILED " << path << std::endl;
+            return false;
+        }
+        LARGE_INTEGER fileSize;
+        GetFileSizeEx(file, &fileSize);
+        length = (size_t)fileSize.QuadPart;
+        if (length == 0)
+            return opened = true;
+        mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+        if (mapping)
+            bytes = (const char*)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+#else
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0)
+        {
+            std::cout << "ERROR::MAPPED_FILE::OPEN_FAILED " << path << std::endl;
+            return false;
+        }
+        struct stat info;
+        fstat(fd, &info);
+        length = (size_t)info.st_size;
+        if (length == 0)
+        {
+            ::close(fd);
+            return opened = true;
+        }
+        void* view = mmap(NULL, length, PROT_READ, MAP_PRIVATE, fd, 0);
+        // the mapping keeps the file alive, the descriptor isn't needed anymore
+        ::close(fd);
+        if (view != MAP_FAILED)
+        {
+            bytes = (const char*)view;
+            // all of it is about to be parsed, so start reading it in now instead of one page fault at a time
+            madvise(view, length, MADV_WILLNEED);
+        }
+#endif
+        if (!bytes)
+        {
+            std::cout << "ERROR::MAPPED_FILE::MAP_FAILED " << path << std::endl;
+            close();
+            return false;
+        }
+        return opened = true;
+    }
+    // ------------------------------------------------------------------------
+    void close()
+    {
+#if defined(_WIN32)
+        if (bytes)
+            UnmapViewOfFile(bytes);
+        if (mapping)
+            CloseHandle(mapping);
+        if (file != INVALID_HANDLE_VALUE)
+            CloseHandle(file);
+        mapping = NULL;
+        file = INVALID_HANDLE_VALUE;
+#else
+        if (bytes)
+            munmap((void*)bytes, length);
+#endif
+        bytes = nullptr;
+        length = 0;
+        opened = false;
+    }
+    // ------------------------------------------------------------------------
+    const char* data() const { return bytes; }
+    size_t size() const { return length; }
+    bool valid() const { return opened; }
+
+private:
+    const char* bytes = nullptr;
+    size_t length = 0;
+    bool opened = false;
+#if defined(_WIN32)
+    HANDLE file = INVALID_HANDLE_VALUE;
+    HANDLE mapping = NULL;
+#endif
+};
+#endif
@@ -0,0 +1,85 @@
+#ifndef MESH_DATA_H
+#define MESH_DATA_H
+
+#include <glm/glm.hpp>
+
+#include "vertex_layout.h"
+#include "vertex_compression.h"
+
+#include <vector>
+#include <cstdint>
+#include <cmath>
+
+static_assert(sizeof(VertexPNT) == 8 * sizeof(float), "VertexPNT has to be 8 tightly packed floats");
+
+// one level of detail: a range of the index buffer, all levels share the same vertices.
+// error is how far (in model units) the level can be off from the full mesh. mesh_file.h stores these as is
+struct MeshLod
+{
+    uint32_t firstIndex;
+    uint32_t indexCount;
+    float error;
+    uint32_t reserved;
+};
+
+// An indexed triangle mesh on the CPU: interleaved vertices + 32 bit indices, ready to go into a
+// GL_ARRAY_BUFFER / GL_ELEMENT_ARRAY_BUFFER as is, or through quantize() first for half the size.
+struct MeshData
+{
+    std::vector<VertexPNT> vertices;
+    std::vector<uint32_t> indices;
+    std::vector<MeshLod> lods;      // empty = just the one level, all of indices (mesh_simplifier.h fills this)
+    glm::vec3 boundsMin = glm::vec3(0.0f);
+    glm::vec3 boundsMax = glm::vec3(0.0f);
+
+    size_t triangleCount() const { return indices.size() / 3; }
+
+    // axis aligned box around every vertex
+    // ------------------------------------------------------------------------
+    void computeBounds()
+    {
+        if (vertices.empty())
+        {
+            boundsMin = boundsMax = glm::vec3(0.0f);
+            return;
+        }
+        boundsMin = boundsMax = vertices[0].position;
+        for (const VertexPNT& v : vertices)
+        {
+            boundsMin = glm::min(boundsMin, v.position);
+            boundsMax = glm::max(boundsMax, v.position);
+        }
+    }
+    // smooth normals for meshes that came without any: every triangle adds its (area weighted) face normal
+    // to its corners, then they get normalized
+    // ------------------------------------------------------------------------
+    void computeNormals()
+    {
+        for (VertexPNT& v : vertices)
+            v.normal = glm::vec3(0.0f);
+        for (size_t i = 0; i + 2 < indices.size(); i += 3)
+        {
+            VertexPNT& a = vertices[indices[i]];
+            VertexPNT& b = vertices[indices[i + 1]];
+            VertexPNT& c = vertices[indices[i + 2]];
+            // not normalized on purpose, the length is twice the triangle area
+            glm::vec3 n = glm::cross(b.position - a.position, c.position - a.position);
+            a.normal += n;
+            b.normal += n;
+            c.normal += n;
+        }
+        for (VertexPNT& v : vertices)
+        {
+            float length = glm::length(v.normal);
+            v.normal = length > 0.0f ? v.normal / length : glm::vec3(0.0f, 1.0f, 0.0f);
+        }
+    }
+    // half float position/UV + 2_10_10_10 normal, laid out like VertexPNTQuantized (16 bytes a vertex)
+    // ------------------------------------------------------------------------
+    CompressedVertices quantize() const
+    {
+        return CompressedVertices::compress(vertices.empty() ? nullptr : &vertices[0].position.x, vertices.size(),
+            { { 0, 3, VertexEncoding::Half }, { 1, 3, VertexEncoding::Snorm10 }, { 2, 2, VertexEncoding::Half } });
+    }
+};
+#endif
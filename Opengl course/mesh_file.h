@@ -0,0 +1,215 @@
+#ifndef MESH_FILE_H
+#define MESH_FILE_H
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include "mesh_data.h"
+#include "mapped_file.h"
+#include "vertex_layout.h"
+
+#include <string>
+#include <vector>
+#include <fstream>
+#include <cstring>
+#include <cstdint>
+#include <iostream>
+
+// Our own binary mesh format (.mesh), made from an .obj/.glb once by the MeshConvert tool so chapters don't
+// parse text on every launch. The vertex and index data are stored exactly the way GL wants them, so loading
+// is: map the file, check the header, hand the mapped pointers to glNamedBufferStorage. No parsing and no
+// copies on the CPU side, the driver reads straight out of the page cache.
+//
+//   MeshFileHeader       fixed size, says where everything else is
+//   MeshLod[lodCount]    index ranges, lod 0 is the full mesh (see MeshLod in mesh_data.h)
+//   vertex blob          vertexCount * vertexStride bytes, VertexPNT or VertexPNTQuantized, 64 byte aligned
+//   index blob           indexCount 16 or 32 bit indices, 64 byte aligned
+//
+// Everything is little endian (the file is written on the same kind of machine that reads it).
+const uint32_t MESH_FILE_MAGIC = 0x4853454D; // "MESH"
+const uint32_t MESH_FILE_VERSION = 1;
+const uint32_t MESH_FILE_ALIGNMENT = 64;
+
+enum class MeshVertexFormat : uint32_t
+{
+    Float = 0,      // VertexPNT, 32 bytes
+    Quantized = 1   // VertexPNTQuantized, 16 bytes
+};
+
+struct MeshFileHeader
+{
+    uint32_t magic;
+    uint32_t version;
+    uint32_t headerSize;
+    uint32_t vertexFormat;  // MeshVertexFormat
+    uint32_t vertexStride;
+    uint32_t indexSize;     // 2 or 4 bytes
+    uint32_t vertexCount;
+    uint32_t indexCount;
+    uint32_t lodCount;
+    uint32_t reserved;
+    float boundsMin[3];
+    float boundsMax[3];
+    uint64_t lodOffset;
+    uint64_t vertexOffset;
+    uint64_t vertexBytes;
+    uint64_t indexOffset;
+    uint64_t indexBytes;
+};
+static_assert(sizeof(MeshFileHeader) == 104, "MeshFileHeader layout changed, bump MESH_FILE_VERSION");
+static_assert(sizeof(MeshLod) == 16, "MeshLod layout changed, bump MESH_FILE_VERSION");
+
+class MeshFile
+{
+public:
+    // writes mesh as a .mesh file. quantize stores 16 byte vertices, indices are stored 16 bit when they fit.
+    // mesh.lods goes into the lod table, no lods means one level with the whole index buffer
+    // ------------------------------------------------------------------------
+    static bool write(const std::string& path, const MeshData& mesh, bool quantize)
+    {
+        std::vector<unsigned char> vertexBlob;
+        if (quantize)
+            vertexBlob = mesh.quantize().data;
+        else
+            vertexBlob.assign((const unsigned char*)mesh.vertices.data(), (const unsigned char*)(mesh.vertices.data() + mesh.vertices.size()));
+
+        bool shortIndices = mesh.vertices.size() <= 65536;
+        std::vector<unsigned char> indexBlob(mesh.indices.size() * (shortIndices ? 2 : 4));
+        if (shortIndices)
+        {
+            for (size_t i = 0; i < mesh.indices.size(); i++)
+            {
+                uint16_t index = (uint16_t)mesh.indices[i];
+                std::memcpy(&indexBlob[i * 2], &index, 2);
+            }
+        }
+        else if (!indexBlob.empty())
+            std::memcpy(indexBlob.data(), mesh.indices.data(), indexBlob.size());
+
+        std::vector<MeshLod> table = mesh.lods;
+        if (table.empty())
+            table.push_back({ 0, (uint32_t)mesh.indices.size(), 0.0f, 0 });
+
+        MeshFileHeader header = {};
+        header.magic = MESH_FILE_MAGIC;
+        header.version = MESH_FILE_VERSION;
+        header.headerSize = sizeof(MeshFileHeader);
+        header.vertexFormat = (uint32_t)(quantize ? MeshVertexFormat::Quantized : MeshVertexFormat::Float);
+        header.vertexStride = quantize ? sizeof(VertexPNTQuantized) : sizeof(VertexPNT);
+        header.indexSize = shortIndices ? 2 : 4;
+        header.vertexCount = (uint32_t)mesh.vertices.size();
+        header.indexCount = (uint32_t)mesh.indices.size();
+        header.lodCount = (uint32_t)table.size();
+        for (int i = 0; i < 3; i++)
+        {
+            header.boundsMin[i] = mesh.boundsMin[i];
+            header.boundsMax[i] = mesh.boundsMax[i];
+        }
+        header.lodOffset = sizeof(MeshFileHeader);
+        header.vertexOffset = align(header.lodOffset + table.size() * sizeof(MeshLod));
+        header.vertexBytes = vertexBlob.size();
+        header.indexOffset = align(header.vertexOffset + header.vertexBytes);
+        header.indexBytes = indexBlob.size();
+
+        std::ofstream out(path, std::ios::binary | std::ios::trunc);
+        if (!out)
+        {
+            std::cout << "ERROR::MESH_FILE::CANNOT_WRITE " << path << std::endl;
+            return false;
+        }
+        out.write((const char*)&header, sizeof(header));
+        out.write((const char*)table.data(), table.size() * sizeof(MeshLod));
+        pad(out, header.vertexOffset);
+        out.write((const char*)vertexBlob.data(), vertexBlob.size());
+        pad(out, header.indexOffset);
+        out.write((const char*)indexBlob.data(), indexBlob.size());
+        if (!out)
+        {
+            std::cout << "ERROR::MESH_FILE::CANNOT_WRITE " << path << std::endl;
+            return false;
+        }
+        return true;
+    }
+
+    // maps the file and checks the header, nothing is read beyond that until the data gets used
+    // ------------------------------------------------------------------------
+    bool open(const std::string& path)
+    {
+        header = nullptr;
+        if (!file.open(path))
+            return false;
+        if (file.size() < sizeof(MeshFileHeader))
+            return fail(path, "TOO_SMALL");
+        const MeshFileHeader* h = (const MeshFileHeader*)file.data();
+        if (h->magic != MESH_FILE_MAGIC)
+            return fail(path, "NOT_A_MESH_FILE");
+        if (h->version != MESH_FILE_VERSION || h->headerSize != sizeof(MeshFileHeader))
+            return fail(path, "UNSUPPORTED_VERSION");
+        uint32_t stride = h->vertexFormat == (uint32_t)MeshVertexFormat::Quantized ? sizeof(VertexPNTQuantized) : sizeof(VertexPNT);
+        if (h->vertexFormat > (uint32_t)MeshVertexFormat::Quantized || h->vertexStride != stride || (h->indexSize != 2 && h->indexSize != 4))
+            return fail(path, "BAD_FORMAT");
+        // every blob has to be inside the file, the right size and aligned, so the pointers can go to GL as is
+        if (!inside(h->lodOffset, (uint64_t)h->lodCount * sizeof(MeshLod)) || h->lodCount == 0
+            || !inside(h->vertexOffset, h->vertexBytes) || h->vertexBytes != (uint64_t)h->vertexCount * h->vertexStride
+            || !inside(h->indexOffset, h->indexBytes) || h->indexBytes != (uint64_t)h->indexCount * h->indexSize
+            || h->vertexOffset % MESH_FILE_ALIGNMENT != 0 || h->indexOffset % MESH_FILE_ALIGNMENT != 0)
+            return fail(path, "CORRUPT");
+        const MeshLod* table = (const MeshLod*)(file.data() + h->lodOffset);
+        for (uint32_t i = 0; i < h->lodCount; i++)
+            if ((uint64_t)table[i].firstIndex + table[i].indexCount > h->indexCount)
+                return fail(path, "CORRUPT");
+        header = h;
+        return true;
+    }
+    // ------------------------------------------------------------------------
+    bool valid() const { return header != nullptr; }
+    const MeshFileHeader& info() const { return *header; }
+    bool quantized() const { return header->vertexFormat == (uint32_t)MeshVertexFormat::Quantized; }
+    const void* vertices() const { return file.data() + header->vertexOffset; }
+    const void* indices() const { return file.data() + header->indexOffset; }
+    const MeshLod& lod(uint32_t level) const { return ((const MeshLod*)(file.data() + header->lodOffset))[level]; }
+    uint32_t lodCount() const { return header->lodCount; }
+    // for glDrawElements
+    unsigned int indexType() const { return header->indexSize == 2 ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT; }
+    const void* indexOffset(const MeshLod& level) const { return (const void*)(uintptr_t)(level.firstIndex * header->indexSize); }
+    glm::vec3 boundsMin() const { return glm::vec3(header->boundsMin[0], header->boundsMin[1], header->boundsMin[2]); }
+    glm::vec3 boundsMax() const { return glm::vec3(header->boundsMax[0], header->boundsMax[1], header->boundsMax[2]); }
+
+    // immutable GL buffers filled straight from the mapping. the file can be closed once these exist
+    // ------------------------------------------------------------------------
+    unsigned int createVertexBuffer() const { return createStaticBuffer(vertices(), (size_t)header->vertexBytes); }
+    unsigned int createIndexBuffer() const { return createStaticBuffer(indices(), (size_t)header->indexBytes); }
+    // ------------------------------------------------------------------------
+    void close()
+    {
+        header = nullptr;
+        file.close();
+    }
+
+private:
+    MappedFile file;
+    const MeshFileHeader* header = nullptr;
+
+    static uint64_t align(uint64_t offset)
+    {
+        return (offset + MESH_FILE_ALIGNMENT - 1) / MESH_FILE_ALIGNMENT * MESH_FILE_ALIGNMENT;
+    }
+    static void pad(std::ofstream& out, uint64_t offset)
+    {
+        static const char zeros[MESH_FILE_ALIGNMENT] = {};
+        uint64_t at = (uint64_t)out.tellp();
+        if (offset > at)
+            out.write(zeros, (std::streamsize)(offset - at));
+    }
+    bool inside(uint64_t offset, uint64_t bytes) const
+    {
+        return offset <= file.size() && bytes <= file.size() - offset;
+    }
+    bool fail(const std::string& path, const char* reason)
+    {
+        std::cout << "ERROR::MESH_FILE::" << reason << " " << path << std::endl;
+        file.close();
+        return false;
+    }
+};
+#endif
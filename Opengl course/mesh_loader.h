@@ -0,0 +1,609 @@
+#ifndef MESH_LOADER_H
+#define MESH_LOADER_H
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+#include "mesh_data.h"
+#include "mapped_file.h"
+#include "json_value.h"
+
+#include <string>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <algorithm>
+#include <cstring>
+#include <cctype>
+#include <cstdint>
+#include <cmath>
+#include <iostream>
+
+// Mesh import: Wavefront OBJ and binary glTF 2.0 (.glb), into one indexed MeshData.
+//
+// Files are memory mapped (mapped_file.h) and parsed in parallel:
+//   OBJ  the file gets cut into one chunk per thread at line breaks. Each thread parses its own v/vn/vt/f
+//        lines, then the chunks are stitched together (OBJ indices count across the whole file, so chunk k
+//        needs to know how many positions chunks 0..k-1 had) and the (v, vt, vn) corners are turned into
+//        unique vertices. Polygons are fanned into triangles.
+//   glb  the JSON chunk says where every primitive's attributes live in the binary chunk, so each primitive
+//        (with its node transform baked in) gets converted on its own thread, straight out of the mapping.
+//
+// Meshes without normals get smooth ones. Materials, skins and animations are ignored.
+class MeshLoader
+{
+public:
+    // picks the parser from the file extension. threads = 0 uses every core
+    // ------------------------------------------------------------------------
+    static bool load(const std::string& path, MeshData& mesh, unsigned int threads = 0)
+    {
+        std::string extension = path.size() >= 4 ? path.substr(path.size() - 4) : "";
+        std::transform(extension.begin(), extension.end(), extension.begin(), [](char c) { return (char)std::tolower((unsigned char)c); });
+        if (extension == ".obj")
+            return loadObj(path, mesh, threads);
+        if (extension == ".glb")
+            return loadGlb(path, mesh, threads);
+        std::cout << "ERROR::MESH_LOADER::UNKNOWN_FORMAT " << path << " (.obj and .glb are supported)" << std::endl;
+        return false;
+    }
+
+    // ------------------------------------------------------------------------
+    static bool loadObj(const std::string& path, MeshData& mesh, unsigned int threads = 0)
+    {
+        MappedFile file(path);
+        if (!file.valid())
+            return false;
+        const char* text = file.data();
+        size_t length = file.size();
+
+        // 1. cut into chunks at line breaks, at least 1MB each so small files stay on one thread
+        unsigned int chunkCount = threadCount(threads, length, 1 << 20);
+        std::vector<size_t> starts(chunkCount + 1, length);
+        starts[0] = 0;
+        for (unsigned int i = 1; i < chunkCount; i++)
+        {
+            size_t at = std::max(starts[i - 1], length / chunkCount * i);
+            while (at < length && text[at - 1] != '\n')
+                at++;
+            starts[i] = at;
+        }
+
+        // 2. parse every chunk on its own thread
+        std::vector<ObjChunk> chunks(chunkCount);
+        parallelFor(chunkCount, chunkCount, [&](size_t i) { parseObjChunk(text + starts[i], text + starts[i + 1], chunks[i]); });
+
+        // 3. stitch: running totals tell each chunk where its positions/normals/uvs land in the whole file
+        std::vector<glm::vec3> positions, normals;
+        std::vector<glm::vec2> texCoords;
+        size_t cornerCount = 0;
+        for (ObjChunk& chunk : chunks)
+        {
+            int base[3] = { (int)positions.size(), (int)texCoords.size(), (int)normals.size() };
+            for (const ObjFixup& fixup : chunk.fixups)
+                chunk.corners[fixup.corner][fixup.component] = base[fixup.component] + fixup.local;
+            positions.insert(positions.end(), chunk.positions.begin(), chunk.positions.end());
+            texCoords.insert(texCoords.end(), chunk.texCoords.begin(), chunk.texCoords.end());
+            normals.insert(normals.end(), chunk.normals.begin(), chunk.normals.end());
+            cornerCount += chunk.corners.size();
+            std::vector<glm::vec3>().swap(chunk.positions);
+            std::vector<glm::vec3>().swap(chunk.normals);
+            std::vector<glm::vec2>().swap(chunk.texCoords);
+        }
+
+        // 4. one vertex per unique (v, vt, vn), open addressing hash so this stays fast for millions of corners
+        mesh = MeshData();
+        mesh.indices.reserve(cornerCount);
+        size_t capacity = 16;
+        while (capacity < cornerCount * 2)
+            capacity *= 2;
+        std::vector<uint32_t> table(capacity, UINT32_MAX);
+        std::vector<glm::ivec3> keys;
+        bool anyNormals = false;
+        for (const ObjChunk& chunk : chunks)
+        {
+            for (const glm::ivec3& corner : chunk.corners)
+            {
+                if (corner.x < 0 || corner.x >= (int)positions.size())
+                {
+                    std::cout << "ERROR::MESH_LOADER::OBJ_INDEX_OUT_OF_RANGE " << path << std::endl;
+                    return false;
+                }
+                size_t slot = hashCorner(corner) & (capacity - 1);
+                while (table[slot] != UINT32_MAX && keys[table[slot]] != corner)
+                    slot = (slot + 1) & (capacity - 1);
+                if (table[slot] == UINT32_MAX)
+                {
+                    table[slot] = (uint32_t)mesh.vertices.size();
+                    keys.push_back(corner);
+                    VertexPNT v;
+                    v.position = positions[corner.x];
+                    v.texCoords = corner.y >= 0 && corner.y < (int)texCoords.size() ? texCoords[corner.y] : glm::vec2(0.0f);
+                    v.normal = corner.z >= 0 && corner.z < (int)normals.size() ? normals[corner.z] : glm::vec3(0.0f);
+                    anyNormals = anyNormals || corner.z >= 0;
+                    mesh.vertices.push_back(v);
+                }
+                mesh.indices.push_back(table[slot]);
+            }
+        }
+        if (!anyNormals)
+            mesh.computeNormals();
+        mesh.computeBounds();
+        return true;
+    }
+
+    // ------------------------------------------------------------------------
+    static bool loadGlb(const std::string& path, MeshData& mesh, unsigned int threads = 0)
+    {
+        MappedFile file(path);
+        if (!file.valid())
+            return false;
+        const unsigned char* bytes = (const unsigned char*)file.data();
+        size_t length = file.size();
+
+        // 12 byte header, then chunks of (length, type, data). first one is JSON, second the binary buffer
+        if (length < 20 || read32(bytes) != 0x46546C67 || read32(bytes + 4) != 2)
+        {
+            std::cout << "ERROR::MESH_LOADER::NOT_A_GLB_V2 " << path << std::endl;
+            return false;
+        }
+        size_t jsonLength = read32(bytes + 12);
+        if (read32(bytes + 16) != 0x4E4F534A || 20 + jsonLength > length)
+        {
+            std::cout << "ERROR::MESH_LOADER::GLB_MISSING_JSON " << path << std::endl;
+            return false;
+        }
+        JsonValue json;
+        if (!JsonValue::parse((const char*)bytes + 20, jsonLength, json))
+        {
+            std::cout << "ERROR::MESH_LOADER::GLB_BAD_JSON " << path << std::endl;
+            return false;
+        }
+        Binary bin = { nullptr, 0 };
+        size_t binHeader = 20 + ((jsonLength + 3) & ~(size_t)3);
+        if (binHeader + 8 <= length && read32(bytes + binHeader + 4) == 0x004E4942)
+        {
+            bin.data = bytes + binHeader + 8;
+            bin.size = std::min<size_t>(read32(bytes + binHeader), length - binHeader - 8);
+        }
+
+        // every triangle primitive we have to convert, with the transform of the node it hangs off
+        std::vector<GltfPrimitive> primitives;
+        const JsonValue& scenes = json["scenes"];
+        if (scenes.size() > 0)
+        {
+            const JsonValue& scene = scenes[json["scene"].integer(0)];
+            for (const JsonValue& node : scene["nodes"].items)
+                collectNode(json, node.integer(), glm::mat4(1.0f), primitives, 0);
+        }
+        else
+        {
+            for (size_t m = 0; m < json["meshes"].size(); m++)
+                collectMesh(json, (int)m, glm::mat4(1.0f), primitives);
+        }
+
+        // work out where every primitive's vertices/indices go, then convert them all in parallel
+        size_t vertexTotal = 0, indexTotal = 0;
+        for (GltfPrimitive& primitive : primitives)
+        {
+            const JsonValue& attributes = (*primitive.json)["attributes"];
+            primitive.vertexCount = json["accessors"][attributes["POSITION"].integer(-1)]["count"].integer();
+            primitive.indexCount = primitive.json->has("indices") ? json["accessors"][(*primitive.json)["indices"].integer()]["count"].integer() : primitive.vertexCount;
+            primitive.firstVertex = vertexTotal;
+            primitive.firstIndex = indexTotal;
+            vertexTotal += primitive.vertexCount;
+            indexTotal += primitive.indexCount;
+        }
+        mesh = MeshData();
+        mesh.vertices.resize(vertexTotal);
+        mesh.indices.resize(indexTotal);
+        std::atomic<bool> ok(true);
+        std::atomic<bool> missingNormals(false);
+        parallelFor(primitives.size(), threadCount(threads, primitives.size(), 1), [&](size_t i)
+        {
+            bool hasNormals = true;
+            if (!convertPrimitive(json, bin, primitives[i], mesh, hasNormals))
+                ok = false;
+            if (!hasNormals)
+                missingNormals = true;
+        });
+        if (!ok)
+        {
+            std::cout << "ERROR::MESH_LOADER::GLB_BAD_ACCESSOR " << path << std::endl;
+            return false;
+        }
+        if (missingNormals)
+            mesh.computeNormals();
+        mesh.computeBounds();
+        return true;
+    }
+
+private:
+    // ------------------------------------------------------------------------
+    // shared
+    // ------------------------------------------------------------------------
+    static unsigned int threadCount(unsigned int requested, size_t work, size_t minimumPerThread)
+    {
+        unsigned int count = requested ? requested : std::max(1u, std::thread::hardware_concurrency());
+        size_t useful = std::max<size_t>(1, work / std::max<size_t>(1, minimumPerThread));
+        return (unsigned int)std::min<size_t>(count, useful);
+    }
+    // runs job(0..count-1) on threadCount threads, each grabbing the next index when it's done
+    template <class Job>
+    static void parallelFor(size_t count, unsigned int threadCount, const Job& job)
+    {
+        std::atomic<size_t> next(0);
+        auto worker = [&]()
+        {
+            for (size_t i = next++; i < count; i = next++)
+                job(i);
+        };
+        std::vector<std::thread> pool;
+        for (unsigned int t = 1; t < threadCount; t++)
+            pool.emplace_back(worker);
+        worker();
+        for (std::thread& thread : pool)
+            thread.join();
+    }
+
+    // ------------------------------------------------------------------------
+    // OBJ
+    // ------------------------------------------------------------------------
+    // a negative (relative) index that points before this chunk's first element, resolved while stitching
+    struct ObjFixup
+    {
+        size_t corner;
+        int component; // 0 = v, 1 = vt, 2 = vn
+        int local;     // index counted from this chunk's start, can be negative
+    };
+    struct ObjChunk
+    {
+        std::vector<glm::vec3> positions, normals;
+        std::vector<glm::vec2> texCoords;
+        std::vector<glm::ivec3> corners; // 3 per triangle, (v, vt, vn), -1 where missing
+        std::vector<ObjFixup> fixups;
+    };
+
+    static bool isSpace(char c) { return c == ' ' || c == '\t'; }
+    static bool isLineEnd(char c) { return c == '\n' || c == '\r'; }
+    static void skipSpace(const char*& p, const char* end)
+    {
+        while (p < end && isSpace(*p))
+            p++;
+    }
+    static void skipLine(const char*& p, const char* end)
+    {
+        while (p < end && *p != '\n')
+            p++;
+        if (p < end)
+            p++;
+    }
+    // strtof is locale dependent and slow, this handles everything OBJ exporters write
+    static float parseFloat(const char*& p, const char* end)
+    {
+        static const double powers[] = { 1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11, 1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18 };
+        skipSpace(p, end);
+        bool negative = false;
+        if (p < end && (*p == '-' || *p == '+'))
+            negative = *p++ == '-';
+        uint64_t mantissa = 0;
+        int exponent = 0, digits = 0;
+        for (; p < end && *p >= '0' && *p <= '9'; p++)
+        {
+            if (digits < 18) { mantissa = mantissa * 10 + (*p - '0'); digits++; }
+            else exponent++;
+        }
+        if (p < end && *p == '.')
+        {
+            for (p++; p < end && *p >= '0' && *p <= '9'; p++)
+            {
+                if (digits < 18) { mantissa = mantissa * 10 + (*p - '0'); digits++; exponent--; }
+            }
+        }
+        if (p < end && (*p == 'e' || *p == 'E'))
+        {
+            p++;
+            bool negativeExponent = false;
+            if (p < end && (*p == '-' || *p == '+'))
+                negativeExponent = *p++ == '-';
+            int e = 0;
+            for (; p < end && *p >= '0' && *p <= '9'; p++)
+                e = std::min(e * 10 + (*p - '0'), 1000);
+            exponent += negativeExponent ? -e : e;
+        }
+        double value = (double)mantissa;
+        if (exponent < 0)
+            value = -exponent <= 18 ? value / powers[-exponent] : value * std::pow(10.0, exponent);
+        else if (exponent > 0)
+            value = exponent <= 18 ? value * powers[exponent] : value * std::pow(10.0, exponent);
+        return (float)(negative ? -value : value);
+    }
+    static bool parseInt(const char*& p, const char* end, int& out)
+    {
+        bool negative = false;
+        if (p < end && (*p == '-' || *p == '+'))
+            negative = *p++ == '-';
+        if (p >= end || *p < '0' || *p > '9')
+            return false;
+        int value = 0;
+        for (; p < end && *p >= '0' && *p <= '9'; p++)
+            value = value * 10 + (*p - '0');
+        out = negative ? -value : value;
+        return true;
+    }
+    // one face corner "v", "v/vt", "v//vn" or "v/vt/vn". OBJ counts from 1, negative counts back from the end
+    static bool parseCorner(const char*& p, const char* end, ObjChunk& chunk, size_t cornerIndex, glm::ivec3& corner)
+    {
+        int counts[3] = { (int)chunk.positions.size(), (int)chunk.texCoords.size(), (int)chunk.normals.size() };
+        corner = glm::ivec3(-1);
+        for (int component = 0; component < 3; component++)
+        {
+            if (component > 0)
+            {
+                if (p >= end || *p != '/')
+                    break;
+                p++;
+                // "v//vn" has no vt
+                if (p < end && *p == '/')
+                    continue;
+            }
+            int value;
+            if (!parseInt(p, end, value))
+                return component > 0;
+            if (value > 0)
+                corner[component] = value - 1;
+            else if (value < 0)
+            {
+                // relative to what's been parsed so far, and that's only known for this chunk yet
+                corner[component] = 0;
+                chunk.fixups.push_back({ cornerIndex, component, counts[component] + value });
+            }
+        }
+        return true;
+    }
+    static void parseObjChunk(const char* p, const char* end, ObjChunk& chunk)
+    {
+        std::vector<glm::ivec3> polygon;
+        std::vector<ObjFixup> polygonFixups;
+        while (p < end)
+        {
+            skipSpace(p, end);
+            if (p + 1 >= end)
+                break;
+            if (p[0] == 'v' && isSpace(p[1]))
+            {
+                p += 2;
+                glm::vec3 v;
+                v.x = parseFloat(p, end);
+                v.y = parseFloat(p, end);
+                v.z = parseFloat(p, end);
+                chunk.positions.push_back(v);
+            }
+            else if (p[0] == 'v' && p[1] == 'n')
+            {
+                p += 2;
+                glm::vec3 n;
+                n.x = parseFloat(p, end);
+                n.y = parseFloat(p, end);
+                n.z = parseFloat(p, end);
+                chunk.normals.push_back(n);
+            }
+            else if (p[0] == 'v' && p[1] == 't')
+            {
+                p += 2;
+                glm::vec2 t;
+                t.x = parseFloat(p, end);
+                t.y = parseFloat(p, end);
+                chunk.texCoords.push_back(t);
+            }
+            else if (p[0] == 'f' && isSpace(p[1]))
+            {
+                p += 2;
+                // gather the polygon's corners, with fixups numbered by position in the polygon for now
+                polygon.clear();
+                polygonFixups.clear();
+                std::swap(chunk.fixups, polygonFixups);
+                while (true)
+                {
+                    skipSpace(p, end);
+                    if (p >= end || isLineEnd(*p))
+                        break;
+                    glm::ivec3 corner;
+                    if (!parseCorner(p, end, chunk, polygon.size(), corner))
+                        break;
+                    polygon.push_back(corner);
+                }
+                std::swap(chunk.fixups, polygonFixups);
+                // fan it into triangles (0, i, i + 1)
+                for (size_t i = 1; i + 1 < polygon.size(); i++)
+                {
+                    size_t first = chunk.corners.size();
+                    size_t picks[3] = { 0, i, i + 1 };
+                    for (int k = 0; k < 3; k++)
+                    {
+                        chunk.corners.push_back(polygon[picks[k]]);
+                        for (const ObjFixup& fixup : polygonFixups)
+                            if (fixup.corner == picks[k])
+                                chunk.fixups.push_back({ first + k, fixup.component, fixup.local });
+                    }
+                }
+            }
+            skipLine(p, end);
+        }
+    }
+    static size_t hashCorner(const glm::ivec3& c)
+    {
+        uint64_t h = (uint64_t)(uint32_t)c.x * 0x9E3779B97F4A7C15ull;
+        h ^= (uint64_t)(uint32_t)c.y * 0xC2B2AE3D27D4EB4Full + (h >> 29);
+        h ^= (uint64_t)(uint32_t)c.z * 0x165667B19E3779F9ull + (h >> 32);
+        return (size_t)(h ^ (h >> 31));
+    }
+
+    // ------------------------------------------------------------------------
+    // glTF
+    // ------------------------------------------------------------------------
+    struct Binary
+    {
+        const unsigned char* data;
+        size_t size;
+    };
+    struct GltfPrimitive
+    {
+        const JsonValue* json;
+        glm::mat4 transform;
+        size_t vertexCount = 0, indexCount = 0;
+        size_t firstVertex = 0, firstIndex = 0;
+    };
+
+    static uint32_t read32(const unsigned char* p)
+    {
+        return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+    }
+    static glm::mat4 nodeTransform(const JsonValue& node)
+    {
+        const JsonValue& matrix = node["matrix"];
+        if (matrix.size() == 16)
+        {
+            glm::mat4 m;
+            for (int i = 0; i < 16; i++)
+                m[i / 4][i % 4] = (float)matrix[i].number();
+            return m;
+        }
+        // T * R * S, each one optional
+        const JsonValue& t = node["translation"];
+        const JsonValue& r = node["rotation"];
+        const JsonValue& s = node["scale"];
+        glm::mat4 m(1.0f);
+        if (t.size() == 3)
+            m = glm::translate(m, glm::vec3((float)t[0].number(), (float)t[1].number(), (float)t[2].number()));
+        if (r.size() == 4)
+            m = m * glm::mat4_cast(glm::quat((float)r[3].number(), (float)r[0].number(), (float)r[1].number(), (float)r[2].number()));
+        if (s.size() == 3)
+            m = glm::scale(m, glm::vec3((float)s[0].number(1.0), (float)s[1].number(1.0), (float)s[2].number(1.0)));
+        return m;
+    }
+    static void collectMesh(const JsonValue& json, int meshIndex, const glm::mat4& transform, std::vector<GltfPrimitive>& out)
+    {
+        for (const JsonValue& primitive : json["meshes"][meshIndex]["primitives"].items)
+        {
+            // 4 = GL_TRIANGLES, the default. points, lines and strips are skipped
+            if (primitive["mode"].integer(4) != 4 || !primitive["attributes"].has("POSITION"))
+                continue;
+            GltfPrimitive p;
+            p.json = &primitive;
+            p.transform = transform;
+            out.push_back(p);
+        }
+    }
+    static void collectNode(const JsonValue& json, int nodeIndex, const glm::mat4& parent, std::vector<GltfPrimitive>& out, int depth)
+    {
+        const JsonValue& node = json["nodes"][nodeIndex];
+        if (node.type != JsonValue::Object || depth > 64)
+            return;
+        glm::mat4 world = parent * nodeTransform(node);
+        if (node.has("mesh"))
+            collectMesh(json, node["mesh"].integer(), world, out);
+        for (const JsonValue& child : node["children"].items)
+            collectNode(json, child.integer(), world, out, depth + 1);
+    }
+
+    // reads one accessor element as floats (normalized integers become 0..1 / -1..1 like GL would)
+    struct Accessor
+    {
+        const unsigned char* data = nullptr;
+        size_t stride = 0;
+        size_t count = 0;
+        int componentType = 0;
+        int components = 0;
+        bool normalized = false;
+
+        bool open(const JsonValue& json, const Binary& bin, int index)
+        {
+            const JsonValue& accessor = json["accessors"][index];
+            const JsonValue& view = json["bufferViews"][accessor["bufferView"].integer(-1)];
+            // only the glb's own binary chunk, no external .bin files or data URIs
+            if (view.type != JsonValue::Object || view["buffer"].integer(0) != 0 || !bin.data)
+                return false;
+            const std::string& type = accessor["type"].string();
+            components = type == "SCALAR" ? 1 : type == "VEC2" ? 2 : type == "VEC3" ? 3 : type == "VEC4" ? 4 : 0;
+            componentType = accessor["componentType"].integer();
+            normalized = accessor["normalized"].boolean;
+            count = (size_t)accessor["count"].integer();
+            size_t componentSize = componentType == 5126 || componentType == 5125 ? 4 : componentType == 5122 || componentType == 5123 ? 2 : 1;
+            size_t offset = (size_t)view["byteOffset"].number() + (size_t)accessor["byteOffset"].number();
+            stride = view.has("byteStride") ? (size_t)view["byteStride"].number() : componentSize * components;
+            if (components == 0 || count == 0 || offset + stride * (count - 1) + componentSize * components > bin.size)
+                return false;
+            data = bin.data + offset;
+            return true;
+        }
+        float component(size_t element, int c) const
+        {
+            const unsigned char* p = data + element * stride;
+            switch (componentType)
+            {
+            case 5126: { float f; std::memcpy(&f, p + c * 4, 4); return f; }
+            case 5121: return normalized ? p[c] / 255.0f : (float)p[c];
+            case 5120: return normalized ? std::max((signed char)p[c] / 127.0f, -1.0f) : (float)(signed char)p[c];
+            case 5123: { uint16_t v; std::memcpy(&v, p + c * 2, 2); return normalized ? v / 65535.0f : (float)v; }
+            case 5122: { int16_t v; std::memcpy(&v, p + c * 2, 2); return normalized ? std::max(v / 32767.0f, -1.0f) : (float)v; }
+            }
+            return 0.0f;
+        }
+        uint32_t index(size_t element) const
+        {
+            const unsigned char* p = data + element * stride;
+            switch (componentType)
+            {
+            case 5121: return p[0];
+            case 5123: { uint16_t v; std::memcpy(&v, p, 2); return v; }
+            case 5125: { uint32_t v; std::memcpy(&v, p, 4); return v; }
+            }
+            return 0;
+        }
+    };
+    static bool convertPrimitive(const JsonValue& json, const Binary& bin, const GltfPrimitive& primitive, MeshData& mesh, bool& hasNormals)
+    {
+        const JsonValue& attributes = (*primitive.json)["attributes"];
+        Accessor positions, normals, texCoords;
+        if (!positions.open(json, bin, attributes["POSITION"].integer(-1)) || positions.components != 3)
+            return false;
+        hasNormals = attributes.has("NORMAL") && normals.open(json, bin, attributes["NORMAL"].integer()) && normals.count == positions.count;
+        bool hasTexCoords = attributes.has("TEXCOORD_0") && texCoords.open(json, bin, attributes["TEXCOORD_0"].integer()) && texCoords.count == positions.count;
+        glm::mat3 normalMatrix = glm::transpose(glm::inverse(glm::mat3(primitive.transform)));
+
+        VertexPNT* out = &mesh.vertices[primitive.firstVertex];
+        for (size_t i = 0; i < positions.count; i++)
+        {
+            glm::vec3 p(positions.component(i, 0), positions.component(i, 1), positions.component(i, 2));
+            out[i].position = glm::vec3(primitive.transform * glm::vec4(p, 1.0f));
+            out[i].normal = glm::vec3(0.0f);
+            if (hasNormals)
+                out[i].normal = glm::normalize(normalMatrix * glm::vec3(normals.component(i, 0), normals.component(i, 1), normals.component(i, 2)));
+            out[i].texCoords = hasTexCoords ? glm::vec2(texCoords.component(i, 0), texCoords.component(i, 1)) : glm::vec2(0.0f);
+        }
+
+        uint32_t* indices = &mesh.indices[primitive.firstIndex];
+        uint32_t base = (uint32_t)primitive.firstVertex;
+        if (primitive.json->has("indices"))
+        {
+            Accessor source;
+            if (!source.open(json, bin, (*primitive.json)["indices"].integer()) || source.components != 1)
+                return false;
+            for (size_t i = 0; i < source.count; i++)
+            {
+                uint32_t index = source.index(i);
+                if (index >= positions.count)
+                    return false;
+                indices[i] = base + index;
+            }
+        }
+        else
+        {
+            for (size_t i = 0; i < positions.count; i++)
+                indices[i] = base + (uint32_t)i;
+        }
+        return true;
+    }
+};
+#endif
@@ -0,0 +1,375 @@
+#ifndef MESH_OPTIMIZER_H
+#define MESH_OPTIMIZER_H
+
+#include <glm/glm.hpp>
+
+#include "mesh_data.h"
+
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <cstdint>
+#include <cmath>
+#include <cstdio>
+
+// Reorders a MeshData so the GPU does less work drawing the exact same triangles. Run it once at import/bake
+// time (Ch18MeshLoading, MeshConvert), nothing changes at draw time.
+//
+//   optimizeVertexCache  triangle order that reuses recently transformed vertices (Tom Forsyth's "Linear-Speed
+//                        Vertex Cache Optimisation"): every vertex shader result the post transform cache still
+//                        has is a vertex that doesn't get shaded again
+//   optimizeOverdraw     cuts that order into clusters and draws the ones facing outwards first (Sander, Nehab
+//                        and Barczak, "Fast Triangle Reordering for Vertex Locality and Reduced Overdraw"), so the
+//                        inner/back parts fail the depth test instead of being shaded and then covered. Gives up a
+//                        little cache efficiency for it, at most threshold times the ACMR
+//   optimizeVertexFetch  renumbers vertices in the order the indices first use them, so the vertex fetch walks
+//                        the vertex buffer forwards instead of jumping around it
+//
+// analyze() measures the result with a simulated FIFO post transform cache:
+//   ACMR  average cache miss ratio, shaded vertices per triangle. 3 is no reuse at all, ~0.5-0.7 is great
+//   ATVR  average transform to vertex ratio, shaded vertices per vertex. 1 is perfect, every vertex shaded once
+//   overfetch  bytes pulled from the vertex buffer (in 64 byte cache lines) per byte of vertex buffer
+class MeshOptimizer
+{
+public:
+    struct Stats
+    {
+        float acmr = 0.0f;
+        float atvr = 0.0f;
+        float overfetch = 0.0f;
+    };
+
+    // everything, in the order that makes sense, with before/after numbers printed if report is set
+    // ------------------------------------------------------------------------
+    static void optimize(MeshData& mesh, const std::string& name = "", bool report = true, float overdrawThreshold = 1.05f)
+    {
+        Stats before = analyze(mesh);
+        optimizeVertexCache(mesh.indices, mesh.vertices.size());
+        Stats cacheOnly = analyze(mesh);
+        optimizeOverdraw(mesh, overdrawThreshold);
+        optimizeVertexFetch(mesh);
+        Stats after = analyze(mesh);
+        if (!report)
+            return;
+        std::printf("MESH_OPTIMIZER %s: %zu triangles, %zu vertices\n", name.c_str(), mesh.triangleCount(), mesh.vertices.size());
+        std::printf("  before         ACMR %.3f  ATVR %.3f  overfetch %.2f\n", before.acmr, before.atvr, before.overfetch);
+        std::printf("  vertex cache   ACMR %.3f  ATVR %.3f\n", cacheOnly.acmr, cacheOnly.atvr);
+        std::printf("  + overdraw     ACMR %.3f  ATVR %.3f  overfetch %.2f\n", after.acmr, after.atvr, after.overfetch);
+    }
+
+    // ------------------------------------------------------------------------
+    static Stats analyze(const MeshData& mesh, unsigned int cacheSize = 16)
+    {
+        Stats stats;
+        if (mesh.indices.size() < 3 || mesh.vertices.empty())
+            return stats;
+        // post transform cache, FIFO like most hardware
+        std::vector<int64_t> cachedAt(mesh.vertices.size(), -1);
+        int64_t fifoHead = 0;
+        // vertex fetch: which 64 byte lines are still around, FIFO as well
+        const size_t LINE = 64, LINES = 64;
+        std::vector<int64_t> lines;
+        size_t misses = 0, lineMisses = 0;
+        for (uint32_t index : mesh.indices)
+        {
+            if (cachedAt[index] >= 0 && fifoHead - cachedAt[index] < (int64_t)cacheSize)
+                continue;
+            cachedAt[index] = ++fifoHead;
+            misses++;
+            // a shaded vertex reads its bytes, a line at a time
+            size_t first = index * sizeof(VertexPNT) / LINE, last = ((index + 1) * sizeof(VertexPNT) - 1) / LINE;
+            for (size_t line = first; line <= last; line++)
+            {
+                if (std::find(lines.begin(), lines.end(), (int64_t)line) != lines.end())
+                    continue;
+                lineMisses++;
+                lines.push_back((int64_t)line);
+                if (lines.size() > LINES)
+                    lines.erase(lines.begin());
+            }
+        }
+        stats.acmr = (float)misses / (float)mesh.triangleCount();
+        stats.atvr = (float)misses / (float)mesh.vertices.size();
+        stats.overfetch = (float)(lineMisses * LINE) / (float)(mesh.vertices.size() * sizeof(VertexPNT));
+        return stats;
+    }
+
+    // Forsyth: every vertex gets a score from where it sits in a simulated LRU cache (recently used is good) and
+    // how many triangles still need it (few left is good, finish it off). Emit the best scoring triangle next to
+    // what's in the cache, update, repeat. Linear time, the scores only change for vertices near the cache.
+    // ------------------------------------------------------------------------
+    static void optimizeVertexCache(std::vector<uint32_t>& indices, size_t vertexCount)
+    {
+        const int CACHE_SIZE = 32;
+        const int MAX_VALENCE = 32; // scores for more triangles than this are the same anyway
+        size_t triangleCount = indices.size() / 3;
+        if (triangleCount == 0)
+            return;
+
+        // scores, looked up instead of calling pow in the inner loop
+        float cacheScore[CACHE_SIZE];
+        for (int i = 0; i < CACHE_SIZE; i++)
+        {
+            // the last triangle's 3 vertices get a fixed score, so we don't just alternate between two strips
+            if (i < 3)
+                cacheScore[i] = 0.75f;
+            else
+                cacheScore[i] = std::pow(1.0f - (float)(i - 3) / (float)(CACHE_SIZE - 3), 1.5f);
+        }
+        float valenceScore[MAX_VALENCE + 1];
+        valenceScore[0] = 0.0f;
+        for (int i = 1; i <= MAX_VALENCE; i++)
+            valenceScore[i] = 2.0f / std::sqrt((float)i);
+
+        // triangles of every vertex, packed (CSR)
+        std::vector<uint32_t> remaining(vertexCount, 0);
+        for (uint32_t index : indices)
+            remaining[index]++;
+        std::vector<uint32_t> firstTriangle(vertexCount + 1, 0);
+        for (size_t v = 0; v < vertexCount; v++)
+            firstTriangle[v + 1] = firstTriangle[v] + remaining[v];
+        std::vector<uint32_t> adjacency(indices.size());
+        {
+            std::vector<uint32_t> fill(firstTriangle.begin(), firstTriangle.end() - 1);
+            for (size_t i = 0; i < indices.size(); i++)
+                adjacency[fill[indices[i]]++] = (uint32_t)(i / 3);
+        }
+
+        std::vector<int> cachePosition(vertexCount, -1);
+        auto vertexScore = [&](uint32_t v) -> float
+        {
+            if (remaining[v] == 0)
+                return -1.0f;
+            float score = valenceScore[std::min<uint32_t>(remaining[v], MAX_VALENCE)];
+            if (cachePosition[v] >= 0)
+                score += cacheScore[cachePosition[v]];
+            return score;
+        };
+        std::vector<float> score(vertexCount);
+        for (size_t v = 0; v < vertexCount; v++)
+            score[v] = vertexScore((uint32_t)v);
+        std::vector<float> triangleScore(triangleCount);
+        for (size_t t = 0; t < triangleCount; t++)
+            triangleScore[t] = score[indices[t * 3]] + score[indices[t * 3 + 1]] + score[indices[t * 3 + 2]];
+
+        std::vector<bool> emitted(triangleCount, false);
+        std::vector<uint32_t> result;
+        result.reserve(indices.size());
+        std::vector<uint32_t> cache, nextCache;
+        size_t scanCursor = 0;
+        int64_t best = -1;
+
+        while (result.size() < indices.size())
+        {
+            // nothing good next to the cache (start, or the cache ran dry): take the next triangle left in input order
+            if (best < 0)
+            {
+                while (emitted[scanCursor])
+                    scanCursor++;
+                best = (int64_t)scanCursor;
+            }
+            uint32_t* tri = &indices[best * 3];
+            emitted[best] = true;
+            result.insert(result.end(), tri, tri + 3);
+
+            // the triangle's vertices go to the front of the LRU cache, and it leaves their adjacency lists
+            nextCache.assign(tri, tri + 3);
+            for (int k = 0; k < 3; k++)
+            {
+                uint32_t v = tri[k];
+                uint32_t* list = &adjacency[firstTriangle[v]];
+                for (uint32_t i = 0; i < remaining[v]; i++)
+                {
+                    if (list[i] == (uint32_t)best)
+                    {
+                        std::swap(list[i], list[remaining[v] - 1]);
+                        break;
+                    }
+                }
+                remaining[v]--;
+            }
+            for (uint32_t v : cache)
+                if (v != tri[0] && v != tri[1] && v != tri[2])
+                    nextCache.push_back(v);
+            std::swap(cache, nextCache);
+
+            // new cache positions; whatever fell off the end goes back to no cache bonus
+            for (size_t i = 0; i < cache.size(); i++)
+                cachePosition[cache[i]] = i < (size_t)CACHE_SIZE ? (int)i : -1;
+            for (size_t i = 0; i < cache.size(); i++)
+            {
+                uint32_t v = cache[i];
+                float newScore = vertexScore(v);
+                float delta = newScore - score[v];
+                score[v] = newScore;
+                uint32_t* list = &adjacency[firstTriangle[v]];
+                for (uint32_t j = 0; j < remaining[v]; j++)
+                    triangleScore[list[j]] += delta;
+            }
+            if (cache.size() > (size_t)CACHE_SIZE)
+                cache.resize(CACHE_SIZE);
+
+            // next up: the best triangle that uses something in the cache
+            best = -1;
+            float bestScore = -1.0f;
+            for (uint32_t v : cache)
+            {
+                uint32_t* list = &adjacency[firstTriangle[v]];
+                for (uint32_t j = 0; j < remaining[v]; j++)
+                {
+                    if (triangleScore[list[j]] > bestScore)
+                    {
+                        bestScore = triangleScore[list[j]];
+                        best = list[j];
+                    }
+                }
+            }
+        }
+        indices.swap(result);
+    }
+
+    // run after optimizeVertexCache. threshold is how much worse (as a factor on ACMR) a cluster is allowed to
+    // get from being cut shorter, more clusters = more freedom to sort them
+    // ------------------------------------------------------------------------
+    static void optimizeOverdraw(MeshData& mesh, float threshold = 1.05f, unsigned int cacheSize = 16)
+    {
+        std::vector<uint32_t>& indices = mesh.indices;
+        size_t triangleCount = indices.size() / 3;
+        if (triangleCount < 2)
+            return;
+
+        // 1. hard boundaries: where a triangle misses all 3 vertices the cache has nothing from before,
+        // so starting a cluster there costs nothing
+        std::vector<size_t> hard;
+        {
+            FifoCache cache(mesh.vertices.size(), cacheSize);
+            for (size_t t = 0; t < triangleCount; t++)
+                if (cache.add(&indices[t * 3]) == 3)
+                    hard.push_back(t);
+        }
+        hard.push_back(triangleCount);
+
+        // 2. soft boundaries: cut a hard cluster early once its running ACMR is within threshold of what the
+        // whole hard cluster gets (the cache restarts at every cut, that's the cost)
+        std::vector<size_t> clusters;
+        for (size_t h = 0; h + 1 < hard.size(); h++)
+        {
+            size_t start = hard[h], end = hard[h + 1];
+            FifoCache cache(mesh.vertices.size(), cacheSize);
+            size_t misses = 0;
+            for (size_t t = start; t < end; t++)
+                misses += cache.add(&indices[t * 3]);
+            float clusterAcmr = (float)misses / (float)(end - start);
+
+            cache.reset();
+            size_t clusterStart = start;
+            misses = 0;
+            clusters.push_back(start);
+            for (size_t t = start; t < end; t++)
+            {
+                misses += cache.add(&indices[t * 3]);
+                float runningAcmr = (float)misses / (float)(t + 1 - clusterStart);
+                if (t + 1 < end && runningAcmr <= clusterAcmr * threshold)
+                {
+                    clusters.push_back(t + 1);
+                    clusterStart = t + 1;
+                    misses = 0;
+                    cache.reset();
+                }
+            }
+        }
+        clusters.push_back(triangleCount);
+
+        // 3. sort: clusters that face away from the mesh center are on the outside and hide the rest, draw them first
+        glm::vec3 meshCenter(0.0f);
+        float meshArea = 0.0f;
+        struct Cluster
+        {
+            size_t start, end;
+            float sortKey;
+        };
+        std::vector<Cluster> sorted;
+        std::vector<glm::vec3> centroids, normals;
+        for (size_t c = 0; c + 1 < clusters.size(); c++)
+        {
+            glm::vec3 centroid(0.0f), normal(0.0f);
+            float area = 0.0f;
+            for (size_t t = clusters[c]; t < clusters[c + 1]; t++)
+            {
+                const glm::vec3& a = mesh.vertices[indices[t * 3]].position;
+                const glm::vec3& b = mesh.vertices[indices[t * 3 + 1]].position;
+                const glm::vec3& d = mesh.vertices[indices[t * 3 + 2]].position;
+                glm::vec3 n = glm::cross(b - a, d - a);
+                float triangleArea = glm::length(n);
+                centroid += (a + b + d) * (triangleArea / 3.0f);
+                normal += n;
+                area += triangleArea;
+            }
+            meshCenter += centroid;
+            meshArea += area;
+            centroids.push_back(area > 0.0f ? centroid / area : mesh.vertices[indices[clusters[c] * 3]].position);
+            float length = glm::length(normal);
+            normals.push_back(length > 0.0f ? normal / length : glm::vec3(0.0f));
+            sorted.push_back({ clusters[c], clusters[c + 1], 0.0f });
+        }
+        if (meshArea > 0.0f)
+            meshCenter /= meshArea;
+        for (size_t c = 0; c < sorted.size(); c++)
+            sorted[c].sortKey = glm::dot(centroids[c] - meshCenter, normals[c]);
+        std::stable_sort(sorted.begin(), sorted.end(), [](const Cluster& a, const Cluster& b) { return a.sortKey > b.sortKey; });
+
+        std::vector<uint32_t> result;
+        result.reserve(indices.size());
+        for (const Cluster& cluster : sorted)
+            result.insert(result.end(), indices.begin() + cluster.start * 3, indices.begin() + cluster.end * 3);
+        indices.swap(result);
+    }
+
+    // vertices in first use order, unused ones dropped. run last, it doesn't change the triangle order
+    // ------------------------------------------------------------------------
+    static void optimizeVertexFetch(MeshData& mesh)
+    {
+        std::vector<uint32_t> remap(mesh.vertices.size(), UINT32_MAX);
+        std::vector<VertexPNT> vertices;
+        vertices.reserve(mesh.vertices.size());
+        for (uint32_t& index : mesh.indices)
+        {
+            if (remap[index] == UINT32_MAX)
+            {
+                remap[index] = (uint32_t)vertices.size();
+                vertices.push_back(mesh.vertices[index]);
+            }
+            index = remap[index];
+        }
+        mesh.vertices.swap(vertices);
+    }
+
+private:
+    // FIFO post transform cache for the overdraw clustering, add() returns how many of the 3 vertices missed
+    struct FifoCache
+    {
+        std::vector<int64_t> cachedAt;
+        int64_t head = 0;
+        int64_t size;
+
+        FifoCache(size_t vertexCount, unsigned int cacheSize) : cachedAt(vertexCount, INT64_MIN / 2), size(cacheSize) {}
+        int add(const uint32_t* tri)
+        {
+            int misses = 0;
+            for (int k = 0; k < 3; k++)
+            {
+                if (head - cachedAt[tri[k]] < size)
+                    continue;
+                cachedAt[tri[k]] = ++head;
+                misses++;
+            }
+            return misses;
+        }
+        // everything counts as evicted from here on
+        void reset()
+        {
+            head += size;
+        }
+    };
+};
+#endif
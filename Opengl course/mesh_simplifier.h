@@ -0,0 +1,441 @@
+#ifndef MESH_SIMPLIFIER_H
+#define MESH_SIMPLIFIER_H
+
+#include <glm/glm.hpp>
+
+#include "mesh_data.h"
+#include "mesh_optimizer.h"
+
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <unordered_map>
+#include <cstdint>
+#include <cstring>
+#include <cmath>
+#include <cfloat>
+#include <cstdio>
+
+// Mesh simplification with quadric error metrics (Garland and Heckbert, "Surface Simplification Using Quadric
+// Error Metrics"), for building a LOD chain offline (MeshConvert -lods, Ch19LevelOfDetail).
+//
+// Every vertex collects the planes of the triangles around it in a quadric, a 4x4 matrix that gives the
+// squared distance from any point to all of those planes at once. Collapsing edge u -> v moves u onto v and
+// the triangles on the edge disappear; its cost is the merged quadric at v, i.e. how far v is from the
+// surface u and v used to be on. Cheapest collapses first until the triangle count is down to the target.
+//
+// Collapses only move a vertex onto one of its neighbours (no new positions), so every level indexes the
+// same vertex buffer and a LOD chain is just more index ranges (MeshLod). Vertices that share a position but
+// have different normals/UVs (seams) move together, along the seam only. Open borders, and points where more
+// than two such vertices meet, are locked in place so holes and UV charts keep their outline.
+class MeshSimplifier
+{
+public:
+    // indices (any triangle list into mesh.vertices) reduced to about targetIndexCount, stopping early if the
+    // next collapse would be off by more than maxError. error gets what the result is off by, in model units
+    // ------------------------------------------------------------------------
+    static std::vector<uint32_t> simplify(const MeshData& mesh, const std::vector<uint32_t>& indices, size_t targetIndexCount,
+        float maxError = FLT_MAX, float* error = nullptr)
+    {
+        std::vector<float> errors;
+        std::vector<std::vector<uint32_t>> levels = simplifyChain(mesh, indices, { targetIndexCount }, maxError, errors);
+        if (error)
+            *error = errors.empty() ? 0.0f : errors[0];
+        return levels.empty() ? indices : levels[0];
+    }
+    // the same, but one run keeps simplifying and takes a snapshot every time it gets down to the next of
+    // targetIndexCounts (largest first), so a whole LOD chain costs one simplification. fewer levels come back
+    // if it stalls (everything left is locked or would flip) or hits maxError
+    // ------------------------------------------------------------------------
+    static std::vector<std::vector<uint32_t>> simplifyChain(const MeshData& mesh, const std::vector<uint32_t>& indices,
+        const std::vector<size_t>& targetIndexCounts, float maxError, std::vector<float>& errors)
+    {
+        std::vector<std::vector<uint32_t>> levels;
+        errors.clear();
+        size_t level = 0;
+        const std::vector<VertexPNT>& vertices = mesh.vertices;
+        size_t vertexCount = vertices.size();
+        std::vector<uint32_t> result = indices;
+        float resultError = 0.0f;
+
+        // 1. weld: position[v] = the first vertex with the same position, members lists all of them
+        std::vector<uint32_t> position(vertexCount);
+        std::vector<std::vector<uint32_t>> members(vertexCount);
+        {
+            std::unordered_map<PositionKey, uint32_t, PositionKeyHash> first;
+            first.reserve(vertexCount);
+            for (uint32_t v = 0; v < vertexCount; v++)
+            {
+                auto inserted = first.emplace(PositionKey(vertices[v].position), v);
+                position[v] = inserted.first->second;
+            }
+            std::vector<bool> used(vertexCount, false);
+            for (uint32_t index : result)
+                used[index] = true;
+            for (uint32_t v = 0; v < vertexCount; v++)
+                if (used[v])
+                    members[position[v]].push_back(v);
+        }
+
+        // 2. open borders: an edge with only one triangle. seam edges: two triangles that don't share the vertices
+        std::vector<bool> locked(vertexCount, false);
+        std::unordered_map<uint64_t, EdgeInfo> edges;
+        edges.reserve(result.size());
+        for (size_t i = 0; i < result.size(); i += 3)
+        {
+            for (int k = 0; k < 3; k++)
+            {
+                uint32_t a = result[i + k], b = result[i + (k + 1) % 3];
+                uint32_t pa = position[a], pb = position[b];
+                if (pa == pb)
+                    continue;
+                EdgeInfo& edge = edges[edgeKey(pa, pb)];
+                uint64_t vertexPair = pa < pb ? ((uint64_t)a << 32 | b) : ((uint64_t)b << 32 | a);
+                if (edge.triangles == 0)
+                    edge.vertexPair = vertexPair;
+                else if (edge.vertexPair != vertexPair)
+                    edge.seam = true;
+                edge.triangles++;
+            }
+        }
+        for (const auto& entry : edges)
+        {
+            if (entry.second.triangles == 1)
+            {
+                locked[(uint32_t)(entry.first >> 32)] = true;
+                locked[(uint32_t)entry.first] = true;
+            }
+        }
+        for (uint32_t p = 0; p < vertexCount; p++)
+            if (members[p].size() > 2)
+                locked[p] = true;
+
+        // 3. quadrics, area weighted so a big triangle's plane counts for more than a sliver's
+        std::vector<Quadric> quadrics(vertexCount);
+        for (size_t i = 0; i + 2 < result.size(); i += 3)
+        {
+            const glm::vec3& a = vertices[result[i]].position;
+            const glm::vec3& b = vertices[result[i + 1]].position;
+            const glm::vec3& c = vertices[result[i + 2]].position;
+            glm::vec3 n = glm::cross(b - a, c - a);
+            float length = glm::length(n);
+            if (length <= 0.0f)
+                continue;
+            Quadric q = Quadric::plane(n / length, a, length * 0.5f);
+            quadrics[position[result[i]]].add(q);
+            quadrics[position[result[i + 1]]].add(q);
+            quadrics[position[result[i + 2]]].add(q);
+        }
+
+        // 4. collapse in passes: find every allowed collapse, do the cheapest ones that don't overlap, rebuild
+        std::vector<uint32_t> remap(vertexCount);
+        std::vector<bool> touched(vertexCount);
+        std::vector<uint32_t> firstTriangle, triangles;
+        while (true)
+        {
+            while (level < targetIndexCounts.size() && result.size() <= targetIndexCounts[level])
+            {
+                levels.push_back(result);
+                errors.push_back(std::sqrt(resultError));
+                level++;
+            }
+            if (level == targetIndexCounts.size())
+                break;
+            size_t targetIndexCount = targetIndexCounts[level];
+
+            // triangles around every position
+            firstTriangle.assign(vertexCount + 1, 0);
+            for (uint32_t index : result)
+                firstTriangle[position[index] + 1]++;
+            for (size_t p = 0; p < vertexCount; p++)
+                firstTriangle[p + 1] += firstTriangle[p];
+            triangles.resize(result.size());
+            {
+                std::vector<uint32_t> fill(firstTriangle.begin(), firstTriangle.end() - 1);
+                for (size_t i = 0; i < result.size(); i++)
+                    triangles[fill[position[result[i]]]++] = (uint32_t)(i / 3);
+            }
+
+            // every edge, in its cheaper allowed direction
+            std::vector<Collapse> collapses;
+            for (size_t i = 0; i < result.size(); i += 3)
+            {
+                for (int k = 0; k < 3; k++)
+                {
+                    uint32_t pa = position[result[i + k]], pb = position[result[i + (k + 1) % 3]];
+                    // each edge is seen from both of its triangles, only take it once
+                    if (pa >= pb)
+                        continue;
+                    const EdgeInfo& edge = edges[edgeKey(pa, pb)];
+                    Quadric merged = quadrics[pa];
+                    merged.add(quadrics[pb]);
+                    Collapse best = { 0, 0, FLT_MAX };
+                    if (canCollapse(pa, pb, edge, locked, members))
+                        best = { pa, pb, merged.error(vertices[pb].position) };
+                    if (canCollapse(pb, pa, edge, locked, members))
+                    {
+                        float cost = merged.error(vertices[pa].position);
+                        if (cost < best.cost)
+                            best = { pb, pa, cost };
+                    }
+                    if (best.cost < FLT_MAX && best.cost <= maxError * maxError)
+                        collapses.push_back(best);
+                }
+            }
+            std::sort(collapses.begin(), collapses.end(), [](const Collapse& a, const Collapse& b) { return a.cost < b.cost; });
+
+            // a collapse removes about 2 triangles, don't overshoot the target by much
+            size_t wanted = (result.size() - targetIndexCount) / 6 + 1;
+            size_t done = 0;
+            for (uint32_t v = 0; v < vertexCount; v++)
+                remap[v] = v;
+            std::fill(touched.begin(), touched.end(), false);
+            for (const Collapse& collapse : collapses)
+            {
+                if (done >= wanted)
+                    break;
+                if (touched[collapse.from] || touched[collapse.to])
+                    continue;
+                if (flips(collapse, result, position, vertices, firstTriangle, triangles))
+                    continue;
+
+                // every vertex at "from" goes to the vertex at "to" it shares a triangle with, or the one with the closest normal/UV
+                for (uint32_t from : members[collapse.from])
+                    remap[from] = closestMember(from, collapse.to, result, position, vertices, members, firstTriangle, triangles);
+                quadrics[collapse.to].add(quadrics[collapse.from]);
+                resultError = std::max(resultError, collapse.cost);
+                // nothing around here moves again this pass, the flip check above assumed it wouldn't
+                for (uint32_t t = firstTriangle[collapse.from]; t < firstTriangle[collapse.from + 1]; t++)
+                    for (int k = 0; k < 3; k++)
+                        touched[position[result[triangles[t] * 3 + k]]] = true;
+                done++;
+            }
+            if (done == 0)
+            {
+                // stuck, what we have is as far as it goes
+                if (levels.empty() || result.size() < levels.back().size())
+                {
+                    levels.push_back(result);
+                    errors.push_back(std::sqrt(resultError));
+                }
+                break;
+            }
+
+            // apply, dropping the triangles that collapsed to a line
+            size_t write = 0;
+            for (size_t i = 0; i < result.size(); i += 3)
+            {
+                uint32_t a = remap[result[i]], b = remap[result[i + 1]], c = remap[result[i + 2]];
+                if (position[a] == position[b] || position[b] == position[c] || position[a] == position[c])
+                    continue;
+                result[write++] = a;
+                result[write++] = b;
+                result[write++] = c;
+            }
+            result.resize(write);
+            for (uint32_t p = 0; p < vertexCount; p++)
+            {
+                if (members[p].empty() || remap[members[p][0]] == members[p][0])
+                    continue;
+                members[p].clear();
+            }
+            // the seam/border info refers to positions, which didn't change for the survivors. the new edges
+            // around "to" inherit the removed edges' flags (keep it conservative: a seam stays a seam)
+            std::unordered_map<uint64_t, EdgeInfo> rebuilt;
+            rebuilt.reserve(result.size());
+            for (size_t i = 0; i < result.size(); i += 3)
+            {
+                for (int k = 0; k < 3; k++)
+                {
+                    uint32_t a = result[i + k], b = result[i + (k + 1) % 3];
+                    uint32_t pa = position[a], pb = position[b];
+                    EdgeInfo& edge = rebuilt[edgeKey(pa, pb)];
+                    uint64_t vertexPair = pa < pb ? ((uint64_t)a << 32 | b) : ((uint64_t)b << 32 | a);
+                    if (edge.triangles == 0)
+                        edge.vertexPair = vertexPair;
+                    else if (edge.vertexPair != vertexPair)
+                        edge.seam = true;
+                    edge.triangles++;
+                }
+            }
+            edges.swap(rebuilt);
+        }
+        return levels;
+    }
+
+    // mesh.lods = the full mesh, then levels with about ratio as many triangles as the one before. all of them
+    // come out of one simplification of the full mesh (so the errors are against the real surface), each
+    // ordered for the vertex cache. levels that barely got smaller than the one before are dropped
+    // ------------------------------------------------------------------------
+    static void buildLods(MeshData& mesh, int maxLevels = 6, float ratio = 0.5f, const std::string& name = "", bool report = true)
+    {
+        std::vector<uint32_t> full(mesh.indices.begin(), mesh.indices.begin() + (mesh.lods.empty() ? mesh.indices.size() : mesh.lods[0].indexCount));
+        mesh.indices = full;
+        mesh.lods.clear();
+        mesh.lods.push_back({ 0, (uint32_t)full.size(), 0.0f, 0 });
+        std::vector<size_t> targets;
+        size_t target = full.size();
+        for (int level = 1; level < maxLevels; level++)
+        {
+            target = (size_t)(target / 3 * ratio) * 3;
+            if (target < 3)
+                break;
+            targets.push_back(target);
+        }
+        std::vector<float> errors;
+        std::vector<std::vector<uint32_t>> levels = simplifyChain(mesh, full, targets, FLT_MAX, errors);
+        for (size_t i = 0; i < levels.size(); i++)
+        {
+            std::vector<uint32_t>& lod = levels[i];
+            if (lod.size() > mesh.lods.back().indexCount * 9 / 10)
+                continue;
+            MeshOptimizer::optimizeVertexCache(lod, mesh.vertices.size());
+            mesh.lods.push_back({ (uint32_t)mesh.indices.size(), (uint32_t)lod.size(), errors[i], 0 });
+            mesh.indices.insert(mesh.indices.end(), lod.begin(), lod.end());
+        }
+        if (!report)
+            return;
+        std::printf("MESH_SIMPLIFIER %s: %zu levels\n", name.c_str(), mesh.lods.size());
+        for (size_t i = 0; i < mesh.lods.size(); i++)
+            std::printf("  lod %zu: %7u triangles, error %.5f\n", i, mesh.lods[i].indexCount / 3, mesh.lods[i].error);
+    }
+
+private:
+    // symmetric 4x4 matrix (10 numbers) for sum of squared distances to planes, plus the summed weight
+    struct Quadric
+    {
+        double a00 = 0, a01 = 0, a02 = 0, a11 = 0, a12 = 0, a22 = 0;
+        double b0 = 0, b1 = 0, b2 = 0, c = 0;
+        double weight = 0;
+
+        static Quadric plane(const glm::vec3& n, const glm::vec3& point, float weight)
+        {
+            double d = -(double)glm::dot(n, point);
+            Quadric q;
+            q.a00 = weight * n.x * n.x; q.a01 = weight * n.x * n.y; q.a02 = weight * n.x * n.z;
+            q.a11 = weight * n.y * n.y; q.a12 = weight * n.y * n.z; q.a22 = weight * n.z * n.z;
+            q.b0 = weight * n.x * d; q.b1 = weight * n.y * d; q.b2 = weight * n.z * d;
+            q.c = weight * d * d;
+            q.weight = weight;
+            return q;
+        }
+        void add(const Quadric& q)
+        {
+            a00 += q.a00; a01 += q.a01; a02 += q.a02; a11 += q.a11; a12 += q.a12; a22 += q.a22;
+            b0 += q.b0; b1 += q.b1; b2 += q.b2; c += q.c;
+            weight += q.weight;
+        }
+        // weighted mean squared distance from p to the planes
+        float error(const glm::vec3& p) const
+        {
+            double x = p.x, y = p.y, z = p.z;
+            double e = a00 * x * x + a11 * y * y + a22 * z * z + 2.0 * (a01 * x * y + a02 * x * z + a12 * y * z)
+                + 2.0 * (b0 * x + b1 * y + b2 * z) + c;
+            return weight > 0.0 ? (float)std::max(e / weight, 0.0) : 0.0f;
+        }
+    };
+    struct EdgeInfo
+    {
+        uint64_t vertexPair = 0;
+        int triangles = 0;
+        bool seam = false;
+    };
+    struct Collapse
+    {
+        uint32_t from, to;
+        float cost;
+    };
+    // exact position match, -0 and 0 are the same point
+    struct PositionKey
+    {
+        float x, y, z;
+        explicit PositionKey(const glm::vec3& p) : x(p.x + 0.0f), y(p.y + 0.0f), z(p.z + 0.0f) {}
+        bool operator==(const PositionKey& o) const { return x == o.x && y == o.y && z == o.z; }
+    };
+    struct PositionKeyHash
+    {
+        size_t operator()(const PositionKey& k) const
+        {
+            uint32_t bits[3];
+            std::memcpy(bits, &k.x, sizeof(bits));
+            uint64_t h = bits[0] * 0x9E3779B97F4A7C15ull;
+            h ^= bits[1] * 0xC2B2AE3D27D4EB4Full + (h >> 29);
+            h ^= bits[2] * 0x165667B19E3779F9ull + (h >> 32);
+            return (size_t)(h ^ (h >> 31));
+        }
+    };
+
+    static uint64_t edgeKey(uint32_t a, uint32_t b)
+    {
+        return a < b ? ((uint64_t)a << 32 | b) : ((uint64_t)b << 32 | a);
+    }
+    static bool canCollapse(uint32_t from, uint32_t to, const EdgeInfo& edge, const std::vector<bool>& locked,
+        const std::vector<std::vector<uint32_t>>& members)
+    {
+        if (locked[from])
+            return false;
+        // a seam vertex only slides along its seam, onto another seam vertex
+        if (members[from].size() > 1)
+            return edge.seam && members[to].size() > 1;
+        return true;
+    }
+    // would moving "from" onto "to" turn any of the remaining triangles around it over?
+    static bool flips(const Collapse& collapse, const std::vector<uint32_t>& result, const std::vector<uint32_t>& position,
+        const std::vector<VertexPNT>& vertices, const std::vector<uint32_t>& firstTriangle, const std::vector<uint32_t>& triangles)
+    {
+        const glm::vec3& target = vertices[collapse.to].position;
+        for (uint32_t t = firstTriangle[collapse.from]; t < firstTriangle[collapse.from + 1]; t++)
+        {
+            const uint32_t* tri = &result[triangles[t] * 3];
+            glm::vec3 before[3], after[3];
+            bool removed = false;
+            for (int k = 0; k < 3; k++)
+            {
+                uint32_t p = position[tri[k]];
+                removed = removed || p == collapse.to;
+                before[k] = vertices[tri[k]].position;
+                after[k] = p == collapse.from ? target : before[k];
+            }
+            if (removed)
+                continue;
+            glm::vec3 n0 = glm::cross(before[1] - before[0], before[2] - before[0]);
+            glm::vec3 n1 = glm::cross(after[1] - after[0], after[2] - after[0]);
+            // flipped, or squashed into a sliver
+            if (glm::dot(n0, n1) <= 0.25f * glm::length(n0) * glm::length(n1))
+                return true;
+        }
+        return false;
+    }
+    static uint32_t closestMember(uint32_t from, uint32_t to, const std::vector<uint32_t>& result, const std::vector<uint32_t>& position,
+        const std::vector<VertexPNT>& vertices, const std::vector<std::vector<uint32_t>>& members,
+        const std::vector<uint32_t>& firstTriangle, const std::vector<uint32_t>& triangles)
+    {
+        const std::vector<uint32_t>& candidates = members[to];
+        if (candidates.size() == 1)
+            return candidates[0];
+        // the one on the same triangle is on the same side of the seam
+        for (uint32_t t = firstTriangle[position[from]]; t < firstTriangle[position[from] + 1]; t++)
+        {
+            const uint32_t* tri = &result[triangles[t] * 3];
+            if (tri[0] != from && tri[1] != from && tri[2] != from)
+                continue;
+            for (int k = 0; k < 3; k++)
+                if (position[tri[k]] == to)
+                    return tri[k];
+        }
+        uint32_t best = candidates[0];
+        float bestDistance = FLT_MAX;
+        for (uint32_t candidate : candidates)
+        {
+            glm::vec2 uv = vertices[candidate].texCoords - vertices[from].texCoords;
+            float distance = 1.0f - glm::dot(vertices[candidate].normal, vertices[from].normal) + glm::dot(uv, uv);
+            if (distance < bestDistance)
+            {
+                bestDistance = distance;
+                best = candidate;
+            }
+        }
+        return best;
+    }
+};
+#endif
@@ -0,0 +1,220 @@
+#ifndef MESHLET_CULLING_H
+#define MESHLET_CULLING_H
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include "meshlets.h"
+#include "shader_pipeline.h"
+#include "vertex_layout.h"
+
+#include <vector>
+#include <cstdint>
+#include <algorithm>
+
+// one glMultiDrawElementsIndirect command, layout fixed by GL
+struct DrawElementsIndirectCommand
+{
+    uint32_t count;
+    uint32_t instanceCount;
+    uint32_t firstIndex;
+    int32_t baseVertex;
+    uint32_t baseInstance;
+};
+
+// what the culling shader counted, same order as the std430 block in cull_cs.glsl.
+// meshletsDrawn doubles as the draw count for glMultiDrawElementsIndirectCount
+struct MeshletCullStats
+{
+    uint32_t meshletsDrawn;
+    uint32_t trianglesDrawn;
+    uint32_t frustumCulled;
+    uint32_t coneCulled;
+    uint32_t occlusionCulled;
+};
+
+// GPU driven culling of meshlets (meshlets.h) for many copies of one mesh.
+// Every frame a compute shader (Shaders/Ch20MeshletCulling/cull_cs.glsl) runs one thread per (object, meshlet)
+// and throws the meshlet away if it's
+//   outside the frustum         bounding sphere vs the 6 planes
+//   facing away                 normal cone vs the camera position
+//   behind last frame's depth   bounding sphere's screen rect vs the depth pyramid (Hi-Z)
+// The survivors append a draw command each, and the whole lot is drawn with one glMultiDrawElementsIndirectCount
+// that reads the count straight from the GPU, so the CPU never touches per meshlet data. The vertex shader finds
+// its object as gl_BaseInstance / meshletCount in the objects buffer.
+//
+// The depth pyramid is built by depth_reduce_cs.glsl from the finished frame's depth, each level keeping the
+// farthest depth of the 2x2 texels under it. A meshlet whose nearest point is behind the farthest depth of
+// every texel its rect covers is hidden. It is last frame's depth with last frame's camera, so something
+// that comes out from behind an occluder shows up one frame late.
+//
+// Buffers (SSBO bindings in the shaders):
+//   0 meshlets (Meshlet)   1 objects (mat4 model)   2 draw commands   3 stats/draw count
+class MeshletCuller
+{
+public:
+    unsigned int indexBuffer = 0;       // MeshletMesh::indices, for the VAO
+    unsigned int depthPyramid = 0;      // GL_R32F, with mips
+    bool frustumCulling = true;
+    bool coneCulling = true;
+    bool occlusionCulling = true;
+
+    MeshletCuller(const MeshletMesh& mesh, const std::vector<glm::mat4>& models, int width, int height)
+        : meshletCount((uint32_t)mesh.meshlets.size()), objectCount((uint32_t)models.size())
+    {
+        indexBuffer = createStaticBuffer(mesh.indices.data(), mesh.indices.size() * sizeof(uint32_t));
+        meshletBuffer = createStaticBuffer(mesh.meshlets.data(), mesh.meshlets.size() * sizeof(Meshlet));
+        glCreateBuffers(1, &objectBuffer);
+        glNamedBufferStorage(objectBuffer, models.size() * sizeof(glm::mat4), models.data(), GL_DYNAMIC_STORAGE_BIT);
+        // worst case every meshlet of every object survives
+        glCreateBuffers(1, &commandBuffer);
+        glNamedBufferStorage(commandBuffer, (size_t)meshletCount * objectCount * sizeof(DrawElementsIndirectCommand), nullptr, GL_DYNAMIC_STORAGE_BIT);
+        // two stats buffers: the GPU counts into one while we read last frame's out of the other
+        glCreateBuffers(2, statsBuffers);
+        for (int i = 0; i < 2; i++)
+            glNamedBufferStorage(statsBuffers[i], sizeof(MeshletCullStats), nullptr, GL_DYNAMIC_STORAGE_BIT);
+        resize(width, height);
+    }
+    ~MeshletCuller()
+    {
+        release();
+    }
+    MeshletCuller(const MeshletCuller&) = delete;
+    MeshletCuller& operator=(const MeshletCuller&) = delete;
+
+    // the pyramid matches the depth buffer it's built from, call this when that gets resized
+    // ------------------------------------------------------------------------
+    void resize(int newWidth, int newHeight)
+    {
+        if (newWidth == width && newHeight == height)
+            return;
+        width = newWidth;
+        height = newHeight;
+        glDeleteTextures(1, &depthPyramid);
+        levels = 1;
+        while ((std::max(width, height) >> levels) > 0)
+            levels++;
+        glCreateTextures(GL_TEXTURE_2D, 1, &depthPyramid);
+        glTextureStorage2D(depthPyramid, levels, GL_R32F, width, height);
+        glTextureParameteri(depthPyramid, GL_TEXTURE_MIN_FILTER, GL_NEAREST_MIPMAP_NEAREST);
+        glTextureParameteri(depthPyramid, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        glTextureParameteri(depthPyramid, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTextureParameteri(depthPyramid, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        // nothing in it yet
+        pyramidValid = false;
+    }
+    // new transforms for the objects (same count as in the constructor)
+    // ------------------------------------------------------------------------
+    void updateObjects(const std::vector<glm::mat4>& models)
+    {
+        glNamedBufferSubData(objectBuffer, 0, std::min<size_t>(models.size(), objectCount) * sizeof(glm::mat4), models.data());
+    }
+
+    // runs the culling shader, fills the command buffer for draw(). before drawing the frame
+    // ------------------------------------------------------------------------
+    void cull(const ShaderStage& cullShader, const glm::mat4& view, const glm::mat4& projection, const glm::vec3& cameraPosition)
+    {
+        // swap stats buffers, the one we're about to count into is the older one
+        frame++;
+        unsigned int stats = statsBuffers[frame % 2];
+        glClearNamedBufferData(stats, GL_R32UI, GL_RED_INTEGER, GL_UNSIGNED_INT, nullptr);
+
+        // frustum planes straight out of viewProjection (Gribb/Hartmann): row 3 +- rows 0, 1, 2
+        glm::mat4 m = glm::transpose(projection * view);
+        glm::vec4 planes[6] = { m[3] + m[0], m[3] - m[0], m[3] + m[1], m[3] - m[1], m[3] + m[2], m[3] - m[2] };
+        for (glm::vec4& plane : planes)
+            plane /= glm::length(glm::vec3(plane));
+        glProgramUniform4fv(cullShader.ID, glGetUniformLocation(cullShader.ID, "frustumPlanes"), 6, &planes[0].x);
+        // occlusion is tested where things were when the pyramid was made
+        cullShader.setMat4("occlusionViewProjection", pyramidViewProjection);
+        cullShader.setVec3("cameraPosition", cameraPosition);
+        cullShader.setInt("meshletCount", (int)meshletCount);
+        cullShader.setInt("objectCount", (int)objectCount);
+        cullShader.setBool("frustumCulling", frustumCulling);
+        cullShader.setBool("coneCulling", coneCulling);
+        cullShader.setBool("occlusionCulling", occlusionCulling && pyramidValid);
+
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, meshletBuffer);
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, objectBuffer);
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, commandBuffer);
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 3, stats);
+        glBindTextureUnit(0, depthPyramid);
+        glUseProgram(cullShader.ID);
+        uint32_t threads = meshletCount * objectCount;
+        glDispatchCompute((threads + CULL_GROUP_SIZE - 1) / CULL_GROUP_SIZE, 1, 1);
+        glUseProgram(0);
+        // the draw reads the commands and the count, the vertex shader the objects
+        glMemoryBarrier(GL_COMMAND_BARRIER_BIT | GL_SHADER_STORAGE_BARRIER_BIT);
+    }
+    // draws what survived. the VAO (with indexBuffer as its element buffer) and the shader have to be bound
+    // ------------------------------------------------------------------------
+    void draw() const
+    {
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, objectBuffer);
+        glBindBuffer(GL_DRAW_INDIRECT_BUFFER, commandBuffer);
+        glBindBuffer(GL_PARAMETER_BUFFER, statsBuffers[frame % 2]);
+        glMultiDrawElementsIndirectCount(GL_TRIANGLES, GL_UNSIGNED_INT, nullptr, 0, meshletCount * objectCount, 0);
+        glBindBuffer(GL_PARAMETER_BUFFER, 0);
+        glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+    }
+    // builds the pyramid from the frame's depth texture (same size as the culler), after the frame is drawn.
+    // view/projection are the ones the frame was drawn with
+    // ------------------------------------------------------------------------
+    void buildDepthPyramid(const ShaderStage& reduceShader, unsigned int depthTexture, const glm::mat4& view, const glm::mat4& projection)
+    {
+        glUseProgram(reduceShader.ID);
+        for (int level = 0; level < levels; level++)
+        {
+            // level 0 is a copy of the depth texture, every other level reduces the one above it
+            glBindTextureUnit(0, level == 0 ? depthTexture : depthPyramid);
+            reduceShader.setInt("sourceLevel", level == 0 ? 0 : level - 1);
+            reduceShader.setBool("copy", level == 0);
+            glBindImageTexture(0, depthPyramid, level, GL_FALSE, 0, GL_WRITE_ONLY, GL_R32F);
+            int levelWidth = std::max(width >> level, 1), levelHeight = std::max(height >> level, 1);
+            glDispatchCompute((levelWidth + 7) / 8, (levelHeight + 7) / 8, 1);
+            glMemoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT);
+        }
+        glUseProgram(0);
+        pyramidViewProjection = projection * view;
+        pyramidValid = true;
+    }
+    // last frame's numbers, reading this frame's would wait for the GPU to finish it
+    // ------------------------------------------------------------------------
+    MeshletCullStats stats() const
+    {
+        MeshletCullStats result = {};
+        if (frame > 1)
+            glGetNamedBufferSubData(statsBuffers[(frame + 1) % 2], 0, sizeof(result), &result);
+        return result;
+    }
+    // ------------------------------------------------------------------------
+    uint32_t meshlets() const { return meshletCount; }
+    uint32_t objects() const { return objectCount; }
+    // deletes the buffers and the pyramid, while the context is still around
+    // ------------------------------------------------------------------------
+    void release()
+    {
+        // already released, the destructor can run after glfwTerminate
+        if (indexBuffer == 0)
+            return;
+        glDeleteBuffers(1, &indexBuffer);
+        glDeleteBuffers(1, &meshletBuffer);
+        glDeleteBuffers(1, &objectBuffer);
+        glDeleteBuffers(1, &commandBuffer);
+        glDeleteBuffers(2, statsBuffers);
+        glDeleteTextures(1, &depthPyramid);
+        indexBuffer = meshletBuffer = objectBuffer = commandBuffer = depthPyramid = 0;
+        statsBuffers[0] = statsBuffers[1] = 0;
+    }
+
+private:
+    static const uint32_t CULL_GROUP_SIZE = 64; // local_size_x in cull_cs.glsl
+    uint32_t meshletCount, objectCount;
+    unsigned int meshletBuffer = 0, objectBuffer = 0, commandBuffer = 0;
+    unsigned int statsBuffers[2] = {};
+    int width = 0, height = 0, levels = 1;
+    bool pyramidValid = false;
+    glm::mat4 pyramidViewProjection = glm::mat4(1.0f);
+    unsigned long long frame = 0;
+};
+#endif
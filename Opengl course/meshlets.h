@@ -0,0 +1,164 @@
+#ifndef MESHLETS_H
+#define MESHLETS_H
+
+#include <glm/glm.hpp>
+
+#include "mesh_data.h"
+
+#include <vector>
+#include <algorithm>
+#include <cstdint>
+#include <cmath>
+#include <cstdio>
+#include <string>
+
+// Meshlets: a mesh cut into small clusters of triangles (at most 64 vertices / 124 triangles, the sizes mesh
+// shader hardware likes) that can each be culled on their own. Culling whole objects does nothing for a big
+// mesh that's half on screen or mostly facing away; per meshlet, the parts outside the frustum, facing away
+// (normal cone) or behind other geometry (depth pyramid) get dropped. See meshlet_culling.h for the GPU side.
+//
+// Every meshlet keeps:
+//   a bounding sphere   for frustum and occlusion tests
+//   a normal cone       axis + cutoff: if the camera looks at the cone's apex from inside the "backface"
+//                       region, every triangle in the meshlet faces away and the whole thing can go
+//
+// The layout is std430 compatible so the array goes into a shader storage buffer as is.
+struct Meshlet
+{
+    glm::vec4 centerRadius;     // bounding sphere, model space
+    glm::vec4 coneAxisCutoff;   // xyz = average normal direction, w = cutoff (> 1 means the cone is too wide to ever cull)
+    glm::vec4 coneApex;         // xyz, w unused
+    uint32_t firstIndex;        // triangles are indices[firstIndex .. firstIndex + indexCount) of MeshletMesh
+    uint32_t indexCount;
+    uint32_t vertexCount;       // unique vertices, <= the build limit
+    uint32_t reserved;
+};
+static_assert(sizeof(Meshlet) == 64, "Meshlet has to match the std430 struct in the culling shader");
+
+// the meshlets of one mesh, with their triangles one after the other in a single index buffer that still
+// indexes the mesh's vertex buffer. every meshlet is one glMultiDrawElementsIndirect command
+struct MeshletMesh
+{
+    std::vector<Meshlet> meshlets;
+    std::vector<uint32_t> indices;
+
+    // ------------------------------------------------------------------------
+    // best done on a vertex cache ordered index list (mesh_optimizer.h): consecutive triangles then share
+    // vertices, so meshlets fill up with triangles before they run out of vertices and stay compact
+    static MeshletMesh build(const MeshData& mesh, const std::vector<uint32_t>& triangles, size_t maxVertices = 64, size_t maxTriangles = 124)
+    {
+        MeshletMesh out;
+        out.indices.reserve(triangles.size());
+        // which meshlet last used each vertex, to count unique vertices without clearing anything
+        std::vector<uint32_t> seenBy(mesh.vertices.size(), UINT32_MAX);
+        Meshlet current = {};
+        uint32_t meshletIndex = 0;
+        for (size_t i = 0; i + 2 < triangles.size(); i += 3)
+        {
+            const uint32_t* tri = &triangles[i];
+            size_t newVertices = 0;
+            for (int k = 0; k < 3; k++)
+                newVertices += seenBy[tri[k]] != meshletIndex ? 1 : 0;
+            if (current.vertexCount + newVertices > maxVertices || current.indexCount / 3 + 1 > maxTriangles)
+            {
+                out.finish(mesh, current);
+                meshletIndex++;
+                current = {};
+                current.firstIndex = (uint32_t)out.indices.size();
+            }
+            for (int k = 0; k < 3; k++)
+            {
+                if (seenBy[tri[k]] != meshletIndex)
+                {
+                    seenBy[tri[k]] = meshletIndex;
+                    current.vertexCount++;
+                }
+                out.indices.push_back(tri[k]);
+            }
+            current.indexCount += 3;
+        }
+        if (current.indexCount > 0)
+            out.finish(mesh, current);
+        return out;
+    }
+
+    // ------------------------------------------------------------------------
+    void printReport(const std::string& name) const
+    {
+        if (meshlets.empty())
+            return;
+        size_t vertices = 0, cullableCones = 0;
+        for (const Meshlet& m : meshlets)
+        {
+            vertices += m.vertexCount;
+            cullableCones += m.coneAxisCutoff.w <= 1.0f ? 1 : 0;
+        }
+        std::printf("MESHLETS %s: %zu meshlets, %.1f triangles and %.1f vertices each on average, %zu%% with a usable normal cone\n",
+            name.c_str(), meshlets.size(), (double)indices.size() / 3.0 / meshlets.size(), (double)vertices / meshlets.size(),
+            cullableCones * 100 / meshlets.size());
+    }
+
+private:
+    // bounds + cone for the meshlet that was just filled
+    void finish(const MeshData& mesh, Meshlet& meshlet)
+    {
+        const uint32_t* tri = &indices[meshlet.firstIndex];
+        size_t count = meshlet.indexCount;
+
+        // sphere around the box, good enough and cheap
+        glm::vec3 lo = mesh.vertices[tri[0]].position, hi = lo;
+        for (size_t i = 0; i < count; i++)
+        {
+            lo = glm::min(lo, mesh.vertices[tri[i]].position);
+            hi = glm::max(hi, mesh.vertices[tri[i]].position);
+        }
+        glm::vec3 center = 0.5f * (lo + hi);
+        float radius = 0.0f;
+        for (size_t i = 0; i < count; i++)
+            radius = std::max(radius, glm::length(mesh.vertices[tri[i]].position - center));
+
+        // cone: average face normal, and how far the furthest face normal is from it
+        struct Face { glm::vec3 point, normal; };
+        std::vector<Face> faces;
+        glm::vec3 axis(0.0f);
+        for (size_t i = 0; i + 2 < count; i += 3)
+        {
+            const glm::vec3& a = mesh.vertices[tri[i]].position;
+            glm::vec3 n = glm::cross(mesh.vertices[tri[i + 1]].position - a, mesh.vertices[tri[i + 2]].position - a);
+            float length = glm::length(n);
+            if (length <= 0.0f)
+                continue;
+            faces.push_back({ a, n / length });
+            axis += n / length;
+        }
+        float axisLength = glm::length(axis);
+        float minDot = 1.0f;
+        if (axisLength > 0.0f)
+        {
+            axis /= axisLength;
+            for (const Face& face : faces)
+                minDot = std::min(minDot, glm::dot(axis, face.normal));
+        }
+        // cones wider than ~85 degrees from the axis hardly ever cull anything, don't bother
+        float cutoff = 2.0f;
+        glm::vec3 apex = center;
+        if (axisLength > 0.0f && minDot > 0.1f)
+        {
+            // the test has to be made from a point that's behind every triangle's plane, otherwise a camera
+            // close to the meshlet could see a triangle's front while the cone says it's looking at backs:
+            // move back from the center along the axis until that's true
+            float apexDistance = 0.0f;
+            for (const Face& face : faces)
+                apexDistance = std::max(apexDistance, glm::dot(center - face.point, face.normal) / glm::dot(axis, face.normal));
+            apex = center - axis * apexDistance;
+            // every triangle faces away when dot(normalize(apex - camera), axis) >= cutoff
+            cutoff = std::sqrt(1.0f - minDot * minDot);
+        }
+
+        meshlet.centerRadius = glm::vec4(center, radius);
+        meshlet.coneAxisCutoff = glm::vec4(axis, cutoff);
+        meshlet.coneApex = glm::vec4(apex, 0.0f);
+        meshlets.push_back(meshlet);
+    }
+};
+#endif
@@ -0,0 +1,418 @@
+#ifndef PERF_OVERLAY_H
+#define PERF_OVERLAY_H
+
+#include <glad/glad.h>
+
+#include "shader_s.h"
+#include "cpu_profiler.h"
+#include "gl_call_stats.h"
+
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <cstdint>
+#include <cstddef>
+
+// GPU memory queries, from the driver's extension if it has one
+#ifndef GL_GPU_MEMORY_INFO_TOTAL_AVAILABLE_MEMORY_NVX
+#define GL_GPU_MEMORY_INFO_TOTAL_AVAILABLE_MEMORY_NVX 0x9048
+#define GL_GPU_MEMORY_INFO_CURRENT_AVAILABLE_VIDMEM_NVX 0x9049
+#endif
+#ifndef GL_TEXTURE_FREE_MEMORY_ATI
+#define GL_TEXTURE_FREE_MEMORY_ATI 0x87FC
+#endif
+// whether a new overlay starts out shown, the golden image test turns it off (timings never match)
+#ifndef PERF_OVERLAY_VISIBLE
+#define PERF_OVERLAY_VISIBLE true
+#endif
+
+// Frame stats drawn over the scene: a frame time graph, the GL call counts from gl_call_stats.h (if installed),
+// GPU memory (NVIDIA and AMD drivers tell), and whatever the chapter adds with setValue() (triangles, culling).
+//
+//   PerfOverlay overlay;                                // after the context exists
+//   overlay.setValue("triangles", count);               // any time during the frame
+//   overlay.draw(deltaTime, framebufferWidth, framebufferHeight);   // last thing before glfwSwapBuffers
+//
+// All of it is one draw call: text and graph are quads in one streamed vertex buffer, textured from a
+// little font atlas made at startup from the 5x7 glyphs below, whose extra all white cell the solid quads use.
+//
+// The overlay times itself (CPU time in draw(), GPU time with a GL_TIME_ELAPSED query read a few frames later)
+// and has to stay under budgetMs per frame on average. Building the text and uploading the quads is most
+// of that, so when it's over budget the quads get rebuilt every 2nd, 4th... frame instead (the frames in
+// between just draw the last ones again), and when it's well under it goes back towards every frame.
+// draw() sets its own blend and depth state and puts the enables back, but leaves its program, VAO and
+// texture bound, so draw it outside any GL_TIME_ELAPSED query.
+class PerfOverlay
+{
+public:
+    static const int GRAPH_SAMPLES = 128;
+    static const int MAX_QUADS = 2048;
+    static const int MAX_REFRESH_INTERVAL = 32;
+    static const int SCALE = 2;             // screen pixels per font pixel
+
+    float budgetMs = 0.25f;                 // CPU + GPU, per frame
+    bool visible = PERF_OVERLAY_VISIBLE;
+
+    PerfOverlay() : shader("./Shaders/Common/overlay_vs.glsl", "./Shaders/Common/overlay_fs.glsl")
+    {
+        shader.use();
+        shader.setInt("atlas", 0);
+        createAtlas();
+
+        glGenVertexArrays(1, &vao);
+        glGenBuffers(1, &vbo);
+        glBindVertexArray(vao);
+        glBindBuffer(GL_ARRAY_BUFFER, vbo);
+        glBufferData(GL_ARRAY_BUFFER, MAX_QUADS * 6 * sizeof(Vertex), NULL, GL_STREAM_DRAW);
+        glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, x));
+        glEnableVertexAttribArray(0);
+        glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, u));
+        glEnableVertexAttribArray(1);
+        glVertexAttribPointer(2, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(Vertex), (void*)offsetof(Vertex, color));
+        glEnableVertexAttribArray(2);
+        glBindVertexArray(0);
+
+        glGenQueries(QUERY_COUNT, queries);
+        vertices.reserve(MAX_QUADS * 6);
+        frameMs.assign(GRAPH_SAMPLES, 0.0f);
+    }
+    PerfOverlay(const PerfOverlay&) = delete;
+    PerfOverlay& operator=(const PerfOverlay&) = delete;
+
+    // a line of its own: "label value". the label has to be a string literal (only the pointer is kept)
+    // ------------------------------------------------------------------------
+    void setValue(const char* label, double value, const char* format = "%.0f")
+    {
+        for (Value& line : values)
+        {
+            if (line.label == label)
+            {
+                line.value = value;
+                line.format = format;
+                return;
+            }
+        }
+        values.push_back({ label, value, format });
+    }
+    // ------------------------------------------------------------------------
+    void draw(float frameSeconds, int width, int height)
+    {
+        uint64_t start = CpuProfiler::ticks();
+        PROFILE_SCOPE("overlay");
+        frameMs[sample++ % GRAPH_SAMPLES] = frameSeconds * 1000.0f;
+        if (!visible || width <= 0 || height <= 0)
+            return;
+
+        readQueries();
+        bool timing = pendingCount < QUERY_COUNT;
+        if (timing)
+            glBeginQuery(GL_TIME_ELAPSED, queries[(oldest + pendingCount) % QUERY_COUNT]);
+
+        if (framesSinceRefresh++ % refreshInterval == 0 || width != screenWidth || height != screenHeight)
+        {
+            rebuild(width, height);
+            framesSinceRefresh = 1;
+        }
+
+        GLboolean depthTest = glIsEnabled(GL_DEPTH_TEST), blend = glIsEnabled(GL_BLEND), cullFace = glIsEnabled(GL_CULL_FACE);
+        glDisable(GL_DEPTH_TEST);
+        glDisable(GL_CULL_FACE);
+        glEnable(GL_BLEND);
+        glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+        glViewport(0, 0, width, height);
+        shader.use();
+        glActiveTexture(GL_TEXTURE0);
+        glBindTexture(GL_TEXTURE_2D, atlas);
+        glBindVertexArray(vao);
+        glDrawArrays(GL_TRIANGLES, 0, vertexCount);
+        glBindVertexArray(0);
+        if (depthTest)
+            glEnable(GL_DEPTH_TEST);
+        if (!blend)
+            glDisable(GL_BLEND);
+        if (cullFace)
+            glEnable(GL_CULL_FACE);
+
+        if (timing)
+        {
+            glEndQuery(GL_TIME_ELAPSED);
+            pendingCount++;
+        }
+        cpuTicks += CpuProfiler::ticks() - start;
+        cpuFrames++;
+        if (cpuFrames == EVALUATE_FRAMES)
+            keepToBudget();
+    }
+    // what the overlay itself cost per frame, averaged over the last EVALUATE_FRAMES
+    // ------------------------------------------------------------------------
+    double cpuMs() const { return lastCpuMs; }
+    double gpuMs() const { return lastGpuMs; }
+    int refreshEvery() const { return refreshInterval; }
+    // ------------------------------------------------------------------------
+    void release()
+    {
+        glDeleteVertexArrays(1, &vao);
+        glDeleteBuffers(1, &vbo);
+        glDeleteTextures(1, &atlas);
+        glDeleteQueries(QUERY_COUNT, queries);
+        glDeleteProgram(shader.ID);
+        vao = vbo = atlas = 0;
+    }
+
+private:
+    static const int GLYPH_WIDTH = 5, GLYPH_HEIGHT = 7;
+    static const int CELL_WIDTH = 6, CELL_HEIGHT = 8;   // a pixel of space right and below every glyph
+    static const int ATLAS_COLUMNS = 16, ATLAS_ROWS = 5;
+    static const int SOLID_CELL = 64;                   // after the 64 glyphs
+    static const int QUERY_COUNT = 4;
+    static const int EVALUATE_FRAMES = 30;
+    static const int GRAPH_HEIGHT = 48;
+    static const int PADDING = 6;
+
+    // ' ' to '_', lower case letters are drawn as upper case. 7 rows each, bit 4 is the leftmost pixel
+    static const unsigned char (&glyphs())[64][GLYPH_HEIGHT]
+    {
+        static const unsigned char table[64][GLYPH_HEIGHT] = {
+            { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 }, { 0x04, 0x04, 0x04, 0x04, 0x04, 0x00, 0x04 }, { 0x0a, 0x0a, 0x00, 0x00, 0x00, 0x00, 0x00 }, { 0x0a, 0x0a, 0x1f, 0x0a, 0x1f, 0x0a, 0x0a },   //   ! " #
+            { 0x04, 0x0f, 0x14, 0x0e, 0x05, 0x1e, 0x04 }, { 0x18, 0x19, 0x02, 0x04, 0x08, 0x13, 0x03 }, { 0x0c, 0x12, 0x14, 0x08, 0x15, 0x12, 0x0d }, { 0x04, 0x04, 0x00, 0x00, 0x00, 0x00, 0x00 },   // $ % & '
+            { 0x02, 0x04, 0x08, 0x08, 0x08, 0x04, 0x02 }, { 0x08, 0x04, 0x02, 0x02, 0x02, 0x04, 0x08 }, { 0x00, 0x04, 0x15, 0x0e, 0x15, 0x04, 0x00 }, { 0x00, 0x04, 0x04, 0x1f, 0x04, 0x04, 0x00 },   // ( ) * +
+            { 0x00, 0x00, 0x00, 0x00, 0x0c, 0x04, 0x08 }, { 0x00, 0x00, 0x00, 0x1f, 0x00, 0x00, 0x00 }, { 0x00, 0x00, 0x00, 0x00, 0x00, 0x0c, 0x0c }, { 0x00, 0x01, 0x02, 0x04, 0x08, 0x10, 0x00 },   // , - . /
+            { 0x0e, 0x11, 0x13, 0x15, 0x19, 0x11, 0x0e }, { 0x04, 0x0c, 0x04, 0x04, 0x04, 0x04, 0x0e }, { 0x0e, 0x11, 0x01, 0x02, 0x04, 0x08, 0x1f }, { 0x1f, 0x02, 0x04, 0x02, 0x01, 0x11, 0x0e },   // 0 1 2 3
+            { 0x02, 0x06, 0x0a, 0x12, 0x1f, 0x02, 0x02 }, { 0x1f, 0x10, 0x1e, 0x01, 0x01, 0x11, 0x0e }, { 0x06, 0x08, 0x10, 0x1e, 0x11, 0x11, 0x0e }, { 0x1f, 0x01, 0x02, 0x04, 0x08, 0x08, 0x08 },   // 4 5 6 7
+            { 0x0e, 0x11, 0x11, 0x0e, 0x11, 0x11, 0x0e }, { 0x0e, 0x11, 0x11, 0x0f, 0x01, 0x02, 0x0c }, { 0x00, 0x0c, 0x0c, 0x00, 0x0c, 0x0c, 0x00 }, { 0x00, 0x0c, 0x0c, 0x00, 0x0c, 0x04, 0x08 },   // 8 9 : ;
+            { 0x02, 0x04, 0x08, 0x10, 0x08, 0x04, 0x02 }, { 0x00, 0x00, 0x1f, 0x00, 0x1f, 0x00, 0x00 }, { 0x08, 0x04, 0x02, 0x01, 0x02, 0x04, 0x08 }, { 0x0e, 0x11, 0x01, 0x02, 0x04, 0x00, 0x04 },   // < = > ?
+            { 0x0e, 0x11, 0x01, 0x0d, 0x15, 0x15, 0x0e }, { 0x0e, 0x11, 0x11, 0x1f, 0x11, 0x11, 0x11 }, { 0x1e, 0x11, 0x11, 0x1e, 0x11, 0x11, 0x1e }, { 0x0e, 0x11, 0x10, 0x10, 0x10, 0x11, 0x0e },   // @ A B C
+            { 0x1c, 0x12, 0x11, 0x11, 0x11, 0x12, 0x1c }, { 0x1f, 0x10, 0x10, 0x1e, 0x10, 0x10, 0x1f }, { 0x1f, 0x10, 0x10, 0x1e, 0x10, 0x10, 0x10 }, { 0x0e, 0x11, 0x10, 0x17, 0x11, 0x11, 0x0f },   // D E F G
+            { 0x11, 0x11, 0x11, 0x1f, 0x11, 0x11, 0x11 }, { 0x0e, 0x04, 0x04, 0x04, 0x04, 0x04, 0x0e }, { 0x07, 0x02, 0x02, 0x02, 0x02, 0x12, 0x0c }, { 0x11, 0x12, 0x14, 0x18, 0x14, 0x12, 0x11 },   // H I J K
+            { 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x1f }, { 0x11, 0x1b, 0x15, 0x15, 0x11, 0x11, 0x11 }, { 0x11, 0x11, 0x19, 0x15, 0x13, 0x11, 0x11 }, { 0x0e, 0x11, 0x11, 0x11, 0x11, 0x11, 0x0e },   // L M N O
+            { 0x1e, 0x11, 0x11, 0x1e, 0x10, 0x10, 0x10 }, { 0x0e, 0x11, 0x11, 0x11, 0x15, 0x12, 0x0d }, { 0x1e, 0x11, 0x11, 0x1e, 0x14, 0x12, 0x11 }, { 0x0f, 0x10, 0x10, 0x0e, 0x01, 0x01, 0x1e },   // P Q R S
+            { 0x1f, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04 }, { 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x0e }, { 0x11, 0x11, 0x11, 0x11, 0x11, 0x0a, 0x04 }, { 0x11, 0x11, 0x11, 0x15, 0x15, 0x15, 0x0a },   // T U V W
+            { 0x11, 0x11, 0x0a, 0x04, 0x0a, 0x11, 0x11 }, { 0x11, 0x11, 0x0a, 0x04, 0x04, 0x04, 0x04 }, { 0x1f, 0x01, 0x02, 0x04, 0x08, 0x10, 0x1f }, { 0x0e, 0x08, 0x08, 0x08, 0x08, 0x08, 0x0e },   // X Y Z [
+            { 0x00, 0x10, 0x08, 0x04, 0x02, 0x01, 0x00 }, { 0x0e, 0x02, 0x02, 0x02, 0x02, 0x02, 0x0e }, { 0x04, 0x0a, 0x11, 0x00, 0x00, 0x00, 0x00 }, { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x1f },   // \ ] ^ _
+        };
+        return table;
+    }
+
+    struct Vertex
+    {
+        float x, y;     // pixels from the top left
+        float u, v;
+        uint32_t color; // RGBA bytes
+    };
+    struct Value
+    {
+        const char* label;
+        double value;
+        const char* format;
+    };
+
+    Shader shader;
+    unsigned int vao = 0, vbo = 0, atlas = 0;
+    std::vector<Vertex> vertices;
+    GLsizei vertexCount = 0;
+    std::vector<Value> values;
+    std::vector<float> frameMs;             // ring of the last GRAPH_SAMPLES frame times
+    unsigned long long sample = 0;
+    int screenWidth = 0, screenHeight = 0;
+    int refreshInterval = 1;
+    unsigned long long framesSinceRefresh = 0;
+
+    // own cost
+    GLuint queries[QUERY_COUNT];
+    int oldest = 0, pendingCount = 0;
+    uint64_t cpuTicks = 0, gpuNanoseconds = 0;
+    int cpuFrames = 0, gpuFrames = 0;
+    double lastCpuMs = 0.0, lastGpuMs = 0.0;
+
+    static uint32_t rgba(int r, int g, int b, int a)
+    {
+        uint8_t bytes[4] = { (uint8_t)r, (uint8_t)g, (uint8_t)b, (uint8_t)a };
+        uint32_t color;
+        std::memcpy(&color, bytes, 4);
+        return color;
+    }
+
+    void createAtlas()
+    {
+        const int width = ATLAS_COLUMNS * CELL_WIDTH, height = ATLAS_ROWS * CELL_HEIGHT;
+        std::vector<unsigned char> pixels(width * height, 0);
+        for (int glyph = 0; glyph < 64; glyph++)
+        {
+            int cellX = (glyph % ATLAS_COLUMNS) * CELL_WIDTH, cellY = (glyph / ATLAS_COLUMNS) * CELL_HEIGHT;
+            for (int y = 0; y < GLYPH_HEIGHT; y++)
+                for (int x = 0; x < GLYPH_WIDTH; x++)
+                    if (glyphs()[glyph][y] & (0x10 >> x))
+                        pixels[(cellY + y) * width + cellX + x] = 255;
+        }
+        int solidX = (SOLID_CELL % ATLAS_COLUMNS) * CELL_WIDTH, solidY = (SOLID_CELL / ATLAS_COLUMNS) * CELL_HEIGHT;
+        for (int y = 0; y < CELL_HEIGHT; y++)
+            std::memset(&pixels[(solidY + y) * width + solidX], 255, CELL_WIDTH);
+
+        glGenTextures(1, &atlas);
+        glBindTexture(GL_TEXTURE_2D, atlas);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_R8, width, height, 0, GL_RED, GL_UNSIGNED_BYTE, pixels.data());
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+        // nearest, every font pixel is exactly SCALE x SCALE screen pixels
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    }
+
+    // ------------------------------------------------------------------------
+    void quad(float x0, float y0, float x1, float y1, float u0, float v0, float u1, float v1, uint32_t color)
+    {
+        if (vertices.size() + 6 > (size_t)MAX_QUADS * 6)
+            return;
+        Vertex a = { x0, y0, u0, v0, color }, b = { x1, y0, u1, v0, color };
+        Vertex c = { x1, y1, u1, v1, color }, d = { x0, y1, u0, v1, color };
+        vertices.insert(vertices.end(), { a, b, c, a, c, d });
+    }
+    void solid(float x0, float y0, float x1, float y1, uint32_t color)
+    {
+        // the middle of the white cell, so filtering never reaches a neighbour
+        float u = ((SOLID_CELL % ATLAS_COLUMNS) + 0.5f) / ATLAS_COLUMNS, v = ((SOLID_CELL / ATLAS_COLUMNS) + 0.5f) / ATLAS_ROWS;
+        quad(x0, y0, x1, y1, u, v, u, v, color);
+    }
+    // returns the width drawn
+    float text(float x, float y, const char* string, uint32_t color)
+    {
+        float startX = x;
+        for (const char* c = string; *c; c++, x += CELL_WIDTH * SCALE)
+        {
+            int code = (unsigned char)*c;
+            if (code >= 'a' && code <= 'z')
+                code -= 'a' - 'A';
+            if (code == ' ')
+                continue;
+            int glyph = (code >= 32 && code < 96) ? code - 32 : '?' - 32;
+            float u0 = (float)(glyph % ATLAS_COLUMNS) / ATLAS_COLUMNS, v0 = (float)(glyph / ATLAS_COLUMNS) / ATLAS_ROWS;
+            quad(x, y, x + CELL_WIDTH * SCALE, y + CELL_HEIGHT * SCALE, u0, v0, u0 + 1.0f / ATLAS_COLUMNS, v0 + 1.0f / ATLAS_ROWS, color);
+        }
+        return x - startX;
+    }
+
+    // lays out everything and uploads it
+    void rebuild(int width, int height)
+    {
+        screenWidth = width;
+        screenHeight = height;
+        std::vector<std::string> lines;
+        char line[128];
+
+        // frame time over the graph's window
+        int count = (int)std::min<unsigned long long>(sample, GRAPH_SAMPLES);
+        float sum = 0.0f, worst = 0.0f;
+        for (int i = 0; i < count; i++)
+        {
+            sum += frameMs[i];
+            worst = std::max(worst, frameMs[i]);
+        }
+        float average = count ? sum / count : 0.0f;
+        std::snprintf(line, sizeof(line), "frame %.2f ms (worst %.1f)  %.0f fps", average, worst, average > 0.0f ? 1000.0f / average : 0.0f);
+        lines.push_back(line);
+
+        const GlFrameStats& gl = GlCallStats::lastFrame();
+        if (gl.totalCalls() > 0)
+        {
+            std::snprintf(line, sizeof(line), "draw calls %llu  gl calls %llu", (unsigned long long)gl.drawCalls(), (unsigned long long)gl.totalCalls());
+            lines.push_back(line);
+            std::snprintf(line, sizeof(line), "uploads %.1f kb", (gl.bufferBytes() + gl.textureBytes() + gl.uniformBytes()) / 1024.0);
+            lines.push_back(line);
+        }
+
+        GLint total = 0, available = 0, atiFree[4] = {};
+        if (GLAD_GL_NVX_gpu_memory_info)
+        {
+            glGetIntegerv(GL_GPU_MEMORY_INFO_TOTAL_AVAILABLE_MEMORY_NVX, &total);
+            glGetIntegerv(GL_GPU_MEMORY_INFO_CURRENT_AVAILABLE_VIDMEM_NVX, &available);
+            std::snprintf(line, sizeof(line), "gpu memory %d / %d mb", (total - available) / 1024, total / 1024);
+            lines.push_back(line);
+        }
+        else if (GLAD_GL_ATI_meminfo)
+        {
+            glGetIntegerv(GL_TEXTURE_FREE_MEMORY_ATI, atiFree);
+            std::snprintf(line, sizeof(line), "gpu memory free %d mb", atiFree[0] / 1024);
+            lines.push_back(line);
+        }
+
+        for (const Value& value : values)
+        {
+            char number[64];
+            std::snprintf(number, sizeof(number), value.format, value.value);
+            lines.push_back(std::string(value.label) + " " + number);
+        }
+        std::snprintf(line, sizeof(line), "overlay %.3f ms cpu %.3f gpu, 1/%d", lastCpuMs, lastGpuMs, refreshInterval);
+        lines.push_back(line);
+
+        // panel, text, graph
+        vertices.clear();
+        const float lineHeight = (CELL_HEIGHT + 2) * SCALE;
+        size_t longest = 0;
+        for (const std::string& text : lines)
+            longest = std::max(longest, text.size());
+        float panelWidth = std::max((float)longest * CELL_WIDTH * SCALE, (float)GRAPH_SAMPLES * 2) + PADDING * 2;
+        float panelHeight = lines.size() * lineHeight + GRAPH_HEIGHT + PADDING * 3;
+        solid(0.0f, 0.0f, panelWidth, panelHeight, rgba(0, 0, 0, 160));
+
+        float y = PADDING;
+        for (size_t i = 0; i < lines.size(); i++, y += lineHeight)
+            text(PADDING, y, lines[i].c_str(), i + 1 == lines.size() ? rgba(150, 150, 150, 255) : rgba(255, 255, 255, 255));
+
+        // oldest sample on the left, full height is 33.3 ms (30 fps)
+        float graphTop = y + PADDING, graphBottom = graphTop + GRAPH_HEIGHT;
+        for (int i = 0; i < GRAPH_SAMPLES; i++)
+        {
+            float ms = frameMs[(sample + i) % GRAPH_SAMPLES];
+            float barHeight = std::min(ms / 33.3f, 1.0f) * GRAPH_HEIGHT;
+            uint32_t color = ms <= 16.7f ? rgba(80, 220, 80, 255) : ms <= 33.3f ? rgba(240, 200, 60, 255) : rgba(240, 70, 60, 255);
+            solid(PADDING + i * 2.0f, graphBottom - barHeight, PADDING + i * 2.0f + 2.0f, graphBottom, color);
+        }
+        // the 60 fps line
+        float target = graphBottom - 16.7f / 33.3f * GRAPH_HEIGHT;
+        solid(PADDING, target, PADDING + GRAPH_SAMPLES * 2.0f, target + 1.0f, rgba(255, 255, 255, 110));
+
+        vertexCount = (GLsizei)vertices.size();
+        shader.use();
+        shader.setVec2("screenSize", glm::vec2((float)width, (float)height));
+        glBindBuffer(GL_ARRAY_BUFFER, vbo);
+        glBufferData(GL_ARRAY_BUFFER, MAX_QUADS * 6 * sizeof(Vertex), NULL, GL_STREAM_DRAW); // orphan last upload
+        glBufferSubData(GL_ARRAY_BUFFER, 0, vertices.size() * sizeof(Vertex), vertices.data());
+    }
+
+    // GPU times of earlier frames that are done, never waits
+    void readQueries()
+    {
+        while (pendingCount > 0)
+        {
+            GLuint available = 0;
+            glGetQueryObjectuiv(queries[oldest], GL_QUERY_RESULT_AVAILABLE, &available);
+            if (!available)
+                break;
+            GLuint64 nanoseconds = 0;
+            glGetQueryObjectui64v(queries[oldest], GL_QUERY_RESULT, &nanoseconds);
+            gpuNanoseconds += nanoseconds;
+            gpuFrames++;
+            oldest = (oldest + 1) % QUERY_COUNT;
+            pendingCount--;
+        }
+    }
+    // rebuild less often when over budget, more often when there's room
+    void keepToBudget()
+    {
+        lastCpuMs = cpuTicks / CpuProfiler::ticksPerMicrosecond() / 1000.0 / cpuFrames;
+        if (gpuFrames > 0)
+            lastGpuMs = gpuNanoseconds / 1.0e6 / gpuFrames;
+        double cost = lastCpuMs + lastGpuMs;
+        if (cost > budgetMs && refreshInterval < MAX_REFRESH_INTERVAL)
+            refreshInterval *= 2;
+        else if (cost < budgetMs / 4.0 && refreshInterval > 1)
+            refreshInterval /= 2;
+        cpuTicks = gpuNanoseconds = 0;
+        cpuFrames = gpuFrames = 0;
+    }
+};
+#endif
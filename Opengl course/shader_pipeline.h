@@ -0,0 +1,209 @@
+#ifndef SHADER_PIPELINE_H
+#define SHADER_PIPELINE_H
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+#include "shader_preprocessor.h"
+
+#include <string>
+#include <vector>
+#include <iostream>
+
+// Separable shader stages + program pipelines (OpenGL 4.1 / ARB_separate_shader_objects).
+//
+// A Shader links one vertex and one fragment shader into one program, so two programs that share a
+// vertex shader still compile and link it twice. A ShaderStage is a program holding a single stage,
+// compiled once, and a ShaderPipeline plugs stages together at draw time:
+//
+//   ShaderStage vertex(GL_VERTEX_SHADER, "vs.glsl");
+//   ShaderStage litFragment(GL_FRAGMENT_SHADER, "fs.glsl");
+//   ShaderStage flatFragment(GL_FRAGMENT_SHADER, "flat_fs.glsl");
+//   ShaderPipeline lit(vertex, litFragment), flat(vertex, flatFragment);
+//
+// Uniforms belong to the stage, not the pipeline, and are set with glProgramUniform* so the stage
+// doesn't have to be bound. A uniform set on the shared vertex stage (like viewProjection) is set once
+// for every pipeline using it. Sources go through ShaderPreprocessor, so #include and defines work too.
+// A GL_COMPUTE_SHADER stage doesn't need a pipeline, glUseProgram(stage.ID) and glDispatchCompute.
+class ShaderStage
+{
+public:
+    unsigned int ID = 0;
+    unsigned int type;
+    // ------------------------------------------------------------------------
+    ShaderStage(unsigned int type, const char* path, const std::vector<std::string>& defines = {}) : type(type)
+    {
+        std::string code;
+        std::vector<std::string> files;
+        if (!ShaderPreprocessor::run(path, defines, code, files))
+            return;
+        const char* source = code.c_str();
+        // compiles, and links with GL_PROGRAM_SEPARABLE set, in one go
+        ID = glCreateShaderProgramv(type, 1, &source);
+
+        int success;
+        glGetProgramiv(ID, GL_LINK_STATUS, &success);
+        if (!success)
+        {
+            char infoLog[1024];
+            glGetProgramInfoLog(ID, 1024, NULL, infoLog);
+            std::cout << "ERROR::SHADER_STAGE_LINKING_ERROR " << path << "\n" << infoLog << "\n -- --------------------------------------------------- -- " << std::endl;
+            for (size_t i = 0; i < files.size(); i++)
+                std::cout << "  source string " << i << ": " << files[i] << std::endl;
+        }
+        viewProjectionLocation = glGetUniformLocation(ID, "viewProjection");
+        modelLocation = glGetUniformLocation(ID, "model");
+        normalMatrixLocation = glGetUniformLocation(ID, "normalMatrix");
+    }
+    ~ShaderStage()
+    {
+        release();
+    }
+    // deletes the program, while the context is still around
+    // ------------------------------------------------------------------------
+    void release()
+    {
+        // already released (or never compiled), the destructor can run after glfwTerminate
+        if (ID == 0)
+            return;
+        glDeleteProgram(ID);
+        ID = 0;
+    }
+    ShaderStage(const ShaderStage&) = delete;
+    ShaderStage& operator=(const ShaderStage&) = delete;
+
+    // the GL_*_SHADER_BIT for glUseProgramStages
+    // ------------------------------------------------------------------------
+    unsigned int stageBit() const
+    {
+        switch (type)
+        {
+        case GL_VERTEX_SHADER: return GL_VERTEX_SHADER_BIT;
+        case GL_FRAGMENT_SHADER: return GL_FRAGMENT_SHADER_BIT;
+        case GL_GEOMETRY_SHADER: return GL_GEOMETRY_SHADER_BIT;
+        case GL_TESS_CONTROL_SHADER: return GL_TESS_CONTROL_SHADER_BIT;
+        case GL_TESS_EVALUATION_SHADER: return GL_TESS_EVALUATION_SHADER_BIT;
+        case GL_COMPUTE_SHADER: return GL_COMPUTE_SHADER_BIT;
+        }
+        return 0;
+    }
+    // utility uniform functions, same as Shader's but they work whether or not the stage is bound
+    // ------------------------------------------------------------------------
+    void setBool(const std::string& name, bool value) const
+    {
+        glProgramUniform1i(ID, glGetUniformLocation(ID, name.c_str()), (int)value);
+    }
+    // ------------------------------------------------------------------------
+    void setInt(const std::string& name, int value) const
+    {
+        glProgramUniform1i(ID, glGetUniformLocation(ID, name.c_str()), value);
+    }
+    // ------------------------------------------------------------------------
+    void setFloat(const std::string& name, float value) const
+    {
+        glProgramUniform1f(ID, glGetUniformLocation(ID, name.c_str()), value);
+    }
+    // ------------------------------------------------------------------------
+    void setVec3(const std::string& name, const glm::vec3& value) const
+    {
+        glProgramUniform3fv(ID, glGetUniformLocation(ID, name.c_str()), 1, glm::value_ptr(value));
+    }
+    void setVec3(const std::string& name, float x, float y, float z) const
+    {
+        glProgramUniform3f(ID, glGetUniformLocation(ID, name.c_str()), x, y, z);
+    }
+    // ------------------------------------------------------------------------
+    void setVec4(const std::string& name, const glm::vec4& value) const
+    {
+        glProgramUniform4fv(ID, glGetUniformLocation(ID, name.c_str()), 1, glm::value_ptr(value));
+    }
+    // ------------------------------------------------------------------------
+    void setMat4(const std::string& name, const glm::mat4& mat) const
+    {
+        glProgramUniformMatrix4fv(ID, glGetUniformLocation(ID, name.c_str()), 1, GL_FALSE, glm::value_ptr(mat));
+    }
+    // same transform convention as Shader (see shader_s.h)
+    // ------------------------------------------------------------------------
+    void setViewProjection(const glm::mat4& view, const glm::mat4& projection) const
+    {
+        setViewProjection(projection * view);
+    }
+    void setViewProjection(const glm::mat4& viewProjection) const
+    {
+        glProgramUniformMatrix4fv(ID, viewProjectionLocation, 1, GL_FALSE, glm::value_ptr(viewProjection));
+    }
+    // ------------------------------------------------------------------------
+    void setModel(const glm::mat4& model) const
+    {
+        glProgramUniformMatrix4fv(ID, modelLocation, 1, GL_FALSE, glm::value_ptr(model));
+        if (normalMatrixLocation != -1)
+        {
+            glm::mat3 normalMatrix = glm::transpose(glm::inverse(glm::mat3(model)));
+            glProgramUniformMatrix3fv(ID, normalMatrixLocation, 1, GL_FALSE, glm::value_ptr(normalMatrix));
+        }
+    }
+
+private:
+    int viewProjectionLocation = -1;
+    int modelLocation = -1;
+    int normalMatrixLocation = -1;
+};
+
+// a set of stages to draw with. bind() replaces glUseProgram, nothing gets linked here
+class ShaderPipeline
+{
+public:
+    unsigned int ID = 0;
+    // ------------------------------------------------------------------------
+    ShaderPipeline(const ShaderStage& vertex, const ShaderStage& fragment)
+    {
+        glGenProgramPipelines(1, &ID);
+        use(vertex);
+        use(fragment);
+    }
+    ~ShaderPipeline()
+    {
+        release();
+    }
+    // ------------------------------------------------------------------------
+    void release()
+    {
+        if (ID == 0)
+            return;
+        glDeleteProgramPipelines(1, &ID);
+        ID = 0;
+    }
+    ShaderPipeline(const ShaderPipeline&) = delete;
+    ShaderPipeline& operator=(const ShaderPipeline&) = delete;
+
+    // swap one stage out for another
+    // ------------------------------------------------------------------------
+    void use(const ShaderStage& stage)
+    {
+        glUseProgramStages(ID, stage.stageBit(), stage.ID);
+    }
+    // glUseProgram wins over the bound pipeline, so make sure no monolithic program is in use
+    // ------------------------------------------------------------------------
+    void bind() const
+    {
+        glUseProgram(0);
+        glBindProgramPipeline(ID);
+    }
+    // checks the stages fit together (outputs of one match the inputs of the next), prints the log if not
+    // ------------------------------------------------------------------------
+    bool validate() const
+    {
+        glValidateProgramPipeline(ID);
+        int valid;
+        glGetProgramPipelineiv(ID, GL_VALIDATE_STATUS, &valid);
+        if (!valid)
+        {
+            char infoLog[1024];
+            glGetProgramPipelineInfoLog(ID, 1024, NULL, infoLog);
+            std::cout << "ERROR::PROGRAM_PIPELINE_VALIDATION_ERROR\n" << infoLog << std::endl;
+        }
+        return valid != 0;
+    }
+};
+#endif
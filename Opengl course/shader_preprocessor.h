@@ -0,0 +1,146 @@
+#ifndef SHADER_PREPROCESSOR_H
+#define SHADER_PREPROCESSOR_H
+
+#include <string>
+#include <vector>
+#include <set>
+#include <fstream>
+#include <sstream>
+#include <iostream>
+#include <filesystem>
+
+// The bits of preprocessing GLSL doesn't do by itself, run on the CPU before the source goes to the driver:
+//
+//   #include "file.glsl"   pastes the file in. The path is relative to the file doing the including.
+//                          Every file gets included at most once per shader, so shared files don't need guards.
+//   defines                a list like { "NUM_LIGHTS 4", "USE_SPECULAR 0" } turned into #define lines right
+//                          after #version, so one source file can be compiled into several variants where
+//                          the #if's are decided by the compiler instead of branching at runtime.
+//
+// #line directives are added around every include so compile errors still point at the right line.
+// The second number in those errors (the "source string") is the file's index in the files list.
+class ShaderPreprocessor
+{
+public:
+    // out gets the final source. files collects every file that went into it (the top file included),
+    // indices in it are the source string numbers. returns false if a file couldn't be read
+    // ------------------------------------------------------------------------
+    static bool run(const std::string& path, const std::vector<std::string>& defines, std::string& out, std::vector<std::string>& files)
+    {
+        std::set<std::string> included;
+        std::ostringstream stream;
+        bool definesDone = false;
+        if (!expand(normalize(path), &defines, definesDone, files, included, stream))
+            return false;
+        out = stream.str();
+        // no #version at all, so there's nothing they have to come after
+        if (!definesDone)
+            out = defineLines(defines) + out;
+        return true;
+    }
+    // read a whole file into a string
+    // ------------------------------------------------------------------------
+    static bool readFile(const std::string& path, std::string& out)
+    {
+        std::ifstream file;
+        // ensure ifstream objects can throw exceptions:
+        file.exceptions(std::ifstream::failbit | std::ifstream::badbit);
+        try
+        {
+            file.open(path);
+            std::stringstream stream;
+            // read file's buffer contents into streams
+            stream << file.rdbuf();
+            file.close();
+            // convert stream into string
+            out = stream.str();
+            return true;
+        }
+        catch (std::ifstream::failure& e)
+        {
+            std::cout << "ERROR::SHADER::FILE_NOT_SUCCESFULLY_READ: " << path << " " << e.what() << std::endl;
+            return false;
+        }
+    }
+    // ------------------------------------------------------------------------
+    static std::string normalize(const std::string& path)
+    {
+        return std::filesystem::path(path).lexically_normal().generic_string();
+    }
+
+private:
+    // defines only go into the top level file, include files get nullptr
+    static bool expand(const std::string& path, const std::vector<std::string>* defines, bool& definesDone,
+        std::vector<std::string>& files, std::set<std::string>& included, std::ostringstream& out)
+    {
+        included.insert(path);
+        std::string source;
+        if (!readFile(path, source))
+            return false;
+        int fileIndex = indexOf(files, path);
+
+        std::istringstream lines(source);
+        std::string line;
+        int lineNumber = 0;
+        while (std::getline(lines, line))
+        {
+            lineNumber++;
+            if (!line.empty() && line.back() == '\r')
+                line.pop_back();
+
+            std::string directive = trimmed(line);
+            if (directive.compare(0, 8, "#include") == 0)
+            {
+                size_t open = directive.find('"');
+                size_t close = directive.find('"', open + 1);
+                if (open == std::string::npos || close == std::string::npos)
+                {
+                    std::cout << "ERROR::SHADER::BAD_INCLUDE " << path << "(" << lineNumber << "): " << line << std::endl;
+                    return false;
+                }
+                std::string name = directive.substr(open + 1, close - open - 1);
+                std::string includePath = normalize((std::filesystem::path(path).parent_path() / name).generic_string());
+                if (included.count(includePath) == 0)
+                {
+                    out << "#line 1 " << indexOf(files, includePath) << "\n";
+                    if (!expand(includePath, nullptr, definesDone, files, included, out))
+                        return false;
+                }
+                // back to where we were in this file
+                out << "#line " << lineNumber + 1 << " " << fileIndex << "\n";
+                continue;
+            }
+
+            out << line << "\n";
+            if (defines && !definesDone && directive.compare(0, 8, "#version") == 0)
+            {
+                // #version has to stay the first thing in the shader, so the variant's defines go right under it
+                out << defineLines(*defines);
+                out << "#line " << lineNumber + 1 << " " << fileIndex << "\n";
+                definesDone = true;
+            }
+        }
+        return true;
+    }
+    static std::string defineLines(const std::vector<std::string>& defines)
+    {
+        std::string lines;
+        for (const std::string& define : defines)
+            lines += "#define " + define + "\n";
+        return lines;
+    }
+    static std::string trimmed(const std::string& line)
+    {
+        size_t first = line.find_first_not_of(" \t");
+        return first == std::string::npos ? std::string() : line.substr(first);
+    }
+    static int indexOf(std::vector<std::string>& files, const std::string& path)
+    {
+        for (size_t i = 0; i < files.size(); i++)
+            if (files[i] == path)
+                return (int)i;
+        files.push_back(path);
+        return (int)files.size() - 1;
+    }
+};
+#endif
@@ -2,75 +2,141 @@
 #define SHADER_H
 
 #include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+#include "shader_preprocessor.h"
 
 #include <string>
+#include <vector>
 #include <fstream>
 #include <sstream>
 #include <iostream>
 
+// Transform convention for vertex shaders:
+//   uniform mat4 viewProjection; // projection * view, done once per frame on the CPU
+//   uniform mat4 model;          // per object
+//   uniform mat3 normalMatrix;   // per object, transpose(inverse(mat3(model))) (only if the shader lights things)
+// so the vertex shader does viewProjection * (model * pos), two mat4 * vec4 products,
+// instead of projection * view * model * pos which chains full matrix products per vertex.
+// setViewProjection() / setModel() fill these in, shaders that don't declare one just ignore it.
 class Shader
 {
 public:
     unsigned int ID;
+    // where the source came from, so the program can be rebuilt later (see reload() and shader_watcher.h)
+    std::string vertexPath;
+    std::string fragmentPath;
+    // #defines for this variant, e.g. { "NUM_LIGHTS 4", "USE_SPECULAR 0" } (see shader_preprocessor.h)
+    std::vector<std::string> defines;
     // constructor generates the shader on the fly
     // ------------------------------------------------------------------------
-    Shader(const char* vertexPath, const char* fragmentPath)
+    Shader(const char* vertexPath, const char* fragmentPath, const std::vector<std::string>& defines = {})
+        : vertexPath(vertexPath), fragmentPath(fragmentPath), defines(defines)
     {
-        // 1. retrieve the vertex/fragment source code from filePath
+        // 1. retrieve the vertex/fragment source code from filePath (with #includes pasted in)
         std::string vertexCode;
         std::string fragmentCode;
-        std::ifstream vShaderFile;
-        std::ifstream fShaderFile;
-        // ensure ifstream objects can throw exceptions:
-        vShaderFile.exceptions(std::ifstream::failbit | std::ifstream::badbit);
-        fShaderFile.exceptions(std::ifstream::failbit | std::ifstream::badbit);
-        try
-        {
-            // open files
-            vShaderFile.open(vertexPath);
-            fShaderFile.open(fragmentPath);
-            std::stringstream vShaderStream, fShaderStream;
-            // read file's buffer contents into streams
-            vShaderStream << vShaderFile.rdbuf();
-            fShaderStream << fShaderFile.rdbuf();
-            // close file handlers
-            vShaderFile.close();
-            fShaderFile.close();
-            // convert stream into string
-            vertexCode = vShaderStream.str();
-            fragmentCode = fShaderStream.str();
-        }
-        catch (std::ifstream::failure& e)
+        loadSources(vertexCode, fragmentCode, files);
+        // 2. compile shaders and link them into the program
+        ID = beginProgram(vertexCode, fragmentCode);
+        if (!finishProgram(ID))
+            printSourceFiles(files);
+        // look up the transform uniforms once instead of every draw
+        lookupLocations();
+    }
+    // rebuild the program from the same files. if anything fails to compile or link the old program is kept
+    // ------------------------------------------------------------------------
+    bool reload()
+    {
+        std::string vertexCode;
+        std::string fragmentCode;
+        std::vector<std::string> newFiles;
+        if (!loadSources(vertexCode, fragmentCode, newFiles))
+            return false;
+        return swapIfLinked(beginProgram(vertexCode, fragmentCode), newFiles);
+    }
+    // run both stages through the preprocessor. only reads the paths and defines, so it's safe off the GL thread
+    // ------------------------------------------------------------------------
+    bool loadSources(std::string& vertexCode, std::string& fragmentCode, std::vector<std::string>& sourceFiles) const
+    {
+        sourceFiles.clear();
+        bool ok = ShaderPreprocessor::run(vertexPath, defines, vertexCode, sourceFiles);
+        return ShaderPreprocessor::run(fragmentPath, defines, fragmentCode, sourceFiles) && ok;
+    }
+    // every file the program is built from (includes too), what a file watcher needs to keep an eye on
+    // ------------------------------------------------------------------------
+    const std::vector<std::string>& sourceFiles() const
+    {
+        return files;
+    }
+    // take over a program started with beginProgram() if it linked, otherwise throw it away and keep the current one.
+    // sourceFiles is what loadSources() gave back for that source
+    // ------------------------------------------------------------------------
+    bool swapIfLinked(unsigned int program, const std::vector<std::string>& sourceFiles)
+    {
+        if (!finishProgram(program))
         {
-            std::cout << "ERROR::SHADER::FILE_NOT_SUCCESFULLY_READ: " << e.what() << std::endl;
+            printSourceFiles(sourceFiles);
+            glDeleteProgram(program);
+            return false;
         }
+        glDeleteProgram(ID);
+        ID = program;
+        files = sourceFiles;
+        lookupLocations();
+        return true;
+    }
+    // compile both stages and start linking, but don't ask GL whether it worked yet.
+    // asking is what blocks, so with KHR_parallel_shader_compile the driver can do this in the background
+    // and finishProgram() can be called once GL_COMPLETION_STATUS_KHR says it's done
+    // ------------------------------------------------------------------------
+    static unsigned int beginProgram(const std::string& vertexCode, const std::string& fragmentCode)
+    {
         const char* vShaderCode = vertexCode.c_str();
         const char* fShaderCode = fragmentCode.c_str();
-        // 2. compile shaders
         unsigned int vertex, fragment;
         // vertex shader
         vertex = glCreateShader(GL_VERTEX_SHADER);
         glShaderSource(vertex, 1, &vShaderCode, NULL);
         glCompileShader(vertex);
-        checkCompileErrors(vertex, "VERTEX");
         // fragment Shader
         fragment = glCreateShader(GL_FRAGMENT_SHADER);
         glShaderSource(fragment, 1, &fShaderCode, NULL);
         glCompileShader(fragment);
-        checkCompileErrors(fragment, "FRAGMENT");
         // shader Program
-        ID = glCreateProgram();
-        glAttachShader(ID, vertex);
-        glAttachShader(ID, fragment);
-        glLinkProgram(ID);
-        checkCompileErrors(ID, "PROGRAM");
-        // delete the shaders as they're linked into our program now and no longer necessary
+        unsigned int program = glCreateProgram();
+        glAttachShader(program, vertex);
+        glAttachShader(program, fragment);
+        glLinkProgram(program);
+        // flag the shaders for deletion, they go away for real once they're detached in finishProgram()
         glDeleteShader(vertex);
         glDeleteShader(fragment);
+        return program;
+    }
+    // print any compile/link errors and drop the shader objects. returns true if the program is usable
+    // ------------------------------------------------------------------------
+    static bool finishProgram(unsigned int program)
+    {
+        bool ok = true;
+        unsigned int shaders[2];
+        int count = 0;
+        glGetAttachedShaders(program, 2, &count, shaders);
+        for (int i = 0; i < count; i++)
+        {
+            int type;
+            glGetShaderiv(shaders[i], GL_SHADER_TYPE, &type);
+            ok = checkCompileErrors(shaders[i], type == GL_VERTEX_SHADER ? "VERTEX" : "FRAGMENT") && ok;
+        }
+        ok = checkCompileErrors(program, "PROGRAM") && ok;
+        // delete the shaders as they're linked into our program now and no longer necessary
+        for (int i = 0; i < count; i++)
+            glDetachShader(program, shaders[i]);
+        return ok;
     }
     // activate the shader
     // ------------------------------------------------------------------------
-    void use()
+    void use() const
     {
         glUseProgram(ID);
     }
@@ -90,11 +156,79 @@ public:
     {
         glUniform1f(glGetUniformLocation(ID, name.c_str()), value);
     }
+    // ------------------------------------------------------------------------
+    void setVec2(const std::string& name, const glm::vec2& value) const
+    {
+        glUniform2fv(glGetUniformLocation(ID, name.c_str()), 1, glm::value_ptr(value));
+    }
+    // ------------------------------------------------------------------------
+    void setVec3(const std::string& name, const glm::vec3& value) const
+    {
+        glUniform3fv(glGetUniformLocation(ID, name.c_str()), 1, glm::value_ptr(value));
+    }
+    void setVec3(const std::string& name, float x, float y, float z) const
+    {
+        glUniform3f(glGetUniformLocation(ID, name.c_str()), x, y, z);
+    }
+    // ------------------------------------------------------------------------
+    void setVec4(const std::string& name, const glm::vec4& value) const
+    {
+        glUniform4fv(glGetUniformLocation(ID, name.c_str()), 1, glm::value_ptr(value));
+    }
+    // ------------------------------------------------------------------------
+    void setMat3(const std::string& name, const glm::mat3& mat) const
+    {
+        glUniformMatrix3fv(glGetUniformLocation(ID, name.c_str()), 1, GL_FALSE, glm::value_ptr(mat));
+    }
+    // ------------------------------------------------------------------------
+    void setMat4(const std::string& name, const glm::mat4& mat) const
+    {
+        glUniformMatrix4fv(glGetUniformLocation(ID, name.c_str()), 1, GL_FALSE, glm::value_ptr(mat));
+    }
+    // once per frame (shader has to be in use): multiplies projection * view on the CPU and uploads it
+    // ------------------------------------------------------------------------
+    void setViewProjection(const glm::mat4& view, const glm::mat4& projection) const
+    {
+        setViewProjection(projection * view);
+    }
+    void setViewProjection(const glm::mat4& viewProjection) const
+    {
+        glUniformMatrix4fv(viewProjectionLocation, 1, GL_FALSE, glm::value_ptr(viewProjection));
+    }
+    // once per object: uploads the model matrix, plus the normal matrix if the shader wants one
+    // ------------------------------------------------------------------------
+    void setModel(const glm::mat4& model) const
+    {
+        glUniformMatrix4fv(modelLocation, 1, GL_FALSE, glm::value_ptr(model));
+        if (normalMatrixLocation != -1)
+        {
+            glm::mat3 normalMatrix = glm::transpose(glm::inverse(glm::mat3(model)));
+            glUniformMatrix3fv(normalMatrixLocation, 1, GL_FALSE, glm::value_ptr(normalMatrix));
+        }
+    }
 
 private:
+    int viewProjectionLocation = -1;
+    int modelLocation = -1;
+    int normalMatrixLocation = -1;
+    std::vector<std::string> files;
+
+    // error logs say "0(12)" for line 12 of source string 0, this says which file that is
+    static void printSourceFiles(const std::vector<std::string>& sourceFiles)
+    {
+        for (size_t i = 0; i < sourceFiles.size(); i++)
+            std::cout << "  source string " << i << ": " << sourceFiles[i] << std::endl;
+    }
+    void lookupLocations()
+    {
+        viewProjectionLocation = glGetUniformLocation(ID, "viewProjection");
+        modelLocation = glGetUniformLocation(ID, "model");
+        normalMatrixLocation = glGetUniformLocation(ID, "normalMatrix");
+    }
+
     // utility function for checking shader compilation/linking errors.
     // ------------------------------------------------------------------------
-    void checkCompileErrors(unsigned int shader, std::string type)
+    static bool checkCompileErrors(unsigned int shader, std::string type)
     {
         int success;
         char infoLog[1024];
@@ -116,6 +250,7 @@ private:
                 std::cout << "ERROR::PROGRAM_LINKING_ERROR of type: " << type << "\n" << infoLog << "\n -- --------------------------------------------------- -- " << std::endl;
             }
         }
+        return success != 0;
     }
 };
 #endif
@@ -0,0 +1,66 @@
+#ifndef SHADER_VARIANTS_H
+#define SHADER_VARIANTS_H
+
+#include "shader_s.h"
+#include "shader_watcher.h"
+
+#include <string>
+#include <vector>
+#include <map>
+#include <memory>
+#include <algorithm>
+
+// Permutation cache for one vertex + fragment shader pair.
+// get({ "NUM_LIGHTS 4", "USE_SPECULAR 0" }) hands back the program compiled with those #defines,
+// building it the first time that combination is asked for. Combinations nobody uses never get compiled,
+// and each one only contains the code its #if's kept, so there's no runtime branching on the settings.
+//
+// Shaders live as long as the cache does, so references from get() stay valid.
+class ShaderVariants
+{
+public:
+    // if a watcher is given every variant gets hot reloaded too. it has to outlive this cache
+    ShaderVariants(const char* vertexPath, const char* fragmentPath, ShaderWatcher* watcher = nullptr)
+        : vertexPath(vertexPath), fragmentPath(fragmentPath), watcher(watcher)
+    {
+    }
+    ~ShaderVariants()
+    {
+        if (watcher)
+            for (auto& variant : variants)
+                watcher->unwatch(*variant.second);
+    }
+    ShaderVariants(const ShaderVariants&) = delete;
+    ShaderVariants& operator=(const ShaderVariants&) = delete;
+
+    // the program for this set of defines. order doesn't matter, { "A", "B" } and { "B", "A" } are the same variant
+    // ------------------------------------------------------------------------
+    Shader& get(std::vector<std::string> defines)
+    {
+        std::sort(defines.begin(), defines.end());
+        std::string key;
+        for (const std::string& define : defines)
+            key += define + "\n";
+
+        auto it = variants.find(key);
+        if (it != variants.end())
+            return *it->second;
+
+        std::unique_ptr<Shader> shader(new Shader(vertexPath.c_str(), fragmentPath.c_str(), defines));
+        if (watcher)
+            watcher->watch(*shader);
+        Shader& result = *shader;
+        variants[key] = std::move(shader);
+        return result;
+    }
+    // how many variants have been compiled so far
+    // ------------------------------------------------------------------------
+    size_t size() const { return variants.size(); }
+
+private:
+    std::string vertexPath;
+    std::string fragmentPath;
+    ShaderWatcher* watcher;
+    std::map<std::string, std::unique_ptr<Shader>> variants;
+};
+#endif
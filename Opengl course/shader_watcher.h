@@ -0,0 +1,319 @@
+#ifndef SHADER_WATCHER_H
+#define SHADER_WATCHER_H
+
+#include <glad/glad.h>
+
+#include "shader_s.h"
+
+#include <string>
+#include <vector>
+#include <map>
+#include <set>
+#include <mutex>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <iostream>
+
+#if defined(__linux__)
+#include <sys/inotify.h>
+#include <poll.h>
+#include <unistd.h>
+#include <climits>
+#endif
+
+// Shader hot reload.
+// watch() the Shader objects you want to edit live and call poll() once per frame on the render thread.
+// A background thread notices when one of their source files (or anything those #include) gets saved (inotify on Linux, checking
+// the file times every quarter second everywhere else) and reads the new source. poll() hands it to GL,
+// and once linking is done the new program replaces the old one. If it doesn't compile or link the
+// error gets printed and the old program stays, so a typo never leaves you with a black screen.
+//
+// GL objects can only be touched on a thread with the context current, so the compiling itself happens
+// in poll(). With KHR_parallel_shader_compile the driver compiles in its own threads and poll() just
+// checks back every frame until it's done, without that it's one short stall on the frame after saving.
+class ShaderWatcher
+{
+public:
+    ShaderWatcher()
+    {
+        worker = std::thread(&ShaderWatcher::run, this);
+    }
+    ~ShaderWatcher()
+    {
+        release();
+    }
+    ShaderWatcher(const ShaderWatcher&) = delete;
+    ShaderWatcher& operator=(const ShaderWatcher&) = delete;
+
+    // start watching a shader's source files. the shader has to outlive the watcher or be unwatch()ed first
+    // ------------------------------------------------------------------------
+    void watch(Shader& shader)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (const std::string& file : shader.sourceFiles())
+        {
+            std::string key = normalize(file);
+            if (watchers[key].insert(&shader).second && files.count(key) == 0)
+                files[key] = modifiedTime(key);
+        }
+        filesChanged = true;
+    }
+    // stop watching a shader, e.g. right before it gets destroyed. render thread only
+    // ------------------------------------------------------------------------
+    void unwatch(Shader& shader)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (auto& file : watchers)
+            file.second.erase(&shader);
+        for (size_t i = 0; i < reloaded.size(); i++)
+        {
+            if (reloaded[i].shader == &shader)
+            {
+                reloaded.erase(reloaded.begin() + i);
+                break;
+            }
+        }
+        for (size_t i = 0; i < compiling.size(); i++)
+        {
+            if (compiling[i].shader == &shader)
+            {
+                glDeleteProgram(compiling[i].program);
+                compiling.erase(compiling.begin() + i);
+                break;
+            }
+        }
+    }
+    // call once per frame with the context current. returns how many programs got swapped in this call
+    // ------------------------------------------------------------------------
+    int poll()
+    {
+        // pick up whatever the watcher thread read since last frame
+        std::vector<Reloaded> ready;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            ready.swap(reloaded);
+        }
+        for (const Reloaded& r : ready)
+        {
+            // a newer edit of the same shader replaces one that's still compiling
+            for (size_t i = 0; i < compiling.size(); i++)
+            {
+                if (compiling[i].shader == r.shader)
+                {
+                    glDeleteProgram(compiling[i].program);
+                    compiling.erase(compiling.begin() + i);
+                    break;
+                }
+            }
+            compiling.push_back({ r.shader, Shader::beginProgram(r.vertexCode, r.fragmentCode), r.files });
+        }
+
+        int swapped = 0;
+        for (size_t i = 0; i < compiling.size();)
+        {
+            const Pending& p = compiling[i];
+            if (!linkDone(p.program))
+            {
+                i++;
+                continue;
+            }
+            if (p.shader->swapIfLinked(p.program, p.files))
+            {
+                std::cout << "SHADER::RELOADED " << p.shader->vertexPath << " + " << p.shader->fragmentPath << std::endl;
+                // the edit might have added an #include
+                watch(*p.shader);
+                swapped++;
+            }
+            else
+                std::cout << "SHADER::RELOAD_FAILED keeping the old program for " << p.shader->vertexPath << " + " << p.shader->fragmentPath << std::endl;
+            compiling.erase(compiling.begin() + i);
+        }
+        return swapped;
+    }
+    // stops the watcher thread and deletes the programs still compiling, while the context is still around
+    // ------------------------------------------------------------------------
+    void release()
+    {
+        if (!worker.joinable())
+            return;
+        running = false;
+        worker.join();
+        for (const Pending& p : compiling)
+            glDeleteProgram(p.program);
+        compiling.clear();
+    }
+
+private:
+    struct Reloaded
+    {
+        Shader* shader;
+        std::string vertexCode;
+        std::string fragmentCode;
+        std::vector<std::string> files;
+    };
+    struct Pending
+    {
+        Shader* shader;
+        unsigned int program;
+        std::vector<std::string> files;
+    };
+
+    std::thread worker;
+    std::atomic<bool> running{ true };
+    // everything below the mutex is shared with the worker thread
+    std::mutex mutex;
+    std::map<std::string, std::set<Shader*>> watchers;                         // file -> shaders built from it
+    std::map<std::string, std::filesystem::file_time_type> files;              // file -> last time we saw it change
+    std::vector<Reloaded> reloaded;
+    bool filesChanged = false;
+    // only touched on the render thread
+    std::vector<Pending> compiling;
+
+    static std::string normalize(const std::string& path)
+    {
+        return ShaderPreprocessor::normalize(path);
+    }
+    static std::filesystem::file_time_type modifiedTime(const std::string& path)
+    {
+        std::error_code error;
+        return std::filesystem::last_write_time(path, error);
+    }
+    // KHR_parallel_shader_compile lets us ask "is the link done yet?" without blocking.
+    // only there if glad was generated with that extension, otherwise we just wait for the link
+    static bool linkDone(unsigned int program)
+    {
+#ifdef GL_KHR_parallel_shader_compile
+        if (GLAD_GL_KHR_parallel_shader_compile)
+        {
+            int done = GL_TRUE;
+            glGetProgramiv(program, GL_COMPLETION_STATUS_KHR, &done);
+            return done == GL_TRUE;
+        }
+#endif
+        return true;
+    }
+
+    // re-read every shader built from one of the changed files (or something they #include) and queue it for poll().
+    // the lock is held the whole time so unwatch() can't pull a shader out from under us
+    // ------------------------------------------------------------------------
+    void fileChanged(const std::vector<std::string>& changed)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        std::set<Shader*> shaders;
+        for (const std::string& file : changed)
+        {
+            auto it = watchers.find(file);
+            if (it != watchers.end())
+                shaders.insert(it->second.begin(), it->second.end());
+        }
+        for (Shader* shader : shaders)
+        {
+            // paths and defines never change after construction so preprocessing here is fine
+            Reloaded r = {};
+            r.shader = shader;
+            if (!shader->loadSources(r.vertexCode, r.fragmentCode, r.files))
+                continue;
+            for (size_t i = 0; i < reloaded.size(); i++)
+            {
+                if (reloaded[i].shader == shader)
+                {
+                    reloaded.erase(reloaded.begin() + i);
+                    break;
+                }
+            }
+            reloaded.push_back(std::move(r));
+        }
+    }
+
+#if defined(__linux__)
+    // inotify watches directories rather than files: most editors save by writing a new file and renaming
+    // it over the old one, and a watch on the old file would be gone after the first save
+    // ------------------------------------------------------------------------
+    void run()
+    {
+        int fd = inotify_init1(IN_NONBLOCK);
+        if (fd < 0)
+        {
+            std::cout << "ERROR::SHADER_WATCHER::INOTIFY_INIT_FAILED, falling back to polling" << std::endl;
+            runPolling();
+            return;
+        }
+        std::map<int, std::string> directories; // watch descriptor -> directory
+        alignas(struct inotify_event) char buffer[4096];
+        while (running)
+        {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                if (filesChanged)
+                {
+                    for (const auto& file : files)
+                    {
+                        std::string directory = std::filesystem::path(file.first).parent_path().generic_string();
+                        if (directory.empty())
+                            directory = ".";
+                        int wd = inotify_add_watch(fd, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO);
+                        if (wd >= 0)
+                            directories[wd] = directory == "." ? "" : directory;
+                    }
+                    filesChanged = false;
+                }
+            }
+
+            // wake up every 250ms to notice new watches and shutdown
+            pollfd waitFor = { fd, POLLIN, 0 };
+            if (::poll(&waitFor, 1, 250) <= 0)
+                continue;
+
+            std::vector<std::string> changed;
+            ssize_t length;
+            while ((length = read(fd, buffer, sizeof(buffer))) > 0)
+            {
+                for (char* p = buffer; p < buffer + length;)
+                {
+                    const struct inotify_event* event = (const struct inotify_event*)p;
+                    auto directory = directories.find(event->wd);
+                    if (event->len > 0 && directory != directories.end())
+                        changed.push_back(normalize(directory->second.empty() ? std::string(event->name) : directory->second + "/" + event->name));
+                    p += sizeof(struct inotify_event) + event->len;
+                }
+            }
+            if (!changed.empty())
+                fileChanged(changed);
+        }
+        close(fd);
+    }
+#else
+    void run()
+    {
+        runPolling();
+    }
+#endif
+
+    // portable fallback: compare file times every 250ms
+    // ------------------------------------------------------------------------
+    void runPolling()
+    {
+        while (running)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(250));
+            std::vector<std::string> changed;
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                for (auto& file : files)
+                {
+                    std::filesystem::file_time_type time = modifiedTime(file.first);
+                    if (time != file.second)
+                    {
+                        file.second = time;
+                        changed.push_back(file.first);
+                    }
+                }
+            }
+            if (!changed.empty())
+                fileChanged(changed);
+        }
+    }
+};
+#endif
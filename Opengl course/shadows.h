@@ -0,0 +1,358 @@
+#ifndef SHADOWS_H
+#define SHADOWS_H
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include "shader_s.h"
+
+#include <functional>
+#include <vector>
+#include <cmath>
+#include <algorithm>
+
+// draws a set of shadow casters with the given depth shader (which is already in use and has its light matrix set).
+// the callback only has to set "model" (shader.setModel) and draw
+typedef std::function<void(const Shader& depthShader)> ShadowCasterDraw;
+
+// Both shadow maps keep the static casters in their own texture and only re-render that when it's actually
+// out of date (light moved / cascade moved / invalidateStatic() was called). Every other frame the static
+// depth just gets blitted over and only the dynamic casters are drawn on top.
+
+// copy a depth layer/face from one texture to another with two scratch FBOs (glBlitFramebuffer, no shaders)
+// ------------------------------------------------------------------------
+inline void blitDepthLayer(unsigned int readFBO, unsigned int drawFBO, int size)
+{
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, readFBO);
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, drawFBO);
+    glBlitFramebuffer(0, 0, size, size, 0, 0, size, size, GL_DEPTH_BUFFER_BIT, GL_NEAREST);
+}
+
+// omnidirectional shadows for a point light: a depth cube map storing distance to the light / farPlane
+class PointShadowMap
+{
+public:
+    unsigned int depthCubemap = 0;
+    int size;
+    float farPlane;
+
+    PointShadowMap(int size = 1024, float farPlane = 25.0f) : size(size), farPlane(farPlane)
+    {
+        depthCubemap = makeCubemap();
+        staticCubemap = makeCubemap();
+        glGenFramebuffers(1, &FBO);
+        glGenFramebuffers(1, &copyFBO);
+    }
+    ~PointShadowMap()
+    {
+        release();
+    }
+    // deletes the maps and framebuffers, while the context is still around
+    // ------------------------------------------------------------------------
+    void release()
+    {
+        // already released, the destructor can run after glfwTerminate
+        if (FBO == 0)
+            return;
+        glDeleteTextures(1, &depthCubemap);
+        glDeleteTextures(1, &staticCubemap);
+        glDeleteFramebuffers(1, &FBO);
+        glDeleteFramebuffers(1, &copyFBO);
+        depthCubemap = staticCubemap = FBO = copyFBO = 0;
+    }
+    // force the static casters to be redrawn next update (call it when something "static" moves)
+    // ------------------------------------------------------------------------
+    void invalidateStatic() { staticValid = false; }
+    // render the shadow cube map. depthShader is the point shadow program (writes distance / farPlane)
+    // returns true if the static casters had to be redrawn this time
+    // ------------------------------------------------------------------------
+    bool update(const glm::vec3& lightPos, const Shader& depthShader, const ShadowCasterDraw& drawStatic, const ShadowCasterDraw& drawDynamic, bool useCache = true)
+    {
+        bool redrawStatic = !useCache || !staticValid || lightPos != cachedLightPos;
+        glm::mat4 faces[6];
+        faceMatrices(lightPos, faces);
+
+        GLint previousViewport[4];
+        glGetIntegerv(GL_VIEWPORT, previousViewport);
+        glViewport(0, 0, size, size);
+        depthShader.use();
+        depthShader.setVec3("lightPos", lightPos);
+        depthShader.setFloat("farPlane", farPlane);
+
+        for (int face = 0; face < 6; face++)
+        {
+            if (redrawStatic)
+            {
+                // static casters into the cache first
+                renderFace(staticCubemap, face, faces[face], depthShader, drawStatic);
+            }
+            // then the cache into the real map, and the dynamic casters on top
+            attachFace(copyFBO, staticCubemap, face);
+            attachFace(FBO, depthCubemap, face);
+            blitDepthLayer(copyFBO, FBO, size);
+            glBindFramebuffer(GL_FRAMEBUFFER, FBO);
+            depthShader.setMat4("lightSpace", faces[face]);
+            drawDynamic(depthShader);
+        }
+
+        staticValid = true;
+        cachedLightPos = lightPos;
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        glViewport(previousViewport[0], previousViewport[1], previousViewport[2], previousViewport[3]);
+        return redrawStatic;
+    }
+
+private:
+    unsigned int staticCubemap = 0;
+    unsigned int FBO = 0, copyFBO = 0;
+    bool staticValid = false;
+    glm::vec3 cachedLightPos = glm::vec3(0.0f);
+
+    unsigned int makeCubemap() const
+    {
+        unsigned int texture;
+        glGenTextures(1, &texture);
+        glBindTexture(GL_TEXTURE_CUBE_MAP, texture);
+        for (int face = 0; face < 6; face++)
+            glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + face, 0, GL_DEPTH_COMPONENT24, size, size, 0, GL_DEPTH_COMPONENT, GL_FLOAT, NULL);
+        glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
+        return texture;
+    }
+    void attachFace(unsigned int fbo, unsigned int cubemap, int face) const
+    {
+        glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_CUBE_MAP_POSITIVE_X + face, cubemap, 0);
+        // depth only
+        glDrawBuffer(GL_NONE);
+        glReadBuffer(GL_NONE);
+    }
+    void renderFace(unsigned int cubemap, int face, const glm::mat4& lightSpace, const Shader& depthShader, const ShadowCasterDraw& draw) const
+    {
+        attachFace(FBO, cubemap, face);
+        glClear(GL_DEPTH_BUFFER_BIT);
+        depthShader.setMat4("lightSpace", lightSpace);
+        draw(depthShader);
+    }
+    // one 90 degree perspective per cube face, looking down +x, -x, +y, -y, +z, -z (the order GL numbers the faces in)
+    void faceMatrices(const glm::vec3& lightPos, glm::mat4* out) const
+    {
+        glm::mat4 projection = glm::perspective(glm::radians(90.0f), 1.0f, 0.05f, farPlane);
+        out[0] = projection * glm::lookAt(lightPos, lightPos + glm::vec3(1.0f, 0.0f, 0.0f), glm::vec3(0.0f, -1.0f, 0.0f));
+        out[1] = projection * glm::lookAt(lightPos, lightPos + glm::vec3(-1.0f, 0.0f, 0.0f), glm::vec3(0.0f, -1.0f, 0.0f));
+        out[2] = projection * glm::lookAt(lightPos, lightPos + glm::vec3(0.0f, 1.0f, 0.0f), glm::vec3(0.0f, 0.0f, 1.0f));
+        out[3] = projection * glm::lookAt(lightPos, lightPos + glm::vec3(0.0f, -1.0f, 0.0f), glm::vec3(0.0f, 0.0f, -1.0f));
+        out[4] = projection * glm::lookAt(lightPos, lightPos + glm::vec3(0.0f, 0.0f, 1.0f), glm::vec3(0.0f, -1.0f, 0.0f));
+        out[5] = projection * glm::lookAt(lightPos, lightPos + glm::vec3(0.0f, 0.0f, -1.0f), glm::vec3(0.0f, -1.0f, 0.0f));
+    }
+};
+
+// cascaded shadow maps for a directional light (the sun).
+// the camera frustum is split into CASCADES slices along the view direction, each slice gets its own
+// orthographic shadow map (one layer of a depth texture array), so close things get lots of texels
+// and far away things don't waste them.
+class CascadedShadowMap
+{
+public:
+    static const int CASCADES = 4;
+    static const int SNAP_TEXELS = 32;  // the cascades move in steps of this many texels
+    unsigned int depthArray = 0;
+    int size;
+    glm::mat4 lightSpace[CASCADES];   // world -> shadow clip space per cascade, upload these for the lighting shader
+    float splitDepths[CASCADES];      // view space depth where each cascade ends
+
+    // lambda blends between uniform (0) and logarithmic (1) split spacing
+    CascadedShadowMap(int size = 2048, float lambda = 0.75f) : size(size), lambda(lambda)
+    {
+        depthArray = makeArray(true);
+        staticArray = makeArray(false);
+        glGenFramebuffers(1, &FBO);
+        glGenFramebuffers(1, &copyFBO);
+        for (int i = 0; i < CASCADES; i++)
+        {
+            lightSpace[i] = glm::mat4(1.0f);
+            cachedLightSpace[i] = glm::mat4(0.0f);
+            splitDepths[i] = 0.0f;
+        }
+    }
+    ~CascadedShadowMap()
+    {
+        release();
+    }
+    // deletes the maps and framebuffers, while the context is still around
+    // ------------------------------------------------------------------------
+    void release()
+    {
+        // already released, the destructor can run after glfwTerminate
+        if (FBO == 0)
+            return;
+        glDeleteTextures(1, &depthArray);
+        glDeleteTextures(1, &staticArray);
+        glDeleteFramebuffers(1, &FBO);
+        glDeleteFramebuffers(1, &copyFBO);
+        depthArray = staticArray = FBO = copyFBO = 0;
+    }
+    // force the static casters to be redrawn into every cascade next update
+    // ------------------------------------------------------------------------
+    void invalidateStatic()
+    {
+        for (int i = 0; i < CASCADES; i++)
+            cachedLightSpace[i] = glm::mat4(0.0f);
+    }
+    // fit the cascades to the camera and render them.
+    // sceneMin/sceneMax bound every shadow caster, they give the near/far of every cascade.
+    // returns how many cascades needed their static casters redrawn
+    // ------------------------------------------------------------------------
+    int update(const glm::mat4& view, float fovy, float aspect, float zNear, float zFar, const glm::vec3& lightDir,
+               const glm::vec3& sceneMin, const glm::vec3& sceneMax,
+               const Shader& depthShader, const ShadowCasterDraw& drawStatic, const ShadowCasterDraw& drawDynamic, bool useCache = true)
+    {
+        fitCascades(view, fovy, aspect, zNear, zFar, lightDir, sceneMin, sceneMax);
+
+        GLint previousViewport[4];
+        glGetIntegerv(GL_VIEWPORT, previousViewport);
+        glViewport(0, 0, size, size);
+        depthShader.use();
+
+        int redrawn = 0;
+        for (int i = 0; i < CASCADES; i++)
+        {
+            // the matrix only changes when the snapped center moves a step (see fitCascades), so a still or
+            // slowly moving camera keeps reusing the static depth
+            if (!useCache || lightSpace[i] != cachedLightSpace[i])
+            {
+                attachLayer(FBO, staticArray, i);
+                glClear(GL_DEPTH_BUFFER_BIT);
+                depthShader.setMat4("lightSpace", lightSpace[i]);
+                drawStatic(depthShader);
+                cachedLightSpace[i] = lightSpace[i];
+                redrawn++;
+            }
+            attachLayer(copyFBO, staticArray, i);
+            attachLayer(FBO, depthArray, i);
+            blitDepthLayer(copyFBO, FBO, size);
+            glBindFramebuffer(GL_FRAMEBUFFER, FBO);
+            depthShader.setMat4("lightSpace", lightSpace[i]);
+            drawDynamic(depthShader);
+        }
+
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        glViewport(previousViewport[0], previousViewport[1], previousViewport[2], previousViewport[3]);
+        return redrawn;
+    }
+    // upload cascade matrices + split depths. the lighting shader has to be in use
+    // ------------------------------------------------------------------------
+    void setUniforms(const Shader& shader) const
+    {
+        glUniformMatrix4fv(glGetUniformLocation(shader.ID, "cascadeLightSpace"), CASCADES, GL_FALSE, &lightSpace[0][0][0]);
+        glUniform1fv(glGetUniformLocation(shader.ID, "cascadeSplits"), CASCADES, splitDepths);
+    }
+
+private:
+    float lambda;
+    unsigned int staticArray = 0;
+    unsigned int FBO = 0, copyFBO = 0;
+    glm::mat4 cachedLightSpace[CASCADES];
+
+    unsigned int makeArray(bool compare) const
+    {
+        unsigned int texture;
+        glGenTextures(1, &texture);
+        glBindTexture(GL_TEXTURE_2D_ARRAY, texture);
+        glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, GL_DEPTH_COMPONENT24, size, size, CASCADES, 0, GL_DEPTH_COMPONENT, GL_FLOAT, NULL);
+        // hardware PCF: linear filtering + compare mode gives a 2x2 filtered shadow test per lookup
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, compare ? GL_LINEAR : GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, compare ? GL_LINEAR : GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_BORDER);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_BORDER);
+        float border[] = { 1.0f, 1.0f, 1.0f, 1.0f }; // outside the map = lit
+        glTexParameterfv(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_BORDER_COLOR, border);
+        if (compare)
+        {
+            glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_COMPARE_MODE, GL_COMPARE_REF_TO_TEXTURE);
+            glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_COMPARE_FUNC, GL_LEQUAL);
+        }
+        return texture;
+    }
+    void attachLayer(unsigned int fbo, unsigned int array, int layer) const
+    {
+        glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+        glFramebufferTextureLayer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, array, 0, layer);
+        glDrawBuffer(GL_NONE);
+        glReadBuffer(GL_NONE);
+    }
+    void fitCascades(const glm::mat4& view, float fovy, float aspect, float zNear, float zFar, const glm::vec3& lightDir,
+                     const glm::vec3& sceneMin, const glm::vec3& sceneMax)
+    {
+        glm::mat4 inverseView = glm::inverse(view);
+        float tanY = std::tan(fovy * 0.5f);
+        float tanX = tanY * aspect;
+
+        // stable light orientation: only depends on the light direction, never on the camera
+        glm::vec3 dir = glm::normalize(lightDir);
+        glm::vec3 up = std::fabs(dir.y) > 0.99f ? glm::vec3(0.0f, 0.0f, 1.0f) : glm::vec3(0.0f, 1.0f, 0.0f);
+        glm::mat4 lightView = glm::lookAt(glm::vec3(0.0f), dir, up);
+
+        // scene bounds in light space give the tightest depth range that still catches every caster
+        float sceneNear = 1e30f, sceneFar = -1e30f;
+        for (int corner = 0; corner < 8; corner++)
+        {
+            glm::vec3 p((corner & 1) ? sceneMax.x : sceneMin.x, (corner & 2) ? sceneMax.y : sceneMin.y, (corner & 4) ? sceneMax.z : sceneMin.z);
+            float z = (lightView * glm::vec4(p, 1.0f)).z;
+            sceneNear = std::min(sceneNear, -z);
+            sceneFar = std::max(sceneFar, -z);
+        }
+        sceneFar = std::max(sceneFar, sceneNear + 0.01f);
+
+        float sliceStart = zNear;
+        for (int i = 0; i < CASCADES; i++)
+        {
+            // practical split scheme: blend of logarithmic and uniform
+            float t = (float)(i + 1) / CASCADES;
+            float logSplit = zNear * std::pow(zFar / zNear, t);
+            float uniformSplit = zNear + (zFar - zNear) * t;
+            float sliceEnd = lambda * logSplit + (1.0f - lambda) * uniformSplit;
+            splitDepths[i] = sliceEnd;
+
+            // the 8 corners of this slice of the camera frustum, in world space
+            glm::vec3 corners[8];
+            glm::vec3 center(0.0f);
+            for (int c = 0; c < 8; c++)
+            {
+                float depth = (c & 4) ? sliceEnd : sliceStart;
+                glm::vec3 viewCorner(((c & 1) ? 1.0f : -1.0f) * tanX * depth, ((c & 2) ? 1.0f : -1.0f) * tanY * depth, -depth);
+                corners[c] = glm::vec3(inverseView * glm::vec4(viewCorner, 1.0f));
+                center += corners[c] / 8.0f;
+            }
+            // fit a sphere around the slice instead of a box, its size doesn't change when the camera turns,
+            // so the texel size stays the same every frame (no shimmering edges)
+            float radius = 0.0f;
+            for (int c = 0; c < 8; c++)
+                radius = std::max(radius, glm::length(corners[c] - center));
+            radius = std::ceil(radius * 16.0f) / 16.0f;
+
+            // snap the center in light space to steps of SNAP_TEXELS whole texels, so the map slides by exact texels
+            // and only every so often (the static depth is reused until it does). the map is a step wider on every
+            // side than the sphere so the slice is still covered wherever the center snapped to
+            float texelSize = 2.0f * radius / (size - 2 * SNAP_TEXELS);
+            float step = SNAP_TEXELS * texelSize;
+            glm::vec3 lightCenter = glm::vec3(lightView * glm::vec4(center, 1.0f));
+            lightCenter.x = std::floor(lightCenter.x / step) * step;
+            lightCenter.y = std::floor(lightCenter.y / step) * step;
+            radius += step;
+
+            // depth range: the whole scene. fitting it to the slice would be tighter, but then it changes whenever
+            // the camera moves towards or away from the light, and so would the matrix and the static cache
+            glm::mat4 projection = glm::ortho(lightCenter.x - radius, lightCenter.x + radius,
+                                              lightCenter.y - radius, lightCenter.y + radius,
+                                              sceneNear, sceneFar);
+            lightSpace[i] = projection * lightView;
+            sliceStart = sliceEnd;
+        }
+    }
+};
+#endif
@@ -0,0 +1,592 @@
+#ifndef SOFTWARE_RASTERIZER_H
+#define SOFTWARE_RASTERIZER_H
+
+#include <glm/glm.hpp>
+
+#include "stb_image.h"
+
+#include <vector>
+#include <memory>
+#include <thread>
+#include <atomic>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <type_traits>
+
+// coverage is tested 4 pixels at a time. SSE2 is always there on x64, ARM64 always has NEON,
+// anything else goes through plain ints
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define SOFTWARE_RASTERIZER_SIMD "SSE2"
+#define SOFTWARE_RASTERIZER_SSE2
+#elif defined(__ARM_NEON) || defined(_M_ARM64)
+#include <arm_neon.h>
+#define SOFTWARE_RASTERIZER_SIMD "NEON"
+#define SOFTWARE_RASTERIZER_NEON
+#else
+#define SOFTWARE_RASTERIZER_SIMD "scalar"
+#endif
+
+// A texture for the software rasterizer: RGBA8, GL_REPEAT wrapping and GL_LINEAR filtering, which is what
+// every textured chapter sets up. No mipmaps, the chapters use GL_LINEAR as the min filter too so GL never
+// reads theirs either.
+class SoftwareTexture
+{
+public:
+    int width = 0, height = 0;
+    std::vector<unsigned char> texels; // RGBA, row 0 is v = 0
+
+    // flip works like stbi_set_flip_vertically_on_load(true), which most chapters call before loading
+    // ------------------------------------------------------------------------
+    bool load(const char* path, bool flip)
+    {
+        stbi_set_flip_vertically_on_load(flip);
+        int channels;
+        unsigned char* data = stbi_load(path, &width, &height, &channels, 4);
+        stbi_set_flip_vertically_on_load(false);
+        if (!data)
+        {
+            std::cout << "ERROR::SOFTWARE_TEXTURE::LOAD_FAILED " << path << std::endl;
+            width = height = 0;
+            return false;
+        }
+        texels.assign(data, data + (size_t)width * height * 4);
+        stbi_image_free(data);
+        return true;
+    }
+    // texture(sampler, uv) in GLSL
+    // ------------------------------------------------------------------------
+    glm::vec4 sample(const glm::vec2& uv) const
+    {
+        if (width == 0)
+            return glm::vec4(0.0f, 0.0f, 0.0f, 1.0f);
+        // texel centers are at half coordinates, like GL_LINEAR
+        float x = uv.x * width - 0.5f, y = uv.y * height - 0.5f;
+        float fx = std::floor(x), fy = std::floor(y);
+        int x0 = wrap((int)fx, width), y0 = wrap((int)fy, height);
+        int x1 = wrap(x0 + 1, width), y1 = wrap(y0 + 1, height);
+        float tx = x - fx, ty = y - fy;
+        glm::vec4 top = glm::mix(texel(x0, y0), texel(x1, y0), tx);
+        glm::vec4 bottom = glm::mix(texel(x0, y1), texel(x1, y1), tx);
+        return glm::mix(top, bottom, ty);
+    }
+
+private:
+    static int wrap(int i, int size)
+    {
+        i %= size;
+        return i < 0 ? i + size : i;
+    }
+    glm::vec4 texel(int x, int y) const
+    {
+        const unsigned char* t = &texels[((size_t)y * width + x) * 4];
+        return glm::vec4(t[0], t[1], t[2], t[3]) * (1.0f / 255.0f);
+    }
+};
+
+// A small GL-like triangle pipeline on the CPU, for machines without a GPU (build boxes, CI) where we still
+// want to render the chapter scenes and time them. Shaders are plain C++ callables:
+//
+//   struct Varyings { glm::vec2 uv; };                         // what the vertex shader passes on, floats only
+//   raster.draw<Varyings>(36,
+//       [&](uint32_t vertex, Varyings& out) { out.uv = ...; return viewProjection * model * position; },
+//       [&](const Varyings& in) { return texture.sample(in.uv); });
+//
+// Same rules as GL where they matter for matching it: clip space in, near/far clipping, perspective correct
+// varyings, pixel centers at .5, the top-left fill rule (shared edges are drawn exactly once), depth test
+// GL_LESS, window y going up. Depth testing is always early since the shaders can't discard.
+//
+// How it goes wide:
+//   draw()    runs the vertex shader and sets up the triangles (clipping, snapping to 1/16 pixel, edge
+//             equations), then bins each triangle into the 64x64 pixel tiles its bounding box touches
+//   finish()  hands out tiles to the threads. A tile is only ever touched by one thread and gets its
+//             triangles in submission order, so the image is exactly the same for any thread count
+// Coverage is tested 4 pixels at a time with integer edge functions (SOFTWARE_RASTERIZER_SIMD), an edge that
+// can't cut through a tile is dropped for that tile, and tiles outside a triangle are skipped entirely.
+class SoftwareRasterizer
+{
+public:
+    static const int TILE_SIZE = 64;
+    bool depthTest = true;  // glEnable(GL_DEPTH_TEST), picked up by each draw()
+
+    // threads = 0 uses every core
+    SoftwareRasterizer(int width, int height, unsigned int threads = 0)
+        : threadCount(threads ? threads : std::max(1u, std::thread::hardware_concurrency()))
+    {
+        resize(width, height);
+    }
+    // ------------------------------------------------------------------------
+    void resize(int newWidth, int newHeight)
+    {
+        finish();
+        width = std::max(newWidth, 1);
+        height = std::max(newHeight, 1);
+        color.assign((size_t)width * height, 0);
+        depth.assign((size_t)width * height, 1.0f);
+        tilesX = (width + TILE_SIZE - 1) / TILE_SIZE;
+        tilesY = (height + TILE_SIZE - 1) / TILE_SIZE;
+        bins.assign((size_t)tilesX * tilesY, {});
+        // the guard band keeps snapped coordinates small enough for the integer edge math (see setup)
+        guardBand = (float)MAX_COORDINATE / (float)std::max(width, height);
+    }
+    // glClearColor + glClear. draws queued before it get finished first
+    // ------------------------------------------------------------------------
+    void clear(const glm::vec4& clearColor, bool clearDepth = true)
+    {
+        finish();
+        std::fill(color.begin(), color.end(), pack(clearColor));
+        if (clearDepth)
+            std::fill(depth.begin(), depth.end(), 1.0f);
+    }
+    // queues vertexCount vertices (or indexCount indices) worth of triangles, see the top of the file.
+    // vertexShader(uint32_t vertex, Varyings& out) -> glm::vec4 clip position
+    // fragmentShader(const Varyings& in) -> glm::vec4 color
+    // ------------------------------------------------------------------------
+    template <class Varyings, class VertexShader, class FragmentShader>
+    void draw(uint32_t vertexCount, const VertexShader& vertexShader, const FragmentShader& fragmentShader,
+        const uint32_t* indices = nullptr, uint32_t indexCount = 0)
+    {
+        static_assert(std::is_trivially_copyable<Varyings>::value && sizeof(Varyings) % sizeof(float) == 0,
+            "varyings get interpolated as a bunch of floats");
+        auto batch = std::unique_ptr<Batch<Varyings, FragmentShader>>(new Batch<Varyings, FragmentShader>(fragmentShader, depthTest));
+
+        // 1. vertex shader, spread over the threads when there's enough of it
+        std::vector<ClipVertex<Varyings>> vertices(vertexCount);
+        const uint32_t VERTICES_PER_JOB = 4096;
+        uint32_t jobs = (vertexCount + VERTICES_PER_JOB - 1) / VERTICES_PER_JOB;
+        parallelFor(jobs, std::min(threadCount, jobs), [&](size_t job)
+        {
+            uint32_t end = std::min(vertexCount, (uint32_t)(job + 1) * VERTICES_PER_JOB);
+            for (uint32_t v = (uint32_t)job * VERTICES_PER_JOB; v < end; v++)
+                vertices[v].position = vertexShader(v, vertices[v].varyings);
+        });
+
+        // 2. clip, project, snap, set up. in order, the triangle order is what makes the output deterministic
+        uint32_t cornerCount = indices ? indexCount : vertexCount;
+        for (uint32_t i = 0; i + 2 < cornerCount; i += 3)
+        {
+            uint32_t a = indices ? indices[i] : i, b = indices ? indices[i + 1] : i + 1, c = indices ? indices[i + 2] : i + 2;
+            if (a >= vertexCount || b >= vertexCount || c >= vertexCount)
+                continue;
+            batch->addTriangle(*this, vertices[a], vertices[b], vertices[c]);
+        }
+
+        // 3. bin
+        uint32_t drawIndex = (uint32_t)batches.size();
+        for (uint32_t t = 0; t < (uint32_t)batch->triangles.size(); t++)
+        {
+            const Setup& setup = batch->triangles[t].setup;
+            for (int ty = setup.minY / TILE_SIZE; ty <= setup.maxY / TILE_SIZE; ty++)
+                for (int tx = setup.minX / TILE_SIZE; tx <= setup.maxX / TILE_SIZE; tx++)
+                    bins[(size_t)ty * tilesX + tx].push_back({ drawIndex, t });
+        }
+        trianglesSubmitted += cornerCount / 3;
+        trianglesSetUp += batch->triangles.size();
+        batches.push_back(std::move(batch));
+    }
+    // rasterizes and shades everything queued. the buffers are only up to date after this
+    // ------------------------------------------------------------------------
+    void finish()
+    {
+        if (batches.empty())
+            return;
+        size_t tileCount = bins.size();
+        parallelFor(tileCount, (unsigned int)std::min<size_t>(threadCount, tileCount), [&](size_t tile)
+        {
+            int tileX = (int)(tile % tilesX) * TILE_SIZE, tileY = (int)(tile / tilesX) * TILE_SIZE;
+            Tile target = { tileX, tileY, std::min(tileX + TILE_SIZE, width), std::min(tileY + TILE_SIZE, height), this };
+            for (const BinEntry& entry : bins[tile])
+                batches[entry.draw]->rasterize(entry.triangle, target);
+            bins[tile].clear();
+        });
+        batches.clear();
+    }
+
+    // ------------------------------------------------------------------------
+    int getWidth() const { return width; }
+    int getHeight() const { return height; }
+    unsigned int threads() const { return threadCount; }
+    // RGBA8 pixels, row 0 at the bottom like GL's window coordinates
+    const uint32_t* pixels() const { return color.data(); }
+    // copies the image out top row first (the way image files store it), 4 bytes a pixel
+    // ------------------------------------------------------------------------
+    void readPixels(std::vector<unsigned char>& rgba) const
+    {
+        rgba.resize((size_t)width * height * 4);
+        for (int y = 0; y < height; y++)
+            std::memcpy(&rgba[(size_t)y * width * 4], &color[(size_t)(height - 1 - y) * width], (size_t)width * 4);
+    }
+    // triangles handed to draw() / the ones left after clipping and dropping degenerate ones, since the last reset
+    // ------------------------------------------------------------------------
+    size_t submittedTriangles() const { return trianglesSubmitted; }
+    size_t setUpTriangles() const { return trianglesSetUp; }
+    void resetStats() { trianglesSubmitted = trianglesSetUp = 0; }
+
+private:
+    // snapped coordinates are in 1/16 pixel, and must stay under 2^17 (8192 pixels) either way so that an edge
+    // function across one tile fits in 32 bits: |A|, |B| < 2^18, times 64 pixels * 16 * 2 edges < 2^29
+    static const int SUBPIXEL_BITS = 4;
+    static const int SUBPIXEL = 1 << SUBPIXEL_BITS;
+    static const int MAX_COORDINATE = 8000;
+
+    template <class Varyings>
+    struct ClipVertex
+    {
+        glm::vec4 position;
+        Varyings varyings;
+    };
+    // everything about a triangle that doesn't depend on the varyings
+    struct Setup
+    {
+        int minX, minY, maxX, maxY;     // pixel bounding box, inside the viewport
+        int64_t A[3], B[3], C[3];       // edge functions in 1/256 pixel^2 (1/16 pixel coordinates), >= 0 inside
+        float x0, y0;                   // vertex 0 in pixels, the interpolation below is relative to it
+        float l1x, l1y, l2x, l2y;       // barycentrics of vertex 1 and 2 as planes over the screen
+        float z[3];                     // window depth
+        float invW[3];
+    };
+    struct Tile
+    {
+        int x0, y0, x1, y1;
+        SoftwareRasterizer* raster;
+    };
+    struct BinEntry
+    {
+        uint32_t draw;
+        uint32_t triangle;
+    };
+    struct BatchBase
+    {
+        virtual ~BatchBase() {}
+        virtual void rasterize(uint32_t triangle, const Tile& tile) const = 0;
+    };
+    // one draw call: its triangles and the fragment shader to run on them
+    template <class Varyings, class FragmentShader>
+    struct Batch : BatchBase
+    {
+        struct Triangle
+        {
+            Setup setup;
+            Varyings varyings[3]; // already divided by w, for perspective correct interpolation
+        };
+        static const int FLOATS = sizeof(Varyings) / sizeof(float);
+        FragmentShader fragmentShader;
+        bool depthTest;
+        std::vector<Triangle> triangles;
+
+        Batch(const FragmentShader& fragmentShader, bool depthTest) : fragmentShader(fragmentShader), depthTest(depthTest) {}
+
+        // ------------------------------------------------------------------------
+        void addTriangle(const SoftwareRasterizer& raster, const ClipVertex<Varyings>& a, const ClipVertex<Varyings>& b, const ClipVertex<Varyings>& c)
+        {
+            // nearly every triangle is well inside the guard band and in front of the camera
+            float g = raster.guardBand;
+            auto inside = [g](const glm::vec4& p)
+            {
+                return p.z >= -p.w && p.z <= p.w && std::fabs(p.x) <= g * p.w && std::fabs(p.y) <= g * p.w;
+            };
+            if (inside(a.position) && inside(b.position) && inside(c.position))
+            {
+                setUp(raster, a, b, c);
+                return;
+            }
+            // Sutherland-Hodgman against near, far and the guard band, then fan the polygon back into triangles
+            ClipVertex<Varyings> buffers[2][9];
+            int count = 3;
+            buffers[0][0] = a;
+            buffers[0][1] = b;
+            buffers[0][2] = c;
+            int current = 0;
+            for (int plane = 0; plane < 6 && count >= 3; plane++)
+            {
+                const ClipVertex<Varyings>* in = buffers[current];
+                ClipVertex<Varyings>* out = buffers[current ^ 1];
+                int outCount = 0;
+                for (int i = 0; i < count; i++)
+                {
+                    const ClipVertex<Varyings>& p = in[i];
+                    const ClipVertex<Varyings>& q = in[(i + 1) % count];
+                    float dp = distance(plane, p.position, g), dq = distance(plane, q.position, g);
+                    if (dp >= 0.0f)
+                        out[outCount++] = p;
+                    if ((dp >= 0.0f) != (dq >= 0.0f))
+                        out[outCount++] = lerp(p, q, dp / (dp - dq));
+                }
+                count = outCount;
+                current ^= 1;
+            }
+            for (int i = 1; i + 1 < count; i++)
+                setUp(raster, buffers[current][0], buffers[current][i], buffers[current][i + 1]);
+        }
+        // >= 0 on the inside of clip plane i
+        static float distance(int plane, const glm::vec4& p, float g)
+        {
+            switch (plane)
+            {
+            case 0: return p.w + p.z;
+            case 1: return p.w - p.z;
+            case 2: return g * p.w + p.x;
+            case 3: return g * p.w - p.x;
+            case 4: return g * p.w + p.y;
+            default: return g * p.w - p.y;
+            }
+        }
+        static ClipVertex<Varyings> lerp(const ClipVertex<Varyings>& p, const ClipVertex<Varyings>& q, float t)
+        {
+            ClipVertex<Varyings> r;
+            r.position = p.position + (q.position - p.position) * t;
+            const float* pv = (const float*)&p.varyings;
+            const float* qv = (const float*)&q.varyings;
+            float* rv = (float*)&r.varyings;
+            for (int i = 0; i < FLOATS; i++)
+                rv[i] = pv[i] + (qv[i] - pv[i]) * t;
+            return r;
+        }
+        // ------------------------------------------------------------------------
+        void setUp(const SoftwareRasterizer& raster, const ClipVertex<Varyings>& a, const ClipVertex<Varyings>& b, const ClipVertex<Varyings>& c)
+        {
+            const ClipVertex<Varyings>* v[3] = { &a, &b, &c };
+            int64_t x[3], y[3];
+            float z[3], invW[3];
+            for (int i = 0; i < 3; i++)
+            {
+                const glm::vec4& p = v[i]->position;
+                if (p.w <= 0.0f)
+                    return;
+                invW[i] = 1.0f / p.w;
+                // viewport transform, then snap to the subpixel grid
+                x[i] = (int64_t)std::lround(((p.x * invW[i]) * 0.5f + 0.5f) * raster.width * SUBPIXEL);
+                y[i] = (int64_t)std::lround(((p.y * invW[i]) * 0.5f + 0.5f) * raster.height * SUBPIXEL);
+                z[i] = (p.z * invW[i]) * 0.5f + 0.5f;
+            }
+            // twice the signed area. no face culling in the chapters, so clockwise ones just get turned around
+            int64_t area = (x[1] - x[0]) * (y[2] - y[0]) - (y[1] - y[0]) * (x[2] - x[0]);
+            if (area == 0)
+                return;
+            int order[3] = { 0, 1, 2 };
+            if (area < 0)
+            {
+                std::swap(order[1], order[2]);
+                area = -area;
+            }
+
+            Triangle triangle;
+            Setup& s = triangle.setup;
+            int64_t sx[3], sy[3];
+            for (int i = 0; i < 3; i++)
+            {
+                sx[i] = x[order[i]];
+                sy[i] = y[order[i]];
+                s.z[i] = z[order[i]];
+                s.invW[i] = invW[order[i]];
+                const float* in = (const float*)&v[order[i]]->varyings;
+                float* out = (float*)&triangle.varyings[i];
+                for (int k = 0; k < FLOATS; k++)
+                    out[k] = in[k] * invW[order[i]];
+            }
+
+            // bounding box, in pixels whose centers could be inside
+            int64_t minX = std::min(sx[0], std::min(sx[1], sx[2])), maxX = std::max(sx[0], std::max(sx[1], sx[2]));
+            int64_t minY = std::min(sy[0], std::min(sy[1], sy[2])), maxY = std::max(sy[0], std::max(sy[1], sy[2]));
+            s.minX = (int)std::max<int64_t>(minX >> SUBPIXEL_BITS, 0);
+            s.minY = (int)std::max<int64_t>(minY >> SUBPIXEL_BITS, 0);
+            s.maxX = (int)std::min<int64_t>(maxX >> SUBPIXEL_BITS, raster.width - 1);
+            s.maxY = (int)std::min<int64_t>(maxY >> SUBPIXEL_BITS, raster.height - 1);
+            if (s.minX > s.maxX || s.minY > s.maxY)
+                return;
+
+            // edge k goes from vertex k+1 to k+2 (so it's 0 at those two and is vertex k's barycentric, unnormalized)
+            for (int k = 0; k < 3; k++)
+            {
+                int i = (k + 1) % 3, j = (k + 2) % 3;
+                s.A[k] = sy[i] - sy[j];
+                s.B[k] = sx[j] - sx[i];
+                s.C[k] = sx[i] * sy[j] - sy[i] * sx[j];
+                // top-left rule: pixel centers exactly on an edge only count for top and left edges.
+                // E >= 0 on those, E > 0 (E - 1 >= 0, everything is an integer) on the others
+                bool topLeft = s.A[k] > 0 || (s.A[k] == 0 && s.B[k] < 0);
+                if (!topLeft)
+                    s.C[k] -= 1;
+            }
+
+            // the same barycentrics as float planes for interpolating, relative to vertex 0
+            float fx[3], fy[3];
+            for (int i = 0; i < 3; i++)
+            {
+                fx[i] = (float)sx[i] / SUBPIXEL;
+                fy[i] = (float)sy[i] / SUBPIXEL;
+            }
+            float d1x = fx[1] - fx[0], d1y = fy[1] - fy[0], d2x = fx[2] - fx[0], d2y = fy[2] - fy[0];
+            float invDet = 1.0f / (d1x * d2y - d1y * d2x);
+            s.x0 = fx[0];
+            s.y0 = fy[0];
+            s.l1x = d2y * invDet;
+            s.l1y = -d2x * invDet;
+            s.l2x = -d1y * invDet;
+            s.l2y = d1x * invDet;
+            triangles.push_back(triangle);
+        }
+
+        // ------------------------------------------------------------------------
+        void rasterize(uint32_t index, const Tile& tile) const override
+        {
+            const Triangle& triangle = triangles[index];
+            const Setup& s = triangle.setup;
+            int x0 = std::max(tile.x0, s.minX), x1 = std::min(tile.x1 - 1, s.maxX);
+            int y0 = std::max(tile.y0, s.minY), y1 = std::min(tile.y1 - 1, s.maxY);
+            if (x0 > x1 || y0 > y1)
+                return;
+
+            // per edge: outside the whole rect -> nothing to draw, inside the whole rect -> no need to test it,
+            // otherwise it cuts through and its values over the rect fit in 32 bits
+            int32_t rowStart[3], stepX[3], stepY[3];
+            for (int k = 0; k < 3; k++)
+            {
+                int64_t cx0 = ((int64_t)x0 << SUBPIXEL_BITS) + SUBPIXEL / 2, cx1 = ((int64_t)x1 << SUBPIXEL_BITS) + SUBPIXEL / 2;
+                int64_t cy0 = ((int64_t)y0 << SUBPIXEL_BITS) + SUBPIXEL / 2, cy1 = ((int64_t)y1 << SUBPIXEL_BITS) + SUBPIXEL / 2;
+                int64_t e00 = s.A[k] * cx0 + s.B[k] * cy0 + s.C[k];
+                int64_t e10 = s.A[k] * cx1 + s.B[k] * cy0 + s.C[k];
+                int64_t e01 = s.A[k] * cx0 + s.B[k] * cy1 + s.C[k];
+                int64_t e11 = s.A[k] * cx1 + s.B[k] * cy1 + s.C[k];
+                int64_t lowest = std::min(std::min(e00, e10), std::min(e01, e11));
+                int64_t highest = std::max(std::max(e00, e10), std::max(e01, e11));
+                if (highest < 0)
+                    return;
+                if (lowest >= 0)
+                {
+                    rowStart[k] = 0;
+                    stepX[k] = 0;
+                    stepY[k] = 0;
+                }
+                else
+                {
+                    rowStart[k] = (int32_t)e00;
+                    stepX[k] = (int32_t)(s.A[k] * SUBPIXEL);
+                    stepY[k] = (int32_t)(s.B[k] * SUBPIXEL);
+                }
+            }
+
+            SoftwareRasterizer& raster = *tile.raster;
+            for (int y = y0; y <= y1; y++)
+            {
+                int32_t e[3] = { rowStart[0], rowStart[1], rowStart[2] };
+                for (int x = x0; x <= x1; x += 4)
+                {
+                    // bit i set = pixel x + i is covered
+                    int mask = coverage(e, stepX);
+                    if (x + 4 > x1 + 1)
+                        mask &= (1 << (x1 + 1 - x)) - 1;
+                    while (mask)
+                    {
+                        int i = lowestBit(mask);
+                        mask &= mask - 1;
+                        shade(triangle, raster, x + i, y);
+                    }
+                    for (int k = 0; k < 3; k++)
+                        e[k] += stepX[k] * 4;
+                }
+                for (int k = 0; k < 3; k++)
+                    rowStart[k] += stepY[k];
+            }
+        }
+        // early depth test, interpolate, run the fragment shader, write
+        void shade(const Triangle& triangle, SoftwareRasterizer& raster, int x, int y) const
+        {
+            const Setup& s = triangle.setup;
+            float px = x + 0.5f - s.x0, py = y + 0.5f - s.y0;
+            float l1 = px * s.l1x + py * s.l1y;
+            float l2 = px * s.l2x + py * s.l2y;
+            float l0 = 1.0f - l1 - l2;
+            size_t pixel = (size_t)y * raster.width + x;
+            float z = l0 * s.z[0] + l1 * s.z[1] + l2 * s.z[2];
+            if (depthTest)
+            {
+                if (!(z < raster.depth[pixel]))
+                    return;
+                raster.depth[pixel] = z;
+            }
+            // perspective correct: interpolate v/w and 1/w linearly on screen, divide at the end
+            float w = 1.0f / (l0 * s.invW[0] + l1 * s.invW[1] + l2 * s.invW[2]);
+            Varyings varyings;
+            float* out = (float*)&varyings;
+            const float* v0 = (const float*)&triangle.varyings[0];
+            const float* v1 = (const float*)&triangle.varyings[1];
+            const float* v2 = (const float*)&triangle.varyings[2];
+            for (int k = 0; k < FLOATS; k++)
+                out[k] = (l0 * v0[k] + l1 * v1[k] + l2 * v2[k]) * w;
+            raster.color[pixel] = pack(fragmentShader(varyings));
+        }
+    };
+
+    // which of the 4 pixels starting at edge values e (stepping by stepX) are inside all 3 edges
+    static int coverage(const int32_t e[3], const int32_t stepX[3])
+    {
+#if defined(SOFTWARE_RASTERIZER_SSE2)
+        __m128i inside = _mm_setzero_si128();
+        for (int k = 0; k < 3; k++)
+        {
+            __m128i steps = _mm_set_epi32(stepX[k] * 3, stepX[k] * 2, stepX[k], 0);
+            inside = _mm_or_si128(inside, _mm_add_epi32(_mm_set1_epi32(e[k]), steps));
+        }
+        // the sign bit of (e0 | e1 | e2) is set if any of them is negative
+        return (~_mm_movemask_ps(_mm_castsi128_ps(inside))) & 0xF;
+#elif defined(SOFTWARE_RASTERIZER_NEON)
+        static const int32_t lanes[4] = { 0, 1, 2, 3 };
+        int32x4_t index = vld1q_s32(lanes);
+        int32x4_t inside = vdupq_n_s32(0);
+        for (int k = 0; k < 3; k++)
+            inside = vorrq_s32(inside, vmlaq_n_s32(vdupq_n_s32(e[k]), index, stepX[k]));
+        uint32x4_t negative = vshrq_n_u32(vreinterpretq_u32_s32(inside), 31);
+        return (~(vgetq_lane_u32(negative, 0) | vgetq_lane_u32(negative, 1) << 1 | vgetq_lane_u32(negative, 2) << 2 | vgetq_lane_u32(negative, 3) << 3)) & 0xF;
+#else
+        int mask = 0;
+        for (int i = 0; i < 4; i++)
+            if ((e[0] + stepX[0] * i | e[1] + stepX[1] * i | e[2] + stepX[2] * i) >= 0)
+                mask |= 1 << i;
+        return mask;
+#endif
+    }
+    static int lowestBit(int mask)
+    {
+        int i = 0;
+        while (!(mask & (1 << i)))
+            i++;
+        return i;
+    }
+    static uint32_t pack(const glm::vec4& c)
+    {
+        auto channel = [](float v) { return (uint32_t)(std::min(std::max(v, 0.0f), 1.0f) * 255.0f + 0.5f); };
+        return channel(c.x) | channel(c.y) << 8 | channel(c.z) << 16 | channel(c.w) << 24;
+    }
+    // runs job(0..count-1) on threadCount threads, each grabbing the next index when it's done (as in mesh_loader.h)
+    template <class Job>
+    static void parallelFor(size_t count, unsigned int threadCount, const Job& job)
+    {
+        std::atomic<size_t> next(0);
+        auto worker = [&]()
+        {
+            for (size_t i = next++; i < count; i = next++)
+                job(i);
+        };
+        std::vector<std::thread> pool;
+        for (unsigned int t = 1; t < threadCount; t++)
+            pool.emplace_back(worker);
+        worker();
+        for (std::thread& thread : pool)
+            thread.join();
+    }
+
+    unsigned int threadCount;
+    int width = 0, height = 0;
+    int tilesX = 0, tilesY = 0;
+    float guardBand = 1.0f;
+    std::vector<uint32_t> color;
+    std::vector<float> depth;
+    std::vector<std::vector<BinEntry>> bins;
+    std::vector<std::unique_ptr<BatchBase>> batches;
+    size_t trianglesSubmitted = 0, trianglesSetUp = 0;
+};
+#endif
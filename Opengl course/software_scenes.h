@@ -0,0 +1,376 @@
+#ifndef SOFTWARE_SCENES_H
+#define SOFTWARE_SCENES_H
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+#include "software_rasterizer.h"
+#include "transform_hierarchy.h"
+
+#include <vector>
+#include <string>
+#include <cmath>
+
+// the textures the chapters load, loaded the same way (most flip on load, Ch7SimpleTexture doesn't)
+struct SoftwareSceneAssets
+{
+    SoftwareTexture wood;           // images/wood.png flipped
+    SoftwareTexture woodUnflipped;  // images/wood.png as Ch7SimpleTexture loads it
+    SoftwareTexture troll;          // images/tf.png flipped
+
+    bool load()
+    {
+        return wood.load("images/wood.png", true) && woodUnflipped.load("images/wood.png", false) && troll.load("images/tf.png", true);
+    }
+};
+
+struct SoftwareScene
+{
+    const char* name;       // the chapter it copies
+    bool animated;          // uses glfwGetTime(), so time matters
+    void (*render)(SoftwareRasterizer& raster, const SoftwareSceneAssets& assets, float time);
+};
+
+// The chapter scenes redone for SoftwareRasterizer: same vertex data, same matrices, and C++ versions of their
+// shaders, so they render what the GL chapters show. time stands in for glfwGetTime(), the camera is wherever
+// the chapter starts it (no input). render() clears, draws and finishes, the image is in raster afterwards.
+class SoftwareScenes
+{
+public:
+    // ------------------------------------------------------------------------
+    static const std::vector<SoftwareScene>& all()
+    {
+        static const std::vector<SoftwareScene> scenes = {
+            { "Ch5TwoOrangeTriangles", false, ch5TwoOrangeTriangles },
+            { "Ch6FlashingGreenTriangles", true, ch6FlashingGreenTriangles },
+            { "Ch7SimpleTexture", false, ch7SimpleTexture },
+            { "Ch7TwoTexturesMixed", false, ch7TwoTexturesMixed },
+            { "Ch8RotatingImageOverTime", true, ch8RotatingImageOverTime },
+            { "Ch9Plane", false, ch9Plane },
+            { "Ch9Cube", false, ch9Cube },
+            { "Ch9ManyCubes", true, ch9ManyCubes },
+            { "Ch10CameraCircle", true, ch10CameraCircle },
+            { "Ch12LightingSetup", false, ch12LightingSetup },
+            { "Ch13DiffuseAndSpecular", true, ch13DiffuseAndSpecular },
+        };
+        return scenes;
+    }
+    // ------------------------------------------------------------------------
+    static const SoftwareScene* find(const std::string& name)
+    {
+        for (const SoftwareScene& scene : all())
+            if (name == scene.name)
+                return &scene;
+        return nullptr;
+    }
+
+private:
+    // ------------------------------------------------------------------------
+    // vertex data, copied from the chapters
+    // ------------------------------------------------------------------------
+    // the Ch5/Ch6 pair of triangles, position only
+    static const float* triangles()
+    {
+        static const float vertices[] = {
+            -0.9f, -0.5f, 0.0f, 0.0f, -0.5f, 0.0f, -0.45f, 0.5f, 0.0f,
+            0.0f, -0.5f, 0.0f, 0.9f, -0.5f, 0.0f, 0.45f, 0.5f, 0.0f
+        };
+        return vertices;
+    }
+    // the Ch7/Ch8 quad: position, color, texture coords, two triangles by index
+    static const float* quad()
+    {
+        static const float vertices[] = {
+            0.5f, 0.5f, 0.0f, 1.0f, 0.0f, 0.0f, 1.0f, 1.0f, // top right
+            0.5f, -0.5f, 0.0f, 0.0f, 1.0f, 0.0f, 1.0f, 0.0f, // bottom right
+            -0.5f, -0.5f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, // bottom left
+            -0.5f, 0.5f, 0.0f, 1.0f, 1.0f, 0.0f, 0.0f, 1.0f // top left
+        };
+        return vertices;
+    }
+    static const uint32_t* quadIndices()
+    {
+        static const uint32_t indices[] = { 0, 1, 3, 1, 2, 3 };
+        return indices;
+    }
+    // the cube every chapter from Ch9 on uses: position, normal (Ch12/Ch13), texture coords (Ch9/Ch10), 36 vertices
+    static const float* cube()
+    {
+        static const float vertices[] = {
+            -0.5f, -0.5f, -0.5f,  0.0f,  0.0f, -1.0f,  0.0f, 0.0f,
+             0.5f, -0.5f, -0.5f,  0.0f,  0.0f, -1.0f,  1.0f, 0.0f,
+             0.5f,  0.5f, -0.5f,  0.0f,  0.0f, -1.0f,  1.0f, 1.0f,
+             0.5f,  0.5f, -0.5f,  0.0f,  0.0f, -1.0f,  1.0f, 1.0f,
+            -0.5f,  0.5f, -0.5f,  0.0f,  0.0f, -1.0f,  0.0f, 1.0f,
+            -0.5f, -0.5f, -0.5f,  0.0f,  0.0f, -1.0f,  0.0f, 0.0f,
+
+            -0.5f, -0.5f,  0.5f,  0.0f,  0.0f,  1.0f,  0.0f, 0.0f,
+             0.5f, -0.5f,  0.5f,  0.0f,  0.0f,  1.0f,  1.0f, 0.0f,
+             0.5f,  0.5f,  0.5f,  0.0f,  0.0f,  1.0f,  1.0f, 1.0f,
+             0.5f,  0.5f,  0.5f,  0.0f,  0.0f,  1.0f,  1.0f, 1.0f,
+            -0.5f,  0.5f,  0.5f,  0.0f,  0.0f,  1.0f,  0.0f, 1.0f,
+            -0.5f, -0.5f,  0.5f,  0.0f,  0.0f,  1.0f,  0.0f, 0.0f,
+
+            -0.5f,  0.5f,  0.5f, -1.0f,  0.0f,  0.0f,  1.0f, 0.0f,
+            -0.5f,  0.5f, -0.5f, -1.0f,  0.0f,  0.0f,  1.0f, 1.0f,
+            -0.5f, -0.5f, -0.5f, -1.0f,  0.0f,  0.0f,  0.0f, 1.0f,
+            -0.5f, -0.5f, -0.5f, -1.0f,  0.0f,  0.0f,  0.0f, 1.0f,
+            -0.5f, -0.5f,  0.5f, -1.0f,  0.0f,  0.0f,  0.0f, 0.0f,
+            -0.5f,  0.5f,  0.5f, -1.0f,  0.0f,  0.0f,  1.0f, 0.0f,
+
+             0.5f,  0.5f,  0.5f,  1.0f,  0.0f,  0.0f,  1.0f, 0.0f,
+             0.5f,  0.5f, -0.5f,  1.0f,  0.0f,  0.0f,  1.0f, 1.0f,
+             0.5f, -0.5f, -0.5f,  1.0f,  0.0f,  0.0f,  0.0f, 1.0f,
+             0.5f, -0.5f, -0.5f,  1.0f,  0.0f,  0.0f,  0.0f, 1.0f,
+             0.5f, -0.5f,  0.5f,  1.0f,  0.0f,  0.0f,  0.0f, 0.0f,
+             0.5f,  0.5f,  0.5f,  1.0f,  0.0f,  0.0f,  1.0f, 0.0f,
+
+            -0.5f, -0.5f, -0.5f,  0.0f, -1.0f,  0.0f,  0.0f, 1.0f,
+             0.5f, -0.5f, -0.5f,  0.0f, -1.0f,  0.0f,  1.0f, 1.0f,
+             0.5f, -0.5f,  0.5f,  0.0f, -1.0f,  0.0f,  1.0f, 0.0f,
+             0.5f, -0.5f,  0.5f,  0.0f, -1.0f,  0.0f,  1.0f, 0.0f,
+            -0.5f, -0.5f,  0.5f,  0.0f, -1.0f,  0.0f,  0.0f, 0.0f,
+            -0.5f, -0.5f, -0.5f,  0.0f, -1.0f,  0.0f,  0.0f, 1.0f,
+
+            -0.5f,  0.5f, -0.5f,  0.0f,  1.0f,  0.0f,  0.0f, 1.0f,
+             0.5f,  0.5f, -0.5f,  0.0f,  1.0f,  0.0f,  1.0f, 1.0f,
+             0.5f,  0.5f,  0.5f,  0.0f,  1.0f,  0.0f,  1.0f, 0.0f,
+             0.5f,  0.5f,  0.5f,  0.0f,  1.0f,  0.0f,  1.0f, 0.0f,
+            -0.5f,  0.5f,  0.5f,  0.0f,  1.0f,  0.0f,  0.0f, 0.0f,
+            -0.5f,  0.5f, -0.5f,  0.0f,  1.0f,  0.0f,  0.0f, 1.0f
+        };
+        return vertices;
+    }
+    static glm::vec3 cubePosition(uint32_t v) { return glm::vec3(cube()[v * 8], cube()[v * 8 + 1], cube()[v * 8 + 2]); }
+    static glm::vec3 cubeNormal(uint32_t v) { return glm::vec3(cube()[v * 8 + 3], cube()[v * 8 + 4], cube()[v * 8 + 5]); }
+    static glm::vec2 cubeTexCoord(uint32_t v) { return glm::vec2(cube()[v * 8 + 6], cube()[v * 8 + 7]); }
+    // the 10 cubes of Ch9ManyCubes / Ch10CameraCircle
+    static const glm::vec3* cubePositions()
+    {
+        static const glm::vec3 positions[10] = {
+            glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3(2.0f, 5.0f, -15.0f), glm::vec3(-1.5f, -2.2f, -2.5f),
+            glm::vec3(-3.8f, -2.0f, -12.3f), glm::vec3(2.4f, -0.4f, -3.5f), glm::vec3(-1.7f, 3.0f, -7.5f),
+            glm::vec3(1.3f, -2.0f, -2.5f), glm::vec3(1.5f, 2.0f, -2.5f), glm::vec3(1.5f, 0.2f, -1.5f),
+            glm::vec3(-1.3f, 1.0f, -1.5f)
+        };
+        return positions;
+    }
+    static float aspect(const SoftwareRasterizer& raster) { return (float)raster.getWidth() / (float)raster.getHeight(); }
+
+    // ------------------------------------------------------------------------
+    // shaders
+    // ------------------------------------------------------------------------
+    struct ColoredTextured { glm::vec3 color; glm::vec2 texturecoord; };
+    struct Textured { glm::vec2 texturecoord; };
+    struct Lit { glm::vec3 fragPos; glm::vec3 normal; };
+    struct Flat { float unused; };
+
+    // Common/colored_textured_vs.glsl, transform = identity unless USE_TRANSFORMATION_MATRIX
+    static void drawColoredTexturedQuad(SoftwareRasterizer& raster, const glm::mat4& transform, bool twoTextures, const SoftwareSceneAssets& assets)
+    {
+        auto vertexShader = [&](uint32_t v, ColoredTextured& out)
+        {
+            const float* p = quad() + v * 8;
+            out.color = glm::vec3(p[3], p[4], p[5]);
+            out.texturecoord = glm::vec2(p[6], p[7]);
+            return transform * glm::vec4(p[0], p[1], p[2], 1.0f);
+        };
+        if (twoTextures)
+            raster.draw<ColoredTextured>(4, vertexShader, [&](const ColoredTextured& in) { return twoTexturesMixed(assets, in.texturecoord); }, quadIndices(), 6);
+        else // Ch7SimpleTexture/fs.glsl
+            raster.draw<ColoredTextured>(4, vertexShader, [&](const ColoredTextured& in)
+            {
+                return assets.woodUnflipped.sample(in.texturecoord) * glm::vec4(in.color, 1.0f);
+            }, quadIndices(), 6);
+    }
+    // Common/two_textures_fs.glsl
+    static glm::vec4 twoTexturesMixed(const SoftwareSceneAssets& assets, const glm::vec2& texturecoord)
+    {
+        return glm::mix(assets.wood.sample(texturecoord), assets.troll.sample(texturecoord), 0.4f);
+    }
+    // Common/textured_vs.glsl + Common/two_textures_fs.glsl on the cube
+    static void drawTexturedCube(SoftwareRasterizer& raster, const glm::mat4& mvp, const SoftwareSceneAssets& assets)
+    {
+        raster.draw<Textured>(36, [&](uint32_t v, Textured& out)
+        {
+            out.texturecoord = cubeTexCoord(v);
+            return mvp * glm::vec4(cubePosition(v), 1.0f);
+        }, [&](const Textured& in) { return twoTexturesMixed(assets, in.texturecoord); });
+    }
+    // Ch12Lighting/vs.glsl with a constant color fragment shader (fs.glsl and light_cube_fs.glsl are both that)
+    static void drawFlatCube(SoftwareRasterizer& raster, const glm::mat4& mvp, const glm::vec3& color)
+    {
+        raster.draw<Flat>(36, [&](uint32_t v, Flat& out)
+        {
+            out.unused = 0.0f;
+            return mvp * glm::vec4(cubePosition(v), 1.0f);
+        }, [color](const Flat&) { return glm::vec4(color, 1.0f); });
+    }
+    // Common/phong.glsl with USE_SPECULAR 1
+    static glm::vec3 phong(const glm::vec3& norm, const glm::vec3& lightDir, const glm::vec3& toEye, const glm::vec3& lightColor)
+    {
+        float diff = std::max(glm::dot(norm, lightDir), 0.0f);
+        glm::vec3 diffuse = lightColor * diff;
+        float specularStrength = 0.5f;
+        glm::vec3 reflected = glm::reflect(-lightDir, norm);
+        float amount = std::pow(std::max(glm::dot(reflected, toEye), 0.0f), 32.0f);
+        return diffuse + lightColor * specularStrength * amount;
+    }
+
+    // ------------------------------------------------------------------------
+    // the chapters
+    // ------------------------------------------------------------------------
+    // Ch5 to Ch8 never clear, black is what a fresh window shows
+    static void drawTriangles(SoftwareRasterizer& raster, const glm::vec4& color)
+    {
+        raster.depthTest = false;
+        raster.clear(glm::vec4(0.0f, 0.0f, 0.0f, 1.0f));
+        raster.draw<Flat>(6, [](uint32_t v, Flat& out)
+        {
+            out.unused = 0.0f;
+            return glm::vec4(triangles()[v * 3], triangles()[v * 3 + 1], triangles()[v * 3 + 2], 1.0f);
+        }, [color](const Flat&) { return color; });
+        raster.finish();
+    }
+    static void ch5TwoOrangeTriangles(SoftwareRasterizer& raster, const SoftwareSceneAssets& assets, float time)
+    {
+        drawTriangles(raster, glm::vec4(1.0f, 0.5f, 0.2f, 1.0f));
+    }
+    static void ch6FlashingGreenTriangles(SoftwareRasterizer& raster, const SoftwareSceneAssets& assets, float time)
+    {
+        float green = std::sin(time) / 2.0f + 0.5f;
+        drawTriangles(raster, glm::vec4(0.0f, green, 0.0f, 1.0f));
+    }
+    static void ch7SimpleTexture(SoftwareRasterizer& raster, const SoftwareSceneAssets& assets, float time)
+    {
+        raster.depthTest = false;
+        raster.clear(glm::vec4(0.0f, 0.0f, 0.0f, 1.0f));
+        drawColoredTexturedQuad(raster, glm::mat4(1.0f), false, assets);
+        raster.finish();
+    }
+    static void ch7TwoTexturesMixed(SoftwareRasterizer& raster, const SoftwareSceneAssets& assets, float time)
+    {
+        raster.depthTest = false;
+        raster.clear(glm::vec4(0.0f, 0.0f, 0.0f, 1.0f));
+        drawColoredTexturedQuad(raster, glm::mat4(1.0f), true, assets);
+        raster.finish();
+    }
+    static void ch8RotatingImageOverTime(SoftwareRasterizer& raster, const SoftwareSceneAssets& assets, float time)
+    {
+        raster.depthTest = false;
+        raster.clear(glm::vec4(0.0f, 0.0f, 0.0f, 1.0f));
+        glm::mat4 mat = glm::mat4(1.0f);
+        mat = glm::translate(mat, glm::vec3(0.5f, 0.5f, 0.0f));
+        mat = glm::rotate(mat, time, glm::vec3(0.0f, 0.0f, 1.0f));
+        drawColoredTexturedQuad(raster, mat, true, assets);
+        raster.finish();
+    }
+    static void ch9Plane(SoftwareRasterizer& raster, const SoftwareSceneAssets& assets, float time)
+    {
+        raster.depthTest = false;
+        raster.clear(glm::vec4(0.2f, 0.3f, 0.3f, 1.0f));
+        glm::mat4 model = glm::rotate(glm::mat4(1.0f), glm::radians(-55.0f), glm::vec3(1.0f, 0.0f, 0.0f));
+        glm::mat4 view = glm::translate(glm::mat4(1.0f), glm::vec3(0.0f, 0.0f, -3.0f));
+        glm::mat4 projection = glm::perspective(glm::radians(45.0f), aspect(raster), 0.1f, 100.0f);
+        glm::mat4 mvp = projection * view * model;
+        // Ch9Plane's quad has no colors, just position + texture coords
+        raster.draw<Textured>(4, [&](uint32_t v, Textured& out)
+        {
+            const float* p = quad() + v * 8;
+            out.texturecoord = glm::vec2(p[6], p[7]);
+            return mvp * glm::vec4(p[0], p[1], p[2], 1.0f);
+        }, [&](const Textured& in) { return twoTexturesMixed(assets, in.texturecoord); }, quadIndices(), 6);
+        raster.finish();
+    }
+    static void ch9Cube(SoftwareRasterizer& raster, const SoftwareSceneAssets& assets, float time)
+    {
+        raster.depthTest = true;
+        raster.clear(glm::vec4(0.2f, 0.3f, 0.3f, 1.0f));
+        glm::mat4 model = glm::mat4(1.0f);
+        model = glm::rotate(model, glm::radians(-55.0f), glm::vec3(1.0f, 0.0f, 0.0f));
+        model = glm::rotate(model, glm::radians(-55.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+        glm::mat4 view = glm::translate(glm::mat4(1.0f), glm::vec3(0.0f, 0.0f, -5.0f));
+        glm::mat4 projection = glm::perspective(glm::radians(25.0f), aspect(raster), 0.1f, 100.0f);
+        drawTexturedCube(raster, projection * view * model, assets);
+        raster.finish();
+    }
+    static void ch9ManyCubes(SoftwareRasterizer& raster, const SoftwareSceneAssets& assets, float time)
+    {
+        raster.depthTest = true;
+        raster.clear(glm::vec4(0.2f, 0.3f, 0.3f, 1.0f));
+        glm::mat4 view = glm::translate(glm::mat4(1.0f), glm::vec3(0.0f, 0.0f, -5.0f));
+        glm::mat4 projection = glm::perspective(glm::radians(45.0f), aspect(raster), 0.1f, 100.0f);
+        TransformHierarchy cubeTransforms;
+        for (int i = 0; i < 10; i++)
+        {
+            glm::quat spin = glm::angleAxis(glm::radians(-15.0f * (i + 1) * time), glm::vec3(1.0f, 0.0f, 0.0f))
+                * glm::angleAxis(glm::radians(-25.0f * (i + 1) * time), glm::vec3(0.0f, 1.0f, 0.0f));
+            cubeTransforms.addNode(TransformHierarchy::NO_PARENT, cubePositions()[i], spin);
+        }
+        cubeTransforms.update();
+        for (int i = 0; i < 10; i++)
+            drawTexturedCube(raster, projection * view * cubeTransforms.world(i), assets);
+        raster.finish();
+    }
+    static void ch10CameraCircle(SoftwareRasterizer& raster, const SoftwareSceneAssets& assets, float time)
+    {
+        raster.depthTest = true;
+        raster.clear(glm::vec4(0.2f, 0.3f, 0.3f, 1.0f));
+        float radius = 10.0f;
+        glm::vec3 cameraPos = glm::vec3(std::cos(time) * radius, -10.0f, std::sin(time) * radius);
+        glm::mat4 view = glm::lookAt(cameraPos, glm::vec3(0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+        glm::mat4 projection = glm::perspective(glm::radians(25.0f), aspect(raster), 0.1f, 100.0f);
+        for (int i = 0; i < 10; i++)
+            drawTexturedCube(raster, projection * view * glm::translate(glm::mat4(1.0f), cubePositions()[i]), assets);
+        raster.finish();
+    }
+    // the camera class starts at its position looking down -z with a 45 degree zoom
+    static glm::mat4 chapterCamera(const SoftwareRasterizer& raster, const glm::vec3& position)
+    {
+        glm::mat4 view = glm::lookAt(position, position + glm::vec3(0.0f, 0.0f, -1.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+        return glm::perspective(glm::radians(45.0f), aspect(raster), 0.1f, 100.0f) * view;
+    }
+    static void ch12LightingSetup(SoftwareRasterizer& raster, const SoftwareSceneAssets& assets, float time)
+    {
+        raster.depthTest = true;
+        raster.clear(glm::vec4(0.2f, 0.3f, 0.3f, 1.0f));
+        glm::mat4 viewProjection = chapterCamera(raster, glm::vec3(0.0f, 0.0f, 3.0f));
+        glm::vec3 lightPos(1.2f, 1.0f, 2.0f);
+        drawFlatCube(raster, viewProjection, glm::vec3(1.0f, 1.0f, 1.0f) * glm::vec3(1.0f, 0.5f, 0.31f));
+        glm::mat4 model = glm::scale(glm::translate(glm::mat4(1.0f), lightPos), glm::vec3(0.2f));
+        drawFlatCube(raster, viewProjection * model, glm::vec3(1.0f));
+        raster.finish();
+    }
+    // one light, specular on: what the chapter starts with
+    static void ch13DiffuseAndSpecular(SoftwareRasterizer& raster, const SoftwareSceneAssets& assets, float time)
+    {
+        raster.depthTest = true;
+        raster.clear(glm::vec4(0.1f, 0.1f, 0.1f, 0.2f));
+        glm::vec3 viewPos(0.0f, 0.0f, 3.0f);
+        glm::mat4 viewProjection = chapterCamera(raster, viewPos);
+        glm::vec3 lightPos(1.2f * std::cos(time), 1.0f, 1.2f * std::sin(time));
+        glm::vec3 lightColor(1.0f);
+        glm::vec3 objectColor(0.4f, 0.7f, 0.65f);
+
+        // Ch13DiffuseAndSpecular/vs.glsl + fs.glsl, model is the identity
+        raster.draw<Lit>(36, [&](uint32_t v, Lit& out)
+        {
+            out.fragPos = cubePosition(v);
+            out.normal = cubeNormal(v);
+            return viewProjection * glm::vec4(out.fragPos, 1.0f);
+        }, [&](const Lit& in)
+        {
+            glm::vec3 norm = glm::normalize(in.normal);
+            glm::vec3 viewDir = glm::normalize(viewPos - in.fragPos);
+            glm::vec3 ambient = 0.05f * lightColor;
+            glm::vec3 lightDir = glm::normalize(lightPos - in.fragPos);
+            glm::vec3 result = ambient + phong(norm, lightDir, viewDir, lightColor);
+            return glm::vec4(result * objectColor, 1.0f);
+        });
+        glm::mat4 model = glm::scale(glm::translate(glm::mat4(1.0f), lightPos), glm::vec3(0.2f));
+        drawFlatCube(raster, viewProjection * model, glm::vec3(1.0f));
+        raster.finish();
+    }
+};
+#endif
@@ -541,7 +541,9 @@ extern "C" {
 ////   end header file   /////////////////////////////////////////////////////
 #endif // STBI_INCLUDE_STB_IMAGE_H
 
-#ifdef STB_IMAGE_IMPLEMENTATION
+// local change: only once per translation unit, RenderRegression.cpp includes chapters that each ask for it
+#if defined(STB_IMAGE_IMPLEMENTATION) && !defined(STBI_IMPLEMENTATION_INCLUDED)
+#define STBI_IMPLEMENTATION_INCLUDED
 
 #if defined(STBI_ONLY_JPEG) || defined(STBI_ONLY_PNG) || defined(STBI_ONLY_BMP) \
   || defined(STBI_ONLY_TGA) || defined(STBI_ONLY_GIF) || defined(STBI_ONLY_PSD) \
@@ -0,0 +1,209 @@
+#ifndef TRANSFORM_BATCH_H
+#define TRANSFORM_BATCH_H
+
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+#include <vector>
+#include <cstddef>
+
+// pick the widest SIMD we were compiled for. /arch:AVX2 on MSVC or -mavx2 on gcc/clang turns on the AVX2 path,
+// ARM64 always has NEON. Everything else (and the leftover objects at the end of a batch) goes through plain floats.
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define TRANSFORM_BATCH_SIMD "AVX2"
+#elif defined(__ARM_NEON) || defined(_M_ARM64)
+#include <arm_neon.h>
+#define TRANSFORM_BATCH_SIMD "NEON"
+#else
+#define TRANSFORM_BATCH_SIMD "scalar"
+#endif
+
+// Translation/rotation/scale for lots of objects, stored SoA (one array per component)
+// so that N objects can be pushed through the matrix math at once, one object per SIMD lane.
+//
+// compose() turns the whole batch into world matrices, MVP matrices (viewProjection * world)
+// and normal matrices (transpose(inverse(mat3(world)))) in one call. Outputs are regular
+// glm matrices packed back to back so they can go straight into glUniformMatrix4fv / a buffer.
+class TransformBatch
+{
+public:
+    // position
+    std::vector<float> px, py, pz;
+    // rotation (unit quaternion)
+    std::vector<float> qx, qy, qz, qw;
+    // scale
+    std::vector<float> sx, sy, sz;
+
+    // ------------------------------------------------------------------------
+    void resize(size_t count)
+    {
+        px.resize(count, 0.0f); py.resize(count, 0.0f); pz.resize(count, 0.0f);
+        qx.resize(count, 0.0f); qy.resize(count, 0.0f); qz.resize(count, 0.0f); qw.resize(count, 1.0f);
+        sx.resize(count, 1.0f); sy.resize(count, 1.0f); sz.resize(count, 1.0f);
+    }
+    // ------------------------------------------------------------------------
+    size_t size() const { return px.size(); }
+    // ------------------------------------------------------------------------
+    void set(size_t i, const glm::vec3& position, const glm::quat& rotation, const glm::vec3& scale)
+    {
+        px[i] = position.x; py[i] = position.y; pz[i] = position.z;
+        qx[i] = rotation.x; qy[i] = rotation.y; qz[i] = rotation.z; qw[i] = rotation.w;
+        sx[i] = scale.x; sy[i] = scale.y; sz[i] = scale.z;
+    }
+    // any output pointer can be NULL if you don't need that one. each non-NULL output needs size() entries
+    // ------------------------------------------------------------------------
+    void compose(const glm::mat4& viewProjection, glm::mat4* world, glm::mat4* mvp, glm::mat3* normal) const
+    {
+        size_t count = size();
+        size_t i = 0;
+#if defined(__AVX2__)
+        for (; i + 8 <= count; i += 8)
+            composeBlock<Avx2Lanes>(i, viewProjection, world, mvp, normal);
+#elif defined(__ARM_NEON) || defined(_M_ARM64)
+        for (; i + 4 <= count; i += 4)
+            composeBlock<NeonLanes>(i, viewProjection, world, mvp, normal);
+#endif
+        // whatever doesn't fill a whole register
+        for (; i < count; i++)
+            composeBlock<ScalarLanes>(i, viewProjection, world, mvp, normal);
+    }
+
+private:
+    // each "Lanes" struct wraps one register type so the math below is only written once.
+    // ------------------------------------------------------------------------
+    struct ScalarLanes
+    {
+        typedef float V;
+        static const int WIDTH = 1;
+        static V load(const float* p) { return *p; }
+        static V set1(float f) { return f; }
+        static V add(V a, V b) { return a + b; }
+        static V sub(V a, V b) { return a - b; }
+        static V mul(V a, V b) { return a * b; }
+        static V div(V a, V b) { return a / b; }
+        static void store(float* p, V v) { *p = v; }
+    };
+#if defined(__AVX2__)
+    struct Avx2Lanes
+    {
+        typedef __m256 V;
+        static const int WIDTH = 8;
+        static V load(const float* p) { return _mm256_loadu_ps(p); }
+        static V set1(float f) { return _mm256_set1_ps(f); }
+        static V add(V a, V b) { return _mm256_add_ps(a, b); }
+        static V sub(V a, V b) { return _mm256_sub_ps(a, b); }
+        static V mul(V a, V b) { return _mm256_mul_ps(a, b); }
+        static V div(V a, V b) { return _mm256_div_ps(a, b); }
+        static void store(float* p, V v) { _mm256_storeu_ps(p, v); }
+    };
+#elif defined(__ARM_NEON) || defined(_M_ARM64)
+    struct NeonLanes
+    {
+        typedef float32x4_t V;
+        static const int WIDTH = 4;
+        static V load(const float* p) { return vld1q_f32(p); }
+        static V set1(float f) { return vdupq_n_f32(f); }
+        static V add(V a, V b) { return vaddq_f32(a, b); }
+        static V sub(V a, V b) { return vsubq_f32(a, b); }
+        static V mul(V a, V b) { return vmulq_f32(a, b); }
+        static V div(V a, V b) { return vdivq_f32(a, b); }
+        static void store(float* p, V v) { vst1q_f32(p, v); }
+    };
+#endif
+
+    // does Lanes::WIDTH objects starting at "first".
+    // results come out one matrix element per register (SoA), then get scattered to the AoS outputs
+    // ------------------------------------------------------------------------
+    template <class L>
+    void composeBlock(size_t first, const glm::mat4& vp, glm::mat4* world, glm::mat4* mvp, glm::mat3* normal) const
+    {
+        typedef typename L::V V;
+        const V one = L::set1(1.0f);
+        const V two = L::set1(2.0f);
+
+        V x = L::load(&qx[first]), y = L::load(&qy[first]), z = L::load(&qz[first]), w = L::load(&qw[first]);
+        V xx = L::mul(x, x), yy = L::mul(y, y), zz = L::mul(z, z);
+        V xy = L::mul(x, y), xz = L::mul(x, z), yz = L::mul(y, z);
+        V wx = L::mul(w, x), wy = L::mul(w, y), wz = L::mul(w, z);
+
+        // rotation part, r[column][row], same layout glm::mat3_cast gives
+        V r[3][3];
+        r[0][0] = L::sub(one, L::mul(two, L::add(yy, zz)));
+        r[0][1] = L::mul(two, L::add(xy, wz));
+        r[0][2] = L::mul(two, L::sub(xz, wy));
+        r[1][0] = L::mul(two, L::sub(xy, wz));
+        r[1][1] = L::sub(one, L::mul(two, L::add(xx, zz)));
+        r[1][2] = L::mul(two, L::add(yz, wx));
+        r[2][0] = L::mul(two, L::add(xz, wy));
+        r[2][1] = L::mul(two, L::sub(yz, wx));
+        r[2][2] = L::sub(one, L::mul(two, L::add(xx, yy)));
+
+        V s[3] = { L::load(&sx[first]), L::load(&sy[first]), L::load(&sz[first]) };
+        V t[3] = { L::load(&px[first]), L::load(&py[first]), L::load(&pz[first]) };
+
+        // world = T * R * S. bottom row is always (0, 0, 0, 1) so we never store/multiply it
+        V m[4][3];
+        for (int c = 0; c < 3; c++)
+            for (int row = 0; row < 3; row++)
+                m[c][row] = L::mul(r[c][row], s[c]);
+        for (int row = 0; row < 3; row++)
+            m[3][row] = t[row];
+
+        // scratch for the SoA -> AoS scatter
+        float lane[16][L::WIDTH];
+
+        if (world)
+        {
+            for (int c = 0; c < 4; c++)
+                for (int row = 0; row < 3; row++)
+                    L::store(lane[c * 4 + row], m[c][row]);
+            for (int k = 0; k < L::WIDTH; k++)
+            {
+                glm::mat4& out = world[first + k];
+                for (int c = 0; c < 4; c++)
+                    out[c] = glm::vec4(lane[c * 4 + 0][k], lane[c * 4 + 1][k], lane[c * 4 + 2][k], c == 3 ? 1.0f : 0.0f);
+            }
+        }
+
+        if (mvp)
+        {
+            // mvp[c][row] = sum_k vp[k][row] * world[c][k], with world[c][3] = 0 for c < 3 and 1 for c == 3
+            for (int row = 0; row < 4; row++)
+            {
+                V vp0 = L::set1(vp[0][row]), vp1 = L::set1(vp[1][row]), vp2 = L::set1(vp[2][row]), vp3 = L::set1(vp[3][row]);
+                for (int c = 0; c < 4; c++)
+                {
+                    V acc = L::add(L::add(L::mul(vp0, m[c][0]), L::mul(vp1, m[c][1])), L::mul(vp2, m[c][2]));
+                    if (c == 3)
+                        acc = L::add(acc, vp3);
+                    L::store(lane[c * 4 + row], acc);
+                }
+            }
+            for (int k = 0; k < L::WIDTH; k++)
+            {
+                glm::mat4& out = mvp[first + k];
+                for (int c = 0; c < 4; c++)
+                    out[c] = glm::vec4(lane[c * 4 + 0][k], lane[c * 4 + 1][k], lane[c * 4 + 2][k], lane[c * 4 + 3][k]);
+            }
+        }
+
+        if (normal)
+        {
+            // inverse(R * S) transposed is just R * S^-1, so no actual matrix inverse is needed
+            for (int c = 0; c < 3; c++)
+            {
+                V invScale = L::div(one, s[c]);
+                for (int row = 0; row < 3; row++)
+                    L::store(lane[c * 3 + row], L::mul(r[c][row], invScale));
+            }
+            for (int k = 0; k < L::WIDTH; k++)
+            {
+                glm::mat3& out = normal[first + k];
+                for (int c = 0; c < 3; c++)
+                    out[c] = glm::vec3(lane[c * 3 + 0][k], lane[c * 3 + 1][k], lane[c * 3 + 2][k]);
+            }
+        }
+    }
+};
+#endif
@@ -0,0 +1,144 @@
+#ifndef TRANSFORM_HIERARCHY_H
+#define TRANSFORM_HIERARCHY_H
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+#include <vector>
+#include <algorithm>
+#include <cstdint>
+#include <cassert>
+
+// Parent/child transforms kept in flat arrays (one entry per node).
+// Nodes are stored in depth order: a parent is always added before its children,
+// so it always has a smaller index. That means one forward pass over the arrays is
+// enough to update every world matrix, parents are always done before their kids.
+//
+// Only nodes marked dirty (or whose parent moved this update) get recomputed,
+// so static geometry costs nothing per frame.
+class TransformHierarchy
+{
+public:
+    static const int NO_PARENT = -1;
+
+    // add a node and return its index. parent has to already exist (which is what keeps things in depth order)
+    // ------------------------------------------------------------------------
+    int addNode(int parent = NO_PARENT,
+                const glm::vec3& position = glm::vec3(0.0f),
+                const glm::quat& rotation = glm::quat(1.0f, 0.0f, 0.0f, 0.0f),
+                const glm::vec3& scale = glm::vec3(1.0f))
+    {
+        assert(parent < (int)size());
+        parents.push_back(parent);
+        positions.push_back(position);
+        rotations.push_back(rotation);
+        scales.push_back(scale);
+        locals.push_back(glm::mat4(1.0f));
+        worlds.push_back(glm::mat4(1.0f));
+        localDirty.push_back(1);
+        worldChanged.push_back(0);
+        anyDirty = true;
+        return (int)size() - 1;
+    }
+    // ------------------------------------------------------------------------
+    void setPosition(int node, const glm::vec3& position)
+    {
+        positions[node] = position;
+        markDirty(node);
+    }
+    // ------------------------------------------------------------------------
+    void setRotation(int node, const glm::quat& rotation)
+    {
+        rotations[node] = rotation;
+        markDirty(node);
+    }
+    // ------------------------------------------------------------------------
+    void setScale(int node, const glm::vec3& scale)
+    {
+        scales[node] = scale;
+        markDirty(node);
+    }
+    // recompute world matrices for dirty nodes (and everything below them) in one linear pass.
+    // returns how many world matrices actually got rebuilt, 0 when nothing moved
+    // ------------------------------------------------------------------------
+    unsigned int update()
+    {
+        if (!anyDirty)
+        {
+            // nothing moved since last time, so nothing changed this update either
+            if (changedLastUpdate)
+            {
+                std::fill(worldChanged.begin(), worldChanged.end(), (uint8_t)0);
+                changedLastUpdate = false;
+            }
+            return 0;
+        }
+
+        unsigned int updated = 0;
+        for (size_t i = 0; i < size(); i++)
+        {
+            int parent = parents[i];
+            bool parentChanged = parent != NO_PARENT && worldChanged[parent];
+
+            if (localDirty[i])
+            {
+                locals[i] = composeTRS(positions[i], rotations[i], scales[i]);
+                localDirty[i] = 0;
+            }
+            else if (!parentChanged)
+            {
+                worldChanged[i] = 0;
+                continue;
+            }
+
+            worlds[i] = parent == NO_PARENT ? locals[i] : worlds[parent] * locals[i];
+            worldChanged[i] = 1;
+            updated++;
+        }
+        anyDirty = false;
+        changedLastUpdate = true;
+        return updated;
+    }
+    // ------------------------------------------------------------------------
+    const glm::mat4& world(int node) const { return worlds[node]; }
+    const glm::mat4& local(int node) const { return locals[node]; }
+    int parent(int node) const { return parents[node]; }
+    // true if the node's world matrix was rebuilt by the last update() (handy for only re-uploading what moved)
+    bool changed(int node) const { return worldChanged[node] != 0; }
+    size_t size() const { return parents.size(); }
+
+    // the world matrices packed back to back, ready for a glBufferSubData / glUniformMatrix4fv(count) upload
+    const glm::mat4* worldData() const { return worlds.data(); }
+
+private:
+    // SoA storage, index i in every array is the same node
+    std::vector<int> parents;
+    std::vector<glm::vec3> positions;
+    std::vector<glm::quat> rotations;
+    std::vector<glm::vec3> scales;
+    std::vector<glm::mat4> locals;
+    std::vector<glm::mat4> worlds;
+    std::vector<uint8_t> localDirty;
+    std::vector<uint8_t> worldChanged;
+    bool anyDirty = false;
+    bool changedLastUpdate = false;
+
+    void markDirty(int node)
+    {
+        localDirty[node] = 1;
+        anyDirty = true;
+    }
+
+    // same thing as translate(T) * rotate(R) * scale(S) but without doing three full mat4 products
+    static glm::mat4 composeTRS(const glm::vec3& t, const glm::quat& r, const glm::vec3& s)
+    {
+        glm::mat4 m = glm::mat4_cast(r);
+        m[0] *= s.x;
+        m[1] *= s.y;
+        m[2] *= s.z;
+        m[3] = glm::vec4(t, 1.0f);
+        return m;
+    }
+};
+#endif
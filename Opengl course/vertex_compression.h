@@ -0,0 +1,265 @@
+#ifndef VERTEX_COMPRESSION_H
+#define VERTEX_COMPRESSION_H
+
+#include <glad/glad.h>
+
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <cstring>
+#include <cmath>
+#include <algorithm>
+#include <iostream>
+#include <iomanip>
+
+// Smaller vertex formats. The chapters store every attribute as 32 bit floats, which is more precision
+// than a position on a unit cube or a normal ever needs, and the GPU has to fetch all of it every vertex.
+//
+//   Float32   4 bytes per component, what we had
+//   Half      16 bit float, 2 bytes per component (about 3 decimal digits, fine for positions near the
+//             origin and for UVs in 0..1)
+//   Snorm10   GL_INT_2_10_10_10_REV, xyz in 10 bits each + 2 spare bits, 4 bytes for a whole normal
+//
+// Every attribute is padded to a multiple of 4 bytes since that's what GPUs like to fetch.
+// Position + normal goes from 24 to 12 bytes, position + UV from 20 to 12.
+enum class VertexEncoding
+{
+    Float32,
+    Half,
+    Snorm10
+};
+
+// one attribute of the source data: shader location, number of floats, how to store it
+struct VertexAttributeLayout
+{
+    unsigned int location;
+    int components;
+    VertexEncoding encoding;
+};
+
+// ------------------------------------------------------------------------
+// float <-> half, round to nearest even like the GPU does
+// ------------------------------------------------------------------------
+inline uint16_t floatToHalf(float value)
+{
+    uint32_t bits;
+    std::memcpy(&bits, &value, 4);
+    uint32_t sign = (bits >> 16) & 0x8000;
+    int exponent = (int)((bits >> 23) & 0xff) - 127 + 15;
+    uint32_t mantissa = bits & 0x7fffff;
+
+    if (((bits >> 23) & 0xff) == 0xff)          // inf / nan stay inf / nan
+        return (uint16_t)(sign | 0x7c00 | (mantissa ? 0x200 : 0));
+    if (exponent >= 31)                          // too big, becomes inf
+        return (uint16_t)(sign | 0x7c00);
+    if (exponent <= 0)                           // too small for a normal half, try a denormal
+    {
+        if (exponent < -10)
+            return (uint16_t)sign;
+        mantissa |= 0x800000;
+        int shift = 14 - exponent;
+        uint32_t half = mantissa >> shift;
+        uint32_t rest = mantissa & ((1u << shift) - 1);
+        uint32_t halfway = 1u << (shift - 1);
+        if (rest > halfway || (rest == halfway && (half & 1)))
+            half++;
+        return (uint16_t)(sign | half);
+    }
+    uint32_t half = ((uint32_t)exponent << 10) | (mantissa >> 13);
+    uint32_t rest = mantissa & 0x1fff;
+    // rounding up can carry into the exponent, which is exactly right (and gives inf at the very top)
+    if (rest > 0x1000 || (rest == 0x1000 && (half & 1)))
+        half++;
+    return (uint16_t)(sign | half);
+}
+inline float halfToFloat(uint16_t half)
+{
+    uint32_t sign = (uint32_t)(half & 0x8000) << 16;
+    uint32_t exponent = (half >> 10) & 0x1f;
+    uint32_t mantissa = half & 0x3ff;
+    if (exponent == 0)
+    {
+        float denormal = std::ldexp((float)mantissa, -24);
+        return sign ? -denormal : denormal;
+    }
+    uint32_t bits = exponent == 31 ? (sign | 0x7f800000 | (mantissa << 13)) : (sign | ((exponent - 15 + 127) << 23) | (mantissa << 13));
+    float value;
+    std::memcpy(&value, &bits, 4);
+    return value;
+}
+
+// ------------------------------------------------------------------------
+// xyz in [-1, 1] <-> GL_INT_2_10_10_10_REV (x in the low bits, w in the top 2 bits, left at 0)
+// ------------------------------------------------------------------------
+inline uint32_t packSnorm10(float x, float y, float z)
+{
+    auto component = [](float c) -> uint32_t
+    {
+        int v = (int)std::lround(std::min(std::max(c, -1.0f), 1.0f) * 511.0f);
+        return (uint32_t)v & 0x3ff;
+    };
+    return component(x) | (component(y) << 10) | (component(z) << 20);
+}
+// decode the way GL 4.2+ does: c / 511, with -512 clamped to -1
+inline float unpackSnorm10(uint32_t packed, int component)
+{
+    int v = (int)((packed >> (component * 10)) & 0x3ff);
+    if (v & 0x200)
+        v -= 0x400;
+    return std::max((float)v / 511.0f, -1.0f);
+}
+
+// Interleaved vertex data in a compressed format, converted from the usual tightly packed float arrays.
+// compress() also measures what the conversion cost in accuracy, see printReport().
+class CompressedVertices
+{
+public:
+    struct Attribute
+    {
+        VertexAttributeLayout layout;
+        unsigned int offset;     // bytes from the start of a vertex
+        float maxError;          // biggest difference of any component after the round trip
+        float maxAngleDegrees;   // Snorm10 only: worst direction change of the (renormalized) vector
+    };
+
+    std::vector<unsigned char> data;
+    std::vector<Attribute> attributes;
+    unsigned int stride = 0;
+    size_t vertexCount = 0;
+    size_t sourceBytes = 0;
+
+    // src is vertexCount vertices of floats laid out like the layout list (e.g. xyz then normal xyz)
+    // ------------------------------------------------------------------------
+    static CompressedVertices compress(const float* src, size_t vertexCount, const std::vector<VertexAttributeLayout>& layout)
+    {
+        CompressedVertices out;
+        out.vertexCount = vertexCount;
+        int floatsPerVertex = 0;
+        for (const VertexAttributeLayout& attribute : layout)
+        {
+            out.attributes.push_back({ attribute, out.stride, 0.0f, 0.0f });
+            out.stride += storedBytes(attribute);
+            floatsPerVertex += attribute.components;
+        }
+        out.sourceBytes = vertexCount * floatsPerVertex * sizeof(float);
+        out.data.assign(vertexCount * out.stride, 0);
+
+        for (size_t v = 0; v < vertexCount; v++)
+        {
+            const float* in = src + v * floatsPerVertex;
+            unsigned char* vertex = &out.data[v * out.stride];
+            for (Attribute& attribute : out.attributes)
+            {
+                encode(attribute, in, vertex + attribute.offset);
+                in += attribute.layout.components;
+            }
+        }
+        return out;
+    }
+    // glVertexAttribPointer + enable for every attribute, with the VAO and the VBO holding data bound
+    // ------------------------------------------------------------------------
+    void setAttributes() const
+    {
+        for (const Attribute& attribute : attributes)
+        {
+            const VertexAttributeLayout& layout = attribute.layout;
+            void* offset = (void*)(uintptr_t)attribute.offset;
+            switch (layout.encoding)
+            {
+            case VertexEncoding::Float32:
+                glVertexAttribPointer(layout.location, layout.components, GL_FLOAT, GL_FALSE, stride, offset);
+                break;
+            case VertexEncoding::Half:
+                glVertexAttribPointer(layout.location, layout.components, GL_HALF_FLOAT, GL_FALSE, stride, offset);
+                break;
+            case VertexEncoding::Snorm10:
+                // packed types always have to be read as 4 components, the shader just ignores w
+                glVertexAttribPointer(layout.location, 4, GL_INT_2_10_10_10_REV, GL_TRUE, stride, offset);
+                break;
+            }
+            glEnableVertexAttribArray(layout.location);
+        }
+    }
+    // sizes and worst case errors, so you can tell whether the smaller format is good enough for this mesh
+    // ------------------------------------------------------------------------
+    void printReport(const std::string& name) const
+    {
+        std::cout << "VERTEX_COMPRESSION " << name << ": " << vertexCount << " vertices, " << sourceBytes << " -> " << data.size()
+            << " bytes (" << std::fixed << std::setprecision(2) << (double)sourceBytes / std::max<size_t>(data.size(), 1) << "x smaller)" << std::endl;
+        for (const Attribute& attribute : attributes)
+        {
+            std::cout << "  location " << attribute.layout.location << " " << encodingName(attribute.layout.encoding)
+                << std::scientific << std::setprecision(3) << " max error " << attribute.maxError;
+            if (attribute.layout.encoding == VertexEncoding::Snorm10)
+                std::cout << std::fixed << std::setprecision(3) << ", max angle " << attribute.maxAngleDegrees << " degrees";
+            std::cout << std::defaultfloat << std::endl;
+        }
+    }
+
+private:
+    static unsigned int storedBytes(const VertexAttributeLayout& layout)
+    {
+        switch (layout.encoding)
+        {
+        case VertexEncoding::Half: return (unsigned int)((layout.components * 2 + 3) & ~3);
+        case VertexEncoding::Snorm10: return 4;
+        default: return (unsigned int)(layout.components * 4);
+        }
+    }
+    static const char* encodingName(VertexEncoding encoding)
+    {
+        switch (encoding)
+        {
+        case VertexEncoding::Half: return "half";
+        case VertexEncoding::Snorm10: return "2_10_10_10";
+        default: return "float";
+        }
+    }
+    // write one attribute and track how far the decoded value ends up from the original
+    static void encode(Attribute& attribute, const float* in, unsigned char* out)
+    {
+        int components = attribute.layout.components;
+        switch (attribute.layout.encoding)
+        {
+        case VertexEncoding::Float32:
+            std::memcpy(out, in, components * sizeof(float));
+            break;
+        case VertexEncoding::Half:
+        {
+            uint16_t halves[4] = { 0, 0, 0, 0 };
+            for (int c = 0; c < components; c++)
+            {
+                halves[c] = floatToHalf(in[c]);
+                attribute.maxError = std::max(attribute.maxError, std::fabs(halfToFloat(halves[c]) - in[c]));
+            }
+            std::memcpy(out, halves, storedBytes(attribute.layout));
+            break;
+        }
+        case VertexEncoding::Snorm10:
+        {
+            float v[3] = { 0.0f, 0.0f, 0.0f };
+            for (int c = 0; c < components && c < 3; c++)
+                v[c] = in[c];
+            uint32_t packed = packSnorm10(v[0], v[1], v[2]);
+            std::memcpy(out, &packed, 4);
+
+            float decoded[3], dot = 0.0f, lengthIn = 0.0f, lengthOut = 0.0f;
+            for (int c = 0; c < 3; c++)
+            {
+                decoded[c] = unpackSnorm10(packed, c);
+                attribute.maxError = std::max(attribute.maxError, std::fabs(decoded[c] - v[c]));
+                dot += decoded[c] * v[c];
+                lengthIn += v[c] * v[c];
+                lengthOut += decoded[c] * decoded[c];
+            }
+            if (lengthIn > 0.0f && lengthOut > 0.0f)
+            {
+                float cosAngle = std::min(std::max(dot / std::sqrt(lengthIn * lengthOut), -1.0f), 1.0f);
+                attribute.maxAngleDegrees = std::max(attribute.maxAngleDegrees, std::acos(cosAngle) * 57.2957795f);
+            }
+            break;
+        }
+        }
+    }
+};
+#endif
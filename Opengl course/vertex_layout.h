@@ -0,0 +1,238 @@
+#ifndef VERTEX_LAYOUT_H
+#define VERTEX_LAYOUT_H
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <typeindex>
+
+// Vertex layouts described once, next to the vertex struct, instead of glVertexAttribPointer calls with
+// hand counted strides and (void*)(3 * sizeof(float)) offsets in every chapter:
+//
+//   struct VertexPN { glm::vec3 position; glm::vec3 normal; };
+//   template <> struct VertexLayout<VertexPN>
+//   {
+//       static constexpr VertexAttribute attributes[] = { VERTEX_ATTRIBUTE(0, VertexPN, position), VERTEX_ATTRIBUTE(1, VertexPN, normal) };
+//   };
+//
+// Component count, GL type and offset all come from the struct at compile time, so changing the struct
+// can't leave the attribute setup behind. Setup goes through direct state access (OpenGL 4.5): the format
+// lives in the VAO and the buffer is attached to binding point 0 separately, so one VAO per layout serves
+// every mesh with that layout, and switching meshes is one glVertexArrayVertexBuffer instead of a new VAO.
+struct VertexAttribute
+{
+    unsigned int location;
+    int components;
+    unsigned int type;
+    bool normalized;
+    bool integer;      // read with glVertexArrayAttribIFormat (ivec/uvec in the shader)
+    unsigned int size; // bytes
+    unsigned int offset;
+};
+
+// packed formats from vertex_compression.h, as members of a vertex struct
+struct Half2 { uint16_t v[2]; };
+struct Half4 { uint16_t v[4]; };
+struct PackedNormal { uint32_t bits; }; // GL_INT_2_10_10_10_REV
+
+// what each member type turns into. add a specialization to use another type in a vertex
+// ------------------------------------------------------------------------
+template <class T> struct VertexAttributeType;
+template <> struct VertexAttributeType<float>        { static constexpr int components = 1; static constexpr unsigned int type = GL_FLOAT; static constexpr bool normalized = false; static constexpr bool integer = false; };
+template <> struct VertexAttributeType<glm::vec2>    { static constexpr int components = 2; static constexpr unsigned int type = GL_FLOAT; static constexpr bool normalized = false; static constexpr bool integer = false; };
+template <> struct VertexAttributeType<glm::vec3>    { static constexpr int components = 3; static constexpr unsigned int type = GL_FLOAT; static constexpr bool normalized = false; static constexpr bool integer = false; };
+template <> struct VertexAttributeType<glm::vec4>    { static constexpr int components = 4; static constexpr unsigned int type = GL_FLOAT; static constexpr bool normalized = false; static constexpr bool integer = false; };
+template <> struct VertexAttributeType<int>          { static constexpr int components = 1; static constexpr unsigned int type = GL_INT; static constexpr bool normalized = false; static constexpr bool integer = true; };
+template <> struct VertexAttributeType<unsigned int> { static constexpr int components = 1; static constexpr unsigned int type = GL_UNSIGNED_INT; static constexpr bool normalized = false; static constexpr bool integer = true; };
+template <> struct VertexAttributeType<glm::uvec4>   { static constexpr int components = 4; static constexpr unsigned int type = GL_UNSIGNED_INT; static constexpr bool normalized = false; static constexpr bool integer = true; };
+template <> struct VertexAttributeType<Half2>        { static constexpr int components = 2; static constexpr unsigned int type = GL_HALF_FLOAT; static constexpr bool normalized = false; static constexpr bool integer = false; };
+template <> struct VertexAttributeType<Half4>        { static constexpr int components = 4; static constexpr unsigned int type = GL_HALF_FLOAT; static constexpr bool normalized = false; static constexpr bool integer = false; };
+template <> struct VertexAttributeType<PackedNormal> { static constexpr int components = 4; static constexpr unsigned int type = GL_INT_2_10_10_10_REV; static constexpr bool normalized = true; static constexpr bool integer = false; };
+
+template <class T>
+constexpr VertexAttribute makeVertexAttribute(unsigned int location, size_t offset)
+{
+    return { location, VertexAttributeType<T>::components, VertexAttributeType<T>::type, VertexAttributeType<T>::normalized,
+        VertexAttributeType<T>::integer, (unsigned int)sizeof(T), (unsigned int)offset };
+}
+#define VERTEX_ATTRIBUTE(location, Vertex, member) makeVertexAttribute<decltype(Vertex::member)>(location, offsetof(Vertex, member))
+
+// specialize this for every vertex struct, see the top of the file
+template <class Vertex> struct VertexLayout;
+
+// compile time sanity check: every attribute fits inside the vertex and no location is used twice
+template <class Vertex>
+constexpr bool vertexLayoutValid()
+{
+    const auto& attributes = VertexLayout<Vertex>::attributes;
+    size_t count = sizeof(attributes) / sizeof(attributes[0]);
+    for (size_t i = 0; i < count; i++)
+    {
+        if (attributes[i].offset + attributes[i].size > sizeof(Vertex))
+            return false;
+        for (size_t j = i + 1; j < count; j++)
+            if (attributes[i].location == attributes[j].location)
+                return false;
+    }
+    return true;
+}
+
+// ------------------------------------------------------------------------
+// the vertex types the chapters use
+// ------------------------------------------------------------------------
+// position + normal, the Ch13 cube
+struct VertexPN
+{
+    glm::vec3 position;
+    glm::vec3 normal;
+};
+template <> struct VertexLayout<VertexPN>
+{
+    static constexpr VertexAttribute attributes[] = { VERTEX_ATTRIBUTE(0, VertexPN, position), VERTEX_ATTRIBUTE(1, VertexPN, normal) };
+};
+// the same buffer with only the position turned on, for depth only passes and light cubes
+struct VertexPNPositionOnly : VertexPN {};
+template <> struct VertexLayout<VertexPNPositionOnly>
+{
+    static constexpr VertexAttribute attributes[] = { VERTEX_ATTRIBUTE(0, VertexPN, position) };
+};
+// position + texture coordinates, the Ch9 cube
+struct VertexPT
+{
+    glm::vec3 position;
+    glm::vec2 texCoords;
+};
+template <> struct VertexLayout<VertexPT>
+{
+    static constexpr VertexAttribute attributes[] = { VERTEX_ATTRIBUTE(0, VertexPT, position), VERTEX_ATTRIBUTE(1, VertexPT, texCoords) };
+};
+
+// position + normal + texture coordinates, what the mesh loader (mesh_loader.h) produces
+struct VertexPNT
+{
+    glm::vec3 position;
+    glm::vec3 normal;
+    glm::vec2 texCoords;
+};
+template <> struct VertexLayout<VertexPNT>
+{
+    static constexpr VertexAttribute attributes[] = { VERTEX_ATTRIBUTE(0, VertexPNT, position), VERTEX_ATTRIBUTE(1, VertexPNT, normal), VERTEX_ATTRIBUTE(2, VertexPNT, texCoords) };
+};
+// the same thing after MeshData::quantize(): half position (w is padding), packed normal, half UV. 16 bytes instead of 32
+struct VertexPNTQuantized
+{
+    Half4 position;
+    PackedNormal normal;
+    Half2 texCoords;
+};
+template <> struct VertexLayout<VertexPNTQuantized>
+{
+    static constexpr VertexAttribute attributes[] = { VERTEX_ATTRIBUTE(0, VertexPNTQuantized, position), VERTEX_ATTRIBUTE(1, VertexPNTQuantized, normal), VERTEX_ATTRIBUTE(2, VertexPNTQuantized, texCoords) };
+};
+
+// One VAO per vertex layout, made on first use and shared by every buffer with that layout.
+// bind<Vertex>(buffer) attaches the buffer and binds the VAO, skipping whatever is already set.
+// If something else binds a VAO behind the cache's back, call forget() so the next bind doesn't get skipped.
+class VertexArrayCache
+{
+public:
+    VertexArrayCache() = default;
+    ~VertexArrayCache()
+    {
+        release();
+    }
+    VertexArrayCache(const VertexArrayCache&) = delete;
+    VertexArrayCache& operator=(const VertexArrayCache&) = delete;
+
+    // the VAO for this layout, with the attribute formats set up but no buffer attached
+    // ------------------------------------------------------------------------
+    template <class Vertex>
+    unsigned int get()
+    {
+        return entry<Vertex>().vao;
+    }
+    // attach vertexBuffer (and indexBuffer, 0 for none) and bind, ready to draw
+    // ------------------------------------------------------------------------
+    template <class Vertex>
+    void bind(unsigned int vertexBuffer, unsigned int indexBuffer = 0, GLintptr offset = 0)
+    {
+        Entry& e = entry<Vertex>();
+        if (e.vertexBuffer != vertexBuffer || e.offset != offset)
+        {
+            glVertexArrayVertexBuffer(e.vao, 0, vertexBuffer, offset, sizeof(Vertex));
+            e.vertexBuffer = vertexBuffer;
+            e.offset = offset;
+        }
+        if (e.indexBuffer != indexBuffer)
+        {
+            glVertexArrayElementBuffer(e.vao, indexBuffer);
+            e.indexBuffer = indexBuffer;
+        }
+        if (bound != e.vao)
+        {
+            glBindVertexArray(e.vao);
+            bound = e.vao;
+        }
+    }
+    // ------------------------------------------------------------------------
+    void forget()
+    {
+        bound = 0;
+    }
+    // deletes every VAO, while the context is still around. the next bind() makes them again
+    // ------------------------------------------------------------------------
+    void release()
+    {
+        for (auto& entry : vertexArrays)
+            glDeleteVertexArrays(1, &entry.second.vao);
+        vertexArrays.clear();
+        bound = 0;
+    }
+
+private:
+    struct Entry
+    {
+        unsigned int vao = 0;
+        unsigned int vertexBuffer = 0;
+        unsigned int indexBuffer = 0;
+        GLintptr offset = 0;
+    };
+    std::map<std::type_index, Entry> vertexArrays;
+    unsigned int bound = 0;
+
+    template <class Vertex>
+    Entry& entry()
+    {
+        static_assert(vertexLayoutValid<Vertex>(), "vertex layout has an attribute outside the vertex or a location used twice");
+        auto it = vertexArrays.find(std::type_index(typeid(Vertex)));
+        if (it != vertexArrays.end())
+            return it->second;
+
+        Entry& e = vertexArrays[std::type_index(typeid(Vertex))];
+        glCreateVertexArrays(1, &e.vao);
+        for (const VertexAttribute& attribute : VertexLayout<Vertex>::attributes)
+        {
+            glEnableVertexArrayAttrib(e.vao, attribute.location);
+            if (attribute.integer)
+                glVertexArrayAttribIFormat(e.vao, attribute.location, attribute.components, attribute.type, attribute.offset);
+            else
+                glVertexArrayAttribFormat(e.vao, attribute.location, attribute.components, attribute.type, attribute.normalized, attribute.offset);
+            glVertexArrayAttribBinding(e.vao, attribute.location, 0);
+        }
+        return e;
+    }
+};
+
+// immutable vertex/index buffer straight from an array, no binding needed
+// ------------------------------------------------------------------------
+inline unsigned int createStaticBuffer(const void* data, size_t bytes)
+{
+    unsigned int buffer;
+    glCreateBuffers(1, &buffer);
+    glNamedBufferStorage(buffer, bytes, data, 0);
+    return buffer;
+}
+#endif